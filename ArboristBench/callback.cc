@@ -0,0 +1,48 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file callback.cc
+
+   @brief Uniform variates for native drivers.  Employs
+   pre-allocated copy-out parameters, as do the front-end bridges.
+
+   @author Mark Seligman
+ */
+
+#include "callback.h"
+
+std::mt19937 CallBack::gen;
+
+
+/**
+   @brief Reseeds the generator.
+
+   @param seed is the new seed.
+
+   @return void.
+ */
+void CallBack::Seed(unsigned int seed) {
+  gen.seed(seed);
+}
+
+
+/**
+  @brief Call-back to uniform random-variate generator.
+
+  @param len is number of variates to generate.
+
+  @param out is the copy-out vector of generated variates.
+
+  @return void, with copy-out parameter vector.
+ */
+void CallBack::RUnif(int len, double out[]) {
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  for (int i = 0; i < len; i++) {
+    out[i] = distribution(gen);
+  }
+}
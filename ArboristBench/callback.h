@@ -0,0 +1,30 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file callback.h
+
+   @brief Native generation of the uniform variates a driver consumes
+   outside of training.
+
+   @author Mark Seligman
+ */
+
+#ifndef ARBORIST_CALLBACK_H
+#define ARBORIST_CALLBACK_H
+
+#include <random>
+
+class CallBack {
+  static std::mt19937 gen; // Seeded, so that runs are reproducible.
+
+ public:
+  static void Seed(unsigned int seed);
+  static void RUnif(int len, double out[]);
+};
+
+#endif
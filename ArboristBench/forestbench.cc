@@ -0,0 +1,490 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file forestbench.cc
+
+   @brief End-to-end training and prediction over synthetic scenarios,
+   reported as JSON for comparison across versions and thread counts.
+
+   Each scenario fixes a shape and response type:  regression, binary
+   and multiclass classification, high-cardinality factors, wide and
+   tall designs.  Data are drawn deterministically from fixed seeds, so
+   that any two runs of a scenario train on identical sets.  Each
+   scenario and thread count runs in a child process, so that peak
+   resident size is reported in isolation.
+
+   @author Mark Seligman
+ */
+
+#include "callback.h"
+#include "train.h"
+#include "rowrank.h"
+#include "forest.h"
+#include "leaf.h"
+#include "predict.h"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <omp.h>
+
+
+/**
+   @brief Shape and response type of a synthetic training set.
+ */
+class Scenario {
+ public:
+  const char *name;
+  unsigned int nRow;
+  unsigned int nPredNum;
+  unsigned int nPredFac;
+  unsigned int card; // Levels per factor.
+  unsigned int ctgWidth; // Zero for regression.
+};
+
+
+static const Scenario scenarioTable[] = {
+  {"regression", 100000, 16, 0, 0, 0},
+  {"binary", 100000, 16, 0, 0, 2},
+  {"multiclass", 100000, 16, 0, 0, 10},
+  {"highcard", 100000, 8, 4, 1000, 0},
+  {"wide", 1000, 10000, 0, 0, 0},
+  {"tall", 100000000, 4, 0, 0, 0}
+};
+
+
+/**
+   @brief Synthetic observations, column-major, with a response depending
+   nonlinearly on the leading numeric predictors and additively on the
+   levels of the leading factors.
+ */
+class Frame {
+ public:
+  const unsigned int nRow;
+  const unsigned int nPredNum;
+  const unsigned int nPredFac;
+  std::vector<double> xNum;
+  std::vector<int> xFac; // Zero-based codes.
+  std::vector<double> y; // Latent response.
+  std::vector<unsigned int> yCtg; // Empty for regression.
+
+  Frame(const Scenario &scenario, unsigned int nRow, unsigned int seed);
+  void Transpose(std::vector<double> &numT, std::vector<int> &facT) const;
+};
+
+
+/**
+   @brief Draws the observations.  Level effects are seeded by the
+   scenario alone, so that training and test sets share a response.
+
+   @param seed seeds the observations.
+ */
+Frame::Frame(const Scenario &scenario, unsigned int _nRow, unsigned int seed) : nRow(_nRow), nPredNum(scenario.nPredNum), nPredFac(scenario.nPredFac), xNum(size_t(_nRow) * scenario.nPredNum), xFac(size_t(_nRow) * scenario.nPredFac), y(_nRow) {
+  std::normal_distribution<double> normal;
+  const unsigned int facEffect = std::min(nPredFac, 2u);
+  std::vector<double> effect(size_t(facEffect) * scenario.card);
+  std::mt19937 effectGen(scenario.card);
+  for (auto & eff : effect)
+    eff = 1.5 * normal(effectGen);
+
+  std::mt19937 gen(seed);
+  for (auto & x : xNum)
+    x = normal(gen);
+  for (size_t i = 0; i < size_t(nRow) * (nPredNum / 3); i++)
+    xNum[i] = std::round(2.0 * xNum[i]);
+  std::uniform_int_distribution<int> level(0, scenario.card > 0 ? scenario.card - 1 : 0);
+  for (auto & code : xFac)
+    code = level(gen);
+
+  for (unsigned int rw = 0; rw < nRow; rw++) {
+    double x0 = nPredNum > 0 ? xNum[rw] : 0.0;
+    double x1 = nPredNum > 1 ? xNum[nRow + rw] : 0.0;
+    double x2 = nPredNum > 2 ? xNum[2 * size_t(nRow) + rw] : 1.0;
+    y[rw] = x0 + 2.0 * x1 * x2 + std::sin(x0) + 0.3 * normal(gen);
+    for (unsigned int facIdx = 0; facIdx < facEffect; facIdx++)
+      y[rw] += effect[size_t(facIdx) * scenario.card + xFac[size_t(facIdx) * nRow + rw]];
+  }
+
+  // Classes are equal-width bands of the latent response's logistic.
+  if (scenario.ctgWidth > 0) {
+    yCtg = std::vector<unsigned int>(nRow);
+    for (unsigned int rw = 0; rw < nRow; rw++) {
+      double p = 1.0 / (1.0 + std::exp(-0.5 * y[rw]));
+      yCtg[rw] = std::min((unsigned int) (p * scenario.ctgWidth), scenario.ctgWidth - 1);
+    }
+  }
+}
+
+
+/**
+   @brief Lays the observations out row-major, as prediction expects.
+
+   @return void, with output vector parameters.
+ */
+void Frame::Transpose(std::vector<double> &numT, std::vector<int> &facT) const {
+  numT = std::vector<double>(size_t(nRow) * nPredNum);
+  facT = std::vector<int>(size_t(nRow) * nPredFac);
+  for (unsigned int rw = 0; rw < nRow; rw++) {
+    for (unsigned int numIdx = 0; numIdx < nPredNum; numIdx++)
+      numT[size_t(rw) * nPredNum + numIdx] = xNum[size_t(numIdx) * nRow + rw];
+    for (unsigned int facIdx = 0; facIdx < nPredFac; facIdx++)
+      facT[size_t(rw) * nPredFac + facIdx] = xFac[size_t(facIdx) * nRow + rw];
+  }
+}
+
+
+/**
+   @brief Outcome of a single run, as reported by the child.
+ */
+class RunStat {
+ public:
+  double generateSec;
+  double presortSec;
+  double trainSec;
+  double predictSec;
+  double score; // Held-out MSE or misprediction rate.
+  size_t nodeCount;
+  size_t leafCount;
+  unsigned int nThread; // As seen by OpenMP.
+};
+
+
+static double Since(std::chrono::steady_clock::time_point &start) {
+  auto now = std::chrono::steady_clock::now();
+  double sec = std::chrono::duration<double>(now - start).count();
+  start = now;
+  return sec;
+}
+
+
+/**
+   @brief Generates, presorts, trains and predicts a single scenario.
+
+   @param scenario is the shape, with any overrides applied.
+
+   @param nTest is the held-out row count.
+
+   @param dfBytes is the footprint below which nodes are finished
+   depth-first, zero if none are.
+
+   @return run statistics.
+ */
+static RunStat RunOnce(const Scenario &scenario, unsigned int nTree, unsigned int nTest, unsigned int trainBlock, size_t dfBytes) {
+  RunStat stat;
+  memset(&stat, 0, sizeof(stat));
+  stat.nThread = omp_get_max_threads();
+  unsigned int nRow = scenario.nRow;
+  unsigned int nPredNum = scenario.nPredNum;
+  unsigned int nPredFac = scenario.nPredFac;
+  unsigned int nPred = nPredNum + nPredFac;
+  unsigned int ctgWidth = scenario.ctgWidth;
+  bool isCtg = ctgWidth > 0;
+
+  auto start = std::chrono::steady_clock::now();
+  Frame train(scenario, nRow, 1);
+  Frame test(scenario, nTest, 2);
+  stat.generateSec = Since(start);
+
+  std::vector<int> row(size_t(nRow) * nPred), rank(size_t(nRow) * nPred), invNum(size_t(nRow) * nPredNum);
+  if (nPredNum > 0)
+    RowRank::PreSortNum(&train.xNum[0], nPredNum, nRow, &row[0], &rank[0], &invNum[0]);
+  if (nPredFac > 0)
+    RowRank::PreSortFac(&train.xFac[0], nPredNum, nPredFac, nRow, &row[0], &rank[0]);
+  std::vector<double> yRanked;
+  std::vector<unsigned int> row2Rank;
+  if (!isCtg) {
+    yRanked = train.y;
+    std::sort(yRanked.begin(), yRanked.end());
+    row2Rank = std::vector<unsigned int>(nRow);
+    for (unsigned int rw = 0; rw < nRow; rw++)
+      row2Rank[rw] = std::lower_bound(yRanked.begin(), yRanked.end(), train.y[rw]) - yRanked.begin();
+  }
+  stat.presortSec = Since(start);
+
+  // Defaults follow the front ends.
+  int minNode = isCtg ? 2 : 5;
+  int predFixed = nPred >= 16 ? 0 : (isCtg ? std::max(int(std::floor(std::sqrt(double(nPred)))), 1) : std::max(int(nPred / 3), 1));
+  double predProb = predFixed != 0 ? 0.0 : (isCtg ? std::ceil(std::sqrt(double(nPred))) / nPred : 0.4);
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predWeight(nPred, predProb);
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<int> facCard(nPredFac, scenario.card);
+  std::vector<unsigned int> origin(nTree), facOrigin(nTree), leafOrigin(nTree), facSplit, leafRank;
+  std::vector<double> predInfo(nPred), weight;
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+
+  CallBack::Seed(17);
+  Train::Init(nPredNum > 0 ? &train.xNum[0] : 0, nPredFac > 0 ? &facCard[0] : 0, nPredFac > 0 ? scenario.card : 0, nPredNum, nPredFac, nRow, nTree, nRow, &sampleWeight[0], true, trainBlock, minNode, 0.01, 0, ctgWidth, predFixed, &predWeight[0], &regMono[0], 0, 0, 17, 1 << 20, dfBytes);
+  if (isCtg) {
+    std::vector<double> jitter(nRow), proxy(nRow);
+    CallBack::RUnif(nRow, &jitter[0]);
+    double recipLen = 1.0 / nRow;
+    for (unsigned int rw = 0; rw < nRow; rw++)
+      proxy[rw] = 1.0 / ctgWidth + (jitter[rw] - 0.5) * 0.5 * (recipLen * recipLen);
+    Train::Classification(&row[0], &rank[0], nPredNum > 0 ? &invNum[0] : 0, train.yCtg, ctgWidth, proxy, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, weight);
+  }
+  else {
+    Train::Regression(&row[0], &rank[0], nPredNum > 0 ? &invNum[0] : 0, train.y, row2Rank, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, leafRank);
+  }
+  stat.trainSec = Since(start);
+  stat.nodeCount = forestNode.size();
+  stat.leafCount = leafNode.size();
+
+  std::vector<double> numT;
+  std::vector<int> facT;
+  test.Transpose(numT, facT);
+  (void) Since(start);
+  double *blockNumT = nPredNum > 0 ? &numT[0] : 0;
+  int *blockFacT = nPredFac > 0 ? &facT[0] : 0;
+  if (isCtg) {
+    std::vector<int> yPred(nTest), census(size_t(nTest) * ctgWidth), conf(ctgWidth * ctgWidth);
+    std::vector<double> error(ctgWidth);
+    Predict::Classification(blockNumT, blockFacT, nPredNum, nPredFac, forestNode, origin, facOrigin, facSplit, leafOrigin, leafNode, bagPack, weight, yPred, &census[0], test.yCtg, &conf[0], error, 0, 0);
+    stat.predictSec = Since(start);
+    unsigned int wrong = 0;
+    for (unsigned int rw = 0; rw < nTest; rw++)
+      wrong += yPred[rw] != int(test.yCtg[rw]);
+    stat.score = double(wrong) / nTest;
+  }
+  else {
+    std::vector<double> yPred(nTest);
+    Predict::Regression(blockNumT, blockFacT, nPredNum, nPredFac, forestNode, origin, facOrigin, facSplit, leafOrigin, leafNode, bagPack, leafRank, yRanked, yPred, 0);
+    stat.predictSec = Since(start);
+    double sse = 0.0;
+    for (unsigned int rw = 0; rw < nTest; rw++)
+      sse += (yPred[rw] - test.y[rw]) * (yPred[rw] - test.y[rw]);
+    stat.score = sse / nTest;
+  }
+
+  return stat;
+}
+
+
+/**
+   @brief Runs a scenario in a child process.
+
+   @param nThread is the OpenMP thread count, zero for the default.
+
+   @param stat outputs the child's run statistics.
+
+   @param usage outputs the child's resource usage.
+
+   @return true iff the child completed.
+ */
+static bool Fork(const Scenario &scenario, unsigned int nTree, unsigned int nTest, unsigned int trainBlock, size_t dfBytes, unsigned int nThread, RunStat &stat, struct rusage &usage) {
+  int fd[2];
+  if (pipe(fd) != 0)
+    return false;
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    if (nThread > 0)
+      omp_set_num_threads(nThread);
+    RunStat childStat = RunOnce(scenario, nTree, nTest, trainBlock, dfBytes);
+    ssize_t written = write(fd[1], &childStat, sizeof(childStat));
+    _exit(written == sizeof(childStat) ? 0 : 1);
+  }
+  close(fd[1]);
+  if (pid < 0) {
+    close(fd[0]);
+    return false;
+  }
+
+  ssize_t got = read(fd[0], &stat, sizeof(stat));
+  close(fd[0]);
+  int status;
+  if (wait4(pid, &status, 0, &usage) != pid)
+    return false;
+
+  return got == sizeof(stat) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+/**
+   @brief Writes a string as a JSON literal.
+ */
+static void JsonString(FILE *out, const std::string &str) {
+  fputc('"', out);
+  for (auto c : str) {
+    if (c == '"' || c == '\\')
+      fprintf(out, "\\%c", c);
+    else if ((unsigned char) c < 0x20)
+      fprintf(out, "\\u%04x", c);
+    else
+      fputc(c, out);
+  }
+  fputc('"', out);
+}
+
+
+/**
+   @brief Splits a comma-separated list.
+ */
+static std::vector<std::string> Split(const std::string &list) {
+  std::vector<std::string> item;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos)
+      end = list.size();
+    if (end > start)
+      item.push_back(list.substr(start, end - start));
+    start = end + 1;
+  }
+  return item;
+}
+
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-s scenario,...] [-j nThread,...] [-n nRow] [-p nPred] [-t nTree] [-T nTest] [-b trainBlock] [-d dfBytes] [-l label] [-o file]\n", prog);
+  fprintf(stderr, "  scenarios:");
+  for (auto & scenario : scenarioTable)
+    fprintf(stderr, " %s", scenario.name);
+  fprintf(stderr, " all\n");
+  fprintf(stderr, "  -n and -p override the scenario's row and numeric predictor counts.\n");
+  fprintf(stderr, "  -d finishes depth-first nodes whose compact copy fits in dfBytes:  default 0, none.\n");
+  fprintf(stderr, "  -l labels the results, as by version.  JSON is written to stdout unless -o.\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  std::string scenarioList = "regression,binary,multiclass,highcard"; // Wide and tall by request.
+  std::string threadList = "0";
+  unsigned int nRowArg = 0;
+  unsigned int nPredArg = 0;
+  unsigned int nTree = 100;
+  unsigned int nTestArg = 10000;
+  unsigned int trainBlock = 8;
+  size_t dfBytes = 0;
+  std::string label;
+  const char *outPath = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "s:j:n:p:t:T:b:d:l:o:h")) != -1) {
+    switch (opt) {
+    case 's':
+      scenarioList = optarg;
+      break;
+    case 'j':
+      threadList = optarg;
+      break;
+    case 'n':
+      nRowArg = atoi(optarg);
+      break;
+    case 'p':
+      nPredArg = atoi(optarg);
+      break;
+    case 't':
+      nTree = atoi(optarg);
+      break;
+    case 'T':
+      nTestArg = atoi(optarg);
+      break;
+    case 'b':
+      trainBlock = atoi(optarg);
+      break;
+    case 'd':
+      dfBytes = strtoull(optarg, 0, 10);
+      break;
+    case 'l':
+      label = optarg;
+      break;
+    case 'o':
+      outPath = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (nTree == 0 || nTestArg == 0 || trainBlock == 0) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Scenario> scenarioRun;
+  for (auto & name : Split(scenarioList)) {
+    bool found = false;
+    for (auto & scenario : scenarioTable) {
+      if (name == "all" || name == scenario.name) {
+        scenarioRun.push_back(scenario);
+        found = true;
+      }
+    }
+    if (!found) {
+      fprintf(stderr, "%s: unknown scenario %s\n", argv[0], name.c_str());
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  for (auto & scenario : scenarioRun) {
+    if (nRowArg > 0)
+      scenario.nRow = nRowArg;
+    if (nPredArg > 0)
+      scenario.nPredNum = nPredArg;
+  }
+  std::vector<unsigned int> threadRun;
+  for (auto & item : Split(threadList))
+    threadRun.push_back(atoi(item.c_str()));
+
+  FILE *out = outPath == 0 ? stdout : fopen(outPath, "w");
+  if (out == 0) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], outPath);
+    return 1;
+  }
+  char host[256] = "";
+  gethostname(host, sizeof(host) - 1);
+  fprintf(out, "{\n  \"bench\": \"forestbench\",\n  \"label\": ");
+  JsonString(out, label);
+  fprintf(out, ",\n  \"host\": ");
+  JsonString(out, host);
+  fprintf(out, ",\n  \"time\": %lld,\n  \"nTree\": %u,\n  \"trainBlock\": %u,\n  \"dfBytes\": %zu,\n  \"runs\": [", (long long) time(0), nTree, trainBlock, dfBytes);
+
+  fprintf(stderr, "%-11s %10s %6s %4s %9s %9s %10s %12s %10s %9s\n", "scenario", "nRow", "nPred", "thr", "trainSec", "trees/s", "predictSec", "predRows/s", "peakMB", "score");
+  bool first = true;
+  int status = 0;
+  for (auto & scenario : scenarioRun) {
+    unsigned int nTest = std::min(nTestArg, scenario.nRow);
+    unsigned int nPred = scenario.nPredNum + scenario.nPredFac;
+    for (auto nThread : threadRun) {
+      RunStat stat;
+      struct rusage usage;
+      bool completed = Fork(scenario, nTree, nTest, trainBlock, dfBytes, nThread, stat, usage);
+      double peakMB = usage.ru_maxrss / 1024.0; // Linux reports kilobytes.
+
+      fprintf(out, "%s\n    {\"scenario\": \"%s\", \"nRow\": %u, \"nPredNum\": %u, \"nPredFac\": %u, \"card\": %u, \"ctgWidth\": %u, \"nTest\": %u, \"threadsRequested\": %u, \"completed\": %s", first ? "" : ",", scenario.name, scenario.nRow, scenario.nPredNum, scenario.nPredFac, scenario.card, scenario.ctgWidth, nTest, nThread, completed ? "true" : "false");
+      first = false;
+      if (!completed) {
+        fprintf(out, "}");
+        fprintf(stderr, "%-11s %10u %6u %4u %9s\n", scenario.name, scenario.nRow, nPred, nThread, "failed");
+        status = 1;
+        continue;
+      }
+      fprintf(out, ", \"threads\": %u, \"phaseSec\": {\"generate\": %.6f, \"presort\": %.6f, \"train\": %.6f, \"predict\": %.6f}, \"treesPerSec\": %.6g, \"trainRowsPerSec\": %.6g, \"predictRowsPerSec\": %.6g, \"peakRSSBytes\": %.0f, \"majorFaults\": %ld, \"nodeCount\": %zu, \"leafCount\": %zu, \"%s\": %.6g}", stat.nThread, stat.generateSec, stat.presortSec, stat.trainSec, stat.predictSec, nTree / stat.trainSec, double(scenario.nRow) * nTree / stat.trainSec, nTest / stat.predictSec, usage.ru_maxrss * 1024.0, usage.ru_majflt, stat.nodeCount, stat.leafCount, scenario.ctgWidth > 0 ? "misprediction" : "mse", stat.score);
+      fprintf(stderr, "%-11s %10u %6u %4u %9.3f %9.2f %10.3f %12.0f %10.1f %9.4f\n", scenario.name, scenario.nRow, nPred, stat.nThread, stat.trainSec, nTree / stat.trainSec, stat.predictSec, nTest / stat.predictSec, peakMB, stat.score);
+      fflush(out);
+    }
+  }
+  fprintf(out, "\n  ]\n}\n");
+  if (out != stdout)
+    fclose(out);
+
+  return status;
+}
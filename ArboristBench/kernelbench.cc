@@ -0,0 +1,642 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file kernelbench.cc
+
+   @brief Times the innermost kernels of training and prediction in
+   isolation, over synthetic designs of increasing row count.
+
+   Training state is built by the core's own factories, up to the level
+   at which a kernel applies, and the kernel is then invoked directly
+   and repeatedly on that state.  Each kernel runs on a single thread,
+   so that its time reflects the kernel alone and not the schedule.
+   Times are the best over repetitions, reported in nanoseconds per
+   element scanned.
+
+   @author Mark Seligman
+ */
+
+#include "synth.h"
+#include "callback.h"
+#include "train.h"
+#include "rowrank.h"
+#include "sample.h"
+#include "samplepred.h"
+#include "bottom.h"
+#include "index.h"
+#include "pretree.h"
+#include "splitpred.h"
+#include "runset.h"
+#include "forest.h"
+#include "leaf.h"
+#include "predict.h"
+#include "predblock.h"
+#include "quant.h"
+#include "bv.h"
+
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+
+/**
+   @brief Synthetic design with numeric and factor predictors, presorted
+   as a front end would present it to training.
+ */
+class Design {
+ public:
+  const unsigned int nRow;
+  const unsigned int nPredNum;
+  const unsigned int nPredFac;
+  std::vector<double> xNum; // Column-major.
+  std::vector<int> xFac; // Column-major, zero-based.
+  std::vector<int> facCard;
+  int cardMax;
+  std::vector<double> y;
+  std::vector<double> yRanked;
+  std::vector<unsigned int> row2Rank;
+  std::vector<int> row, rank, invNum;
+
+  Design(unsigned int _nRow, unsigned int _nPredNum, unsigned int _nPredFac, unsigned int card, unsigned int seed);
+
+  inline unsigned int NPred() const {
+    return nPredNum + nPredFac;
+  }
+
+
+  /**
+     @brief Derives a categorical response from the ranks of the numeric
+     response, with a jittered uniform proxy.
+
+     @return void, with output vectors.
+   */
+  void Ctg(unsigned int ctgWidth, std::vector<unsigned int> &yCtg, std::vector<double> &proxy) const {
+    yCtg = std::vector<unsigned int>(nRow);
+    proxy = std::vector<double>(nRow);
+    std::vector<double> jitter(nRow);
+    CallBack::RUnif(nRow, &jitter[0]);
+    double recipLen = 1.0 / nRow;
+    for (unsigned int rw = 0; rw < nRow; rw++) {
+      yCtg[rw] = (size_t(row2Rank[rw]) * ctgWidth) / nRow;
+      proxy[rw] = 1.0 / ctgWidth + (jitter[rw] - 0.5) * 0.5 * recipLen * recipLen;
+    }
+  }
+};
+
+
+/**
+   @brief Draws the numeric predictors from Synth, whose trailing
+   columns are then binned into 'card' levels to form the factors.
+ */
+Design::Design(unsigned int _nRow, unsigned int _nPredNum, unsigned int _nPredFac, unsigned int card, unsigned int seed) : nRow(_nRow), nPredNum(_nPredNum), nPredFac(_nPredFac), xNum(size_t(_nRow) * _nPredNum), xFac(size_t(_nRow) * _nPredFac), facCard(_nPredFac, card), cardMax(_nPredFac > 0 ? card : 0), row(size_t(_nRow) * (_nPredNum + _nPredFac)), rank(size_t(_nRow) * (_nPredNum + _nPredFac)), invNum(size_t(_nRow) * _nPredNum) {
+  Synth synth(nRow, NPred(), seed);
+  y = synth.y;
+  yRanked = synth.yRanked;
+  row2Rank = synth.row2Rank;
+  std::copy(synth.xNum.begin(), synth.xNum.begin() + xNum.size(), xNum.begin());
+  for (size_t i = 0; i < xFac.size(); i++) {
+    int code = int(std::floor((synth.xNum[xNum.size() + i] + 2.5) * card / 5.0));
+    xFac[i] = std::min(std::max(code, 0), int(card) - 1);
+  }
+
+  if (nPredNum > 0)
+    RowRank::PreSortNum(&xNum[0], nPredNum, nRow, &row[0], &rank[0], &invNum[0]);
+  if (nPredFac > 0)
+    RowRank::PreSortFac(&xFac[0], nPredNum, nPredFac, nRow, &row[0], &rank[0]);
+}
+
+
+/**
+   @brief Accumulates the best time of a kernel over repetitions.
+ */
+class Timing {
+  std::chrono::steady_clock::time_point start;
+  double rep; // Seconds accumulated in the current repetition.
+ public:
+  double best;
+  double elements; // Per repetition.
+
+  Timing() : rep(0.0), best(0.0), elements(0.0) {
+  }
+
+
+  inline void Start() {
+    start = std::chrono::steady_clock::now();
+  }
+
+
+  inline void Stop(double _elements) {
+    rep += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    elements = _elements;
+  }
+
+
+  /**
+     @brief Closes a repetition.
+   */
+  void Rep() {
+    if (best == 0.0 || rep < best)
+      best = rep;
+    rep = 0.0;
+  }
+};
+
+
+/**
+   @brief Drives the kernels over state built by the core.  Friend of the
+   core classes whose kernels or state are otherwise private.
+ */
+class KernelBench {
+  static void Step(Index *index, unsigned int &levelCount);
+  static void Restage(Index *index, Bottom *bottom, SamplePred *samplePred, unsigned int levelCount, unsigned int nPred, unsigned int reps, Timing &general, Timing &two);
+  static void Split(Index *index, Bottom *bottom, SamplePred *samplePred, unsigned int ctgWidth, Timing &num, Timing &fac);
+
+ public:
+  static void Report(const char *kernel, const std::string &variant, unsigned int nRow, const Timing &timing);
+  static void Train(const Design &design, unsigned int ctgWidth, unsigned int reps);
+  static void Predict(const Design &design, unsigned int nTree, unsigned int reps);
+  static void Bits(unsigned int nRow, unsigned int nTree, unsigned int reps);
+};
+
+
+void KernelBench::Report(const char *kernel, const std::string &variant, unsigned int nRow, const Timing &timing) {
+  if (timing.elements == 0.0)
+    return;
+  printf("%-24s %-12s %9u %12.0f %9.2f\n", kernel, variant.c_str(), nRow, timing.elements, 1.0e9 * timing.best / timing.elements);
+  fflush(stdout);
+}
+
+
+/**
+   @brief Trains a single level, as does Index::Levels().
+
+   @param levelCount inputs the node count of the level, and outputs
+   that of the next.
+
+   @return void, with output reference parameter.
+ */
+void KernelBench::Step(Index *index, unsigned int &levelCount) {
+  index->bottom->LevelInit(index->LevelArena());
+  unsigned int splitNext, lhNext, leafNext, dfNext;
+  NodeCache *nodeCache = index->LevelConsume(levelCount, splitNext, lhNext, leafNext, dfNext);
+  if (splitNext != 0) {
+    index->LevelProduce(nodeCache, levelCount, splitNext, lhNext, leafNext);
+  }
+  levelCount = splitNext;
+  delete [] nodeCache;
+  index->bottom->LevelClear();
+  index->level++;
+}
+
+
+/**
+   @brief Times the splitting kernels over the root, with the level's
+   splitting state initialized as by Bottom::LevelSplit().
+
+   @param num accumulates numeric splitting.
+
+   @param fac accumulates factor splitting.
+
+   @return void, with accumulated timings.
+ */
+void KernelBench::Split(Index *index, Bottom *bottom, SamplePred *samplePred, unsigned int ctgWidth, Timing &num, Timing &fac) {
+  bottom->LevelInit(index->LevelArena());
+  Run *run;
+  bool *splitFlags = bottom->splitPred->LevelInit(index, index->indexNode, bottom, 1, run);
+  std::vector<SplitPair> pairNode;
+  std::vector<RestageNode> restageNode;
+  std::vector<RestagePair> restagePair;
+  (void) bottom->PairInit(run, splitFlags, pairNode, restageNode, restagePair);
+  bottom->splitPred->RunOffsets();
+
+  SPReg *spReg = static_cast<SPReg *>(bottom->splitPred);
+  SPCtg *spCtg = static_cast<SPCtg *>(bottom->splitPred);
+  const IndexNode *root = &index->indexNode[0];
+  double numElts = 0.0;
+  double facElts = 0.0;
+  for (auto pair : pairNode) {
+    int setIdx;
+    if (!pair.Split(setIdx))
+      continue;
+    unsigned int restageIdx;
+    unsigned int predIdx = pair.BottomIdx(restageIdx); // Root:  level index zero.
+    const SPNode *spn = samplePred->PredBase(predIdx, 0);
+    SPRank rank = samplePred->Ranks(predIdx, 0);
+    if (setIdx >= 0) {
+      if (ctgWidth > 0) {
+        fac.Start();
+        spCtg->SplitFacGini(predIdx, setIdx, root, spn, rank);
+        fac.Stop(facElts += root->idxCount);
+      }
+    }
+    else if (ctgWidth > 0) {
+      num.Start();
+      (spCtg->*SPCtg::splitNumGini)(predIdx, root, spn, rank);
+      num.Stop(numElts += root->idxCount);
+    }
+    else {
+      num.Start();
+      spReg->SplitNum(predIdx, root, spn, rank);
+      num.Stop(numElts += root->idxCount);
+    }
+  }
+  bottom->LevelClear();
+}
+
+
+/**
+   @brief Times restaging at the level passed, which must be at least
+   the second below the root.  Restaging from the preceding level, the
+   customary case, exercises RestageTwo().  Restaging directly from the
+   root, as when a predictor has sat out a level, exercises the general
+   multi-path Restage().
+
+   Restaging leaves the content of each cell unchanged as a set, so
+   that repetitions remain valid as the two buffers are overwritten in
+   turn.
+
+   @param general accumulates restaging from the root.
+
+   @param two accumulates restaging from the preceding level.
+
+   @return void, with accumulated timings.
+ */
+void KernelBench::Restage(Index *index, Bottom *bottom, SamplePred *samplePred, unsigned int levelCount, unsigned int nPred, unsigned int reps, Timing &general, Timing &two) {
+  bottom->LevelInit(index->LevelArena());
+  Run *run;
+  bool *splitFlags = bottom->splitPred->LevelInit(index, index->indexNode, bottom, levelCount, run);
+  std::vector<SplitPair> pairNode;
+  std::vector<RestageNode> restageNode;
+  std::vector<RestagePair> restagePair;
+  unsigned int targTot = bottom->PairInit(run, splitFlags, pairNode, restageNode, restagePair);
+  std::vector<PathNode> pathNode(targTot);
+  for (auto & node : pathNode)
+    node.Init();
+  BV *restageSource = bottom->RestageInit(index->indexNode, pairNode, restageNode, pathNode);
+
+  // The root cell spans every staged sample, in buffer zero.
+  const unsigned int levelDel = 2;
+  std::vector<unsigned int> explRoot(nPred);
+  for (unsigned int predIdx = 0; predIdx < nPred; predIdx++)
+    explRoot[predIdx] = samplePred->StageCount(predIdx);
+  std::vector<PathNode> pathRoot(1 << levelDel);
+  for (auto & node : pathRoot)
+    node.Init();
+  for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++) {
+    unsigned int start, extent, path;
+    index->indexNode[levelIdx].PathCoords(start, extent, path);
+    pathRoot[path & ((1 << levelDel) - 1)].Init(levelIdx, start, extent);
+  }
+  RestageNode rootNode;
+  rootNode.Init(0, &explRoot[0], levelDel, 0);
+
+  for (unsigned int rep = 0; rep < reps; rep++) {
+    double elts = 0.0;
+    for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
+      if (explRoot[predIdx] == 0)
+        continue;
+      general.Start();
+      rootNode.Restage(bottom, samplePred, pathRoot, predIdx, 0);
+      general.Stop(elts += explRoot[predIdx]);
+    }
+    general.Rep();
+
+    elts = 0.0;
+    for (auto rsPair : restagePair) {
+      int nodeIdx, predIdx;
+      rsPair.Coords(nodeIdx, predIdx);
+      unsigned int sourceBit = restageSource->TestBit(bottom->PairOffset(nodeIdx, predIdx)) ? 1 : 0;
+      two.Start();
+      restageNode[nodeIdx].Restage(bottom, samplePred, pathNode, predIdx, sourceBit);
+      two.Stop(elts += restageNode[nodeIdx].Extent(predIdx));
+    }
+    two.Rep();
+  }
+
+  delete restageSource;
+  bottom->LevelClear();
+}
+
+
+/**
+   @brief Times staging, splitting and restaging over a single tree.
+
+   @param ctgWidth is the response cardinality, zero for regression.
+
+   @return void.
+ */
+void KernelBench::Train(const Design &design, unsigned int ctgWidth, unsigned int reps) {
+  unsigned int nRow = design.nRow;
+  unsigned int nPred = design.NPred();
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predProb(nPred, 1.0); // Every pair splits.
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<double> xNum(design.xNum);
+  std::vector<int> facCard(design.facCard);
+  std::vector<int> row(design.row), rank(design.rank), invNum(design.invNum);
+  std::vector<unsigned int> yCtg;
+  std::vector<double> proxy;
+  if (ctgWidth > 0)
+    design.Ctg(ctgWidth, yCtg, proxy);
+
+  CallBack::Seed(17);
+  Train::Init(design.nPredNum > 0 ? &xNum[0] : 0, design.nPredFac > 0 ? &facCard[0] : 0, design.cardMax, design.nPredNum, design.nPredFac, nRow, 1, nRow, &sampleWeight[0], true, 1, 2, 0.0, 0, ctgWidth, 0, &predProb[0], &regMono[0], 0, 0, 17);
+  RowRank *rowRank = new RowRank(&row[0], &rank[0], design.nPredNum > 0 ? &invNum[0] : 0, nRow, nPred);
+  Sample *sample;
+  if (ctgWidth > 0)
+    sample = Sample::FactoryCtg(proxy, rowRank, yCtg, 0);
+  else
+    sample = Sample::FactoryReg(design.y, rowRank, design.row2Rank, 0);
+  std::string variant = ctgWidth > 0 ? "ctg" + std::to_string(ctgWidth) : "reg";
+
+  Timing preStage;
+  for (unsigned int rep = 0; rep < reps; rep++) {
+    preStage.Start();
+    for (unsigned int predIdx = 0; predIdx < nPred; predIdx++)
+      sample->PreStage(rowRank, predIdx);
+    preStage.Stop(double(nRow) * nPred);
+    preStage.Rep();
+  }
+  if (ctgWidth == 0)
+    Report("Sample::PreStage", "", nRow, preStage);
+
+  Bottom *bottom = sample->Bot();
+  SamplePred *samplePred = sample->SmpPred();
+  PreTree *preTree = PreTree::Acquire(sample->BagCount());
+  Index *index = new Index(samplePred, preTree, bottom, Sample::NSamp(), sample->BagCount(), sample->BagSum(), 0.0, 0, false);
+
+  Timing num, fac;
+  for (unsigned int rep = 0; rep < reps; rep++) {
+    Split(index, bottom, samplePred, ctgWidth, num, fac);
+    num.Rep();
+    fac.Rep();
+  }
+  if (ctgWidth == 0) {
+    Report("SPReg::SplitNumWV", "", nRow, num);
+  }
+  else {
+    Report("SPCtg::SplitNumGini", variant, nRow, num);
+    Report("SPCtg::SplitFacGini", variant, nRow, fac);
+  }
+
+  if (ctgWidth == 0) {
+    unsigned int levelCount = 1;
+    Step(index, levelCount);
+    if (levelCount > 0)
+      Step(index, levelCount);
+    if (levelCount > 0) {
+      Timing general, two;
+      Restage(index, bottom, samplePred, levelCount, nPred, reps, general, two);
+      Report("RestageNode::RestageTwo", "", nRow, two);
+      Report("RestageNode::Restage", "paths4", nRow, general);
+    }
+  }
+
+  delete index;
+  PreTree::Release(preTree);
+  delete sample;
+  delete rowRank;
+  Train::DeImmutables();
+}
+
+
+/**
+   @brief Times tree walking and quantile estimation over a trained
+   regression forest, predicting a block of the training rows.
+
+   @return void.
+ */
+void KernelBench::Predict(const Design &design, unsigned int nTree, unsigned int reps) {
+  unsigned int nRow = design.nRow;
+  unsigned int nPredNum = design.nPredNum;
+  unsigned int nPredFac = design.nPredFac;
+  unsigned int nPred = design.NPred();
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predProb(nPred, 1.0);
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<double> xNum(design.xNum);
+  std::vector<int> facCard(design.facCard);
+  std::vector<int> row(design.row), rank(design.rank), invNum(design.invNum);
+  std::vector<unsigned int> origin(nTree), facOrigin(nTree), leafOrigin(nTree), facSplit, leafRank;
+  std::vector<double> predInfo(nPred);
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+
+  CallBack::Seed(17);
+  Train::Init(nPredNum > 0 ? &xNum[0] : 0, nPredFac > 0 ? &facCard[0] : 0, design.cardMax, nPredNum, nPredFac, nRow, nTree, nRow, &sampleWeight[0], true, 1, 5, 0.01, 0, 0, std::max(nPred / 3, 1u), &predProb[0], &regMono[0], 0, 0, 17);
+  Train::Regression(&row[0], &rank[0], nPredNum > 0 ? &invNum[0] : 0, design.y, design.row2Rank, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, leafRank);
+
+  // Prediction expects row-major blocks.
+  const unsigned int blockRows = std::min(nRow, 4096u); // Within Predict's row block.
+  std::vector<double> numT(size_t(blockRows) * nPredNum);
+  std::vector<int> facT(size_t(blockRows) * nPredFac);
+  for (unsigned int rw = 0; rw < blockRows; rw++) {
+    for (unsigned int numIdx = 0; numIdx < nPredNum; numIdx++)
+      numT[size_t(rw) * nPredNum + numIdx] = design.xNum[size_t(numIdx) * nRow + rw];
+    for (unsigned int facIdx = 0; facIdx < nPredFac; facIdx++)
+      facT[size_t(rw) * nPredFac + facIdx] = design.xFac[size_t(facIdx) * nRow + rw];
+  }
+
+  Forest forest(&forestNode[0], &origin[0], nTree, &facOrigin[0], facSplit.data(), facSplit.size());
+  LeafReg leafReg(&leafOrigin[0], nTree, &leafNode[0], leafNode.size(), &bagPack[0], &leafRank[0]);
+  PBPredict::Immutables(nPredNum > 0 ? &numT[0] : 0, nPredFac > 0 ? &facT[0] : 0, nPredNum, nPredFac, blockRows);
+  PredictReg predictReg(&leafReg, &design.yRanked[0], nRow, nTree, blockRows, leafReg.NodeCount());
+  BitMatrix *bag = leafReg.ForestBag(0);
+
+  Timing walk;
+  for (unsigned int rep = 0; rep < reps; rep++) {
+    walk.Start();
+    if (nPredFac == 0) {
+      for (unsigned int rw = 0; rw < blockRows; rw++)
+        forest.PredictRowNum(&predictReg, rw, PBPredict::RowNum(rw), rw, bag);
+    }
+    else if (nPredNum == 0) {
+      for (unsigned int rw = 0; rw < blockRows; rw++)
+        forest.PredictRowFac(&predictReg, rw, PBPredict::RowFac(rw), rw, bag);
+    }
+    else {
+      for (unsigned int rw = 0; rw < blockRows; rw++)
+        forest.PredictRowMixed(&predictReg, rw, PBPredict::RowNum(rw), PBPredict::RowFac(rw), rw, bag);
+    }
+    walk.Stop(double(blockRows) * nTree);
+    walk.Rep();
+  }
+  Report(nPredFac == 0 ? "Forest::PredictRowNum" : (nPredNum == 0 ? "Forest::PredictRowFac" : "Forest::PredictRowMixed"), "", nRow, walk);
+
+  // Leaves are those just predicted.
+  if (nPredFac == 0) {
+    std::vector<double> quantVec = {0.25, 0.5, 0.75};
+    Quant quant(&predictReg, &leafReg, quantVec, 5000);
+    std::vector<double> qPred(size_t(blockRows) * quantVec.size());
+    std::vector<unsigned int> sampRanks(quant.binSize), sCountLeaf(quant.extentMax), rankLeaf(quant.extentMax);
+    std::vector<double> countThreshold(quantVec.size());
+    Timing leaves;
+    for (unsigned int rep = 0; rep < reps; rep++) {
+      leaves.Start();
+      for (unsigned int rw = 0; rw < blockRows; rw++)
+        quant.Leaves(rw, &qPred[size_t(rw) * quantVec.size()], &sampRanks[0], &sCountLeaf[0], &rankLeaf[0], &countThreshold[0]);
+      leaves.Stop(double(blockRows) * nTree);
+      leaves.Rep();
+    }
+    Report("Quant::Leaves", "", nRow, leaves);
+  }
+
+  delete bag;
+  PBPredict::DeImmutables();
+}
+
+
+/**
+   @brief Times bit-vector access in the patterns of training and
+   prediction:  random single bits, slot-wise population counts and the
+   row-by-tree walk of the validation bag.
+
+   @return void.
+ */
+void KernelBench::Bits(unsigned int nRow, unsigned int nTree, unsigned int reps) {
+  std::mt19937 gen(3);
+  std::vector<unsigned int> pos(nRow);
+  for (auto & p : pos)
+    p = gen() % nRow;
+
+  BV bv(nRow);
+  BitMatrix bag(nRow, nTree);
+  Timing set, test, pop, matSet, matTest;
+  unsigned int found = 0;
+  for (unsigned int rep = 0; rep < reps; rep++) {
+    set.Start();
+    for (auto p : pos)
+      bv.SetBit(p);
+    set.Stop(nRow);
+
+    test.Start();
+    for (auto p : pos)
+      found += bv.TestBit(p) ? 1 : 0;
+    test.Stop(nRow);
+
+    pop.Start();
+    found += bv.PopCount();
+    pop.Stop(nRow);
+
+    matSet.Start();
+    for (unsigned int tc = 0; tc < nTree; tc++) {
+      for (unsigned int rw = tc % 3; rw < nRow; rw += 3)
+        bag.SetBit(rw, tc);
+    }
+    matSet.Stop(double(nRow) * nTree / 3);
+
+    matTest.Start();
+    for (unsigned int rw = 0; rw < nRow; rw++) {
+      for (unsigned int tc = 0; tc < nTree; tc++)
+        found += bag.TestBit(rw, tc) ? 1 : 0;
+    }
+    matTest.Stop(double(nRow) * nTree);
+
+    set.Rep();
+    test.Rep();
+    pop.Rep();
+    matSet.Rep();
+    matTest.Rep();
+  }
+  if (found == 0) // Keeps the tests live.
+    fprintf(stderr, "no bits found\n");
+
+  Report("BV::SetBit", "random", nRow, set);
+  Report("BV::TestBit", "random", nRow, test);
+  Report("BV::PopCount", "", nRow, pop);
+  Report("BitMatrix::SetBit", "column", nRow, matSet);
+  Report("BitMatrix::TestBit", "row", nRow, matTest);
+}
+
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-p nPred] [-c card] [-t nTree] [-r reps] [-k kernel] [nRow ...]\n", prog);
+  fprintf(stderr, "  -k restricts to kernels whose names contain the string passed.\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  unsigned int nPred = 8;
+  unsigned int card = 16;
+  unsigned int nTree = 20;
+  unsigned int reps = 5;
+  std::string filter;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:c:t:r:k:h")) != -1) {
+    switch (opt) {
+    case 'p':
+      nPred = atoi(optarg);
+      break;
+    case 'c':
+      card = atoi(optarg);
+      break;
+    case 't':
+      nTree = atoi(optarg);
+      break;
+    case 'r':
+      reps = atoi(optarg);
+      break;
+    case 'k':
+      filter = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  std::vector<unsigned int> rowSweep;
+  for (int i = optind; i < argc; i++) {
+    unsigned int nRow = atoi(argv[i]);
+    if (nRow > 0)
+      rowSweep.push_back(nRow);
+  }
+  if (rowSweep.empty()) {
+    rowSweep = {4096, 16384, 65536, 262144};
+  }
+  if (reps == 0)
+    reps = 1;
+  if (nPred < 2)
+    nPred = 2;
+  if (card < 2)
+    card = 2;
+
+  auto want = [&filter](const char *group) {
+    return filter.empty() || strstr(group, filter.c_str()) != 0;
+  };
+
+  printf("%-24s %-12s %9s %12s %9s\n", "kernel", "variant", "nRow", "elements", "ns/elt");
+  for (auto nRow : rowSweep) {
+    Design num(nRow, nPred, 0, card, 1);
+    Design fac(nRow, 0, nPred, card, 1);
+    Design mixed(nRow, nPred - nPred / 2, nPred / 2, card, 1);
+    if (want("Sample::PreStage SPReg::SplitNumWV RestageNode::Restage RestageNode::RestageTwo"))
+      KernelBench::Train(num, 0, reps);
+    if (want("SPCtg::SplitNumGini SPCtg::SplitFacGini")) {
+      KernelBench::Train(mixed, 2, reps);
+      KernelBench::Train(mixed, 5, reps);
+    }
+    if (want("Forest::PredictRowNum Quant::Leaves"))
+      KernelBench::Predict(num, nTree, reps);
+    if (want("Forest::PredictRowFac"))
+      KernelBench::Predict(fac, nTree, reps);
+    if (want("Forest::PredictRowMixed"))
+      KernelBench::Predict(mixed, nTree, reps);
+    if (want("BV::SetBit BV::TestBit BV::PopCount BitMatrix::SetBit BitMatrix::TestBit"))
+      KernelBench::Bits(nRow, nTree, reps);
+  }
+
+  return 0;
+}
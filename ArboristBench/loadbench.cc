@@ -0,0 +1,267 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file loadbench.cc
+
+   @brief Times loading a saved regression forest and predicting a
+   first, small batch of rows.
+
+   Three loaders are compared over the same trained forest:  mapping
+   the binary model file, reading it onto the heap as a single block
+   and, as a baseline, deserializing a conventional stream of
+   length-prefixed vectors into freshly-allocated front-end vectors.
+   Each trial reloads from scratch, and predictions are checked for
+   agreement with the in-memory forest.
+
+   @author Mark Seligman
+ */
+
+#include "synth.h"
+#include "train.h"
+#include "forest.h"
+#include "leaf.h"
+#include "predict.h"
+#include "modelmap.h"
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+
+/**
+   @brief Trained regression forest, held as front-end vectors.
+ */
+class Model {
+ public:
+  std::vector<unsigned int> origin, facOrigin, facSplit, leafOrigin, rank;
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+  std::vector<double> yRanked;
+};
+
+
+template<typename T> static void VecWrite(FILE *file, const std::vector<T> &vec) {
+  unsigned long long count = vec.size();
+  fwrite(&count, sizeof(count), 1, file);
+  fwrite(vec.data(), sizeof(T), vec.size(), file);
+}
+
+
+template<typename T> static bool VecRead(FILE *file, std::vector<T> &vec) {
+  unsigned long long count;
+  if (fread(&count, sizeof(count), 1, file) != 1)
+    return false;
+  vec.resize(count);
+  return fread(vec.data(), sizeof(T), count, file) == count;
+}
+
+
+/**
+   @brief Writes the baseline stream format.
+
+   @return true iff written.
+ */
+static bool StreamSave(const char *path, const Model &model) {
+  FILE *file = fopen(path, "wb");
+  if (file == 0)
+    return false;
+  VecWrite(file, model.forestNode);
+  VecWrite(file, model.origin);
+  VecWrite(file, model.facOrigin);
+  VecWrite(file, model.facSplit);
+  VecWrite(file, model.leafOrigin);
+  VecWrite(file, model.leafNode);
+  VecWrite(file, model.bagPack);
+  VecWrite(file, model.rank);
+  VecWrite(file, model.yRanked);
+  return fclose(file) == 0;
+}
+
+
+/**
+   @brief Reads the baseline stream format.
+
+   @return true iff read in full.
+ */
+static bool StreamLoad(const char *path, Model &model) {
+  FILE *file = fopen(path, "rb");
+  if (file == 0)
+    return false;
+  bool ok = VecRead(file, model.forestNode) && VecRead(file, model.origin) && VecRead(file, model.facOrigin) && VecRead(file, model.facSplit) && VecRead(file, model.leafOrigin) && VecRead(file, model.leafNode) && VecRead(file, model.bagPack) && VecRead(file, model.rank) && VecRead(file, model.yRanked);
+  fclose(file);
+  return ok;
+}
+
+
+/**
+   @brief Outcome of a single loader.
+ */
+class LoadStat {
+ public:
+  double loadSec; // Mean load time.
+  double firstSec; // Mean load time plus first prediction.
+  bool agree;
+};
+
+
+static double Since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+   @brief Times a loader over several trials.
+
+   @param how is zero for the stream baseline, otherwise one to map and
+   two to read the binary model file.
+
+   @param xBatch is the row-major batch to predict.
+
+   @param yRef is the reference prediction for the batch.
+
+   @return loader statistics.
+ */
+static LoadStat TimeLoad(unsigned int how, const char *path, unsigned int nPred, std::vector<double> &xBatch, const std::vector<double> &yRef, unsigned int trials) {
+  LoadStat stat;
+  stat.loadSec = 0.0;
+  stat.firstSec = 0.0;
+  stat.agree = true;
+  std::vector<double> yPred(yRef.size());
+  for (unsigned int trial = 0; trial < trials; trial++) {
+    auto start = std::chrono::steady_clock::now();
+    if (how == 0) {
+      Model model;
+      if (!StreamLoad(path, model)) {
+        stat.agree = false;
+        return stat;
+      }
+      stat.loadSec += Since(start) / trials;
+      Predict::Regression(&xBatch[0], 0, nPred, 0, model.forestNode, model.origin, model.facOrigin, model.facSplit, model.leafOrigin, model.leafNode, model.bagPack, model.rank, model.yRanked, yPred, 0);
+    }
+    else {
+      ModelMap *model = ModelMap::Load(path, how == 1);
+      if (model == 0) {
+        stat.agree = false;
+        return stat;
+      }
+      stat.loadSec += Since(start) / trials;
+      Predict::Regression(model, &xBatch[0], 0, yPred, 0);
+      delete model;
+    }
+    stat.firstSec += Since(start) / trials;
+    stat.agree = stat.agree && yPred == yRef;
+  }
+
+  return stat;
+}
+
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-n nRow] [-p nPred] [-t nTree] [-m minNode] [-r trials] [-o dir]\n", prog);
+  fprintf(stderr, "  Model files are written to, and removed from, the output directory.\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  unsigned int nRow = 50000;
+  unsigned int nPred = 10;
+  unsigned int nTree = 200;
+  unsigned int minNode = 2;
+  unsigned int trials = 5;
+  std::string dir = "/tmp";
+  int opt;
+  while ((opt = getopt(argc, argv, "n:p:t:m:r:o:h")) != -1) {
+    switch (opt) {
+    case 'n':
+      nRow = atoi(optarg);
+      break;
+    case 'p':
+      nPred = atoi(optarg);
+      break;
+    case 't':
+      nTree = atoi(optarg);
+      break;
+    case 'm':
+      minNode = atoi(optarg);
+      break;
+    case 'r':
+      trials = atoi(optarg);
+      break;
+    case 'o':
+      dir = optarg;
+      break;
+    default:
+      Usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (trials == 0)
+    trials = 1;
+
+  Synth synth(nRow, nPred, 1);
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predProb(nPred, 1.0);
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<double> xNum(synth.xNum);
+  std::vector<int> row(synth.row), rank(synth.rank), invNum(synth.invNum);
+  std::vector<double> predInfo(nPred);
+  Model model;
+  model.origin = std::vector<unsigned int>(nTree);
+  model.facOrigin = std::vector<unsigned int>(nTree);
+  model.leafOrigin = std::vector<unsigned int>(nTree);
+  model.yRanked = synth.yRanked;
+
+  Train::Init(&xNum[0], 0, 0, nPred, 0, nRow, nTree, nRow, &sampleWeight[0], true, 8, minNode, 0.0, 0, 0, nPred / 3 > 0 ? nPred / 3 : 1, &predProb[0], &regMono[0], 0, 0, 17);
+  Train::Regression(&row[0], &rank[0], &invNum[0], synth.y, synth.row2Rank, model.origin, model.facOrigin, &predInfo[0], model.forestNode, model.facSplit, model.leafOrigin, model.leafNode, model.bagPack, model.rank);
+
+  std::string mapPath = dir + "/loadbench.arb";
+  std::string streamPath = dir + "/loadbench.stream";
+  std::vector<unsigned int> predMap(nPred), facCard;
+  for (unsigned int pred = 0; pred < nPred; pred++)
+    predMap[pred] = pred;
+  if (!ModelMap::SaveReg(mapPath.c_str(), nPred, 0, nRow, model.forestNode, model.origin, model.facOrigin, model.facSplit, model.leafOrigin, model.leafNode, model.bagPack, model.rank, model.yRanked, predMap, facCard, std::vector<std::string>()) || !StreamSave(streamPath.c_str(), model)) {
+    fprintf(stderr, "%s: cannot write model files under %s\n", argv[0], dir.c_str());
+    return 1;
+  }
+
+  // First batch:  a handful of held-out rows, row-major.
+  Synth test(64, nPred, 2);
+  std::vector<double> xBatch(size_t(test.nRow) * nPred);
+  for (unsigned int rw = 0; rw < test.nRow; rw++) {
+    for (unsigned int pred = 0; pred < nPred; pred++) {
+      xBatch[size_t(rw) * nPred + pred] = test.xNum[size_t(pred) * test.nRow + rw];
+    }
+  }
+  std::vector<double> yRef(test.nRow);
+  Predict::Regression(&xBatch[0], 0, nPred, 0, model.forestNode, model.origin, model.facOrigin, model.facSplit, model.leafOrigin, model.leafNode, model.bagPack, model.rank, model.yRanked, yRef, 0);
+
+  ModelMap *probe = ModelMap::Load(mapPath.c_str());
+  size_t bytes = probe == 0 ? 0 : probe->Bytes();
+  delete probe;
+  printf("trees %u, nodes %zu, leaves %zu, file %.1f MB\n", nTree, model.forestNode.size(), model.leafNode.size(), bytes / 1.0e6);
+  printf("%8s %12s %12s %9s %6s\n", "loader", "load ms", "first ms", "speedup", "agree");
+
+  const char *name[3] = {"stream", "mapped", "read"};
+  LoadStat base;
+  for (unsigned int how = 0; how < 3; how++) {
+    LoadStat stat = TimeLoad(how, how == 0 ? streamPath.c_str() : mapPath.c_str(), nPred, xBatch, yRef, trials);
+    if (how == 0)
+      base = stat;
+    printf("%8s %12.3f %12.3f %9.2f %6s\n", name[how], 1.0e3 * stat.loadSec, 1.0e3 * stat.firstSec, base.firstSec / stat.firstSec, stat.agree ? "yes" : "NO");
+    fflush(stdout);
+  }
+
+  unlink(mapPath.c_str());
+  unlink(streamPath.c_str());
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file rankbench.cc
+
+   @brief Compares training over exact predictor ranks with training
+   over ranks capped by quantile binning.
+
+   Each cap presorts the same synthetic design, trains regression
+   forests under several seeds and predicts a held-out set drawn from
+   the same distribution.  Training time and held-out error, averaged
+   over the seeds, are reported relative to exact ranks.
+
+   @author Mark Seligman
+ */
+
+#include "synth.h"
+#include "train.h"
+#include "forest.h"
+#include "leaf.h"
+#include "predict.h"
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+
+/**
+   @brief Outcome of training under a single cap.
+ */
+class RunStat {
+ public:
+  double seconds;
+  double mse; // Held-out mean squared error.
+  size_t nodeCount;
+};
+
+
+/**
+   @brief Trains a regression forest and scores it on a held-out set.
+
+   @param synth is the training set, presorted under the cap.
+
+   @param test is the held-out set.
+
+   @param seed seeds the sampler.
+
+   @return run statistics.
+ */
+static RunStat TrainOnce(const Synth &synth, const Synth &test, unsigned int nTree, unsigned int trainBlock, unsigned int seed) {
+  unsigned int nPred = synth.nPred;
+  unsigned int nRow = synth.nRow;
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predProb(nPred, 1.0);
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<double> xNum(synth.xNum);
+  std::vector<int> row(synth.row), rank(synth.rank), invNum(synth.invNum);
+
+  std::vector<unsigned int> origin(nTree), facOrigin(nTree), leafOrigin(nTree), facSplit, leafRank;
+  std::vector<double> predInfo(nPred);
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+
+  auto start = std::chrono::steady_clock::now();
+  Train::Init(&xNum[0], 0, 0, nPred, 0, nRow, nTree, nRow, &sampleWeight[0], true, trainBlock, 5, 0.01, 0, 0, nPred / 3 > 0 ? nPred / 3 : 1, &predProb[0], &regMono[0], 0, 0, seed);
+  Train::Regression(&row[0], &rank[0], &invNum[0], synth.y, synth.row2Rank, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, leafRank);
+  auto finish = std::chrono::steady_clock::now();
+
+  // Prediction expects a row-major design.
+  unsigned int nTest = test.nRow;
+  std::vector<double> xTest(size_t(nTest) * nPred);
+  for (unsigned int rw = 0; rw < nTest; rw++) {
+    for (unsigned int pred = 0; pred < nPred; pred++) {
+      xTest[size_t(rw) * nPred + pred] = test.xNum[size_t(pred) * nTest + rw];
+    }
+  }
+  std::vector<double> yPred(nTest);
+  Predict::Regression(&xTest[0], 0, nPred, 0, forestNode, origin, facOrigin, facSplit, leafOrigin, leafNode, bagPack, leafRank, synth.yRanked, yPred, 0);
+
+  RunStat stat;
+  stat.seconds = std::chrono::duration<double>(finish - start).count();
+  stat.mse = 0.0;
+  for (unsigned int rw = 0; rw < nTest; rw++) {
+    double err = yPred[rw] - test.y[rw];
+    stat.mse += err * err;
+  }
+  stat.mse /= nTest;
+  stat.nodeCount = forestNode.size();
+
+  return stat;
+}
+
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-n nRow] [-p nPred] [-t nTree] [-b trainBlock] [-r reps] [rankMax ...]\n", prog);
+  fprintf(stderr, "  A rankMax of zero ranks exactly, and is always run first.\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  unsigned int nRow = 100000;
+  unsigned int nPred = 16;
+  unsigned int nTree = 20;
+  unsigned int trainBlock = 4;
+  unsigned int reps = 3;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:p:t:b:r:h")) != -1) {
+    switch (opt) {
+    case 'n':
+      nRow = atoi(optarg);
+      break;
+    case 'p':
+      nPred = atoi(optarg);
+      break;
+    case 't':
+      nTree = atoi(optarg);
+      break;
+    case 'b':
+      trainBlock = atoi(optarg);
+      break;
+    case 'r':
+      reps = atoi(optarg);
+      break;
+    default:
+      Usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  std::vector<unsigned int> capSweep;
+  for (int i = optind; i < argc; i++) {
+    unsigned int cap = atoi(argv[i]);
+    if (cap > 0)
+      capSweep.push_back(cap);
+  }
+  if (capSweep.empty()) {
+    capSweep = {4096, 1024, 256, 64};
+  }
+  capSweep.insert(capSweep.begin(), 0);
+  if (reps == 0)
+    reps = 1;
+
+  Synth test(nRow / 4 > 0 ? nRow / 4 : 1, nPred, 2);
+  printf("%8s %9s %10s %9s %12s %10s\n", "rankMax", "seconds", "nodes", "speedup", "heldOutMSE", "mseDelta");
+  RunStat exact = RunStat(); // Set by the leading, uncapped pass.
+  for (auto cap : capSweep) {
+    Synth synth(nRow, nPred, 1, cap);
+    RunStat stat;
+    stat.seconds = 0.0;
+    stat.mse = 0.0;
+    stat.nodeCount = 0;
+    for (unsigned int rep = 0; rep < reps; rep++) {
+      RunStat repStat = TrainOnce(synth, test, nTree, trainBlock, 17 + rep);
+      stat.seconds += repStat.seconds / reps;
+      stat.mse += repStat.mse / reps;
+      stat.nodeCount += repStat.nodeCount / reps;
+    }
+    if (cap == 0)
+      exact = stat;
+
+    printf("%8s %9.3f %10zu %9.2f %12.6f %+10.6f\n", cap == 0 ? "exact" : std::to_string(cap).c_str(), stat.seconds, stat.nodeCount, exact.seconds / stat.seconds, stat.mse, stat.mse - exact.mse);
+    fflush(stdout);
+  }
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file spillbench.cc
+
+   @brief Compares in-memory with file-backed training as the working
+   set grows.
+
+   Each configuration trains in a child process, so that its peak
+   resident size and major page faults are reported in isolation.  Run
+   beneath a memory limit, for example
+
+     systemd-run --user --scope -p MemoryMax=1G ./spillbench -d /var/tmp
+
+   to observe in-memory training fail once the working set exceeds the
+   limit, while spilled training continues at a cost in throughput.
+
+   @author Mark Seligman
+ */
+
+#include "synth.h"
+#include "train.h"
+#include "samplepred.h"
+#include "forest.h"
+#include "leaf.h"
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+
+/**
+   @brief Outcome of a single training run, as reported by the child.
+ */
+class RunStat {
+ public:
+  double seconds;
+  double infoSum; // Sum of predictor information:  agrees across modes.
+  size_t leafCount;
+};
+
+
+/**
+   @brief Trains a regression forest over a synthetic set.
+
+   @param spillDir is the spill directory, or null for in-memory.
+
+   @return run statistics.
+ */
+static RunStat TrainOnce(const Synth &synth, unsigned int nTree, unsigned int trainBlock, const char *spillDir) {
+  unsigned int nPred = synth.nPred;
+  unsigned int nRow = synth.nRow;
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> predProb(nPred, 1.0);
+  std::vector<double> regMono(nPred, 0.0);
+  std::vector<double> xNum(synth.xNum);
+  std::vector<int> row(synth.row), rank(synth.rank), invNum(synth.invNum);
+
+  std::vector<unsigned int> origin(nTree), facOrigin(nTree), leafOrigin(nTree), facSplit, leafRank;
+  std::vector<double> predInfo(nPred);
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+
+  auto start = std::chrono::steady_clock::now();
+  Train::Init(&xNum[0], 0, 0, nPred, 0, nRow, nTree, nRow, &sampleWeight[0], true, trainBlock, 5, 0.01, 0, 0, nPred / 3 > 0 ? nPred / 3 : 1, &predProb[0], &regMono[0], 0, spillDir, 17);
+  Train::Regression(&row[0], &rank[0], &invNum[0], synth.y, synth.row2Rank, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, leafRank);
+  auto finish = std::chrono::steady_clock::now();
+
+  RunStat stat;
+  stat.seconds = std::chrono::duration<double>(finish - start).count();
+  stat.infoSum = 0.0;
+  for (auto info : predInfo) {
+    stat.infoSum += info;
+  }
+  stat.leafCount = leafNode.size();
+
+  return stat;
+}
+
+
+/**
+   @brief Runs a configuration in a child process.
+
+   @param spillDir is the spill directory, or null for in-memory.
+
+   @param stat outputs the child's run statistics.
+
+   @param usage outputs the child's resource usage.
+
+   @return true iff the child completed.
+ */
+static bool Fork(unsigned int nRow, unsigned int nPred, unsigned int nTree, unsigned int trainBlock, const char *spillDir, RunStat &stat, struct rusage &usage) {
+  int fd[2];
+  if (pipe(fd) != 0)
+    return false;
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    Synth synth(nRow, nPred, 1);
+    RunStat childStat = TrainOnce(synth, nTree, trainBlock, spillDir);
+    ssize_t written = write(fd[1], &childStat, sizeof(childStat));
+    _exit(written == sizeof(childStat) ? 0 : 1);
+  }
+  close(fd[1]);
+  if (pid < 0) {
+    close(fd[0]);
+    return false;
+  }
+
+  ssize_t got = read(fd[0], &stat, sizeof(stat));
+  close(fd[0]);
+  int status;
+  if (wait4(pid, &status, 0, &usage) != pid)
+    return false;
+
+  return got == sizeof(stat) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-d spillDir] [-p nPred] [-t nTree] [-b trainBlock] [-s] [nRow ...]\n", prog);
+  fprintf(stderr, "  -s runs spilled configurations only.\n");
+}
+
+
+int main(int argc, char *argv[]) {
+  const char *spillDir = 0;
+  unsigned int nPred = 16;
+  unsigned int nTree = 4;
+  unsigned int trainBlock = 4;
+  bool spillOnly = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:p:t:b:sh")) != -1) {
+    switch (opt) {
+    case 'd':
+      spillDir = optarg;
+      break;
+    case 'p':
+      nPred = atoi(optarg);
+      break;
+    case 't':
+      nTree = atoi(optarg);
+      break;
+    case 'b':
+      trainBlock = atoi(optarg);
+      break;
+    case 's':
+      spillOnly = true;
+      break;
+    default:
+      Usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (spillOnly && spillDir == 0) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<unsigned int> rowSweep;
+  for (int i = optind; i < argc; i++) {
+    rowSweep.push_back(atoi(argv[i]));
+  }
+  if (rowSweep.empty()) {
+    rowSweep = {100000, 200000, 400000, 800000};
+  }
+
+  printf("%10s %12s %6s %9s %12s %10s %12s %12s %8s\n", "nRow", "workingMB", "mode", "seconds", "rows/s", "peakMB", "majorFaults", "infoSum", "slowdown");
+  for (auto nRow : rowSweep) {
+    // Bag count with replacement approaches (1 - 1/e) of the rows.
+    size_t workingSet = trainBlock * SamplePred::BytesEst(nPred, nRow * 0.632) + size_t(nRow) * nPred * 2 * sizeof(unsigned int);
+
+    double memSeconds = 0.0;
+    for (unsigned int mode = spillOnly ? 1 : 0; mode < (spillDir == 0 ? 1 : 2); mode++) {
+      RunStat stat;
+      struct rusage usage;
+      bool completed = Fork(nRow, nPred, nTree, trainBlock, mode == 0 ? 0 : spillDir, stat, usage);
+      const char *modeName = mode == 0 ? "memory" : "spill";
+      if (!completed) {
+        printf("%10u %12.1f %6s %9s\n", nRow, workingSet / 1.0e6, modeName, "failed");
+        continue;
+      }
+      if (mode == 0)
+        memSeconds = stat.seconds;
+
+      double peakMB = usage.ru_maxrss / 1024.0; // Linux reports kilobytes.
+      printf("%10u %12.1f %6s %9.3f %12.0f %10.1f %12ld %12.6f", nRow, workingSet / 1.0e6, modeName, stat.seconds, nRow * double(nTree) / stat.seconds, peakMB, usage.ru_majflt, stat.infoSum);
+      if (mode == 1 && memSeconds > 0.0)
+        printf(" %8.2f", stat.seconds / memSeconds);
+      printf("\n");
+      fflush(stdout);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file synth.cc
+
+   @brief Generation of synthetic training sets.
+
+   @author Mark Seligman
+ */
+
+#include "synth.h"
+#include "rowrank.h"
+
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+
+/**
+   @brief Draws a standard normal design, a third of whose predictors are
+   rounded so as to exercise ties, and a response depending nonlinearly
+   on the leading predictors.
+
+   @param seed seeds the generator, for reproducible sets.
+
+   @param rankMax caps the distinct ranks of each predictor, zero if
+   uncapped.
+ */
+Synth::Synth(unsigned int _nRow, unsigned int _nPred, unsigned int seed, unsigned int rankMax) : nRow(_nRow), nPred(_nPred), xNum(size_t(_nRow) * _nPred), y(_nRow), row(size_t(_nRow) * _nPred), rank(size_t(_nRow) * _nPred), invNum(size_t(_nRow) * _nPred), row2Rank(_nRow) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<double> normal;
+  for (auto & x : xNum) {
+    x = normal(gen);
+  }
+  for (size_t i = 0; i < size_t(nRow) * (nPred / 3); i++) {
+    xNum[i] = std::round(2.0 * xNum[i]);
+  }
+
+  for (unsigned int rw = 0; rw < nRow; rw++) {
+    double x0 = xNum[rw];
+    double x1 = nPred > 1 ? xNum[nRow + rw] : 0.0;
+    double x2 = nPred > 2 ? xNum[2 * size_t(nRow) + rw] : 1.0;
+    y[rw] = x0 + 2.0 * x1 * x2 + std::sin(x0) + 0.3 * normal(gen);
+  }
+
+  RowRank::PreSortNum(&xNum[0], nPred, nRow, &row[0], &rank[0], &invNum[0], rankMax);
+
+  yRanked = y;
+  std::sort(yRanked.begin(), yRanked.end());
+  for (unsigned int rw = 0; rw < nRow; rw++) {
+    row2Rank[rw] = std::lower_bound(yRanked.begin(), yRanked.end(), y[rw]) - yRanked.begin();
+  }
+}
@@ -0,0 +1,40 @@
+// This file is part of ArboristBench.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file synth.h
+
+   @brief Synthetic training sets for benchmarking.
+
+   @author Mark Seligman
+ */
+
+#ifndef ARBORIST_SYNTH_H
+#define ARBORIST_SYNTH_H
+
+#include <vector>
+
+/**
+   @brief Numeric design with a nonlinear regression response, presorted
+   as a front end would present it to training.
+ */
+class Synth {
+ public:
+  const unsigned int nRow;
+  const unsigned int nPred;
+  std::vector<double> xNum; // Column-major design.
+  std::vector<double> y;
+  std::vector<int> row; // Presorted rows, by predictor.
+  std::vector<int> rank; // Presorted ranks, by predictor.
+  std::vector<int> invNum; // Rank-to-row map, by predictor.
+  std::vector<double> yRanked; // Sorted response.
+  std::vector<unsigned int> row2Rank; // Response rank, by row.
+
+  Synth(unsigned int _nRow, unsigned int _nPred, unsigned int seed, unsigned int rankMax = 0);
+};
+
+#endif
@@ -0,0 +1,45 @@
+# distutils: language = c++
+
+from libcpp cimport bool
+from libcpp.vector cimport vector
+from libcpp.string cimport string
+
+
+
+cdef extern from 'facremap.h':
+    cdef cppclass FacRemap:
+        FacRemap(const vector[vector[string]] &levelTrain) except +
+        unsigned int NPredFac()
+        size_t Remap(int blockFac[],
+            unsigned int nRow,
+            const vector[vector[string]] &levelTest)
+
+
+cdef extern from 'frameload.h':
+    cdef cppclass FrameLoad:
+        bool WriteColumnar(const char *path)
+        size_t Conform(const FacRemap *remap)
+        unsigned int NRow()
+        unsigned int NPredNum()
+        unsigned int NPredFac()
+        unsigned int CardMax()
+        const vector[string] &ColName()
+        const vector[unsigned int] &PredMap()
+        const vector[double] &BlockNum()
+        const vector[int] &BlockFac()
+        const vector[unsigned int] &FacCard()
+        const vector[vector[string]] &Level()
+
+    cdef FrameLoad *FrameLoad_Read 'FrameLoad::Read'(const char *path,
+        string &diag,
+        char sep,
+        bool header)
+
+
+
+cdef class PyFacRemap:
+    cdef FacRemap *thisptr
+
+
+cdef class PyFrameLoad:
+    cdef FrameLoad *thisptr
@@ -0,0 +1,97 @@
+import numpy as np
+cimport numpy as np
+
+
+
+cdef class PyFacRemap:
+    """Hashed index of training factor levels, built once per model."""
+    def __cinit__(self, levels_train):
+        cdef vector[vector[string]] levelTrain = [[str(name).encode() for name in facLevel] for facLevel in levels_train]
+        self.thisptr = new FacRemap(levelTrain)
+
+
+    def __dealloc__(self):
+        del self.thisptr
+
+
+    def Remap(self, int[::1, :] block_fac not None, levels_test):
+        """Recodes a column-major factor block in place.  Levels unseen in
+        training map to the training cardinality.  Returns the number of
+        such rows."""
+        if block_fac.shape[1] != self.thisptr.NPredFac() or len(levels_test) != block_fac.shape[1]:
+            raise ValueError('Factor count differs from training.')
+        cdef vector[vector[string]] levelTest = [[str(name).encode() for name in facLevel] for facLevel in levels_test]
+        if block_fac.shape[0] == 0 or block_fac.shape[1] == 0:
+            return 0
+        return self.thisptr.Remap(&block_fac[0, 0], block_fac.shape[0], levelTest)
+
+
+
+cdef class PyFrameLoad:
+    """Design read natively from delimited text or columnar binary."""
+    def __cinit__(self):
+        self.thisptr = NULL
+
+
+    def __dealloc__(self):
+        del self.thisptr
+
+
+    @staticmethod
+    def Read(path, sep = ',', header = True):
+        cdef string diag
+        cdef PyFrameLoad frame = PyFrameLoad()
+        frame.thisptr = FrameLoad_Read(path.encode(), diag, ord(sep[0]), header)
+        if frame.thisptr == NULL:
+            raise IOError('{}: {}'.format(path, diag.decode()))
+        return frame
+
+
+    def WriteColumnar(self, path):
+        return self.thisptr.WriteColumnar(path.encode())
+
+
+    def Conform(self, PyFacRemap remap):
+        """Recodes factors against training levels, which replace those
+        read.  Returns the number of rows with levels unseen in training."""
+        if remap.thisptr.NPredFac() != self.thisptr.NPredFac():
+            raise ValueError('Factor count differs from training.')
+        return self.thisptr.Conform(remap.thisptr)
+
+
+    @property
+    def n_row(self):
+        return self.thisptr.NRow()
+
+
+    @property
+    def col_names(self):
+        return [name.decode() for name in self.thisptr.ColName()]
+
+
+    @property
+    def pred_map(self):
+        """Front-end column of each core predictor, numeric first."""
+        return np.asarray(self.thisptr.PredMap(), dtype=np.uintc)
+
+
+    @property
+    def block_num(self):
+        """Numeric predictors, shape=(n_row, n_pred_num)."""
+        cdef unsigned int nPredNum = self.thisptr.NPredNum()
+        block = np.asarray(self.thisptr.BlockNum(), dtype=np.double)
+        return block.reshape((self.thisptr.NRow(), nPredNum), order='F')
+
+
+    @property
+    def block_fac(self):
+        """Zero-based factor codes, shape=(n_row, n_pred_fac)."""
+        cdef unsigned int nPredFac = self.thisptr.NPredFac()
+        block = np.asarray(self.thisptr.BlockFac(), dtype=np.intc)
+        return block.reshape((self.thisptr.NRow(), nPredFac), order='F')
+
+
+    @property
+    def levels(self):
+        """Sorted level names of each factor predictor."""
+        return [[name.decode() for name in facLevel] for facLevel in self.thisptr.Level()]
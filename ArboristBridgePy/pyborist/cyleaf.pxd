@@ -6,18 +6,15 @@ from libcpp.memory cimport shared_ptr, make_shared
 
 
 cdef extern from 'leaf.h':
-    cdef cppclass BagRow:
-        pass
-
     cdef cppclass LeafNode:
         pass
 
 
 
-cdef class PyPtrVecBagRow:
-    cdef shared_ptr[vector[BagRow]] thisptr
-    cdef set(self, shared_ptr[vector[BagRow]] ptr)
-    cdef shared_ptr[vector[BagRow]] get(self)
+cdef class PyPtrVecBagPack:
+    cdef shared_ptr[vector[unsigned char]] thisptr
+    cdef set(self, shared_ptr[vector[unsigned char]] ptr)
+    cdef shared_ptr[vector[unsigned char]] get(self)
 
 
 
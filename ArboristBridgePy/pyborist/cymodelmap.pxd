@@ -0,0 +1,82 @@
+# distutils: language = c++
+
+from libcpp cimport bool
+from libcpp.vector cimport vector
+from libcpp.string cimport string
+
+from .cyforest cimport ForestNode
+from .cyleaf cimport LeafNode
+
+
+
+cdef extern from 'modelmap.h':
+    cdef cppclass ModelMap:
+        bool IsRegression()
+        bool Mapped()
+        size_t Bytes()
+        unsigned int NTree()
+        unsigned int NPredNum()
+        unsigned int NPredFac()
+        unsigned int NRowTrain()
+        unsigned int CtgWidth()
+        void CtgLevel(vector[string] &ctgLevel)
+
+    cdef bool ModelMap_SaveReg 'ModelMap::SaveReg'(const char *path,
+        unsigned int nPredNum,
+        unsigned int nPredFac,
+        unsigned int rowTrain,
+        const vector[ForestNode] &forestNode,
+        const vector[unsigned int] &origin,
+        const vector[unsigned int] &facOrigin,
+        const vector[unsigned int] &facSplit,
+        const vector[unsigned int] &leafOrigin,
+        const vector[LeafNode] &leafNode,
+        const vector[unsigned char] &bagPack,
+        const vector[unsigned int] &rank,
+        const vector[double] &yRanked,
+        const vector[unsigned int] &predMap,
+        const vector[unsigned int] &facCard,
+        const vector[string] &predLevel)
+
+    cdef bool ModelMap_SaveCtg 'ModelMap::SaveCtg'(const char *path,
+        unsigned int nPredNum,
+        unsigned int nPredFac,
+        unsigned int rowTrain,
+        const vector[ForestNode] &forestNode,
+        const vector[unsigned int] &origin,
+        const vector[unsigned int] &facOrigin,
+        const vector[unsigned int] &facSplit,
+        const vector[unsigned int] &leafOrigin,
+        const vector[LeafNode] &leafNode,
+        const vector[unsigned char] &bagPack,
+        const vector[double] &weight,
+        const vector[unsigned int] &predMap,
+        const vector[unsigned int] &facCard,
+        const vector[string] &predLevel,
+        const vector[string] &ctgLevel)
+
+    cdef ModelMap *ModelMap_Load 'ModelMap::Load'(const char *path, bool doMap)
+
+
+cdef extern from 'predict.h':
+    cdef void Predict_RegressionMap 'Predict::Regression'(const ModelMap *model,
+        double *_blockNumT,
+        int *_blockFacT,
+        vector[double] &yPred,
+        unsigned int bagTrain)
+
+    cdef void Predict_ClassificationMap 'Predict::Classification'(const ModelMap *model,
+        double *_blockNumT,
+        int *_blockFacT,
+        vector[int] &yPred,
+        int *_census,
+        const vector[unsigned int] &_yTest,
+        int *_conf,
+        vector[double] &_error,
+        double *_prob,
+        unsigned int bagTrain)
+
+
+
+cdef class PyModelMap:
+    cdef ModelMap *thisptr
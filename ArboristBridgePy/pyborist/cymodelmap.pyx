@@ -0,0 +1,142 @@
+import numpy as np
+cimport numpy as np
+from cython cimport view
+from cython.operator cimport dereference as deref
+
+from .cyforest cimport PyPtrVecForestNode
+from .cyleaf cimport PyPtrVecLeafNode, PyPtrVecBagPack
+
+
+
+cdef class PyModelMap:
+    """Trained model in the binary format, predicted upon in place."""
+    def __cinit__(self):
+        self.thisptr = NULL
+
+
+    def __dealloc__(self):
+        del self.thisptr
+
+
+    @staticmethod
+    def SaveReg(path,
+        unsigned int nPred,
+        unsigned int[::view.contiguous] origin not None,
+        unsigned int[::view.contiguous] facOrig not None,
+        unsigned int[::view.contiguous] facSplit not None,
+        PyPtrVecForestNode pyPtrForestNode,
+        double[::view.contiguous] yRanked,
+        unsigned int[::view.contiguous] leafOrigin,
+        PyPtrVecLeafNode pyPtrLeafNode,
+        PyPtrVecBagPack pyPtrBagPack,
+        unsigned int rowTrain,
+        unsigned int[::view.contiguous] rank):
+        cdef vector[unsigned int] predMap = range(nPred)
+        cdef vector[unsigned int] facCard # empty
+        cdef vector[string] predLevel # empty
+        return ModelMap_SaveReg(path.encode(),
+            nPred,
+            0, # nPredFac
+            rowTrain,
+            deref(pyPtrForestNode.get()),
+            np.asarray(origin),
+            np.asarray(facOrig),
+            np.asarray(facSplit),
+            np.asarray(leafOrigin),
+            deref(pyPtrLeafNode.get()),
+            deref(pyPtrBagPack.get()),
+            np.asarray(rank),
+            np.asarray(yRanked),
+            predMap,
+            facCard,
+            predLevel)
+
+
+    @staticmethod
+    def SaveCtg(path,
+        unsigned int nPred,
+        unsigned int[::view.contiguous] origin not None,
+        unsigned int[::view.contiguous] facOrig not None,
+        unsigned int[::view.contiguous] facSplit not None,
+        PyPtrVecForestNode pyPtrForestNode,
+        unsigned int[::view.contiguous] leafOrigin,
+        PyPtrVecLeafNode pyPtrLeafNode,
+        PyPtrVecBagPack pyPtrBagPack,
+        unsigned int rowTrain,
+        double[::view.contiguous] weight,
+        ctgLevel):
+        cdef vector[unsigned int] predMap = range(nPred)
+        cdef vector[unsigned int] facCard # empty
+        cdef vector[string] predLevel # empty
+        cdef vector[string] ctgName = [str(level).encode() for level in ctgLevel]
+        return ModelMap_SaveCtg(path.encode(),
+            nPred,
+            0, # nPredFac
+            rowTrain,
+            deref(pyPtrForestNode.get()),
+            np.asarray(origin),
+            np.asarray(facOrig),
+            np.asarray(facSplit),
+            np.asarray(leafOrigin),
+            deref(pyPtrLeafNode.get()),
+            deref(pyPtrBagPack.get()),
+            np.asarray(weight),
+            predMap,
+            facCard,
+            predLevel,
+            ctgName)
+
+
+    @staticmethod
+    def Load(path, bool doMap = True):
+        cdef ModelMap *model = ModelMap_Load(path.encode(), doMap)
+        if model == NULL:
+            raise IOError('Unreadable or malformed model file: {}'.format(path))
+        cdef PyModelMap pyModel = PyModelMap()
+        pyModel.thisptr = model
+        return pyModel
+
+
+    def is_regression(self):
+        return self.thisptr.IsRegression()
+
+
+    def ctg_level(self):
+        cdef vector[string] ctgLevel
+        self.thisptr.CtgLevel(ctgLevel)
+        return [level.decode() for level in ctgLevel]
+
+
+    def Regression(self, double[::view.contiguous] X not None,
+        unsigned int nRow,
+        unsigned int nPred):
+        if not self.thisptr.IsRegression():
+            raise ValueError('Model is not of regression type.')
+        if nPred != self.thisptr.NPredNum() + self.thisptr.NPredFac():
+            raise ValueError('Predictor count does not match training.')
+        cdef vector[double] yPred = vector[double](nRow)
+        Predict_RegressionMap(self.thisptr, &X[0], NULL, yPred, 0)
+
+        return np.asarray(yPred)
+
+
+    def Classification(self, double[::view.contiguous] X not None,
+        unsigned int nRow,
+        unsigned int nPred):
+        if self.thisptr.IsRegression():
+            raise ValueError('Model is not of classification type.')
+        if nPred != self.thisptr.NPredNum() + self.thisptr.NPredFac():
+            raise ValueError('Predictor count does not match training.')
+        cdef unsigned int ctgWidth = self.thisptr.CtgWidth()
+        cdef double[:] probCore = np.zeros(nRow*ctgWidth, dtype=np.double)
+        cdef int[:] censusCore = np.empty(nRow*ctgWidth, dtype=np.intc)
+
+        cdef vector[int] yPred = vector[int](nRow)
+        cdef vector[unsigned int] yTest # empty
+        cdef vector[double] misPredCore # empty
+
+        Predict_ClassificationMap(self.thisptr, &X[0], NULL, yPred, &censusCore[0], yTest, NULL, misPredCore, &probCore[0], 0)
+
+        return (np.asarray(yPred),
+            np.asarray(censusCore).reshape(nRow, ctgWidth),
+            np.asarray(probCore).reshape(nRow, ctgWidth))
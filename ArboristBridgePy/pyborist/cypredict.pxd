@@ -4,7 +4,6 @@ from libcpp.vector cimport vector
 
 from .cyforest cimport ForestNode
 from .cyleaf cimport LeafNode
-from .cyleaf cimport BagRow
 
 
 cdef extern from 'predict.h':
@@ -18,7 +17,7 @@ cdef extern from 'predict.h':
         vector[unsigned int] &_facSplit,
         vector[unsigned int] &_leafOrigin,
         vector[LeafNode] &_leafNode,
-        vector[BagRow] &_bagRow,
+        vector[unsigned char] &_bagPack,
         vector[unsigned int] &_rank,
         const vector[double] &yRanked,
         vector[double] &yPred,
@@ -34,7 +33,7 @@ cdef extern from 'predict.h':
         vector[unsigned int] &_facSplit,
         vector[unsigned int] &_leafOrigin,
         vector[LeafNode] &_leafNode,
-        vector[BagRow] &_bagRow,
+        vector[unsigned char] &_bagPack,
         vector[unsigned int] &_rank,
         const vector[double] &yRanked,
         vector[double] &yPred,
@@ -53,7 +52,7 @@ cdef extern from 'predict.h':
         vector[unsigned int] &_facSplit,
         vector[unsigned int] &_leafOrigin,
         vector[LeafNode] &_leafNode,
-        vector[BagRow] &_bagRow,
+        vector[unsigned char] &_bagPack,
         vector[double] &_leafInfoCtg,
         vector[int] &yPred,
         int *_census,
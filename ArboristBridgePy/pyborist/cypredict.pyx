@@ -7,7 +7,7 @@ from libcpp.memory cimport shared_ptr, make_shared
 
 from .cyforest cimport ForestNode, PyPtrVecForestNode
 from .cyleaf cimport LeafNode, PyPtrVecLeafNode
-from .cyleaf cimport BagRow, PyPtrVecBagRow
+from .cyleaf cimport PyPtrVecBagPack
 
 
 
@@ -23,7 +23,7 @@ cdef class PyPredict:
         double[::view.contiguous] yRanked,
         unsigned int[::view.contiguous] leafOrigin,
         PyPtrVecLeafNode pyPtrLeafNode,
-        PyPtrVecBagRow pyPtrBagRow,
+        PyPtrVecBagPack pyPtrBagPack,
         unsigned int rowTrain,
         unsigned int[::view.contiguous] rank):
         cdef vector[double] yPred = vector[double](nRow)
@@ -38,7 +38,7 @@ cdef class PyPredict:
             np.asarray(facSplit),
             np.asarray(leafOrigin),
             deref(pyPtrLeafNode.get()),
-            deref(pyPtrBagRow.get()),
+            deref(pyPtrBagPack.get()),
             np.asarray(rank),
             np.asarray(yRanked),
             yPred,
@@ -59,7 +59,7 @@ cdef class PyPredict:
         unsigned int[::view.contiguous] yLevels,
         unsigned int[::view.contiguous] leafOrigin,
         PyPtrVecLeafNode pyPtrLeafNode,
-        PyPtrVecBagRow pyPtrBagRow,
+        PyPtrVecBagPack pyPtrBagPack,
         unsigned int rowTrain,
         double[::view.contiguous] weight):
 
@@ -80,7 +80,7 @@ cdef class PyPredict:
             np.asarray(facSplit),
             np.asarray(leafOrigin),
             deref(pyPtrLeafNode.get()),
-            deref(pyPtrBagRow.get()),
+            deref(pyPtrBagPack.get()),
             np.asarray(weight),
             yPred,
             &censusCore[0],
@@ -11,7 +11,8 @@ cdef extern from 'rowrank.h':
             unsigned int _nRow,
             int _row[],
             int _rank[],
-            int _invNum[])
+            int _invNum[],
+            unsigned int _rankMax)
 
     cdef void RowRank_PreSortFac 'RowRank::PreSortFac'(const int _feFac[],
             unsigned int _nPredNum,
@@ -19,3 +20,22 @@ cdef extern from 'rowrank.h':
             unsigned int _nRow,
             int _row[],
             int _rank[])
+
+    cdef void RowRank_MergeNum 'RowRank::MergeNum'(const double _feNum[],
+            unsigned int _nPredNum,
+            unsigned int _nRowOld,
+            unsigned int _nRow,
+            const int _rowOld[],
+            int _row[],
+            int _rank[],
+            int _invNum[],
+            unsigned int _rankMax)
+
+    cdef void RowRank_MergeFac 'RowRank::MergeFac'(const int _feFac[],
+            unsigned int _facStart,
+            unsigned int _nPredFac,
+            unsigned int _nRowOld,
+            unsigned int _nRow,
+            const int _rowOld[],
+            int _row[],
+            int _rank[])
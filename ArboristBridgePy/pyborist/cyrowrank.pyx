@@ -5,13 +5,15 @@ cdef class PyRowRank:
         unsigned int _nRow,
         int[:] _row not None,
         int[:] _rank not None,
-        int[:] _invNum not None):
+        int[:] _invNum not None,
+        unsigned int _rankMax = 0):
         return RowRank_PreSortNum(&_feNum[0],
             _nPredNum,
             _nRow,
             &_row[0],
             &_rank[0],
-            &_invNum[0])
+            &_invNum[0],
+            _rankMax)
 
     @staticmethod
     def PreSortFac(int[:] _feFac not None,
@@ -26,3 +28,41 @@ cdef class PyRowRank:
             _nRow,
             &_row[0],
             &_rank[0])
+
+    @staticmethod
+    def MergeNum(double[:] _feNum not None,
+        unsigned int _nPredNum,
+        unsigned int _nRowOld,
+        unsigned int _nRow,
+        int[:] _rowOld not None,
+        int[:] _row not None,
+        int[:] _rank not None,
+        int[:] _invNum not None,
+        unsigned int _rankMax = 0):
+        RowRank_MergeNum(&_feNum[0],
+            _nPredNum,
+            _nRowOld,
+            _nRow,
+            &_rowOld[0],
+            &_row[0],
+            &_rank[0],
+            &_invNum[0],
+            _rankMax)
+
+    @staticmethod
+    def MergeFac(int[:] _feFac not None,
+        unsigned int _facStart,
+        unsigned int _nPredFac,
+        unsigned int _nRowOld,
+        unsigned int _nRow,
+        int[:] _rowOld not None,
+        int[:] _row not None,
+        int[:] _rank not None):
+        RowRank_MergeFac(&_feFac[0],
+            _facStart,
+            _nPredFac,
+            _nRowOld,
+            _nRow,
+            &_rowOld[0],
+            &_row[0],
+            &_rank[0])
@@ -2,10 +2,10 @@
 
 from libcpp cimport bool
 from libcpp.vector cimport vector
+from libcpp.string cimport string
 
 from .cyforest cimport ForestNode
 from .cyleaf cimport LeafNode
-from .cyleaf cimport BagRow
 
 
 
@@ -27,7 +27,10 @@ cdef extern from 'train.h':
         int _ctgWidth,
         int _predFixed,
         double _predProb[],
-        double _regMono[])
+        double _regMono[],
+        size_t _blockBytes,
+        const char *_spillDir,
+        unsigned int _seed)
 
     cdef void Train_Regression 'Train::Regression'(int _feRow[],
         int _feRank[],
@@ -41,7 +44,7 @@ cdef extern from 'train.h':
         vector[unsigned int] &_facSplit,
         vector[unsigned int] &_leafOrigin,
         vector[LeafNode] &_leafNode,
-        vector[BagRow] &_bagRow,
+        vector[unsigned char] &_bagPack,
         vector[unsigned int] &_rank)
 
     cdef void Train_Classification 'Train::Classification'(int _feRow[],
@@ -57,5 +60,31 @@ cdef extern from 'train.h':
         vector[unsigned int] &_facSplit,
         vector[unsigned int] &_leafOrigin,
         vector[LeafNode] &_leafNode,
-        vector[BagRow] &_bagRow,
+        vector[unsigned char] &_bagPack,
         vector[double] &_weight)
+
+    cdef size_t Train_PeakRSS 'Train::PeakRSS'()
+
+    cdef unsigned int Train_SegmentCount 'Train::SegmentCount'()
+
+    cdef unsigned int Train_ReallocCount 'Train::ReallocCount'()
+
+    cdef void Train_ArenaReport 'Train::ArenaReport'(size_t &allocCount,
+        size_t &chunkCount,
+        size_t &bytesServed,
+        size_t &highWater)
+
+    cdef void Train_MemReport 'Train::MemReport'(vector[string] &subName,
+        vector[size_t] &current,
+        vector[size_t] &peak,
+        vector[size_t] &treePeak,
+        vector[size_t] &levelPeak)
+
+    cdef void Train_ProfReport 'Train::ProfReport'(vector[string] &phaseName,
+        vector[double] &phaseSec,
+        vector[double] &levelSec,
+        vector[double] &treeSec,
+        vector[size_t] &levelPairs,
+        vector[size_t] &levelVolume)
+
+    cdef void Train_ProfTrace 'Train::ProfTrace'(string &trace)
@@ -9,7 +9,7 @@ from libcpp.memory cimport shared_ptr, make_shared
 
 from .cyforest cimport ForestNode, PyPtrVecForestNode
 from .cyleaf cimport LeafNode, PyPtrVecLeafNode
-from .cyleaf cimport BagRow, PyPtrVecBagRow
+from .cyleaf cimport PyPtrVecBagPack
 
 ctypedef vector[unsigned int] VecUInt # workaround deal to cython bug
 
@@ -24,6 +24,72 @@ def match(a, b, dtype=np.uintc):
 
 
 
+def ArenaReport():
+    """Traffic through the per-tree scratch arenas over the most
+    recent training, summed across trees."""
+    cdef size_t allocCount, chunkCount, bytesServed, highWater
+    Train_ArenaReport(allocCount, chunkCount, bytesServed, highWater)
+    return {
+        'allocCount': allocCount,
+        'chunkCount': chunkCount,
+        'bytesServed': bytesServed,
+        'highWater': highWater
+    }
+
+
+def MemReport():
+    """Memory accounting of the most recent training.  Counts of
+    overflow segments and reallocating copies made by the forest and
+    leaf storage are always reported; byte counts by subsystem, tree
+    and depth only if the core was built with ARBORIST_MEMTRACK
+    defined."""
+    cdef vector[string] subName
+    cdef vector[size_t] current, peak, treePeak, levelPeak
+    report = {
+        'segmentCount': Train_SegmentCount(),
+        'reallocCount': Train_ReallocCount()
+    }
+    Train_MemReport(subName, current, peak, treePeak, levelPeak)
+    if subName.empty():
+        return report
+
+    names = [x.decode() for x in subName]
+    report.update({
+        'current': dict(zip(names, current)),
+        'peak': dict(zip(names, peak)),
+        'treePeak': np.asarray(treePeak, dtype=np.uint64),
+        'levelPeak': np.asarray(levelPeak, dtype=np.uint64)
+    })
+    return report
+
+
+def ProfReport():
+    """Phase timing of the most recent training, or None unless the
+    core was built with ARBORIST_PROFILE defined.  Arrays by depth and
+    by tree have one column per phase."""
+    cdef vector[string] phaseName
+    cdef vector[double] phaseSec, levelSec, treeSec
+    cdef vector[size_t] levelPairs, levelVolume
+    cdef string trace
+    Train_ProfReport(phaseName, phaseSec, levelSec, treeSec, levelPairs, levelVolume)
+    if phaseName.empty():
+        return None
+    Train_ProfTrace(trace)
+
+    names = [x.decode() for x in phaseName]
+    phaseCount = len(names)
+    return {
+        'sec': dict(zip(names, phaseSec)),
+        'phase': names,
+        'levelSec': np.asarray(levelSec).reshape(-1, phaseCount),
+        'treeSec': np.asarray(treeSec).reshape(-1, phaseCount),
+        'levelPairs': np.asarray(levelPairs, dtype=np.uint64).reshape(-1, phaseCount),
+        'levelVolume': np.asarray(levelVolume, dtype=np.uint64).reshape(-1, phaseCount),
+        'trace': trace.decode()
+    }
+
+
+
 cdef class PyTrain:
     @staticmethod
     def Regression(double[::view.contiguous] X not None, #F
@@ -43,7 +109,12 @@ cdef class PyTrain:
         int totLevels,
         int predFixed,
         double[::view.contiguous] predProb not None,
-        double[::view.contiguous] regMono not None):
+        double[::view.contiguous] regMono not None,
+        size_t blockBytes = 0):
+
+        # The seed is drawn from numpy's generator, so that np.random.seed
+        # governs reproducibility.
+        cdef unsigned int seed = np.random.randint(0, 2**32, dtype=np.uint32)
 
         Train_Init(&X[0],
             NULL, #feFacCard,
@@ -62,7 +133,10 @@ cdef class PyTrain:
             0,
             predFixed,
             &predProb[0],
-            &regMono[0])
+            &regMono[0],
+            blockBytes,
+            NULL, # spillDir
+            seed)
 
         yRanked = np.empty(y.shape[0], dtype=np.double)
         yRanked[:] = y
@@ -76,7 +150,7 @@ cdef class PyTrain:
 
         cdef shared_ptr[vector[ForestNode]] ptrVecForestNode = make_shared[vector[ForestNode]]()
         cdef shared_ptr[vector[LeafNode]] ptrVecLeafNode = make_shared[vector[LeafNode]]()
-        cdef shared_ptr[vector[BagRow]] ptrVecBagRow = make_shared[vector[BagRow]]()
+        cdef shared_ptr[vector[unsigned char]] ptrVecBagPack = make_shared[vector[unsigned char]]()
 
         cdef VecUInt rank
         cdef VecUInt facSplit
@@ -93,7 +167,7 @@ cdef class PyTrain:
             facSplit,
             leafOrigin,
             deref(ptrVecLeafNode),
-            deref(ptrVecBagRow),
+            deref(ptrVecBagPack),
             rank)
 
         result = {
@@ -106,12 +180,16 @@ cdef class PyTrain:
             'leaf': {
                 'leafOrigin': np.asarray(leafOrigin, dtype=np.uintc),
                 'leafNode': PyPtrVecLeafNode().set(ptrVecLeafNode),
-                'bagRow': PyPtrVecBagRow().set(ptrVecBagRow),
+                'bagPack': PyPtrVecBagPack().set(ptrVecBagPack),
                 'nRow': nRow, #nRow in train
                 'rank': np.asarray(rank, dtype=np.uintc),
                 'yRanked': np.asarray(yRanked) # old y getting sorted
             },
-            'predInfo': np.asarray(predInfo)
+            'predInfo': np.asarray(predInfo),
+            'peakRSS': Train_PeakRSS(),
+            'arena': ArenaReport(),
+            'memory': MemReport(),
+            'profile': ProfReport()
         }
         return result
 
@@ -134,9 +212,11 @@ cdef class PyTrain:
         int totLevels,
         int predFixed,
         double[::view.contiguous] predProb not None,
-        double[::view.contiguous] classWeightJittered not None):
+        double[::view.contiguous] classWeightJittered not None,
+        size_t blockBytes = 0):
 
         cdef unsigned int ctgWidth = np.max(y) + 1 # how many categories
+        cdef unsigned int seed = np.random.randint(0, 2**32, dtype=np.uint32)
 
         Train_Init(&X[0],
             NULL, #feFacCard,
@@ -155,7 +235,10 @@ cdef class PyTrain:
             ctgWidth,
             predFixed,
             &predProb[0],
-            NULL # regMono
+            NULL, # regMono
+            blockBytes,
+            NULL, # spillDir
+            seed
             )
 
         cdef VecUInt origin = VecUInt(nTree)
@@ -165,7 +248,7 @@ cdef class PyTrain:
 
         cdef shared_ptr[vector[ForestNode]] ptrVecForestNode = make_shared[vector[ForestNode]]()
         cdef shared_ptr[vector[LeafNode]] ptrVecLeafNode = make_shared[vector[LeafNode]]()
-        cdef shared_ptr[vector[BagRow]] ptrVecBagRow = make_shared[vector[BagRow]]()
+        cdef shared_ptr[vector[unsigned char]] ptrVecBagPack = make_shared[vector[unsigned char]]()
 
         cdef VecUInt facSplit
         cdef vector[double] weight
@@ -183,7 +266,7 @@ cdef class PyTrain:
             facSplit,
             leafOrigin,
             deref(ptrVecLeafNode),
-            deref(ptrVecBagRow),
+            deref(ptrVecBagPack),
             weight)
 
         result = {
@@ -196,11 +279,15 @@ cdef class PyTrain:
             'leaf': {
                 'leafOrigin': np.asarray(leafOrigin, dtype=np.uintc),
                 'leafNode': PyPtrVecLeafNode().set(ptrVecLeafNode),
-                'bagRow': PyPtrVecBagRow().set(ptrVecBagRow),
+                'bagPack': PyPtrVecBagPack().set(ptrVecBagPack),
                 'nRow': nRow, #nRow in train
                 'weight': np.asarray(weight, dtype=np.double),
                 'yLevels': np.unique(y) # old y all different levels
             },
-            'predInfo': np.asarray(predInfo)
+            'predInfo': np.asarray(predInfo),
+            'peakRSS': Train_PeakRSS(),
+            'arena': ArenaReport(),
+            'memory': MemReport(),
+            'profile': ProfReport()
         }
         return result
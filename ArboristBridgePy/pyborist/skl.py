@@ -3,6 +3,7 @@ import numpy as np
 from .cyrowrank import PyRowRank
 from .cytrain import PyTrain
 from .cypredict import PyPredict
+from .cymodelmap import PyModelMap
 
 __all__ = ['PyboristClassifier', 'PyboristRegressor']
 
@@ -57,6 +58,10 @@ class PyboristModel(object):
     tree_block: int, optional (default=1)
         Maximum number of trees to train during a single level (e.g., coprocessor computing).
 
+    block_bytes: int, optional (default=0)
+        Memory budget, in bytes, for the trees trained as a block, which
+        then may number fewer than tree_block.  Zero if unbudgeted.
+
     pvt_block: int, optional (default=8)
         Maximum number of trees to train in a block (e.g., cluster computing).
 
@@ -95,6 +100,7 @@ class PyboristModel(object):
         q_bin = 5000,
         reg_mono = None,
         tree_block = 1,
+        block_bytes = 0,
         pvt_block = 8,
         is_classifier = False):
         # a trick to save everything into self...
@@ -123,6 +129,7 @@ class PyboristModel(object):
             'q_bin',
             'reg_mono',
             'tree_block',
+            'block_bytes',
             'pvt_block',
             'is_classifier']
         return keys
@@ -395,7 +402,8 @@ class PyboristModel(object):
             self.max_depth,
             self.real_params['max_features'],
             np.ascontiguousarray(np.reshape(self.real_params['prob_arr'], n_features)),
-            np.ascontiguousarray(np.reshape(self.real_params['reg_mono'], self.real_params['reg_mono'].size))
+            np.ascontiguousarray(np.reshape(self.real_params['reg_mono'], self.real_params['reg_mono'].size)),
+            blockBytes = self.block_bytes
         )
         self.estimators_ = result
         return self
@@ -432,7 +440,8 @@ class PyboristModel(object):
             self.max_depth,
             self.real_params['max_features'],
             np.ascontiguousarray(np.reshape(self.real_params['prob_arr'], n_features)),
-            np.ascontiguousarray(self.real_params['class_weight'])
+            np.ascontiguousarray(self.real_params['class_weight']),
+            blockBytes = self.block_bytes
         )
         self.estimators_ = result
         return self
@@ -460,6 +469,48 @@ class PyboristModel(object):
             return self.y_pred
 
 
+    def save_model(self, path):
+        """Save fitted estimator in the binary model format.
+
+        Parameters
+        ----------
+        path : str
+            The file to write.  The saved model is loaded with
+            PyModelMap.Load() and predicted upon without copying.
+        """
+        forest = self.estimators_['forest']
+        leaf = self.estimators_['leaf']
+        if self.is_classifier:
+            ok = PyModelMap.SaveCtg(path,
+                self.n_features_,
+                forest['origin'],
+                forest['facOrig'],
+                forest['facSplit'],
+                forest['forestNode'],
+                leaf['leafOrigin'],
+                leaf['leafNode'],
+                leaf['bagPack'],
+                leaf['nRow'],
+                leaf['weight'],
+                self.classes_)
+        else:
+            ok = PyModelMap.SaveReg(path,
+                self.n_features_,
+                forest['origin'],
+                forest['facOrig'],
+                forest['facSplit'],
+                forest['forestNode'],
+                leaf['yRanked'],
+                leaf['leafOrigin'],
+                leaf['leafNode'],
+                leaf['bagPack'],
+                leaf['nRow'],
+                leaf['rank'])
+        if not ok:
+            raise IOError('Unable to write model file: {}'.format(path))
+        return self
+
+
     def _predict_regression(self, X):
         result = PyPredict.Regression(np.ascontiguousarray(X.reshape(X.size)),
             X.shape[0],
@@ -471,7 +522,7 @@ class PyboristModel(object):
             self.estimators_['leaf']['yRanked'],
             self.estimators_['leaf']['leafOrigin'],
             self.estimators_['leaf']['leafNode'],
-            self.estimators_['leaf']['bagRow'],
+            self.estimators_['leaf']['bagPack'],
             self.estimators_['leaf']['nRow'],
             self.estimators_['leaf']['rank']
         )
@@ -490,7 +541,7 @@ class PyboristModel(object):
             self.estimators_['leaf']['yLevels'],
             self.estimators_['leaf']['leafOrigin'],
             self.estimators_['leaf']['leafNode'],
-            self.estimators_['leaf']['bagRow'],
+            self.estimators_['leaf']['bagPack'],
             self.estimators_['leaf']['nRow'],
             self.estimators_['leaf']['weight']
         )
@@ -564,6 +615,10 @@ class PyboristClassifier(PyboristModel):
     tree_block: int, optional (default=1)
         Maximum number of trees to train during a single level (e.g., coprocessor computing).
 
+    block_bytes: int, optional (default=0)
+        Memory budget, in bytes, for the trees trained as a block, which
+        then may number fewer than tree_block.  Zero if unbudgeted.
+
     pvt_block: int, optional (default=8)
         Maximum number of trees to train in a block (e.g., cluster computing).
 
@@ -601,6 +656,7 @@ class PyboristClassifier(PyboristModel):
         quantiles_arr = None,
         q_bin = 5000,
         tree_block = 1,
+        block_bytes = 0,
         pvt_block = 8):
         super(PyboristClassifier, self).__init__(n_estimators = n_estimators,
             bootstrap = bootstrap,
@@ -616,6 +672,7 @@ class PyboristClassifier(PyboristModel):
             q_bin = q_bin,
             reg_mono = None,
             tree_block = tree_block,
+            block_bytes = block_bytes,
             pvt_block = pvt_block,
             is_classifier = True)
 
@@ -638,6 +695,7 @@ class PyboristClassifier(PyboristModel):
             'quantiles_arr',
             'q_bin',
             'tree_block',
+            'block_bytes',
             'pvt_block']
         return keys
 
@@ -710,6 +768,10 @@ class PyboristRegressor(PyboristModel):
     tree_block: int, optional (default=1)
         Maximum number of trees to train during a single level (e.g., coprocessor computing).
 
+    block_bytes: int, optional (default=0)
+        Memory budget, in bytes, for the trees trained as a block, which
+        then may number fewer than tree_block.  Zero if unbudgeted.
+
     pvt_block: int, optional (default=8)
         Maximum number of trees to train in a block (e.g., cluster computing).
 
@@ -741,6 +803,7 @@ class PyboristRegressor(PyboristModel):
         q_bin = 5000,
         reg_mono = None,
         tree_block = 1,
+        block_bytes = 0,
         pvt_block = 8):
         super(PyboristRegressor, self).__init__(n_estimators = n_estimators,
             bootstrap = bootstrap,
@@ -756,6 +819,7 @@ class PyboristRegressor(PyboristModel):
             q_bin = q_bin,
             reg_mono = reg_mono,
             tree_block = tree_block,
+            block_bytes = block_bytes,
             pvt_block = pvt_block,
             is_classifier = False)
 
@@ -778,5 +842,6 @@ class PyboristRegressor(PyboristModel):
             'q_bin',
             'reg_mono',
             'tree_block',
+            'block_bytes',
             'pvt_block']
         return keys
@@ -5,7 +5,7 @@ from distutils.extension import Extension
 from Cython.Build import cythonize
 from Cython.Distutils import build_ext as _build_ext
 import numpy as np
-from os import listdir, path
+from os import environ, listdir, path
 
 
 
@@ -24,8 +24,7 @@ cc_src_dir = path.join('..', 'ArboristCore')
 
 all_pyx_files = [x for x in listdir(pyx_src_dir) if x.endswith('.pyx')]
 all_cpp_core_files = [path.join(cc_src_dir, x) 
-    for x in listdir(cc_src_dir) if x.endswith('.cc')] + \
-    [path.join(pyx_src_dir, 'callback.cc')]
+    for x in listdir(cc_src_dir) if x.endswith('.cc')]
 
 
 lib_aborist_core = ('libaboristcore', 
@@ -52,6 +51,16 @@ win_link_args = []
 unix_compile_args = ['-std=c++11', '-fopenmp','-O3','-ffast-math']
 unix_link_args = ['-fopenmp']
 
+# Reports training memory by subsystem.
+if environ.get('ARBORIST_MEMTRACK'):
+    win_compile_args.append('/DARBORIST_MEMTRACK')
+    unix_compile_args.append('-DARBORIST_MEMTRACK')
+
+# Times training phases by level and tree.
+if environ.get('ARBORIST_PROFILE'):
+    win_compile_args.append('/DARBORIST_PROFILE')
+    unix_compile_args.append('-DARBORIST_PROFILE')
+
 
 class build_clib(_build_clib):
     def build_libraries(self, libraries):
@@ -12,9 +12,7 @@ cp ../FrontEnd/*.Rd Rborist/man/
 cp ../FrontEnd/NEWS Rborist/inst/
 cp ../FrontEnd/*R Rborist/R/
 cp ../Shared/Makevars Rborist/src/
-cp ../Shared/?[^cpp]*.cc Rborist/src/
-cp ../Shared/rcppArmadillo*.cc Rborist/src
-cat ../Shared/rcppMonolithHeader ../Shared/rcpp[^Armadillo]*.cc > Rborist/src/rcppMonolith.cc
+cat ../Shared/rcppMonolithHeader ../Shared/rcpp*.cc > Rborist/src/rcppMonolith.cc
 cp ../Shared/*.h Rborist/src/
 cp ../../ArboristCore/*.cc Rborist/src/
 cp ../../ArboristCore/*.h Rborist/src/
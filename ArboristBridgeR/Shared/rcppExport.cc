@@ -88,16 +88,16 @@ RcppExport SEXP ExportReg(SEXP sForest, SEXP sLeaf, IntegerVector predMap) {
   std::vector<double> yRanked;
   std::vector<unsigned int> leafOrigin;
   std::vector<LeafNode> *leafNode;
-  std::vector<BagRow> *bagRow;
+  std::vector<unsigned char> bagPack;
   unsigned int rowTrain;
   std::vector<unsigned int> rank;
-  LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagRow, rowTrain, rank);
+  LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagPack, rowTrain, rank);
 
   std::vector<std::vector<unsigned int> > rowTree(nTree), sCountTree(nTree);
   std::vector<std::vector<double> > scoreTree(nTree);
   std::vector<std::vector<unsigned int> > extentTree(nTree);
   std::vector<std::vector<unsigned int> > rankTree(nTree);
-  LeafReg::Export(leafOrigin, *leafNode, *bagRow, rank, rowTree, sCountTree, scoreTree, extentTree, rankTree);
+  LeafReg::Export(leafOrigin, *leafNode, bagPack, rank, rowTree, sCountTree, scoreTree, extentTree, rankTree);
 
   List outBundle = List::create(
 				_["rowTrain"] = rowTrain,
@@ -138,17 +138,17 @@ RcppExport SEXP ExportCtg(SEXP sForest, SEXP sLeaf, IntegerVector predMap) {
 
   std::vector<unsigned int> leafOrigin;
   std::vector<LeafNode> *leafNode;
-  std::vector<BagRow> *bagRow;
+  std::vector<unsigned char> bagPack;
   unsigned int rowTrain;
   std::vector<double> weight;
   CharacterVector yLevel;
-  LeafUnwrapCtg(sLeaf, leafOrigin, leafNode, bagRow, rowTrain, weight, yLevel);
+  LeafUnwrapCtg(sLeaf, leafOrigin, leafNode, bagPack, rowTrain, weight, yLevel);
 
   std::vector<std::vector<unsigned int> > rowTree(nTree), sCountTree(nTree);
   std::vector<std::vector<double> > scoreTree(nTree);
   std::vector<std::vector<unsigned int> > extentTree(nTree);
   std::vector<std::vector<double> > weightTree(nTree);
-  LeafCtg::Export(leafOrigin, *leafNode, *bagRow, weight, yLevel.length(), rowTree, sCountTree, scoreTree, extentTree, weightTree);
+  LeafCtg::Export(leafOrigin, *leafNode, bagPack, weight, yLevel.length(), rowTree, sCountTree, scoreTree, extentTree, weightTree);
 
   List outBundle = List::create(
 				_["rowTrain"] = rowTrain,
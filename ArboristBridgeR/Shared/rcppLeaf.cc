@@ -30,9 +30,7 @@
 
 namespace Rcpp {
   template <> SEXP wrap(const std::vector<LeafNode> &);
-  template <> SEXP wrap(const std::vector<BagRow> &);
   template <> std::vector<LeafNode>* as(SEXP);
-  template <> std::vector<BagRow>* as(SEXP);
 }
 
 #include "rcppLeaf.h"
@@ -44,33 +42,20 @@ template <> SEXP Rcpp::wrap(const std::vector<LeafNode> &leafNode) {
 }
 
 
-template <> SEXP Rcpp::wrap(const std::vector<BagRow> &bagRow) {
-  XPtr<const std::vector<BagRow> > extWrap(new std::vector<BagRow>(bagRow), true);
-
-  return wrap(extWrap);
-}
-
-
 template <> std::vector<LeafNode>* Rcpp::as(SEXP sLNReg) {
   Rcpp::XPtr<std::vector<LeafNode> > xp(sLNReg);
   return (std::vector<LeafNode>*) xp;
 }
 
 
-template <> std::vector<BagRow>* Rcpp::as(SEXP sLNReg) {
-  Rcpp::XPtr<std::vector<BagRow> > xp(sLNReg);
-  return (std::vector<BagRow>*) xp;
-}
-
-
 /**
    @brief Wraps core (regression) Leaf vectors for reference by front end.
  */
-RcppExport SEXP LeafWrapReg(const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<BagRow> &bagRow, unsigned int rowTrain, const std::vector<unsigned int> &rank, const std::vector<double> &yRanked) {
+RcppExport SEXP LeafWrapReg(const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, unsigned int rowTrain, const std::vector<unsigned int> &rank, const std::vector<double> &yRanked) {
   List leaf = List::create(
    _["origin"] = leafOrigin,
    _["node"] = leafNode,
-   _["bagRow"] = bagRow,
+   _["bagPack"] = RawVector(bagPack.begin(), bagPack.end()),
    _["rowTrain"] = rowTrain,
    _["rank"] = rank,
    _["yRanked"] = yRanked
@@ -84,11 +69,11 @@ RcppExport SEXP LeafWrapReg(const std::vector<unsigned int> &leafOrigin, const s
 /**
    @brief Wraps core (classification) Leaf vectors for reference by front end.
  */
-RcppExport SEXP LeafWrapCtg(const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<BagRow> &bagRow, unsigned int rowTrain, const std::vector<double> &weight, const CharacterVector &levels) {
+RcppExport SEXP LeafWrapCtg(const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, unsigned int rowTrain, const std::vector<double> &weight, const CharacterVector &levels) {
   List leaf = List::create(
    _["origin"] = leafOrigin,	
    _["node"] = leafNode,
-   _["bagRow"] = bagRow,
+   _["bagPack"] = RawVector(bagPack.begin(), bagPack.end()),
    _["rowTrain"] = rowTrain,
    _["weight"] = weight,
    _["levels"] = levels
@@ -110,7 +95,7 @@ RcppExport SEXP LeafWrapCtg(const std::vector<unsigned int> &leafOrigin, const s
 
    @return void, with output reference parameters.
  */
-void LeafUnwrapReg(SEXP sLeaf, std::vector<double> &_yRanked, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> *&_leafNode, std::vector<BagRow> *&_bagRow, unsigned int &_rowTrain, std::vector<unsigned int> &_rank) {
+void LeafUnwrapReg(SEXP sLeaf, std::vector<double> &_yRanked, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> *&_leafNode, std::vector<unsigned char> &_bagPack, unsigned int &_rowTrain, std::vector<unsigned int> &_rank) {
   List leaf(sLeaf);
   if (!leaf.inherits("LeafReg"))
     stop("Expecting LeafReg");
@@ -118,7 +103,8 @@ void LeafUnwrapReg(SEXP sLeaf, std::vector<double> &_yRanked, std::vector<unsign
   _yRanked = as<std::vector<double> >(leaf["yRanked"]);
   _leafOrigin = as<std::vector<unsigned int>>(leaf["origin"]);
   _leafNode = as<std::vector<LeafNode> *>(leaf["node"]);
-  _bagRow = as<std::vector<BagRow> *>(leaf["bagRow"]);
+  RawVector bagPack((SEXP) leaf["bagPack"]);
+  _bagPack.assign(bagPack.begin(), bagPack.end());
   _rowTrain = as<unsigned int>(leaf["rowTrain"]);
   _rank = as<std::vector<unsigned int> >(leaf["rank"]);
 }
@@ -135,14 +121,15 @@ void LeafUnwrapReg(SEXP sLeaf, std::vector<double> &_yRanked, std::vector<unsign
 
    @return void, with output reference parameters.
  */
-void LeafUnwrapCtg(SEXP sLeaf, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> *&_leafNode, std::vector<BagRow> *&_bagRow, unsigned int &_rowTrain, std::vector<double> &_weight, CharacterVector &_levels) {
+void LeafUnwrapCtg(SEXP sLeaf, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> *&_leafNode, std::vector<unsigned char> &_bagPack, unsigned int &_rowTrain, std::vector<double> &_weight, CharacterVector &_levels) {
   List leaf(sLeaf);
   if (!leaf.inherits("LeafCtg")) {
     stop("Expecting LeafCtg");
   }
   _leafOrigin = as<std::vector<unsigned int> >(leaf["origin"]);
   _leafNode = as<std::vector<LeafNode> *>(leaf["node"]);
-  _bagRow = as<std::vector<BagRow> *>(leaf["bagRow"]);
+  RawVector bagPack((SEXP) leaf["bagPack"]);
+  _bagPack.assign(bagPack.begin(), bagPack.end());
   _rowTrain = as<unsigned int>(leaf["rowTrain"]);
   _weight = as<std::vector<double> >(leaf["weight"]);
   _levels = as<CharacterVector>((SEXP) leaf["levels"]);
@@ -0,0 +1,175 @@
+// Copyright (C)  2012-2016   Mark Seligman
+//
+// This file is part of ArboristBridgeR.
+//
+// ArboristBridgeR is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// ArboristBridgeR is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with ArboristBridgeR.  If not, see <http://www.gnu.org/licenses/>.
+
+/**
+   @file rcppModelMap.cc
+
+   @brief C++ interface to R entry for saving and loading the binary
+   model format.
+
+   @author Mark Seligman
+ */
+
+#include <Rcpp.h>
+
+using namespace std;
+using namespace Rcpp;
+
+#include "rcppForest.h"
+#include "rcppLeaf.h"
+#include "rcppPredblock.h"
+#include "rcppModelMap.h"
+#include "modelmap.h"
+#include "forest.h"
+#include "leaf.h"
+
+//#include <iostream>
+
+
+/**
+   @brief Saves a trained forest to a file in the binary model format.
+
+   @param sForest is the trained forest.
+
+   @param sLeaf is the trained leaf set.
+
+   @param sSignature is the training signature.
+
+   @param sPath is the file to write.
+
+   @return Wrapped true, or error if unwritable.
+ */
+RcppExport SEXP RcppModelSave(SEXP sForest, SEXP sLeaf, SEXP sSignature, SEXP sPath) {
+  std::vector<unsigned int> origin, facOrig, facSplit;
+  std::vector<ForestNode> *forestNode;
+  ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
+
+  IntegerVector predMapFE;
+  List level;
+  SignatureUnwrap(sSignature, predMapFE, level);
+
+  // Factors alone record their level names.
+  std::vector<unsigned int> facCard;
+  std::vector<std::string> predLevel;
+  for (int i = 0; i < level.length(); i++) {
+    if (Rf_isString(level[i])) {
+      std::vector<std::string> facLevel(as<std::vector<std::string> >(level[i]));
+      facCard.push_back(facLevel.size());
+      predLevel.insert(predLevel.end(), facLevel.begin(), facLevel.end());
+    }
+  }
+  std::vector<unsigned int> predMap(predMapFE.begin(), predMapFE.end());
+  unsigned int nPredFac = facCard.size();
+  unsigned int nPredNum = predMap.size() - nPredFac;
+
+  std::string path = as<std::string>(sPath);
+  std::vector<unsigned int> leafOrigin;
+  std::vector<LeafNode> *leafNode;
+  std::vector<unsigned char> bagPack;
+  unsigned int rowTrain;
+  bool ok;
+  if (List(sLeaf).inherits("LeafReg")) {
+    std::vector<double> yRanked;
+    std::vector<unsigned int> rank;
+    LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagPack, rowTrain, rank);
+    ok = ModelMap::SaveReg(path.c_str(), nPredNum, nPredFac, rowTrain, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, bagPack, rank, yRanked, predMap, facCard, predLevel);
+  }
+  else {
+    std::vector<double> weight;
+    CharacterVector levelsTrain;
+    LeafUnwrapCtg(sLeaf, leafOrigin, leafNode, bagPack, rowTrain, weight, levelsTrain);
+    std::vector<std::string> ctgLevel(as<std::vector<std::string> >(levelsTrain));
+    ok = ModelMap::SaveCtg(path.c_str(), nPredNum, nPredFac, rowTrain, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, bagPack, weight, predMap, facCard, predLevel, ctgLevel);
+  }
+  if (!ok)
+    stop("Unable to write model file");
+
+  return wrap(true);
+}
+
+
+/**
+   @brief Loads a model saved in the binary format.  The file is mapped
+   and remains so until the wrapper is collected.
+
+   @param sPath is the file to read.
+
+   @return RboristMapped object, or error if unreadable.
+ */
+RcppExport SEXP RcppModelLoad(SEXP sPath) {
+  std::string path = as<std::string>(sPath);
+  ModelMap *model = ModelMap::Load(path.c_str());
+  if (model == 0)
+    stop("Unreadable or malformed model file");
+
+  // Rebuilds the signature:  level names are split by cardinality.
+  unsigned int nPredNum = model->NPredNum();
+  unsigned int nPredFac = model->NPredFac();
+  IntegerVector predMap(model->PredMap(), model->PredMap() + nPredNum + nPredFac);
+  std::vector<std::string> predLevel;
+  model->PredLevel(predLevel);
+  List level(nPredFac);
+  unsigned int levelOff = 0;
+  for (unsigned int facIdx = 0; facIdx < nPredFac; facIdx++) {
+    unsigned int card = model->FacCard()[facIdx];
+    level[facIdx] = CharacterVector(predLevel.begin() + levelOff, predLevel.begin() + levelOff + card);
+    levelOff += card;
+  }
+  List signature = List::create(
+        _["predMap"] = predMap,
+        _["level"] = level
+	);
+  signature.attr("class") = "Signature";
+
+  std::vector<std::string> ctgLevel;
+  model->CtgLevel(ctgLevel);
+  bool isReg = model->IsRegression();
+  XPtr<ModelMap> extWrap(model, true); // Unmaps when collected.
+  List mapped = List::create(
+       _["model"] = extWrap,
+       _["signature"] = signature,
+       _["levels"] = isReg ? CharacterVector(0) : CharacterVector(ctgLevel.begin(), ctgLevel.end()),
+       _["regression"] = isReg,
+       _["nTree"] = model->NTree(),
+       _["rowTrain"] = model->NRowTrain(),
+       _["mapped"] = model->Mapped()
+       );
+  mapped.attr("class") = "RboristMapped";
+
+  return mapped;
+}
+
+
+/**
+   @brief Exposes the loaded model of a front-end wrapper.
+
+   @param sMapped is an RboristMapped object.
+
+   @return loaded model.
+ */
+ModelMap *ModelMapUnwrap(SEXP sMapped) {
+  List mapped(sMapped);
+  if (!mapped.inherits("RboristMapped"))
+    stop("Expecting RboristMapped");
+
+  XPtr<ModelMap> xp((SEXP) mapped["model"]);
+  ModelMap *model = (ModelMap *) xp;
+  if (model == 0)
+    stop("Mapped model not loaded in this session:  use ModelLoad()");
+
+  return model;
+}
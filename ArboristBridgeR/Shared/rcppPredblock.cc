@@ -24,14 +24,19 @@
 */
 
 #include "rowrank.h"
+#include "frameload.h"
+#include "facremap.h"
+#include "modelmap.h"
 // Testing only:
 //#include <iostream>
 
 #include <Rcpp.h>
 using namespace Rcpp;
 
+#include "rcppModelMap.h"
 
-void FactorRemap(IntegerMatrix &xFac, List &level, List &levelTrain);
+
+void FactorRemap(IntegerMatrix &xFac, List &level, List &levelTrain, const FacRemap *remap = 0);
 
 /**
   @brief Extracts contents of a data frame into numeric and (zero-based) factor blocks.  Can be quite slow for large predictor counts, as a linked list is being walked.
@@ -48,9 +53,11 @@ void FactorRemap(IntegerMatrix &xFac, List &level, List &levelTrain);
 
   @param sLevel is a vector of level counts for each column.
 
+  @param sMapped is a mapped model, whose level index is reused, or null.
+
   @return PredBlock with separate numeric and integer matrices.
 */
-RcppExport SEXP RcppPredBlockFrame(SEXP sX, SEXP sNumElt, SEXP sFacElt, SEXP sLevels, SEXP sSigTrain) {
+RcppExport SEXP RcppPredBlockFrame(SEXP sX, SEXP sNumElt, SEXP sFacElt, SEXP sLevels, SEXP sSigTrain, SEXP sMapped) {
   DataFrame xf(sX);
   IntegerVector numElt = IntegerVector(sNumElt) - 1;
   IntegerVector facElt = IntegerVector(sFacElt) - 1;
@@ -104,7 +111,7 @@ RcppExport SEXP RcppPredBlockFrame(SEXP sX, SEXP sNumElt, SEXP sFacElt, SEXP sLe
       stop("Signature mismatch");
 
     List levelTrain(as<List>(sigTrain["level"]));
-    FactorRemap(xFac, level, levelTrain);
+    FactorRemap(xFac, level, levelTrain, Rf_isNull(sMapped) ? 0 : ModelMapUnwrap(sMapped)->Remap());
   }
   List signature = List::create(
         _["predMap"] = predMap,
@@ -129,27 +136,118 @@ RcppExport SEXP RcppPredBlockFrame(SEXP sX, SEXP sNumElt, SEXP sFacElt, SEXP sLe
 }
 
 
-void FactorRemap(IntegerMatrix &xFac, List &levelTest, List &levelTrain) {
+/**
+   @brief Recodes test factors against the levels seen in training, in
+   place.  Unseen levels map to a proxy.
+
+   @param remap is a prebuilt index of training levels, or null to index
+   'levelTrain' afresh.
+
+   @return void, with output matrix parameter.
+ */
+void FactorRemap(IntegerMatrix &xFac, List &levelTest, List &levelTrain, const FacRemap *remap) {
+  std::vector<std::vector<std::string> > test(xFac.ncol());
   for (int col = 0; col < xFac.ncol(); col++) {
-    CharacterVector colTest(as<CharacterVector>(levelTest[col]));
-    CharacterVector colTrain(as<CharacterVector>(levelTrain[col]));
-    if (is_true(any(colTest != colTrain))) {
-      IntegerVector colMatch = match(colTest, colTrain);
-      IntegerVector sq = seq(0, colTest.length() - 1);
-      IntegerVector idxNonMatch = sq[is_na(colMatch)];
-      if (idxNonMatch.length() > 0) {
-	warning("Factor levels not observed in training:  employing proxy");
-	int proxy = colTrain.length() + 1;
-	colMatch[idxNonMatch] = proxy;
-      }
-
-      colMatch = colMatch - 1;  // match() is one-based.
-      IntegerMatrix::Column xCol = xFac(_, col);
-      IntegerVector colT(xCol);
-      IntegerVector colRemap = colMatch[colT];
-      xFac(_, col) = colRemap;
+    test[col] = as<std::vector<std::string> >(levelTest[col]);
+  }
+
+  FacRemap *remapLocal = 0;
+  if (remap == 0) {
+    std::vector<std::vector<std::string> > train(xFac.ncol());
+    for (int col = 0; col < xFac.ncol(); col++) {
+      train[col] = as<std::vector<std::string> >(levelTrain[col]);
     }
+    remapLocal = new FacRemap(train);
+    remap = remapLocal;
   }
+  size_t unseen = remap->Remap(xFac.begin(), xFac.nrow(), test);
+  delete remapLocal;
+
+  if (unseen > 0)
+    warning("Factor levels not observed in training:  employing proxy");
+}
+
+
+/**
+   @brief Reads a frame from file directly into numeric and factor blocks,
+   bypassing the R data frame.
+
+   @param sPath is the file to read, either delimited text or columnar binary.
+
+   @param sSep is the field separator, if text.
+
+   @param sHeader indicates whether text begins with column names.
+
+   @return PredBlock with separate numeric and integer matrices.
+ */
+RcppExport SEXP RcppPredBlockLoad(SEXP sPath, SEXP sSep, SEXP sHeader) {
+  std::string path = as<std::string>(sPath);
+  std::string sep = as<std::string>(sSep);
+  std::string diag;
+  FrameLoad *frame = FrameLoad::Read(path.c_str(), diag, sep.empty() ? ',' : sep[0], as<bool>(sHeader));
+  if (frame == 0)
+    stop(diag);
+
+  int nRow = frame->NRow();
+  int nPredNum = frame->NPredNum();
+  int nPredFac = frame->NPredFac();
+  NumericMatrix xNum = nPredNum > 0 ? NumericMatrix(nRow, nPredNum, frame->BlockNum().begin()) : NumericMatrix(0, 0);
+  IntegerMatrix xFac = nPredFac > 0 ? IntegerMatrix(nRow, nPredFac, frame->BlockFac().begin()) : IntegerMatrix(0);
+  List level(nPredFac);
+  for (int facIdx = 0; facIdx < nPredFac; facIdx++) {
+    level[facIdx] = wrap(frame->Level()[facIdx]);
+  }
+  List signature = List::create(
+        _["predMap"] = IntegerVector(frame->PredMap().begin(), frame->PredMap().end()),
+        _["level"] = level
+	);
+  signature.attr("class") = "Signature";
+
+  List predBlock = List::create(
+      _["colNames"] = wrap(frame->ColName()),
+      _["rowNames"] = R_NilValue,
+      _["blockNum"] = xNum,
+      _["nPredNum"] = nPredNum,
+      _["blockFac"] = xFac,
+      _["nPredFac"] = nPredFac,
+      _["nRow"] = nRow,
+      _["facCard"] = IntegerVector(frame->FacCard().begin(), frame->FacCard().end()),
+      _["signature"] = signature
+      );
+  predBlock.attr("class") = "PredBlock";
+  delete frame;
+
+  return predBlock;
+}
+
+
+/**
+   @brief Reconciles a loaded PredBlock with the signature of training,
+   as is done for frames by RcppPredBlockFrame.
+
+   @return PredBlock with factor codes remapped to training levels.
+ */
+RcppExport SEXP RcppPredBlockConform(SEXP sPredBlock, SEXP sSigTrain, SEXP sMapped) {
+  List predBlock = clone(List(sPredBlock));
+  if (!predBlock.inherits("PredBlock"))
+    stop("Expecting PredBlock");
+  if (as<int>(predBlock["nPredFac"]) == 0)
+    return predBlock;
+
+  List signature(as<List>(predBlock["signature"]));
+  List sigTrain(sSigTrain);
+  IntegerVector predMap(as<IntegerVector>(signature["predMap"]));
+  IntegerVector predTrain(as<IntegerVector>(sigTrain["predMap"]));
+  if (predMap.length() != predTrain.length() || !is_true(all(predMap == predTrain)))
+    stop("Signature mismatch");
+
+  IntegerMatrix xFac(as<IntegerMatrix>(predBlock["blockFac"]));
+  List level(as<List>(signature["level"]));
+  List levelTrain(as<List>(sigTrain["level"]));
+  FactorRemap(xFac, level, levelTrain, Rf_isNull(sMapped) ? 0 : ModelMapUnwrap(sMapped)->Remap());
+  predBlock["blockFac"] = xFac;
+
+  return predBlock;
 }
 
 
@@ -31,7 +31,9 @@ using namespace Rcpp;
 #include "rcppPredblock.h"
 #include "rcppForest.h"
 #include "rcppLeaf.h"
+#include "rcppModelMap.h"
 #include "predict.h"
+#include "modelmap.h"
 #include "forest.h"
 #include "leaf.h"
 
@@ -66,31 +68,56 @@ double MSE(const double yValid[], NumericVector y, double &rsq) {
 }
 
 
+/**
+   @brief Exposes a mapped model, checking that the block conforms.
+
+   @param sMapped is an RboristMapped object.
+
+   @return loaded model.
+ */
+ModelMap *MappedUnwrap(SEXP sMapped, int nPredNum, int nPredFac) {
+  ModelMap *model = ModelMapUnwrap(sMapped);
+  if (model->NPredNum() != (unsigned int) nPredNum || model->NPredFac() != (unsigned int) nPredFac)
+    stop("Predictor types do not conform with training");
+
+  return model;
+}
+
+
 /**
    @brief Predction for regression.
 
+   @param sMapped is a mapped model, if nonnull, predicted upon in
+   place of the forest and leaves.
+
    @return Wrapped zero, with copy-out parameters.
  */
-RcppExport SEXP RcppPredictReg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest, bool bag) {
+RcppExport SEXP RcppPredictReg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest, bool bag, SEXP sMapped) {
   int nPredNum, nPredFac, nRow;
   NumericMatrix blockNum;
   IntegerMatrix blockFac;
   PredblockUnwrap(sPredBlock, nRow, nPredNum, nPredFac, blockNum, blockFac);
 
-  std::vector<unsigned int> origin, facOrig, facSplit;
-  std::vector<ForestNode> *forestNode;
-  ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
-  
-  std::vector<double> yRanked;
-  std::vector<unsigned int> leafOrigin;
-  std::vector<LeafNode> *leafNode;
-  std::vector<BagRow> *bagRow;
-  unsigned int rowTrain;
-  std::vector<unsigned int> rank;
-  LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagRow, rowTrain, rank);
-
   std::vector<double> yPred(nRow);
-  Predict::Regression(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, *bagRow, rank, yRanked, yPred, bag ? rowTrain : 0);
+  if (!Rf_isNull(sMapped)) {
+    ModelMap *model = MappedUnwrap(sMapped, nPredNum, nPredFac);
+    Predict::Regression(model, nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, yPred, 0);
+  }
+  else {
+    std::vector<unsigned int> origin, facOrig, facSplit;
+    std::vector<ForestNode> *forestNode;
+    ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
+  
+    std::vector<double> yRanked;
+    std::vector<unsigned int> leafOrigin;
+    std::vector<LeafNode> *leafNode;
+    std::vector<unsigned char> bagPack;
+    unsigned int rowTrain;
+    std::vector<unsigned int> rank;
+    LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagPack, rowTrain, rank);
+
+    Predict::Regression(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, bagPack, rank, yRanked, yPred, bag ? rowTrain : 0);
+  }
 
   List prediction;
   if (Rf_isNull(sYTest)) { // Prediction
@@ -118,37 +145,58 @@ RcppExport SEXP RcppPredictReg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP s
 
 
 RcppExport SEXP RcppValidateReg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictReg(sPredBlock, sForest, sLeaf, sYTest, true);
+  return RcppPredictReg(sPredBlock, sForest, sLeaf, sYTest, true, R_NilValue);
 }
 
 
 RcppExport SEXP RcppTestReg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictReg(sPredBlock, sForest, sLeaf, sYTest, false);
+  return RcppPredictReg(sPredBlock, sForest, sLeaf, sYTest, false, R_NilValue);
+}
+
+
+/**
+   @brief Predicts regression directly from a mapped model.
+
+   @param sMapped is an RboristMapped object.
+
+   @return Prediction list.
+ */
+RcppExport SEXP RcppTestRegMapped(SEXP sPredBlock, SEXP sMapped, SEXP sYTest) {
+  return RcppPredictReg(sPredBlock, R_NilValue, R_NilValue, sYTest, false, sMapped);
 }
 
 
 /**
    @brief Prediction for classification.
 
+   @param sMapped is a mapped model, if nonnull, predicted upon in
+   place of the forest and leaves.
+
    @return Prediction list.
  */
-RcppExport SEXP RcppPredictCtg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest, bool bag, bool doProb) {
+RcppExport SEXP RcppPredictCtg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest, bool bag, bool doProb, SEXP sMapped) {
   int nPredNum, nPredFac, nRow;
   NumericMatrix blockNum;
   IntegerMatrix blockFac;
   PredblockUnwrap(sPredBlock, nRow, nPredNum, nPredFac, blockNum, blockFac);
     
   std::vector<unsigned int> origin, facOrig, facSplit;
-  std::vector<ForestNode> *forestNode;
-  ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
-
+  std::vector<ForestNode> *forestNode = 0;
   std::vector<unsigned int> leafOrigin;
-  std::vector<LeafNode> *leafNode;
-  std::vector<BagRow> *bagRow;
-  unsigned int rowTrain;
+  std::vector<LeafNode> *leafNode = 0;
+  std::vector<unsigned char> bagPack;
+  unsigned int rowTrain = 0;
   std::vector<double> weight;
   CharacterVector levelsTrain;
-  LeafUnwrapCtg(sLeaf, leafOrigin, leafNode, bagRow, rowTrain, weight, levelsTrain);
+  ModelMap *model = 0;
+  if (!Rf_isNull(sMapped)) {
+    model = MappedUnwrap(sMapped, nPredNum, nPredFac);
+    levelsTrain = as<CharacterVector>(List(sMapped)["levels"]);
+  }
+  else {
+    ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
+    LeafUnwrapCtg(sLeaf, leafOrigin, leafNode, bagPack, rowTrain, weight, levelsTrain);
+  }
 
   unsigned int ctgWidth = levelsTrain.length();
   bool validate = !Rf_isNull(sYTest);
@@ -195,7 +243,12 @@ RcppExport SEXP RcppPredictCtg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP s
   IntegerVector censusCore = IntegerVector(nRow * ctgWidth);
   std::vector<int> yPred(nRow);
   NumericVector probCore = doProb ? NumericVector(nRow * ctgWidth) : NumericVector(0);
-  Predict::Classification(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, *bagRow, weight, yPred, censusCore.begin(), testCore, validate ? confCore.begin() : 0, misPredCore, doProb ? probCore.begin() : 0, bag ? rowTrain : 0);
+  if (model != 0) {
+    Predict::Classification(model, nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, yPred, censusCore.begin(), testCore, validate ? confCore.begin() : 0, misPredCore, doProb ? probCore.begin() : 0, 0);
+  }
+  else {
+    Predict::Classification(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, bagPack, weight, yPred, censusCore.begin(), testCore, validate ? confCore.begin() : 0, misPredCore, doProb ? probCore.begin() : 0, bag ? rowTrain : 0);
+  }
 
   List predBlock(sPredBlock);
   IntegerMatrix census = transpose(IntegerMatrix(ctgWidth, nRow, censusCore.begin()));
@@ -249,12 +302,12 @@ RcppExport SEXP RcppPredictCtg(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP s
 
 
 RcppExport SEXP RcppValidateVotes(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, true, false);
+  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, true, false, R_NilValue);
 }
 
 
 RcppExport SEXP RcppValidateProb(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, true, true);
+  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, true, true, R_NilValue);
 }
 
 
@@ -272,7 +325,7 @@ RcppExport SEXP RcppValidateProb(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP
    @return Prediction object.
  */
 RcppExport SEXP RcppTestVotes(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, false, false);
+  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, false, false, R_NilValue);
 }
 
 
@@ -290,7 +343,31 @@ RcppExport SEXP RcppTestVotes(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sY
    @return Prediction object.
  */
 RcppExport SEXP RcppTestProb(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYTest) {
-  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, false, true);
+  return RcppPredictCtg(sPredBlock, sForest, sLeaf, sYTest, false, true, R_NilValue);
+}
+
+
+/**
+   @brief Predicts with class votes directly from a mapped model.
+
+   @param sMapped is an RboristMapped object.
+
+   @return Prediction object.
+ */
+RcppExport SEXP RcppTestVotesMapped(SEXP sPredBlock, SEXP sMapped, SEXP sYTest) {
+  return RcppPredictCtg(sPredBlock, R_NilValue, R_NilValue, sYTest, false, false, sMapped);
+}
+
+
+/**
+   @brief Predicts with class probabilities directly from a mapped model.
+
+   @param sMapped is an RboristMapped object.
+
+   @return Prediction object.
+ */
+RcppExport SEXP RcppTestProbMapped(SEXP sPredBlock, SEXP sMapped, SEXP sYTest) {
+  return RcppPredictCtg(sPredBlock, R_NilValue, R_NilValue, sYTest, false, true, sMapped);
 }
 
 
@@ -313,30 +390,41 @@ RcppExport SEXP RcppTestProb(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sYT
 
    @param bag is true iff validating.
 
+   @param sMapped is a mapped model, if nonnull, predicted upon in
+   place of the forest and leaves.
+
    @return Prediction list.
 */
-RcppExport SEXP RcppPredictQuant(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sQuantVec, SEXP sQBin, SEXP sYTest, bool bag) {
+RcppExport SEXP RcppPredictQuant(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sQuantVec, SEXP sQBin, SEXP sYTest, bool bag, SEXP sMapped) {
   int nPredNum, nPredFac, nRow;
   NumericMatrix blockNum;
   IntegerMatrix blockFac;
   PredblockUnwrap(sPredBlock, nRow, nPredNum, nPredFac, blockNum, blockFac);
-    
-  std::vector<unsigned int> origin, facOrig, facSplit;
-  std::vector<ForestNode> *forestNode;
-  ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
-
-  std::vector<double> yRanked;
-  std::vector<unsigned int> leafOrigin;
-  std::vector<LeafNode> *leafNode;
-  std::vector<BagRow> *bagRow;
-  unsigned int rowTrain;
-  std::vector<unsigned int> rank;
-  LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagRow, rowTrain, rank);
 
   std::vector<double> yPred(nRow);
   std::vector<double> quantVecCore(as<std::vector<double> >(sQuantVec));
   std::vector<double> qPredCore(nRow * quantVecCore.size());
-  Predict::Quantiles(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, *bagRow, rank, yRanked, yPred, quantVecCore, as<int>(sQBin), qPredCore,  bag ? rowTrain : 0);
+  if (!Rf_isNull(sMapped)) {
+    ModelMap *model = MappedUnwrap(sMapped, nPredNum, nPredFac);
+    if (!model->IsRegression())
+      stop("Quantiles supported for regression case only");
+    Predict::Quantiles(model, nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, yPred, quantVecCore, as<int>(sQBin), qPredCore, 0);
+  }
+  else {
+    std::vector<unsigned int> origin, facOrig, facSplit;
+    std::vector<ForestNode> *forestNode;
+    ForestUnwrap(sForest, origin, facOrig, facSplit, forestNode);
+
+    std::vector<double> yRanked;
+    std::vector<unsigned int> leafOrigin;
+    std::vector<LeafNode> *leafNode;
+    std::vector<unsigned char> bagPack;
+    unsigned int rowTrain;
+    std::vector<unsigned int> rank;
+    LeafUnwrapReg(sLeaf, yRanked, leafOrigin, leafNode, bagPack, rowTrain, rank);
+
+    Predict::Quantiles(nPredNum > 0 ? transpose(blockNum).begin() : 0, nPredFac > 0 ? transpose(blockFac).begin() : 0, nPredNum, nPredFac, *forestNode, origin, facOrig, facSplit, leafOrigin, *leafNode, bagPack, rank, yRanked, yPred, quantVecCore, as<int>(sQBin), qPredCore,  bag ? rowTrain : 0);
+  }
 
   NumericMatrix qPred(transpose(NumericMatrix(quantVecCore.size(), nRow, qPredCore.begin())));
   List prediction;
@@ -364,10 +452,22 @@ RcppExport SEXP RcppPredictQuant(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP
 
 
 RcppExport SEXP RcppValidateQuant(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sQuantVec, SEXP sQBin, SEXP sYTest) {
-  return RcppPredictQuant(sPredBlock, sForest, sLeaf, sQuantVec, sQBin, sYTest, true);
+  return RcppPredictQuant(sPredBlock, sForest, sLeaf, sQuantVec, sQBin, sYTest, true, R_NilValue);
 }
 
 
 RcppExport SEXP RcppTestQuant(SEXP sPredBlock, SEXP sForest, SEXP sLeaf, SEXP sQuantVec, SEXP sQBin, SEXP sYTest) {
-  return RcppPredictQuant(sPredBlock, sForest, sLeaf, sQuantVec, sQBin, sYTest, false);
+  return RcppPredictQuant(sPredBlock, sForest, sLeaf, sQuantVec, sQBin, sYTest, false, R_NilValue);
+}
+
+
+/**
+   @brief Prediction with quantiles directly from a mapped model.
+
+   @param sMapped is an RboristMapped object.
+
+   @return Prediction list.
+ */
+RcppExport SEXP RcppTestQuantMapped(SEXP sPredBlock, SEXP sMapped, SEXP sQuantVec, SEXP sQBin, SEXP sYTest) {
+  return RcppPredictQuant(sPredBlock, R_NilValue, R_NilValue, sQuantVec, sQBin, sYTest, false, sMapped);
 }
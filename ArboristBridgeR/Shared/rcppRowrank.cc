@@ -39,9 +39,12 @@ using namespace std;
 
    @param sPredBlock is an (S3) PredBlock object.
 
+   @param sRankMax caps the distinct ranks of numeric predictors, zero
+   if uncapped.
+
    @return parallel row and rank arrays and the inverse numeric mapping.
  */
-RcppExport SEXP RcppRowRank(SEXP sPredBlock) {
+RcppExport SEXP RcppRowRank(SEXP sPredBlock, SEXP sRankMax) {
   List predBlock(sPredBlock);
   if (!predBlock.inherits("PredBlock"))
     stop("Expecting PredBlock");
@@ -56,7 +59,7 @@ RcppExport SEXP RcppRowRank(SEXP sPredBlock) {
   if (nPredNum > 0) {
     invNum = IntegerVector(nRow * nPredNum);
     NumericMatrix blockNum(as<NumericMatrix>(predBlock["blockNum"]));
-    RowRank::PreSortNum(blockNum.begin(), nPredNum, nRow, row.begin(), rank.begin(), invNum.begin());
+    RowRank::PreSortNum(blockNum.begin(), nPredNum, nRow, row.begin(), rank.begin(), invNum.begin(), as<unsigned int>(sRankMax));
   }
   if (nPredFac > 0) {
     IntegerMatrix blockFac(as<IntegerMatrix>(predBlock["blockFac"]));
@@ -72,3 +75,61 @@ RcppExport SEXP RcppRowRank(SEXP sPredBlock) {
 
   return rowRank;
 }
+
+
+/**
+   @brief Builds row/rank maps for a block extending the rows of a prior
+   presort, merging the appended rows into the prior orderings.
+
+   @param sPredBlock is an (S3) PredBlock object over all rows, appended
+   rows last.
+
+   @param sRowRank is the RowRank object of the prior presort.
+
+   @param sNRowOld is the number of rows in the prior presort.
+
+   @param sRankMax caps the distinct ranks of numeric predictors, zero
+   if uncapped.
+
+   @return parallel row and rank arrays and the inverse numeric mapping.
+ */
+RcppExport SEXP RcppRowRankMerge(SEXP sPredBlock, SEXP sRowRank, SEXP sNRowOld, SEXP sRankMax) {
+  List predBlock(sPredBlock);
+  if (!predBlock.inherits("PredBlock"))
+    stop("Expecting PredBlock");
+
+  List rowRankOld(sRowRank);
+  if (!rowRankOld.inherits("RowRank"))
+    stop("Expecting RowRank");
+
+  unsigned int nRow = as<unsigned int>(predBlock["nRow"]);
+  unsigned int nRowOld = as<unsigned int>(sNRowOld);
+  unsigned int nPredNum = as<unsigned int>(predBlock["nPredNum"]);
+  unsigned int nPredFac = as<unsigned int>(predBlock["nPredFac"]);
+  unsigned int nPred = nPredNum + nPredFac;
+  IntegerVector rowOld(as<IntegerVector>(rowRankOld["row"]));
+  if (nRowOld > nRow || rowOld.length() != nRowOld * nPred)
+    stop("Prior RowRank does not match PredBlock");
+
+  IntegerVector rank = IntegerVector(nRow * nPred);
+  IntegerVector row = IntegerVector(nRow * nPred);
+  IntegerVector invNum = 0;
+  if (nPredNum > 0) {
+    invNum = IntegerVector(nRow * nPredNum);
+    NumericMatrix blockNum(as<NumericMatrix>(predBlock["blockNum"]));
+    RowRank::MergeNum(blockNum.begin(), nPredNum, nRowOld, nRow, rowOld.begin(), row.begin(), rank.begin(), invNum.begin(), as<unsigned int>(sRankMax));
+  }
+  if (nPredFac > 0) {
+    IntegerMatrix blockFac(as<IntegerMatrix>(predBlock["blockFac"]));
+    RowRank::MergeFac(blockFac.begin(), nPredNum, nPredFac, nRowOld, nRow, rowOld.begin(), row.begin(), rank.begin());
+  }
+
+  List rowRank = List::create(
+      _["row"] = row,
+      _["rank"] = rank,
+      _["invNum"] = invNum
+    );
+  rowRank.attr("class") = "RowRank";
+
+  return rowRank;
+}
@@ -68,6 +68,101 @@ void RcppProxyCtg(IntegerVector y, NumericVector classWeight, std::vector<double
 }
 
 
+/**
+   @brief Draws the training seed from R's generator, so that
+   'set.seed' continues to govern reproducibility.
+
+   @return seed keying the core's generator.
+ */
+unsigned int RcppSeed() {
+  RNGScope scope;
+  return (unsigned int) R::runif(0.0, 4294967296.0);
+}
+
+
+/**
+   @brief Wraps the per-tree arenas' tallied counters from the most recent training.
+
+   @return named vector of request, allocation and byte counts.
+ */
+NumericVector ArenaWrap() {
+  size_t allocCount, chunkCount, bytesServed, highWater;
+  Train::ArenaReport(allocCount, chunkCount, bytesServed, highWater);
+  return NumericVector::create(
+      _["allocCount"] = double(allocCount),
+      _["chunkCount"] = double(chunkCount),
+      _["bytesServed"] = double(bytesServed),
+      _["highWater"] = double(highWater)
+  );
+}
+
+
+/**
+   @brief Wraps the core's memory accounting of the most recent training.
+
+   @return list of byte counts by subsystem, tree and depth, or NULL if
+   accounting was not compiled in.
+ */
+SEXP MemWrap() {
+  std::vector<std::string> subName;
+  std::vector<size_t> current, peak, treePeak, levelPeak;
+  Train::MemReport(subName, current, peak, treePeak, levelPeak);
+  if (subName.empty())
+    return R_NilValue;
+
+  NumericVector subCurrent(current.begin(), current.end());
+  NumericVector subPeak(peak.begin(), peak.end());
+  subCurrent.names() = wrap(subName);
+  subPeak.names() = wrap(subName);
+
+  return List::create(
+      _["current"] = subCurrent,
+      _["peak"] = subPeak,
+      _["treePeak"] = NumericVector(treePeak.begin(), treePeak.end()),
+      _["levelPeak"] = NumericVector(levelPeak.begin(), levelPeak.end())
+  );
+}
+
+
+/**
+   @brief Wraps the core's phase timing of the most recent training.
+
+   @return list of seconds and work counts by phase, depth and tree,
+   with the Chrome trace, or NULL if timing was not compiled in.
+ */
+SEXP ProfWrap() {
+  std::vector<std::string> phaseName;
+  std::vector<double> phaseSec, levelSec, treeSec;
+  std::vector<size_t> levelPairs, levelVolume;
+  Train::ProfReport(phaseName, phaseSec, levelSec, treeSec, levelPairs, levelVolume);
+  if (phaseName.empty())
+    return R_NilValue;
+
+  unsigned int phaseCount = phaseName.size();
+  NumericVector sec(phaseSec.begin(), phaseSec.end());
+  sec.names() = wrap(phaseName);
+  NumericMatrix level(phaseCount, levelSec.size() / phaseCount, levelSec.begin());
+  NumericMatrix tree(phaseCount, treeSec.size() / phaseCount, treeSec.begin());
+  NumericMatrix pairs(phaseCount, levelPairs.size() / phaseCount, levelPairs.begin());
+  NumericMatrix volume(phaseCount, levelVolume.size() / phaseCount, levelVolume.begin());
+  rownames(level) = wrap(phaseName);
+  rownames(tree) = wrap(phaseName);
+  rownames(pairs) = wrap(phaseName);
+  rownames(volume) = wrap(phaseName);
+  std::string trace;
+  Train::ProfTrace(trace);
+
+  return List::create(
+      _["sec"] = sec,
+      _["levelSec"] = level,
+      _["treeSec"] = tree,
+      _["levelPairs"] = pairs,
+      _["levelVolume"] = volume,
+      _["trace"] = trace
+  );
+}
+
+
 /**
    @brief Constructs classification forest.
 
@@ -83,7 +178,7 @@ void RcppProxyCtg(IntegerVector y, NumericVector classWeight, std::vector<double
 
    @return Wrapped length of forest vector, with output parameters.
  */
-RcppExport SEXP RcppTrainCtg(SEXP sPredBlock, SEXP sRowRank, SEXP sYOneBased, SEXP sNTree, SEXP sNSamp, SEXP sSampleWeight, SEXP sWithRepl, SEXP sTrainBlock, SEXP sMinNode, SEXP sMinRatio, SEXP sTotLevels, SEXP sPredFixed, SEXP sProbVec, SEXP sClassWeight) {
+RcppExport SEXP RcppTrainCtg(SEXP sPredBlock, SEXP sRowRank, SEXP sYOneBased, SEXP sNTree, SEXP sNSamp, SEXP sSampleWeight, SEXP sWithRepl, SEXP sTrainBlock, SEXP sBlockBytes, SEXP sSpillDir, SEXP sMinNode, SEXP sMinRatio, SEXP sTotLevels, SEXP sPredFixed, SEXP sProbVec, SEXP sClassWeight) {
   List predBlock(sPredBlock);
   if (!predBlock.inherits("PredBlock"))
     stop("Expecting PredBlock");
@@ -130,8 +225,9 @@ RcppExport SEXP RcppTrainCtg(SEXP sPredBlock, SEXP sRowRank, SEXP sYOneBased, SE
 
   int nPred = nPredNum + nPredFac;
   NumericVector predProb = NumericVector(sProbVec)[predMap];
+  std::string spillDir = as<std::string>(sSpillDir);
 
-  Train::Init(feNum, feFacCard, cardMax, nPredNum, nPredFac, nRow, nTree, as<int>(sNSamp), sampleWeight.begin(), as<bool>(sWithRepl), as<int>(sTrainBlock), as<int>(sMinNode), as<double>(sMinRatio), as<int>(sTotLevels), ctgWidth, as<int>(sPredFixed), predProb.begin());
+  Train::Init(feNum, feFacCard, cardMax, nPredNum, nPredFac, nRow, nTree, as<int>(sNSamp), sampleWeight.begin(), as<bool>(sWithRepl), as<int>(sTrainBlock), as<int>(sMinNode), as<double>(sMinRatio), as<int>(sTotLevels), ctgWidth, as<int>(sPredFixed), predProb.begin(), 0, as<double>(sBlockBytes), spillDir.c_str(), RcppSeed());
 
   std::vector<unsigned int> origin(nTree);
   std::vector<unsigned int> facOrig(nTree);
@@ -142,20 +238,26 @@ RcppExport SEXP RcppTrainCtg(SEXP sPredBlock, SEXP sRowRank, SEXP sYOneBased, SE
 
   std::vector<unsigned int> facSplit;
   std::vector<LeafNode> leafNode;
-  std::vector<BagRow> bagRow;
+  std::vector<unsigned char> bagPack;
   std::vector<double> weight;
 
-  Train::Classification(feRow.begin(), feRank.begin(), feInvNum, as<std::vector<unsigned int> >(y), ctgWidth, proxy, origin, facOrig, predInfo.begin(), forestNode, facSplit, leafOrigin, leafNode, bagRow, weight);
+  Train::Classification(feRow.begin(), feRank.begin(), feInvNum, as<std::vector<unsigned int> >(y), ctgWidth, proxy, origin, facOrig, predInfo.begin(), forestNode, facSplit, leafOrigin, leafNode, bagPack, weight);
 
   return List::create(
       _["forest"] = ForestWrap(origin, facOrig, facSplit, forestNode),
-      _["leaf"] = LeafWrapCtg(leafOrigin, leafNode, bagRow, nRow, weight, CharacterVector(yOneBased.attr("levels"))),
-      _["predInfo"] = predInfo[predMap] // Maps back from core order.
+      _["leaf"] = LeafWrapCtg(leafOrigin, leafNode, bagPack, nRow, weight, CharacterVector(yOneBased.attr("levels"))),
+      _["predInfo"] = predInfo[predMap], // Maps back from core order.
+      _["peakRSS"] = double(Train::PeakRSS()),
+      _["segmentCount"] = Train::SegmentCount(),
+      _["reallocCount"] = Train::ReallocCount(),
+      _["arena"] = ArenaWrap(),
+      _["memory"] = MemWrap(),
+      _["profile"] = ProfWrap()
   );
 }
 
 
-RcppExport SEXP RcppTrainReg(SEXP sPredBlock, SEXP sRowRank, SEXP sY, SEXP sNTree, SEXP sNSamp, SEXP sSampleWeight, SEXP sWithRepl, SEXP sTrainBlock, SEXP sMinNode, SEXP sMinRatio, SEXP sTotLevels, SEXP sPredFixed, SEXP sProbVec, SEXP sRegMono) {
+RcppExport SEXP RcppTrainReg(SEXP sPredBlock, SEXP sRowRank, SEXP sY, SEXP sNTree, SEXP sNSamp, SEXP sSampleWeight, SEXP sWithRepl, SEXP sTrainBlock, SEXP sBlockBytes, SEXP sSpillDir, SEXP sMinNode, SEXP sMinRatio, SEXP sTotLevels, SEXP sPredFixed, SEXP sProbVec, SEXP sRegMono) {
   List predBlock(sPredBlock);
   if (!predBlock.inherits("PredBlock"))
     stop("Expecting PredBlock");
@@ -190,9 +292,10 @@ RcppExport SEXP RcppTrainReg(SEXP sPredBlock, SEXP sRowRank, SEXP sY, SEXP sNTre
 
   int nPred = nPredNum + nPredFac;
   NumericVector predProb = NumericVector(sProbVec)[predMap];
+  std::string spillDir = as<std::string>(sSpillDir);
   NumericVector regMono = NumericVector(sRegMono)[predMap];
   
-  Train::Init(feNum, feFacCard, cardMax, nPredNum, nPredFac, nRow, nTree, as<int>(sNSamp), sampleWeight.begin(), as<bool>(sWithRepl), as<int>(sTrainBlock), as<int>(sMinNode), as<double>(sMinRatio), as<int>(sTotLevels), 0, as<int>(sPredFixed), predProb.begin(), regMono.begin());
+  Train::Init(feNum, feFacCard, cardMax, nPredNum, nPredFac, nRow, nTree, as<int>(sNSamp), sampleWeight.begin(), as<bool>(sWithRepl), as<int>(sTrainBlock), as<int>(sMinNode), as<double>(sMinRatio), as<int>(sTotLevels), 0, as<int>(sPredFixed), predProb.begin(), regMono.begin(), as<double>(sBlockBytes), spillDir.c_str(), RcppSeed());
 
   IntegerVector feRow(as<IntegerVector>(rowRank["row"]));
   IntegerVector feRank(as<IntegerVector>(rowRank["rank"]));
@@ -208,15 +311,21 @@ RcppExport SEXP RcppTrainReg(SEXP sPredBlock, SEXP sRowRank, SEXP sY, SEXP sNTre
 
   std::vector<ForestNode> forestNode;
   std::vector<LeafNode> leafNode;
-  std::vector<BagRow> bagRow;
+  std::vector<unsigned char> bagPack;
   std::vector<unsigned int> rank;
   std::vector<unsigned int> facSplit;
 
-  Train::Regression(feRow.begin(), feRank.begin(), feInvNum, as<std::vector<double> >(y), as<std::vector<unsigned int> >(row2Rank), origin, facOrig, predInfo.begin(), forestNode, facSplit, leafOrigin, leafNode, bagRow, rank);
+  Train::Regression(feRow.begin(), feRank.begin(), feInvNum, as<std::vector<double> >(y), as<std::vector<unsigned int> >(row2Rank), origin, facOrig, predInfo.begin(), forestNode, facSplit, leafOrigin, leafNode, bagPack, rank);
 
   return List::create(
       _["forest"] = ForestWrap(origin, facOrig, facSplit, forestNode),
-      _["leaf"] = LeafWrapReg(leafOrigin, leafNode, bagRow, nRow, rank, as<std::vector<double> >(yRanked)),
-      _["predInfo"] = predInfo[predMap] // Maps back from core order.
+      _["leaf"] = LeafWrapReg(leafOrigin, leafNode, bagPack, nRow, rank, as<std::vector<double> >(yRanked)),
+      _["predInfo"] = predInfo[predMap], // Maps back from core order.
+      _["peakRSS"] = double(Train::PeakRSS()),
+      _["segmentCount"] = Train::SegmentCount(),
+      _["reallocCount"] = Train::ReallocCount(),
+      _["arena"] = ArenaWrap(),
+      _["memory"] = MemWrap(),
+      _["profile"] = ProfWrap()
     );
 }
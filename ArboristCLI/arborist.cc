@@ -0,0 +1,695 @@
+// This file is part of ArboristCLI.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file arborist.cc
+
+   @brief Command-line driver for training and prediction, built from
+   the core alone.
+
+   Designs are read by FrameLoad, either as delimited text or in the
+   columnar binary format, and models are saved and loaded through
+   ModelMap.  The response, when present, is a named column of the
+   design file.
+
+   @author Mark Seligman
+ */
+
+#include "callback.h"
+#include "frameload.h"
+#include "facremap.h"
+#include "levelindex.h"
+#include "modelmap.h"
+#include "rowrank.h"
+#include "train.h"
+#include "forest.h"
+#include "leaf.h"
+#include "predict.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+
+/**
+   @brief Command-line settings, with the defaults of the R front end.
+ */
+class Options {
+ public:
+  std::string design; // -x
+  std::string model; // -m
+  std::string response; // -y
+  std::string output; // -o
+  char sep; // -s
+  bool header; // -H clears.
+
+  // Training.
+  unsigned int nTree; // -t
+  unsigned int nSamp; // -n
+  bool withRepl; // -R clears.
+  int minNode; // -N; negative defaults by response type.
+  double minInfo; // -i
+  unsigned int nLevel; // -l
+  int predFixed; // -f; negative defaults by predictor count.
+  double predProb; // -p; negative defaults by response type.
+  int trainBlock; // -b; negative defaults by whether budgeted.
+  unsigned int rankMax; // -k
+  bool ctg; // -c forces classification.
+  bool seeded; // Whether -S given.
+  unsigned int seed; // -S
+  double blockBytes; // -B
+  std::string spillDir; // -d
+  double spillMin; // -M
+  std::string tracePath; // -P
+
+  // Quantiles.
+  std::vector<double> quantVec; // -q
+  unsigned int qBin; // -Q
+
+  Options() : sep(','), header(true), nTree(500), nSamp(0), withRepl(true), minNode(-1), minInfo(0.01), nLevel(0), predFixed(-1), predProb(-1.0), trainBlock(-1), rankMax(0), ctg(false), seeded(false), seed(0), blockBytes(0.0), spillMin(1 << 20), qBin(5000) {
+    quantVec = {0.25, 0.5, 0.75, 1.0};
+  }
+};
+
+
+static void Usage() {
+  fprintf(stderr,
+    "usage: arborist <command> [options]\n"
+    "\n"
+    "commands:\n"
+    "  train      -x design -y response -m model\n"
+    "  predict    -m model -x design [-y response] [-o output]\n"
+    "  quantiles  -m model -x design [-y response] [-q q1,q2,...] [-Q qBin] [-o output]\n"
+    "  validate   -m model -x design -y response [-o output]\n"
+    "\n"
+    "design:\n"
+    "  -x file    delimited text or columnar binary, recognized by inspection\n"
+    "  -y name    column holding the response, removed from the predictors\n"
+    "  -s char    field separator of text (default ',')\n"
+    "  -H         text has no header line\n"
+    "\n"
+    "training:\n"
+    "  -t nTree   trees to train (500)\n"
+    "  -n nSamp   samples per tree (rows, or 63.2%% if without replacement)\n"
+    "  -R         sample without replacement\n"
+    "  -N minNode minimum splitting width (5 regression, 2 classification)\n"
+    "  -i ratio   minimum information ratio for splitting (0.01)\n"
+    "  -l nLevel  maximum tree depth, zero if unlimited (0)\n"
+    "  -f count   fixed count of trial predictors per split\n"
+    "  -p prob    Bernoulli probability of trying each predictor\n"
+    "  -b count   most trees trained per block, zero if unbounded (1, or 0 under -B)\n"
+    "  -k rankMax caps distinct numeric ranks, zero if uncapped (0)\n"
+    "  -c         classify a numeric response\n"
+    "  -S seed    seeds training (random)\n"
+    "  -B bytes   memory budget of a block of trees, zero if unbudgeted (0)\n"
+    "  -d dir     spill directory for the largest training buffers\n"
+    "  -M bytes   smallest buffer spilled under -d (1048576)\n"
+    "  -P file    writes a Chrome trace of training phases (built with PROFILE=1)\n"
+    "\n"
+    "Predictions are written one row per line, to standard output unless\n"
+    "-o is given.  Scores and summaries are written to standard error.\n");
+}
+
+
+/**
+   @brief Parses a comma-separated list of quantiles.
+
+   @return true iff all values lie in [0,1] and increase.
+ */
+static bool QuantParse(const char *arg, std::vector<double> &quantVec) {
+  quantVec.clear();
+  const char *pos = arg;
+  while (*pos != '\0') {
+    char *end;
+    double quant = strtod(pos, &end);
+    if (end == pos || quant < 0.0 || quant > 1.0 || (!quantVec.empty() && quant <= quantVec.back()))
+      return false;
+    quantVec.push_back(quant);
+    pos = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0')
+      return false;
+  }
+  return !quantVec.empty();
+}
+
+
+static bool OptParse(int argc, char *argv[], Options &opt) {
+  int ch;
+  while ((ch = getopt(argc, argv, "x:m:y:o:s:Ht:n:RN:i:l:f:p:b:k:cS:B:d:M:P:q:Q:h")) != -1) {
+    switch (ch) {
+    case 'x':
+      opt.design = optarg;
+      break;
+    case 'm':
+      opt.model = optarg;
+      break;
+    case 'y':
+      opt.response = optarg;
+      break;
+    case 'o':
+      opt.output = optarg;
+      break;
+    case 's':
+      opt.sep = strcmp(optarg, "\\t") == 0 ? '\t' : optarg[0];
+      break;
+    case 'H':
+      opt.header = false;
+      break;
+    case 't':
+      opt.nTree = atoi(optarg);
+      break;
+    case 'n':
+      opt.nSamp = atoi(optarg);
+      break;
+    case 'R':
+      opt.withRepl = false;
+      break;
+    case 'N':
+      opt.minNode = atoi(optarg);
+      break;
+    case 'i':
+      opt.minInfo = atof(optarg);
+      break;
+    case 'l':
+      opt.nLevel = atoi(optarg);
+      break;
+    case 'f':
+      opt.predFixed = atoi(optarg);
+      break;
+    case 'p':
+      opt.predProb = atof(optarg);
+      break;
+    case 'b':
+      opt.trainBlock = atoi(optarg);
+      break;
+    case 'k':
+      opt.rankMax = atoi(optarg);
+      break;
+    case 'c':
+      opt.ctg = true;
+      break;
+    case 'S':
+      opt.seeded = true;
+      opt.seed = strtoul(optarg, 0, 10);
+      break;
+    case 'B':
+      opt.blockBytes = atof(optarg);
+      break;
+    case 'd':
+      opt.spillDir = optarg;
+      break;
+    case 'M':
+      opt.spillMin = atof(optarg);
+      break;
+    case 'P':
+      opt.tracePath = optarg;
+      break;
+    case 'q':
+      if (!QuantParse(optarg, opt.quantVec)) {
+        fprintf(stderr, "arborist: quantiles must increase within [0,1]\n");
+        return false;
+      }
+      break;
+    case 'Q':
+      opt.qBin = atoi(optarg);
+      break;
+    default:
+      return false;
+    }
+  }
+  if (optind != argc) {
+    fprintf(stderr, "arborist: unexpected argument '%s'\n", argv[optind]);
+    return false;
+  }
+
+  return true;
+}
+
+
+/**
+   @brief Reads the design and, if named, removes its response column.
+
+   @param yNum outputs a numeric response.
+
+   @param yCode outputs a factor response, with levels in 'yLevel'.
+
+   @return frame, or null on error.
+ */
+static FrameLoad *DesignRead(const Options &opt, std::vector<double> &yNum, std::vector<int> &yCode, std::vector<std::string> &yLevel) {
+  if (opt.design.empty()) {
+    fprintf(stderr, "arborist: design file (-x) required\n");
+    return 0;
+  }
+  std::string diag;
+  auto start = std::chrono::steady_clock::now();
+  FrameLoad *frame = FrameLoad::Read(opt.design.c_str(), diag, opt.sep, opt.header);
+  if (frame == 0) {
+    fprintf(stderr, "arborist: %s: %s\n", opt.design.c_str(), diag.c_str());
+    return 0;
+  }
+  if (!opt.response.empty() && frame->Extract(opt.response, yNum, yCode, yLevel) < 0) {
+    fprintf(stderr, "arborist: %s: no column named '%s'\n", opt.design.c_str(), opt.response.c_str());
+    delete frame;
+    return 0;
+  }
+  if (frame->NPredNum() + frame->NPredFac() == 0) {
+    fprintf(stderr, "arborist: %s: no predictors\n", opt.design.c_str());
+    delete frame;
+    return 0;
+  }
+  fprintf(stderr, "read %u rows, %u numeric and %u factor predictors in %.3fs\n", frame->NRow(), frame->NPredNum(), frame->NPredFac(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+  return frame;
+}
+
+
+/**
+   @brief Recasts a numeric response as categorical, with levels named
+   by value.
+
+   @return void, with output reference parameters.
+ */
+static void NumToCtg(const std::vector<double> &yNum, std::vector<int> &yCode, std::vector<std::string> &yLevel) {
+  std::vector<double> value(yNum);
+  std::sort(value.begin(), value.end());
+  value.erase(std::unique(value.begin(), value.end()), value.end());
+  yCode = std::vector<int>(yNum.size());
+  for (size_t row = 0; row < yNum.size(); row++)
+    yCode[row] = std::lower_bound(value.begin(), value.end(), yNum[row]) - value.begin();
+  yLevel.clear();
+  char buf[32];
+  for (auto val : value) {
+    snprintf(buf, sizeof(buf), "%g", val);
+    yLevel.push_back(buf);
+  }
+}
+
+
+/**
+   @brief Output stream for predictions:  standard output unless a file
+   is named.
+ */
+static FILE *OutOpen(const Options &opt) {
+  if (opt.output.empty())
+    return stdout;
+  FILE *out = fopen(opt.output.c_str(), "w");
+  if (out == 0)
+    fprintf(stderr, "arborist: cannot write %s\n", opt.output.c_str());
+  return out;
+}
+
+
+static void OutClose(FILE *out) {
+  if (out != stdout)
+    fclose(out);
+  else
+    fflush(out);
+}
+
+
+/**
+   @brief Summarizes training time by phase and writes the trace, if
+   requested.
+
+   @return false iff a requested trace could not be written.
+ */
+static bool Profile(const Options &opt) {
+  std::vector<std::string> phaseName;
+  std::vector<double> phaseSec, levelSec, treeSec;
+  std::vector<size_t> levelPairs, levelVolume;
+  Train::ProfReport(phaseName, phaseSec, levelSec, treeSec, levelPairs, levelVolume);
+  if (phaseName.empty()) {
+    if (!opt.tracePath.empty())
+      fprintf(stderr, "arborist: no trace written, as profiling was not built in\n");
+    return true;
+  }
+  for (unsigned int phase = 0; phase < phaseName.size(); phase++)
+    fprintf(stderr, "  %-24s %.3fs\n", phaseName[phase].c_str(), phaseSec[phase]);
+  if (opt.tracePath.empty())
+    return true;
+
+  std::string trace;
+  Train::ProfTrace(trace);
+  FILE *file = fopen(opt.tracePath.c_str(), "w");
+  bool written = file != 0 && fwrite(trace.data(), 1, trace.size(), file) == trace.size();
+  if (file != 0 && fclose(file) != 0)
+    written = false;
+  if (!written)
+    fprintf(stderr, "arborist: cannot write %s\n", opt.tracePath.c_str());
+
+  return written;
+}
+
+
+static int Train(const Options &opt) {
+  if (opt.response.empty() || opt.model.empty()) {
+    fprintf(stderr, "arborist: train requires a response (-y) and a model file (-m)\n");
+    return 1;
+  }
+  std::vector<double> yNum;
+  std::vector<int> yCode;
+  std::vector<std::string> yLevel;
+  FrameLoad *frame = DesignRead(opt, yNum, yCode, yLevel);
+  if (frame == 0)
+    return 1;
+  bool isCtg = opt.ctg || !yCode.empty();
+  if (isCtg && yCode.empty())
+    NumToCtg(yNum, yCode, yLevel);
+
+  unsigned int nRow = frame->NRow();
+  unsigned int nPredNum = frame->NPredNum();
+  unsigned int nPredFac = frame->NPredFac();
+  unsigned int nPred = nPredNum + nPredFac;
+  unsigned int ctgWidth = yLevel.size();
+  if (isCtg && ctgWidth < 2) {
+    fprintf(stderr, "arborist: classification requires at least two response levels\n");
+    delete frame;
+    return 1;
+  }
+
+  // Defaults follow those of the R front end.
+  unsigned int nSamp = opt.nSamp > 0 ? opt.nSamp : (opt.withRepl ? nRow : (unsigned int) round((1.0 - exp(-1.0)) * nRow));
+  int minNode = opt.minNode >= 0 ? opt.minNode : (isCtg ? 2 : 5);
+  int trainBlock = opt.trainBlock >= 0 ? opt.trainBlock : (opt.blockBytes > 0.0 ? 0 : 1);
+  double predProbArg = opt.predProb >= 0.0 ? opt.predProb : 0.0;
+  int predFixed = opt.predFixed >= 0 ? opt.predFixed : (predProbArg != 0.0 || nPred >= 16 ? 0 : (isCtg ? (int) floor(sqrt(double(nPred))) : std::max(int(nPred / 3), 1)));
+  double predProb = opt.predProb >= 0.0 ? opt.predProb : (predFixed != 0 ? 0.0 : (isCtg ? ceil(sqrt(double(nPred))) / nPred : 0.4));
+  if (minNode < 1 || (unsigned int) minNode > nSamp || predFixed > int(nPred) || predProb > 1.0 || opt.nTree == 0) {
+    fprintf(stderr, "arborist: training parameters out of range\n");
+    delete frame;
+    return 1;
+  }
+  std::vector<double> predWeight(nPred, predProb == 0.0 ? 1.0 : predProb);
+  std::vector<double> sampleWeight(nRow, 1.0);
+  std::vector<double> regMono(nPred, 0.0);
+
+  unsigned int seed = opt.seeded ? opt.seed : std::random_device()();
+  CallBack::Seed(seed);
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<int> row(size_t(nRow) * nPred), rank(size_t(nRow) * nPred), invNum(size_t(nRow) * nPredNum);
+  if (nPredNum > 0)
+    RowRank::PreSortNum(&frame->BlockNum()[0], nPredNum, nRow, &row[0], &rank[0], &invNum[0], opt.rankMax);
+  if (nPredFac > 0)
+    RowRank::PreSortFac(&frame->BlockFac()[0], nPredNum, nPredFac, nRow, &row[0], &rank[0]);
+  auto sorted = std::chrono::steady_clock::now();
+
+  std::vector<int> facCard(frame->FacCard().begin(), frame->FacCard().end());
+  // Training reads, but does not write, the numeric block.
+  Train::Init(nPredNum > 0 ? const_cast<double *>(&frame->BlockNum()[0]) : 0, nPredFac > 0 ? &facCard[0] : 0, frame->CardMax(), nPredNum, nPredFac, nRow, opt.nTree, nSamp, &sampleWeight[0], opt.withRepl, trainBlock, minNode, opt.minInfo, opt.nLevel, isCtg ? ctgWidth : 0, predFixed, &predWeight[0], &regMono[0], opt.blockBytes, opt.spillDir.empty() ? 0 : opt.spillDir.c_str(), seed, opt.spillMin);
+
+  std::vector<unsigned int> origin(opt.nTree), facOrigin(opt.nTree), leafOrigin(opt.nTree), facSplit;
+  std::vector<double> predInfo(nPred);
+  std::vector<ForestNode> forestNode;
+  std::vector<LeafNode> leafNode;
+  std::vector<unsigned char> bagPack;
+  std::vector<std::string> predLevel;
+  for (auto &level : frame->Level())
+    predLevel.insert(predLevel.end(), level.begin(), level.end());
+
+  bool saved;
+  if (isCtg) {
+    std::vector<unsigned int> yCtg(yCode.begin(), yCode.end());
+    // Uniform class weights, jittered to break ties, as in the R bridge.
+    std::vector<double> jitter(nRow), proxy(nRow);
+    CallBack::RUnif(nRow, &jitter[0]);
+    double recipLen = 1.0 / nRow;
+    for (unsigned int rw = 0; rw < nRow; rw++)
+      proxy[rw] = 1.0 / ctgWidth + (jitter[rw] - 0.5) * 0.5 * (recipLen * recipLen);
+    std::vector<double> weight;
+    Train::Classification(&row[0], &rank[0], nPredNum > 0 ? &invNum[0] : 0, yCtg, ctgWidth, proxy, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, weight);
+    saved = ModelMap::SaveCtg(opt.model.c_str(), nPredNum, nPredFac, nRow, forestNode, origin, facOrigin, facSplit, leafOrigin, leafNode, bagPack, weight, frame->PredMap(), frame->FacCard(), predLevel, yLevel);
+  }
+  else {
+    std::vector<double> yRanked(yNum);
+    std::sort(yRanked.begin(), yRanked.end());
+    std::vector<unsigned int> row2Rank(nRow);
+    for (unsigned int rw = 0; rw < nRow; rw++)
+      row2Rank[rw] = std::lower_bound(yRanked.begin(), yRanked.end(), yNum[rw]) - yRanked.begin();
+    std::vector<unsigned int> leafRank;
+    Train::Regression(&row[0], &rank[0], nPredNum > 0 ? &invNum[0] : 0, yNum, row2Rank, origin, facOrigin, &predInfo[0], forestNode, facSplit, leafOrigin, leafNode, bagPack, leafRank);
+    saved = ModelMap::SaveReg(opt.model.c_str(), nPredNum, nPredFac, nRow, forestNode, origin, facOrigin, facSplit, leafOrigin, leafNode, bagPack, leafRank, yRanked, frame->PredMap(), frame->FacCard(), predLevel);
+  }
+  auto finish = std::chrono::steady_clock::now();
+
+  if (!saved) {
+    fprintf(stderr, "arborist: cannot write %s\n", opt.model.c_str());
+    delete frame;
+    return 1;
+  }
+  fprintf(stderr, "trained %u %s trees, %zu nodes, seed %u:  presort %.3fs, train %.3fs\n", opt.nTree, isCtg ? "classification" : "regression", forestNode.size(), seed, std::chrono::duration<double>(sorted - start).count(), std::chrono::duration<double>(finish - sorted).count());
+  size_t arenaAlloc, arenaChunk, arenaServed, arenaHighWater;
+  Train::ArenaReport(arenaAlloc, arenaChunk, arenaServed, arenaHighWater);
+  fprintf(stderr, "storage:  %u overflow segments, %u reallocations\n", Train::SegmentCount(), Train::ReallocCount());
+  fprintf(stderr, "arena:  %zu requests in %zu chunks, %zu bytes served, %zu bytes peak\n", arenaAlloc, arenaChunk, arenaServed, arenaHighWater);
+
+  // Reports the most informative predictors, by front-end name.
+  std::vector<unsigned int> order(nPred);
+  for (unsigned int predIdx = 0; predIdx < nPred; predIdx++)
+    order[predIdx] = predIdx;
+  std::sort(order.begin(), order.end(), [&predInfo](unsigned int a, unsigned int b) {
+      return predInfo[a] > predInfo[b];
+    });
+  for (unsigned int i = 0; i < std::min(nPred, 10u); i++)
+    fprintf(stderr, "  %-24s %.6g\n", frame->ColName()[frame->PredMap()[order[i]]].c_str(), predInfo[order[i]]);
+  delete frame;
+
+  return Profile(opt) ? 0 : 1;
+}
+
+
+/**
+   @brief Loads a model and a design conforming to it.
+
+   @return true iff both loaded and conforming.
+ */
+static bool ModelDesign(const Options &opt, ModelMap *&model, FrameLoad *&frame, std::vector<double> &yNum, std::vector<int> &yCode, std::vector<std::string> &yLevel) {
+  if (opt.model.empty()) {
+    fprintf(stderr, "arborist: model file (-m) required\n");
+    return false;
+  }
+  model = ModelMap::Load(opt.model.c_str());
+  if (model == 0) {
+    fprintf(stderr, "arborist: %s: unreadable or malformed model\n", opt.model.c_str());
+    return false;
+  }
+  frame = DesignRead(opt, yNum, yCode, yLevel);
+  if (frame == 0)
+    return false;
+
+  unsigned int nPred = model->NPredNum() + model->NPredFac();
+  if (frame->NPredNum() != model->NPredNum() || frame->NPredFac() != model->NPredFac() || !std::equal(frame->PredMap().begin(), frame->PredMap().end(), model->PredMap()) || frame->PredMap().size() != nPred) {
+    fprintf(stderr, "arborist: predictors do not conform to those of training%s\n", opt.response.empty() ? " (name any response column with -y)" : "");
+    return false;
+  }
+  if (model->NPredFac() > 0) {
+    size_t unseen = frame->Conform(model->Remap());
+    if (unseen > 0)
+      fprintf(stderr, "warning:  %zu rows have factor levels not observed in training\n", unseen);
+  }
+
+  return true;
+}
+
+
+/**
+   @brief Maps a test response onto the training categories, by name.
+
+   @return true iff all test categories were seen in training.
+ */
+static bool CtgConform(const ModelMap *model, const std::vector<double> &yNum, std::vector<int> &yCode, std::vector<std::string> &yLevel, std::vector<unsigned int> &yTest) {
+  if (yCode.empty())
+    NumToCtg(yNum, yCode, yLevel);
+  std::vector<std::string> ctgLevel;
+  model->CtgLevel(ctgLevel);
+  LevelIndex ctgIndex(ctgLevel);
+  std::vector<int> trans(yLevel.size());
+  for (unsigned int code = 0; code < yLevel.size(); code++) {
+    trans[code] = ctgIndex.Find(yLevel[code]);
+    if (trans[code] < 0) {
+      fprintf(stderr, "arborist: response level '%s' not observed in training\n", yLevel[code].c_str());
+      return false;
+    }
+  }
+  yTest = std::vector<unsigned int>(yCode.size());
+  for (size_t row = 0; row < yCode.size(); row++)
+    yTest[row] = trans[yCode[row]];
+  return true;
+}
+
+
+/**
+   @brief Reports regression scores.
+ */
+static void RegScore(const std::vector<double> &yNum, const std::vector<double> &yPred, const char *label) {
+  double sse = 0.0, mean = 0.0;
+  for (auto y : yNum)
+    mean += y / yNum.size();
+  double sst = 0.0;
+  for (size_t row = 0; row < yNum.size(); row++) {
+    sse += (yPred[row] - yNum[row]) * (yPred[row] - yNum[row]);
+    sst += (yNum[row] - mean) * (yNum[row] - mean);
+  }
+  fprintf(stderr, "%s mse %.6g rsq %.6f\n", label, sse / yNum.size(), sst > 0.0 ? 1.0 - sse / sst : 0.0);
+}
+
+
+/**
+   @brief Predicts from a saved model, reporting scores if the design
+   carries a response.
+
+   @param quantiles indicates whether to predict quantiles.
+
+   @param validate indicates whether to predict the training set out of
+   bag.
+
+   @return exit status.
+ */
+static int Predict(const Options &opt, bool quantiles, bool validate) {
+  if (validate && opt.response.empty()) {
+    fprintf(stderr, "arborist: validate requires a response (-y)\n");
+    return 1;
+  }
+  ModelMap *model = 0;
+  FrameLoad *frame = 0;
+  std::vector<double> yNum;
+  std::vector<int> yCode;
+  std::vector<std::string> yLevel;
+  int status = 1;
+  if (!ModelDesign(opt, model, frame, yNum, yCode, yLevel)) {
+    delete frame;
+    delete model;
+    return status;
+  }
+
+  unsigned int nRow = frame->NRow();
+  unsigned int bagTrain = 0;
+  if (validate) {
+    if (nRow != model->NRowTrain()) {
+      fprintf(stderr, "arborist: validation requires the %u training rows\n", model->NRowTrain());
+      delete frame;
+      delete model;
+      return status;
+    }
+    bagTrain = nRow;
+  }
+  if (quantiles && !model->IsRegression()) {
+    fprintf(stderr, "arborist: quantiles supported for regression only\n");
+    delete frame;
+    delete model;
+    return status;
+  }
+
+  std::vector<double> numT;
+  std::vector<int> facT;
+  frame->Transpose(numT, facT);
+  double *blockNumT = numT.empty() ? 0 : &numT[0];
+  int *blockFacT = facT.empty() ? 0 : &facT[0];
+  const char *label = validate ? "out-of-bag" : "test";
+  FILE *out = 0;
+  auto start = std::chrono::steady_clock::now();
+  if (model->IsRegression()) {
+    if (!yCode.empty()) {
+      fprintf(stderr, "arborist: factor response for regression model\n");
+    }
+    else {
+      std::vector<double> yPred(nRow);
+      std::vector<double> qPred;
+      if (quantiles) {
+        qPred = std::vector<double>(size_t(nRow) * opt.quantVec.size());
+        Predict::Quantiles(model, blockNumT, blockFacT, yPred, opt.quantVec, opt.qBin, qPred, bagTrain);
+      }
+      else {
+        Predict::Regression(model, blockNumT, blockFacT, yPred, bagTrain);
+      }
+      fprintf(stderr, "predicted %u rows in %.3fs\n", nRow, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+      if (!yNum.empty())
+        RegScore(yNum, yPred, label);
+
+      out = OutOpen(opt);
+      if (out != 0) {
+        unsigned int nQuant = quantiles ? opt.quantVec.size() : 0;
+        for (unsigned int row = 0; row < nRow; row++) {
+          fprintf(out, "%.10g", yPred[row]);
+          for (unsigned int q = 0; q < nQuant; q++)
+            fprintf(out, ",%.10g", qPred[size_t(row) * nQuant + q]);
+          fputc('\n', out);
+        }
+        OutClose(out);
+        status = 0;
+      }
+    }
+  }
+  else {
+    std::vector<unsigned int> yTest;
+    bool scored = !opt.response.empty();
+    if (!scored || CtgConform(model, yNum, yCode, yLevel, yTest)) {
+      unsigned int ctgWidth = model->CtgWidth();
+      std::vector<int> yPred(nRow), census(size_t(nRow) * ctgWidth), conf(ctgWidth * ctgWidth);
+      std::vector<double> error(ctgWidth);
+      Predict::Classification(model, blockNumT, blockFacT, yPred, &census[0], yTest, &conf[0], error, 0, bagTrain);
+      fprintf(stderr, "predicted %u rows in %.3fs\n", nRow, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+      std::vector<std::string> ctgLevel;
+      model->CtgLevel(ctgLevel);
+      if (scored) {
+        unsigned int wrong = 0;
+        for (unsigned int row = 0; row < nRow; row++)
+          wrong += yPred[row] != int(yTest[row]);
+        fprintf(stderr, "%s misprediction %.6f\n", label, double(wrong) / nRow);
+        for (unsigned int ctg = 0; ctg < ctgWidth; ctg++)
+          fprintf(stderr, "  %-24s error %.6f\n", ctgLevel[ctg].c_str(), error[ctg]);
+      }
+
+      out = OutOpen(opt);
+      if (out != 0) {
+        for (unsigned int row = 0; row < nRow; row++)
+          fprintf(out, "%s\n", ctgLevel[yPred[row]].c_str());
+        OutClose(out);
+        status = 0;
+      }
+    }
+  }
+  delete frame;
+  delete model;
+
+  return status;
+}
+
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "help") == 0) {
+    Usage();
+    return argc < 2 ? 1 : 0;
+  }
+  std::string command = argv[1];
+  Options opt;
+  if (!OptParse(argc - 1, argv + 1, opt)) {
+    Usage();
+    return 1;
+  }
+
+  if (command == "train")
+    return Train(opt);
+  else if (command == "predict")
+    return Predict(opt, false, false);
+  else if (command == "quantiles")
+    return Predict(opt, true, false);
+  else if (command == "validate")
+    return Predict(opt, false, true);
+
+  fprintf(stderr, "arborist: unrecognized command '%s'\n", command.c_str());
+  Usage();
+  return 1;
+}
@@ -0,0 +1,175 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file arena.cc
+
+   @brief Methods for the per-tree bump allocator.
+
+   @author Mark Seligman
+ */
+
+#include "arena.h"
+
+size_t Arena::allocTot = 0;
+size_t Arena::chunkTot = 0;
+size_t Arena::servedTot = 0;
+size_t Arena::highWaterMax = 0;
+
+
+/**
+   @brief Zeroes the tallies ahead of training.
+
+   @return void.
+ */
+void Arena::Immutables() {
+  allocTot = chunkTot = servedTot = highWaterMax = 0;
+}
+
+
+void Arena::DeImmutables() {
+  allocTot = chunkTot = servedTot = highWaterMax = 0;
+}
+
+
+/**
+   @brief Reports the tallies of all instances retired since training
+   began.
+
+   @return void, with output reference parameters.
+ */
+void Arena::Totals(size_t &_allocTot, size_t &_chunkTot, size_t &_servedTot, size_t &_highWaterMax) {
+  _allocTot = allocTot;
+  _chunkTot = chunkTot;
+  _servedTot = servedTot;
+  _highWaterMax = highWaterMax;
+}
+
+
+/**
+   @brief Constructor.  Chunks are allocated on demand.
+ */
+Arena::Arena() : chunkIdx(0), offset(0), inUse(0), highWater(0), allocCount(0), chunkCount(0), bytesServed(0) {
+}
+
+
+/**
+   @brief Destructor.  Folds the instance's counters into the tallies.
+ */
+Arena::~Arena() {
+  for (auto base : chunk)
+    delete [] base;
+
+#pragma omp critical(arenaTally)
+  {
+    allocTot += allocCount;
+    chunkTot += chunkCount;
+    servedTot += bytesServed;
+    if (highWater > highWaterMax)
+      highWaterMax = highWater;
+  }
+}
+
+
+/**
+   @brief Records the current bump position.
+
+   @return mark for subsequent release.
+ */
+ArenaMark Arena::Mark() const {
+  ArenaMark mark;
+  mark.chunkIdx = chunkIdx;
+  mark.offset = offset;
+
+  return mark;
+}
+
+
+/**
+   @brief Releases all storage drawn since the mark.  Releasing to the
+   origin coalesces chunks, if several were needed.
+
+   @param mark is a position previously returned by Mark().
+
+   @return void.
+ */
+void Arena::Release(const ArenaMark &mark) {
+  if (mark.chunkIdx == 0 && mark.offset == 0) {
+    if (chunk.size() > 1)
+      Coalesce();
+    inUse = 0;
+  }
+  else {
+    // Bytes beyond the mark are tallied only loosely, as chunk tails
+    // may have been skipped.
+    size_t drawn = 0;
+    for (unsigned int idx = mark.chunkIdx; idx < chunkIdx; idx++)
+      drawn += chunkSize[idx];
+    drawn += offset;
+    drawn -= mark.offset;
+    inUse = drawn > inUse ? 0 : inUse - drawn;
+  }
+  chunkIdx = mark.chunkIdx;
+  offset = mark.offset;
+}
+
+
+/**
+   @brief Replaces all chunks with a single one large enough to hold the
+   high-water mark.  Only called when the arena is empty.
+
+   @return void.
+ */
+void Arena::Coalesce() {
+  size_t total = 0;
+  for (unsigned int idx = 0; idx < chunk.size(); idx++) {
+    total += chunkSize[idx];
+    delete [] chunk[idx];
+  }
+  chunk.clear();
+  chunkSize.clear();
+
+  chunk.push_back(new unsigned char[total]);
+  chunkSize.push_back(total);
+  chunkCount++;
+}
+
+
+/**
+   @brief Advances the bump position, appending a chunk if none
+   remaining is large enough.
+
+   @param bytes is the size requested.
+
+   @return aligned base of requested storage.
+ */
+void *Arena::Bump(size_t bytes) {
+  size_t aligned = (bytes + align - 1) & ~(align - 1);
+  allocCount++;
+  bytesServed += bytes;
+
+  while (chunkIdx < chunk.size() && offset + aligned > chunkSize[chunkIdx]) {
+    chunkIdx++;
+    offset = 0;
+  }
+  if (chunkIdx == chunk.size()) {
+    size_t size = chunk.empty() ? chunkMin : 2 * chunkSize.back();
+    if (size < aligned)
+      size = aligned;
+    chunk.push_back(new unsigned char[size]);
+    chunkSize.push_back(size);
+    chunkCount++;
+  }
+
+  void *base = chunk[chunkIdx] + offset;
+  offset += aligned;
+  inUse += aligned;
+  if (inUse > highWater)
+    highWater = inUse;
+
+  return base;
+}
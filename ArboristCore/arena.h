@@ -0,0 +1,125 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file arena.h
+
+   @brief Bump allocator for per-tree training scratch.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_ARENA_H
+#define ARBORIST_ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+
+/**
+   @brief Position within the arena, for stack-like release.
+ */
+class ArenaMark {
+ public:
+  unsigned int chunkIdx;
+  size_t offset;
+};
+
+
+/**
+   @brief Chunked bump allocator.  Each tree under training owns an
+   instance, as does each of its depth-first subtrees, from which its
+   per-level consumers draw.  The instance is marked as a level begins
+   and released back to the mark as it ends.  Storage is retained
+   across the tree's levels, coalescing into a single chunk once the
+   high-water mark is known.  As no instance is shared, allocation does
+   not contend, even as subtrees train in parallel.
+
+   Only trivially-destructible types are served, as destructors are not
+   run on release.
+ */
+class Arena {
+  // Tallies over all instances retired since Immutables():
+  static size_t allocTot;
+  static size_t chunkTot;
+  static size_t servedTot;
+  static size_t highWaterMax; // Greatest per-instance high water.
+
+  static constexpr size_t align = alignof(std::max_align_t);
+  static constexpr size_t chunkMin = 1 << 16;
+
+  std::vector<unsigned char *> chunk;
+  std::vector<size_t> chunkSize;
+  unsigned int chunkIdx; // Chunk currently bumped.
+  size_t offset; // Bump position within current chunk.
+  size_t inUse; // Bytes currently drawn.
+  size_t highWater; // Greatest 'inUse' seen.
+
+  // Counters:
+  size_t allocCount; // Requests served.
+  size_t chunkCount; // System allocations.
+  size_t bytesServed; // Total bytes requested.
+
+  void *Bump(size_t bytes);
+  void Coalesce();
+
+ public:
+  Arena();
+  ~Arena();
+
+  static void Immutables();
+  static void DeImmutables();
+  static void Totals(size_t &_allocTot, size_t &_chunkTot, size_t &_servedTot, size_t &_highWaterMax);
+
+
+  /**
+     @brief Draws a default-initialized vector from the arena.
+
+     @param count is the number of elements.
+
+     @return vector base, valid until release past the current mark.
+   */
+  template<typename T> T *Alloc(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "Arena types must be trivially destructible");
+    T *vec = static_cast<T *>(Bump(count * sizeof(T)));
+    for (size_t i = 0; i < count; i++) {
+      new (vec + i) T;
+    }
+    return vec;
+  }
+
+  ArenaMark Mark() const;
+  void Release(const ArenaMark &mark);
+
+
+  /**
+     @brief Counter accessors.
+   */
+  inline size_t AllocCount() const {
+    return allocCount;
+  }
+
+
+  inline size_t ChunkCount() const {
+    return chunkCount;
+  }
+
+
+  inline size_t BytesServed() const {
+    return bytesServed;
+  }
+
+
+  inline size_t HighWater() const {
+    return highWater;
+  }
+};
+
+#endif
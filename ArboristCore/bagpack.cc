@@ -0,0 +1,64 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file bagpack.cc
+
+   @brief Methods for encoding bagged rows and sample ranks.
+
+   @author Mark Seligman
+ */
+
+#include "bagpack.h"
+
+
+/**
+   @brief Packs a tree's ranks into zero-initialized words.
+
+   @param rank are the ranks to pack, in leaf order.
+
+   @param count is the number of ranks.
+
+   @param width is the packing width.
+
+   @param out outputs the packed words, beginning on a word boundary.
+
+   @return void, with output vector.
+ */
+void BagPack::RankPack(const unsigned int rank[], unsigned int count, unsigned int width, unsigned int out[]) {
+  size_t bitOff = 0;
+  for (unsigned int i = 0; i < count; i++, bitOff += width) {
+    size_t slot = bitOff / slotBits;
+    unsigned int shift = bitOff - slot * slotBits;
+    uint64_t window = uint64_t(rank[i]) << shift;
+    out[slot] |= (unsigned int) window;
+    if (shift + width > slotBits)
+      out[slot + 1] |= (unsigned int) (window >> slotBits);
+  }
+}
+
+
+/**
+   @brief Estimates the encoded size of a bag, absent the rows
+   themselves.  Rows are assumed uniformly spread over leaves of
+   average extent and singly sampled.
+
+   @param nRow is the number of training rows.
+
+   @param leafCount is the number of leaves.
+
+   @param bagCount is the number of bagged samples.
+
+   @return estimated size, in bytes.
+ */
+size_t BagPack::BytesEst(unsigned int nRow, unsigned int leafCount, unsigned int bagCount) {
+  if (bagCount == 0)
+    return 0;
+
+  uint64_t gapMean = (uint64_t(nRow) * leafCount) / bagCount;
+  return size_t(bagCount) * VarLen(gapMean << countBits);
+}
@@ -0,0 +1,253 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file bagpack.h
+
+   @brief Compressed encoding of bagged rows and sample ranks.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_BAGPACK_H
+#define ARBORIST_BAGPACK_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+   @brief Codec for the leaf-membership format.
+
+   Bagged rows are recorded leaf by leaf, in increasing row order
+   within each leaf.  A sample is encoded as a single token:  its
+   distance from the preceding row of the same leaf, or from row zero
+   for the leaf's first, shifted left to admit the sample count less
+   one in the low bits.  Counts too large for the low bits saturate
+   them and are completed by a second token holding the excess.
+   Tokens are written as little-endian base-128 varints, so that the
+   common case of a singly-sampled row in a populous leaf occupies a
+   byte or two.
+
+   Regression ranks are packed at a fixed width sufficient for the
+   largest rank.  The width occupies the vector's leading word and each
+   tree begins on a word boundary, so that ranks are addressable
+   given the tree's word origin.
+ */
+class BagPack {
+  static constexpr unsigned int countBits = 2; // Low token bits for count.
+  static constexpr unsigned int countMask = (1 << countBits) - 1;
+  static constexpr unsigned int slotBits = 8 * sizeof(unsigned int);
+
+  /**
+     @brief Counts the bytes needed to encode a value.
+
+     @param val is the value to encode.
+
+     @return encoded length, in bytes.
+   */
+  static inline unsigned int VarLen(uint64_t val) {
+    unsigned int len = 1;
+    while (val >= 0x80) {
+      val >>= 7;
+      len++;
+    }
+    return len;
+  }
+
+
+  /**
+     @brief Writes a value as a varint.
+
+     @param out is the output position.
+
+     @param val is the value to write.
+
+     @return position following the written value.
+   */
+  static inline unsigned char *VarPut(unsigned char *out, uint64_t val) {
+    while (val >= 0x80) {
+      *out++ = (unsigned char) (val | 0x80);
+      val >>= 7;
+    }
+    *out++ = (unsigned char) val;
+    return out;
+  }
+
+
+  /**
+     @brief Reads a varint, advancing the input position.
+
+     @param in is the input position, updated.
+
+     @return decoded value.
+   */
+  static inline uint64_t VarGet(const unsigned char *&in) {
+    uint64_t val = *in & 0x7f;
+    unsigned int shift = 7;
+    while (*in++ & 0x80) {
+      val |= uint64_t(*in & 0x7f) << shift;
+      shift += 7;
+    }
+    return val;
+  }
+
+
+ public:
+  /**
+     @brief Sizes the encoding of a single sample.
+
+     @param delta is the distance from the preceding row in the leaf.
+
+     @param sCount is the sample count, strictly positive.
+
+     @return encoded length, in bytes.
+   */
+  static inline unsigned int TokenLen(unsigned int delta, unsigned int sCount) {
+    unsigned int excess = sCount - 1;
+    unsigned int low = excess < countMask ? excess : countMask;
+    unsigned int len = VarLen((uint64_t(delta) << countBits) | low);
+    return excess < countMask ? len : len + VarLen(excess - countMask);
+  }
+
+
+  /**
+     @brief Encodes a single sample.
+
+     @param out is the output position.
+
+     @param delta is the distance from the preceding row in the leaf.
+
+     @param sCount is the sample count, strictly positive.
+
+     @return position following the encoded sample.
+   */
+  static inline unsigned char *TokenPut(unsigned char *out, unsigned int delta, unsigned int sCount) {
+    unsigned int excess = sCount - 1;
+    unsigned int low = excess < countMask ? excess : countMask;
+    out = VarPut(out, (uint64_t(delta) << countBits) | low);
+    return excess < countMask ? out : VarPut(out, excess - countMask);
+  }
+
+
+  /**
+     @brief Decodes the samples of a single leaf.
+
+     @param in is the position of the leaf's first sample, advanced
+     past its last.
+
+     @param extent is the number of samples in the leaf.
+
+     @param row outputs the bagged rows, if nonnull.
+
+     @param sCount outputs the sample counts, if nonnull.
+
+     @return sum of sample counts over the leaf.
+   */
+  static inline unsigned int LeafDecode(const unsigned char *&in, unsigned int extent, unsigned int row[], unsigned int sCount[]) {
+    unsigned int rowAccum = 0;
+    unsigned int sCountTot = 0;
+    for (unsigned int i = 0; i < extent; i++) {
+      uint64_t token = VarGet(in);
+      unsigned int excess = token & countMask;
+      if (excess == countMask)
+        excess += VarGet(in);
+      rowAccum += token >> countBits;
+      if (row != 0)
+        row[i] = rowAccum;
+      if (sCount != 0)
+        sCount[i] = excess + 1;
+      sCountTot += excess + 1;
+    }
+    return sCountTot;
+  }
+
+
+  /**
+     @brief Advances past the samples of a single leaf.
+
+     @param in is the position of the leaf's first sample, advanced
+     past its last.
+
+     @param extent is the number of samples in the leaf.
+
+     @return void, with updated input position.
+   */
+  static inline void LeafSkip(const unsigned char *&in, unsigned int extent) {
+    for (unsigned int i = 0; i < extent; i++) {
+      if ((VarGet(in) & countMask) == countMask)
+        (void) VarGet(in);
+    }
+  }
+
+
+  /**
+     @brief Computes the packing width for ranks.
+
+     @param rankMax is the largest rank to be packed.
+
+     @return number of bits per rank.
+   */
+  static inline unsigned int RankWidth(unsigned int rankMax) {
+    unsigned int width = 1;
+    while (width < slotBits && (rankMax >> width) != 0)
+      width++;
+    return width;
+  }
+
+
+  /**
+     @brief Sizes a tree's packed ranks.
+
+     @param count is the number of ranks in the tree.
+
+     @param width is the packing width.
+
+     @return number of words occupied.
+   */
+  static inline size_t RankWords(unsigned int count, unsigned int width) {
+    return (size_t(count) * width + slotBits - 1) / slotBits;
+  }
+
+
+  /**
+     @brief Unpacks a contiguous run of ranks.
+
+     @param in is the packed vector, including leading word.
+
+     @param bitOff is the position of the first rank, in bits beyond
+     the leading word.
+
+     @param width is the packing width.
+
+     @param count is the number of ranks to unpack.
+
+     @param rank outputs the unpacked ranks.
+
+     @return void, with output vector.
+   */
+  static inline void RankUnpack(const unsigned int in[], size_t bitOff, unsigned int width, unsigned int count, unsigned int rank[]) {
+    const unsigned int *word = in + 1;
+    uint64_t mask = (uint64_t(1) << width) - 1;
+    for (unsigned int i = 0; i < count; i++, bitOff += width) {
+      size_t slot = bitOff / slotBits;
+      unsigned int shift = bitOff - slot * slotBits;
+      uint64_t window = word[slot];
+      if (shift + width > slotBits)
+        window |= uint64_t(word[slot + 1]) << slotBits;
+      rank[i] = (window >> shift) & mask;
+    }
+  }
+
+
+  static void RankPack(const unsigned int rank[], unsigned int count, unsigned int width, unsigned int out[]);
+  static size_t BytesEst(unsigned int nRow, unsigned int leafCount, unsigned int bagCount);
+};
+
+#endif
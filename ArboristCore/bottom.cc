@@ -22,6 +22,10 @@
 #include "splitsig.h"
 #include "predblock.h"
 #include "runset.h"
+#include "memtrack.h"
+#include "proftrack.h"
+
+#include <algorithm>
 
 // Testing only:
 //#include <iostream>
@@ -45,21 +49,49 @@ Bottom *Bottom::FactoryCtg(SamplePred *_samplePred, SampleNode *_sampleCtg, unsi
 }
 
 
+/**
+   @brief Creates a Bottom of like response type over a compact copy of
+   a subset of this Bottom's samples.  As spawned Bottoms train
+   concurrently with one another, their level passes run serially.
+
+   @param _samplePred is the compact copy.
+
+   @param _bagCount is the count of samples in the copy.
+
+   @param sIdxMap maps compact sample indices to those of this Bottom.
+
+   @return new Bottom, for which caller assumes ownership.
+ */
+Bottom *Bottom::Spawn(SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const {
+  return new Bottom(_samplePred, splitPred->Spawn(_samplePred, _bagCount, sIdxMap), _bagCount, nPred, nPredFac, true);
+}
+
+
 /**
    @brief Class constructor.
 
    @param bagCount enables sizing of predicate bit vectors.
 
    @param splitCount specifies the number of splits to map.
+
+   @param _serial is true iff level passes are to open no parallel regions.
  */
-Bottom::Bottom(SamplePred *_samplePred, SplitPred *_splitPred, unsigned int bagCount, unsigned int _nPred, unsigned int _nPredFac) : samplePath(new SamplePath[bagCount]), nPred(_nPred), nPredFac(_nPredFac), ancTot(0), levelCount(1), samplePred(_samplePred), splitPred(_splitPred), splitSig(new SplitSig()) {
+Bottom::Bottom(SamplePred *_samplePred, SplitPred *_splitPred, unsigned int bagCount, unsigned int _nPred, unsigned int _nPredFac, bool _serial) : samplePath(new SamplePath[bagCount]), nPred(_nPred), nPredFac(_nPredFac), serial(_serial), ancTot(0), levelCount(1), samplePred(_samplePred), splitPred(_splitPred), splitSig(new SplitSig()), arena(0) {
+  // Predictors with no samples staged explicitly lie entirely within
+  // their implicit runs, so are singletons from the outset.
   bottomNode.reserve(nPred);
+  std::vector<unsigned int> explZero(nPred);
   for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
     bottomNode[predIdx].Init(PBTrain::FacCard(predIdx));
+    explZero[predIdx] = samplePred->StageCount(predIdx);
+    if (explZero[predIdx] == 0)
+      bottomNode[predIdx].RunCount(1);
   }
+  explLevel.push_front(explZero);
 
   // 'nPred'-many source bits for level zero initialized to zero.
   bufferLevel.push_front(new BitMatrix(1, nPred));
+  MemTrack::Charge(MemTrack::bottom, bufferLevel.front()->Bytes());
 
   // 'bagCount'-many indices in staged predictors.
   std::vector<MRRA> mrraZero;
@@ -75,10 +107,12 @@ Bottom::Bottom(SamplePred *_samplePred, SplitPred *_splitPred, unsigned int bagC
  */
 Bottom::~Bottom() {
   for (BitMatrix *bitLevel : bufferLevel) {
+    MemTrack::Release(MemTrack::bottom, bitLevel->Bytes());
     delete bitLevel;
   }
   bufferLevel.clear();
   mrraLevel.clear();
+  explLevel.clear();
 
   delete [] samplePath;
   delete splitPred;
@@ -98,18 +132,23 @@ Run *Bottom::Runs() {
  */
 const std::vector<class SSNode*> Bottom::LevelSplit(class Index *index, class IndexNode indexNode[]) {
   Run *run;
+  ProfTrack::Begin(ProfTrack::levelInit);
   bool *splitFlags = splitPred->LevelInit(index, indexNode, this, levelCount, run);
+  ProfTrack::End(levelCount);
   Level(run, splitFlags, indexNode);
+  ProfTrack::Begin(ProfTrack::argMax);
   std::vector<SSNode*> ssNode(levelCount);
   for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++) {
     ssNode[levelIdx] = splitSig->ArgMax(levelIdx, indexNode[levelIdx].MinInfo());
   }
+  ProfTrack::End(levelCount);
 
   return ssNode;
 }
 
 
 void Bottom::Level(Run *run, const bool splitFlags[], const IndexNode indexNode[]) {
+  ProfTrack::Begin(ProfTrack::restage);
   std::vector<SplitPair> pairNode;
   pairNode.reserve(levelCount * nPred); // Very high limit.
 
@@ -119,6 +158,7 @@ void Bottom::Level(Run *run, const bool splitFlags[], const IndexNode indexNode[
   restageNode.reserve(ancTot); // Safe upper limit.
   std::vector<RestagePair> restagePair;
   unsigned int targTot = PairInit(run, splitFlags, pairNode, restageNode, restagePair);
+  size_t restageBytes = 0;
   
    // None of the restaging work need be done at level zero.
   if (ancTot > 0) {
@@ -128,10 +168,16 @@ void Bottom::Level(Run *run, const bool splitFlags[], const IndexNode indexNode[
     std::fill(pathNode.begin(), pathNode.end(), node);
 
     BV *restageSource = RestageInit(indexNode, pairNode, restageNode, pathNode);
-    Restage(restageNode, restagePair, pathNode, restageSource);
+    restageBytes = Restage(restageNode, restagePair, pathNode, restageSource);
     delete restageSource;
+
+    // Restaging has read counts from the oldest level, if any.
+    if (explLevel.size() > BottomNode::pathMax) {
+      explLevel.pop_front();
+    }
   }
   ancTot += levelCount; // All nodes at this level are potential ancestors.
+  ProfTrack::End(restagePair.size(), restageBytes);
 
   Split(pairNode, indexNode);
 }
@@ -211,7 +257,7 @@ unsigned int Bottom::PairInit(Run *run, const bool splitFlags[], std::vector<Spl
   }
   delete ancReach;
 
-  run->RunSets(safeCount);
+  run->RunSets(arena, safeCount);
 
   // Every restageable target now references a dense index into the set of MRRAs
   // visible from the current level.
@@ -222,6 +268,42 @@ unsigned int Bottom::PairInit(Run *run, const bool splitFlags[], std::vector<Spl
 }
 
 
+/**
+   @brief Locates the buffer cell holding a pair's samples, once the
+   current level has restaged.  The cell is that of the pair's MRRA, so
+   may hold samples of other nodes as well.
+
+   @param levelIdx is the level-relative node index.
+
+   @param predIdx is the predictor index.
+
+   @param start outputs the starting index of the cell.
+
+   @param extent outputs the count of explicit indices in the cell.
+
+   @param bufBit outputs the buffer (0/1) holding the cell.
+
+   @return false iff the pair is a singleton, whose cell may no longer be
+   reachable.
+ */
+bool Bottom::StagedCell(unsigned int levelIdx, unsigned int predIdx, unsigned int &start, unsigned int &extent, unsigned int &bufBit) const {
+  const BottomNode &botNode = bottomNode[PairOffset(levelIdx, predIdx)];
+  if (botNode.RunCount() == 1)
+    return false;
+
+  // Restaging at this level has appended its own entries.
+  unsigned int levelDel;
+  unsigned int mrraIdx = botNode.Mrra(levelDel);
+  const std::vector<MRRA> &mrraVec = *(end(mrraLevel) - 1 - levelDel);
+  unsigned int mrraExtent;
+  mrraVec[mrraIdx].Coords(start, mrraExtent);
+  extent = (*(end(explLevel) - 1 - levelDel))[PairOffset(mrraIdx, predIdx)];
+  bufBit = (*(end(bufferLevel) - 1 - levelDel))->TestBit(mrraIdx, predIdx) ? 1 : 0;
+
+  return true;
+}
+
+
 /**
    @brief Reports source buffer.
  */
@@ -247,24 +329,28 @@ unsigned int Bottom::PathAccum(std::vector<RestageNode> &restageNode, unsigned i
   unsigned int mrraIdx = MrraIdx(bottomIdx, levelIdx, levelDel);
 
   std::vector<MRRA> &mrraVec = *(end(mrraLevel) - levelDel);
-  return mrraVec[mrraIdx].PathAccum(levelDel, pathAccum, restageNode);
+  const std::vector<unsigned int> &explVec = *(end(explLevel) - levelDel);
+  return mrraVec[mrraIdx].PathAccum(levelDel, &explVec[PairOffset(mrraIdx, 0)], pathAccum, restageNode);
 }
 
 
 /**
    @brief Assigns and updates dense index and target path offset.
 
+   @param explCount are the explicit index counts of the MRRA's cells,
+   by predictor.
+
    @param pathZero is a starting index into a vector of target positions.
 
    @param _restageIdx accumulates the high water mark for dense indexing.
 
    @return restageIndex.
 */
-unsigned int MRRA::PathAccum(unsigned int levelDel, unsigned int &pathAccum, std::vector<RestageNode> &restageNode) {
+unsigned int MRRA::PathAccum(unsigned int levelDel, const unsigned int explCount[], unsigned int &pathAccum, std::vector<RestageNode> &restageNode) {
   if (restageIdx < 0) { // First encounter:  caches state and starting index.
     RestageNode rsNode;
     restageIdx = restageNode.size();
-    rsNode.Init(start, extent, levelDel, pathAccum);
+    rsNode.Init(start, explCount, levelDel, pathAccum);
     restageNode.push_back(rsNode);
     pathAccum += (1 << levelDel); // 2^del potential reaching paths.
   }
@@ -324,7 +410,7 @@ BV *Bottom::RestageInit(const IndexNode indexNode[], const std::vector<SplitPair
     // Source buffer looked up by node position at MRRA's level:
     unsigned int levelDel;
     unsigned int mrraIdx = MrraIdx(bottomIdx, levelIdx, levelDel, true);
-    pathNode[pathZero + (path & ~(0xff << levelDel))].Init(levelIdx, start);
+    pathNode[pathZero + (path & ~(0xff << levelDel))].Init(levelIdx, start, extent);
     BitMatrix *bufMRRA = *(end(bufferLevel) - levelDel);
     bool sourceBit = bufMRRA->TestBit(mrraIdx, predIdx);
 
@@ -343,10 +429,13 @@ BV *Bottom::RestageInit(const IndexNode indexNode[], const std::vector<SplitPair
   }
 
   bufferLevel.push_back(restageTarg);
+  MemTrack::Charge(MemTrack::bottom, restageTarg->Bytes());
   mrraLevel.push_back(mrraTarg);
+  explLevel.push_back(std::vector<unsigned int>(levelCount * nPred));
 
   // Deletes information beyond the reach of future levels.
   if (bufferLevel.size() > BottomNode::pathMax) {
+    MemTrack::Release(MemTrack::bottom, bufferLevel.front()->Bytes());
     delete *(begin(bufferLevel));
     bufferLevel.erase(bufferLevel.begin());
   }
@@ -369,29 +458,110 @@ BV *Bottom::RestageInit(const IndexNode indexNode[], const std::vector<SplitPair
 /**
    @brief Restages predictors and splits as pairs with equal priority.
 
+   Pairs are dispatched in order of decreasing restaging cost, so that
+   the widest MRRAs begin first and small pairs fill in behind them.
 
-   @return void, with side-effected restaging buffers.
+   @return count of bytes restaged, with side-effected restaging buffers.
  */
-void Bottom::Restage(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, const std::vector<PathNode> &pathNode, const BV *restageSource) {
-  int pairIdx, nodeIdx, predIdx;
+size_t Bottom::Restage(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, const std::vector<PathNode> &pathNode, const BV *restageSource) {
+  std::vector<unsigned int> schedule;
+  size_t restageBytes = RestageSchedule(restageNode, restagePair, schedule);
+  int schedIdx, nodeIdx, predIdx;
+  if (serial) {
+    for (schedIdx = 0; schedIdx < int(schedule.size()); schedIdx++) {
+      restagePair[schedule[schedIdx]].Coords(nodeIdx, predIdx);
+      restageNode[nodeIdx].Restage(this, samplePred, pathNode, predIdx, restageSource->TestBit(PairOffset(nodeIdx, predIdx)) ? 1 : 0);
+    }
+    return restageBytes;
+  }
 
-#pragma omp parallel default(shared) private(pairIdx, nodeIdx, predIdx)
+#pragma omp parallel default(shared) private(schedIdx, nodeIdx, predIdx)
   {
 #pragma omp for schedule(dynamic, 1)
-    for (pairIdx = 0; pairIdx < int(restagePair.size()); pairIdx++) {
-      restagePair[pairIdx].Coords(nodeIdx, predIdx);
+    for (schedIdx = 0; schedIdx < int(schedule.size()); schedIdx++) {
+      restagePair[schedule[schedIdx]].Coords(nodeIdx, predIdx);
       restageNode[nodeIdx].Restage(this, samplePred, pathNode, predIdx, restageSource->TestBit(PairOffset(nodeIdx, predIdx)) ? 1 : 0);
     }
   }
+
+  return restageBytes;
 }
 
 
 /**
-   @brief General, multi-level restaging.
+   @brief Orders restaging pairs by decreasing cost, estimated as the
+   explicit extent of the restaged MRRA.
+
+   @param schedule outputs the pair indices in dispatch order.
+
+   @return count of bytes to restage, with output vector.
+ */
+size_t Bottom::RestageSchedule(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, std::vector<unsigned int> &schedule) const {
+  std::vector<std::pair<unsigned int, unsigned int> > costIdx;
+  costIdx.reserve(restagePair.size());
+  size_t restageBytes = 0;
+  for (unsigned int pairIdx = 0; pairIdx < restagePair.size(); pairIdx++) {
+    int nodeIdx, predIdx;
+    restagePair[pairIdx].Coords(nodeIdx, predIdx);
+    unsigned int extent = restageNode[nodeIdx].Extent(predIdx);
+    restageBytes += size_t(extent) * samplePred->ElementBytes(predIdx);
+    costIdx.push_back(std::make_pair(extent, pairIdx));
+  }
+  CostOrder(costIdx, schedule);
+
+  return restageBytes;
+}
+
+
+/**
+   @brief Sorts (cost, index) pairs by decreasing cost and records the
+   resulting index order.  Ties retain their original, node-major order.
+
+   @param costIdx holds the estimated cost and index of each task.
+
+   @param schedule outputs task indices in dispatch order.
+
+   @return void, with output vector.
+ */
+void Bottom::CostOrder(std::vector<std::pair<unsigned int, unsigned int> > &costIdx, std::vector<unsigned int> &schedule) {
+  std::stable_sort(costIdx.begin(), costIdx.end(), [](const std::pair<unsigned int, unsigned int> &a, const std::pair<unsigned int, unsigned int> &b) { return a.first > b.first; });
+  schedule.reserve(costIdx.size());
+  for (auto ci : costIdx) {
+    schedule.push_back(ci.second);
+  }
+}
+
+
+/**
+   @brief Dispatches restaging according to the predictor's rank width,
+   having requested the source range if paged.
+
+   @return void.
  */
 void RestageNode::Restage(Bottom *bottom, SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const {
+  samplePred->Prefetch(predIdx, sourceBit, startIdx, Extent(predIdx));
+  switch (samplePred->Ranks(predIdx, sourceBit).Width()) {
+  case 1:
+    Restage<unsigned char>(bottom, samplePred, pathNode, predIdx, sourceBit);
+    break;
+  case 2:
+    Restage<unsigned short>(bottom, samplePred, pathNode, predIdx, sourceBit);
+    break;
+  default:
+    Restage<unsigned int>(bottom, samplePred, pathNode, predIdx, sourceBit);
+    break;
+  }
+}
+
+
+/**
+   @brief General, multi-level restaging.
+
+   @param rankType is the storage type of the predictor's ranks.
+ */
+template<typename rankType> void RestageNode::Restage(Bottom *bottom, SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const {
   if (levelDel == 1) {
-    RestageTwo(bottom, samplePred, pathNode, predIdx, sourceBit);
+    RestageTwo<rankType>(bottom, samplePred, pathNode, predIdx, sourceBit);
     return;
   }
   int targOffset[1 << BottomNode::pathMax];
@@ -403,39 +573,50 @@ void RestageNode::Restage(Bottom *bottom, SamplePred *samplePred, const std::vec
   SPNode *source, *targ;
   unsigned int *sIdxSource, *sIdxTarg;
   samplePred->Buffers(predIdx, sourceBit, source, sIdxSource, targ, sIdxTarg);
+  const rankType *rkSource = samplePred->Ranks(predIdx, sourceBit).Col<rankType>();
+  SPRank rankTarg = samplePred->Ranks(predIdx, 1 - sourceBit);
+  rankType *rkTarg = rankTarg.Col<rankType>();
 
-  for (unsigned int idx = startIdx; idx < startIdx + extent; idx++) {
+  unsigned int idxEnd = startIdx + Extent(predIdx);
+  for (unsigned int idx = startIdx; idx < idxEnd; idx++) {
     unsigned int sIdx = sIdxSource[idx];
     int path;
     if ((path = bottom->Path(sIdx, levelDel)) >= 0) {
       unsigned int destIdx = targOffset[path]++;
       targ[destIdx] = source[idx];
+      rkTarg[destIdx] = rkSource[idx];
       sIdxTarg[destIdx] = sIdx;
     }
   }
   // Target bit recorded during initialization.
 
-  Singletons(bottom, pathNode, targOffset, targ, predIdx);
+  Singletons(bottom, pathNode, targOffset, rankTarg, predIdx);
 }
 
 
 /**
    @brief Specialized for two-path case, bypasses stack array.
 
+   @param rankType is the storage type of the predictor's ranks.
  */
-void RestageNode::RestageTwo(Bottom *bottom, SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const {
+template<typename rankType> void RestageNode::RestageTwo(Bottom *bottom, SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const {
   SPNode *source, *targ;
   unsigned int *sIdxSource, *sIdxTarg;
   samplePred->Buffers(predIdx, sourceBit, source, sIdxSource, targ, sIdxTarg);
+  const rankType *rkSource = samplePred->Ranks(predIdx, sourceBit).Col<rankType>();
+  SPRank rankTarg = samplePred->Ranks(predIdx, 1 - sourceBit);
+  rankType *rkTarg = rankTarg.Col<rankType>();
 
   unsigned int leftOff = pathNode[pathZero].Offset();
   unsigned int rightOff = pathNode[pathZero + 1].Offset();
-  for (unsigned int idx = startIdx; idx < startIdx + extent; idx++) {
+  unsigned int idxEnd = startIdx + Extent(predIdx);
+  for (unsigned int idx = startIdx; idx < idxEnd; idx++) {
     unsigned int sIdx = sIdxSource[idx];
     int path;
     if ((path = bottom->Path(sIdx, levelDel)) >= 0) {
       unsigned int destIdx = path == 0 ? leftOff++ : rightOff++;
       targ[destIdx] = source[idx];
+      rkTarg[destIdx] = rkSource[idx];
       sIdxTarg[destIdx] = sIdx;
     }
   }
@@ -444,28 +625,37 @@ void RestageNode::RestageTwo(Bottom *bottom, SamplePred *samplePred, const std::
   int targOffset[2];
   targOffset[0] = leftOff;
   targOffset[1] = rightOff;
-  Singletons(bottom, pathNode, targOffset, targ, predIdx);
+  Singletons(bottom, pathNode, targOffset, rankTarg, predIdx);
 }
 
 
 /**
-   @brief Notes any new singletons arising as a result of this restaging.
+   @brief Records the explicit index counts of the restaged targets and
+   notes any new singletons arising as a result of this restaging.
+
+   A target is a singleton if its samples all lie within the implicit
+   run or, having none there, if its explicit samples form a run.
+   Explicit ranks never equal the implicit rank, so a target having
+   samples of both kinds is never a singleton.
 
    @param bottom is the bottom environment.
 
-   @param targ is the restaged data.
+   @param targ is the restaged rank column.
 
    @param predIdx is the predictor index.
 
    @return void, with side-effected bottom nodes.
  */
-void RestageNode::Singletons(Bottom *bottom, const std::vector<PathNode> &pathNode, const int targOffset[], const SPNode targ[], unsigned int predIdx) const {
+void RestageNode::Singletons(Bottom *bottom, const std::vector<PathNode> &pathNode, const int targOffset[], const SPRank &targ, unsigned int predIdx) const {
   unsigned int pathTot = 1 << levelDel;
   for (unsigned int path = 0; path < pathTot; path++) {
     int levelIdx, offset;
-    pathNode[pathZero + path].Coords(levelIdx, offset);
+    unsigned int extent;
+    pathNode[pathZero + path].Coords(levelIdx, offset, extent);
     if (levelIdx >= 0) {
-      if (targ->IsRun(offset, targOffset[path]-1)) {
+      unsigned int explCount = targOffset[path] - offset;
+      bottom->SetExplicit(levelIdx, predIdx, explCount);
+      if (explCount == 0 || (explCount == extent && targ.IsRun(offset, targOffset[path]-1))) {
     	bottom->SetSingleton(levelIdx, predIdx);
       }
     }
@@ -476,19 +666,66 @@ void RestageNode::Singletons(Bottom *bottom, const std::vector<PathNode> &pathNo
 /**
    @brief Dispatches splitting of staged pairs independently.
 
+   Pairs are dispatched largest first, with restage-only pairs omitted,
+   to shorten the tail of work preceding the level barrier.
+
    @return void.
  */
 void Bottom::Split(const std::vector<SplitPair> &pairNode, const IndexNode indexNode[]) {
+  ProfTrack::Begin(ProfTrack::split);
   splitPred->RunOffsets();
-  int stageIdx;
-  
-#pragma omp parallel default(shared) private(stageIdx)
+  std::vector<unsigned int> schedule;
+  size_t candidates = SplitSchedule(pairNode, schedule);
+  int schedIdx;
+  if (serial) {
+    for (schedIdx = 0; schedIdx < int(schedule.size()); schedIdx++) {
+      Split(indexNode, pairNode[schedule[schedIdx]]);
+    }
+  }
+  else {
+#pragma omp parallel default(shared) private(schedIdx)
   {
 #pragma omp for schedule(dynamic, 1)
-    for (stageIdx = 0; stageIdx < int(pairNode.size()); stageIdx++) {
-      Split(indexNode, pairNode[stageIdx]);
+    for (schedIdx = 0; schedIdx < int(schedule.size()); schedIdx++) {
+      Split(indexNode, pairNode[schedule[schedIdx]]);
     }
   }
+  }
+  ProfTrack::End(schedule.size(), candidates);
+}
+
+
+/**
+   @brief Orders splitting pairs by decreasing cost, estimated as the
+   explicit index count of the node being split.  Factor pairs are charged an
+   additional run-count term for their sorting and heap work.
+
+   @param schedule outputs the splitting pair indices in dispatch order.
+
+   @return total cost, a count of split candidates, with output vector.
+ */
+size_t Bottom::SplitSchedule(const std::vector<SplitPair> &pairNode, std::vector<unsigned int> &schedule) const {
+  std::vector<std::pair<unsigned int, unsigned int> > costIdx;
+  costIdx.reserve(pairNode.size());
+  size_t costTot = 0;
+  for (unsigned int pairIdx = 0; pairIdx < pairNode.size(); pairIdx++) {
+    int setIdx;
+    if (pairNode[pairIdx].Split(setIdx)) {
+      unsigned int restageIdx;
+      unsigned int bottomIdx = pairNode[pairIdx].BottomIdx(restageIdx);
+      unsigned int levelIdx, predIdx;
+      SplitCoords(bottomIdx, levelIdx, predIdx);
+      unsigned int cost = Explicit(levelIdx, predIdx);
+      if (setIdx >= 0) {
+        cost += bottomNode[bottomIdx].RunCount();
+      }
+      costTot += cost;
+      costIdx.push_back(std::make_pair(cost, pairIdx));
+    }
+  }
+  CostOrder(costIdx, schedule);
+
+  return costTot;
 }
 
 
@@ -503,11 +740,16 @@ void Bottom::Split(const IndexNode indexNode[], const SplitPair &pairNode) {
      unsigned int levelIdx, predIdx;
      SplitCoords(bottomIdx, levelIdx, predIdx);
      unsigned int bufBit = BufBit(levelIdx, predIdx);
+     unsigned int explCount = Explicit(levelIdx, predIdx);
+     samplePred->Prefetch(predIdx, bufBit, indexNode[levelIdx].lhStart, explCount);
      if (setIdx >= 0) {
-       splitPred->SplitFac(bottomIdx, setIdx, &indexNode[levelIdx], samplePred->PredBase(predIdx, bufBit));
+       splitPred->SplitFac(bottomIdx, setIdx, &indexNode[levelIdx], samplePred->PredBase(predIdx, bufBit), samplePred->Ranks(predIdx, bufBit));
+    }
+    else if (explCount < indexNode[levelIdx].idxCount) {
+      splitPred->SplitImplicit(bottomIdx, &indexNode[levelIdx], samplePred->PredBase(predIdx, bufBit), samplePred->Ranks(predIdx, bufBit), explCount, samplePred->RankDense(predIdx));
     }
     else {
-      splitPred->SplitNum(bottomIdx, &indexNode[levelIdx], samplePred->PredBase(predIdx, bufBit));
+      splitPred->SplitNum(bottomIdx, &indexNode[levelIdx], samplePred->PredBase(predIdx, bufBit), samplePred->Ranks(predIdx, bufBit));
     }
   }
 }
@@ -520,17 +762,52 @@ void Bottom::SSWrite(unsigned int bottomIdx, int setIdx, unsigned int lhSampCoun
 }
 
 
-void Bottom::LevelInit() {
-  splitSig->LevelInit(levelCount);
+/**
+   @brief Translates a split found over a merged copy of a sparse pair's
+   explicit samples and implicit run into buffer coordinates.
+
+   @param runPos is the position of the implicit run within the copy.
+
+   @param runWidth is the count of positions representing the run.
+
+   @param implicit is the count of implicit indices.
+
+   @param rank are the ranks of the merged copy.
+
+   @return void.
+ */
+void Bottom::SSImplicit(unsigned int bottomIdx, unsigned int runPos, unsigned int runWidth, unsigned int implicit, const unsigned int rank[]) {
+  unsigned int levelIdx, predIdx;
+  SplitCoords(bottomIdx, levelIdx, predIdx);
+  splitSig->Implicit(levelIdx, predIdx, runPos, runWidth, implicit, rank);
+}
+
+
+/**
+   @brief Marks the arena, from which the level's splitting workspace
+   is drawn.
+
+   @param _arena is the tree's arena.
+
+   @return void.
+ */
+void Bottom::LevelInit(Arena *_arena) {
+  arena = _arena;
+  levelMark = arena->Mark();
+  splitSig->LevelInit(levelCount, arena);
 }
 
 
 /**
-   @brief
+   @brief Clears per-level state and releases the level's workspace
+   back to the arena.
+
+   @return void.
  */
 void Bottom::LevelClear() {
   splitPred->LevelClear();
   splitSig->LevelClear();
+  arena->Release(levelMark);
 }
 
 
@@ -546,6 +823,7 @@ void Bottom::LevelClear() {
 void Bottom::Overlap(unsigned int _splitNext) {
   levelCount = _splitNext;
   preStage.reserve(levelCount * nPred);
+  splitPred->Overlap(levelCount);
 }
 
 
@@ -562,12 +840,32 @@ void Bottom::Overlap(unsigned int _splitNext) {
 
    @param _rhIdxCount is the count of indices associated with the split's RHS.
 
+   @param isLH is true iff the successor is left-hand.
+
    @return void.
 */
-void Bottom::Inherit(unsigned int _levelIdx, unsigned int nodeNext) {
+void Bottom::Inherit(unsigned int _levelIdx, unsigned int nodeNext, bool isLH) {
   for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
     preStage[PairOffset(nodeNext, predIdx)].Inherit(bottomNode[PairOffset(_levelIdx, predIdx)]);
   }
+  splitPred->Inherit(_levelIdx, nodeNext, isLH);
+}
+
+
+/**
+   @brief Obtains the splitter's accumulators for the successor whose
+   statistics are gathered as its samples are replayed.
+
+   @param levelIdx is the level-relative index of the splitting node.
+
+   @param isLH is true iff the gathered successor is left-hand.
+
+   @param sCountExpl outputs the per-category sample counts, if any.
+
+   @return per-category response sums, or null if none are carried.
+ */
+double *Bottom::ExplSums(unsigned int levelIdx, bool isLH, unsigned int *&sCountExpl) {
+  return splitPred->ExplSums(levelIdx, isLH, sCountExpl);
 }
 
 
@@ -18,8 +18,11 @@
 #ifndef ARBORIST_BOTTOM_H
 #define ARBORIST_BOTTOM_H
 
+#include "arena.h"
+
 #include <deque>
 #include <vector>
+#include <utility>
 
 /**
    @brief Records sample's recent branching path.
@@ -72,6 +75,7 @@ class SamplePath {
 class PathNode {
   int levelIdx; // Negative iff path extinct.
   int offset; // Target offset for path.
+  unsigned int extent; // Index count of target node.
  public:
 
   /**
@@ -80,21 +84,24 @@ class PathNode {
   void Init() {
     levelIdx = -1;
     offset = -1;
+    extent = 0;
   }
 
   
   /**
      @brief Sets to non-extinct path coordinates.
    */
-  inline void Init(unsigned int _levelIdx, unsigned int _offset) {
+  inline void Init(unsigned int _levelIdx, unsigned int _offset, unsigned int _extent) {
     levelIdx = _levelIdx;
     offset = _offset;
+    extent = _extent;
   }
   
 
-  inline void Coords(int &_levelIdx, int &_offset) const {
+  inline void Coords(int &_levelIdx, int &_offset, unsigned int &_extent) const {
     _offset = offset;
     _levelIdx = levelIdx;
+    _extent = extent;
   }
 
   
@@ -106,26 +113,29 @@ class PathNode {
 
 class RestageNode {
   unsigned int startIdx;
-  unsigned int extent;// Requires access to start, end
+  const unsigned int *explCount; // Explicit index counts of MRRA, by predictor.
   unsigned int pathZero; // Beginning index of path offsets within 'pathAccum'.
   unsigned char levelDel; // Level difference between creation and restaging.
-  void Singletons(class Bottom *bottom, const std::vector<PathNode> &pathNode, const int targOffset[], const class SPNode targ[], unsigned int predIdx) const;
+  void Singletons(class Bottom *bottom, const std::vector<PathNode> &pathNode, const int targOffset[], const class SPRank &targ, unsigned int predIdx) const;
+  template<typename rankType> void Restage(class Bottom *bottom, class SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const;
+  template<typename rankType> void RestageTwo(class Bottom *bottom, class SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const;
  public:
 
   void Restage(class Bottom *bottom, class SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const;
-  void RestageTwo(class Bottom *bottom, class SamplePred *samplePred, const std::vector<PathNode> &pathNode, unsigned int predIdx, unsigned int sourceBit) const;
 
 
   /**
      @brief Initializes the node.  The first three parameters are the immutable state of the MRRA.
 
+     @param _explCount are the explicit index counts of the MRRA's cells.
+
      @param _pathZero is an accumulated starting index for restaging targets.
 
      @return void.
    */
-  inline void Init(unsigned int _startIdx, unsigned int _extent, unsigned int _levelDel, unsigned int _pathZero) {
+  inline void Init(unsigned int _startIdx, const unsigned int _explCount[], unsigned int _levelDel, unsigned int _pathZero) {
     startIdx = _startIdx;
-    extent = _extent;
+    explCount = _explCount;
     pathZero = _pathZero;
     levelDel = _levelDel;
   }
@@ -134,6 +144,19 @@ class RestageNode {
   inline unsigned int PathZero() const {
     return pathZero;
   };
+
+
+  /**
+     @brief Accessor for count of indices scanned when restaging.  Only
+     the explicit samples of the MRRA's cell are scanned.
+
+     @param predIdx is the predictor index.
+
+     @return explicit extent of MRRA's cell.
+   */
+  inline unsigned int Extent(unsigned int predIdx) const {
+    return explCount[predIdx];
+  }
 };
 
 
@@ -187,8 +210,19 @@ public:
     restageIdx = -1;
   }
 
+
+  /**
+     @brief Accessor for buffer coordinates of cell.
+
+     @return void, with output reference parameters.
+   */
+  inline void Coords(unsigned int &_start, unsigned int &_extent) const {
+    _start = start;
+    _extent = extent;
+  }
+
   
-  unsigned int PathAccum(unsigned int levelDel, unsigned int &pathAccum, std::vector<RestageNode> &restageNode);
+  unsigned int PathAccum(unsigned int levelDel, const unsigned int explCount[], unsigned int &pathAccum, std::vector<RestageNode> &restageNode);
 };
 
 
@@ -286,6 +320,19 @@ class BottomNode {
 
     return _mrraIdx;
   }
+
+
+  /**
+     @brief Nonresetting accessor for MRRA.
+
+     @param _levelDel outputs level delta.
+
+     @return MRRA index.
+   */
+  inline unsigned int Mrra(unsigned int &_levelDel) const {
+    _levelDel = levelDel;
+    return mrraIdx;
+  }
 };
 
 
@@ -325,8 +372,10 @@ class SplitPair {
 
 
 class Bottom {
+  friend class KernelBench; // Sets up and restages a level outside of Index.
   std::deque<class BitMatrix *> bufferLevel;
   std::deque<std::vector<MRRA> > mrraLevel;
+  std::deque<std::vector<unsigned int> > explLevel; // Explicit index counts of restaged pairs.
   std::vector<BottomNode> bottomNode; // All levelCount x nPred cells referenceable at current level.
   std::vector<BottomNode> preStage; // Temporary staging area.
 
@@ -334,20 +383,26 @@ class Bottom {
   SamplePath *samplePath;
   const unsigned int nPred;
   const unsigned int nPredFac;
+  const bool serial; // Whether level passes run without parallel regions.
   unsigned int ancTot; // Current count of extant ancestors.
   unsigned int levelCount; // # nodes in the level about to split.
   class SamplePred *samplePred;
   class SplitPred *splitPred;  // constant?
   class SplitSig *splitSig;
+  class Arena *arena; // Level's workspace, owned by the Index.
+  ArenaMark levelMark; // Arena position on entry to current level.
 
   //unsigned int rhIdxNext; // GPU client only:  Starting RHS index.
 
   int RestageIdx(unsigned int bottomIdx);
   unsigned int PairInit(class Run *run, const bool splitFlags[], std::vector<SplitPair> &pairNode, std::vector<RestageNode> &restageNode, std::vector<RestagePair> &restagePair);
   class BV *RestageInit(const class IndexNode indexNode[], const std::vector<SplitPair> &pairNode, std::vector<RestageNode> &restageNode, std::vector<PathNode> &pathNode);
-  void Restage(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, const std::vector<PathNode> &pathNode, const class BV *bufSource);
+  size_t Restage(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, const std::vector<PathNode> &pathNode, const class BV *bufSource);
   void Split(const std::vector<SplitPair> &pairNode, const class IndexNode indexNode[]);
   void Split(const class IndexNode indexNode[], const SplitPair &pairNode);
+  size_t SplitSchedule(const std::vector<SplitPair> &pairNode, std::vector<unsigned int> &schedule) const;
+  size_t RestageSchedule(const std::vector<RestageNode> &restageNode, const std::vector<RestagePair> &restagePair, std::vector<unsigned int> &schedule) const;
+  static void CostOrder(std::vector<std::pair<unsigned int, unsigned int> > &costIdx, std::vector<unsigned int> &schedule);
 
   
   inline bool Singleton(unsigned int botIdx) {
@@ -372,21 +427,36 @@ class Bottom {
  public:
   static Bottom *FactoryReg(class SamplePred *_samplePred, unsigned int bagCount);
   static Bottom *FactoryCtg(class SamplePred *_samplePred, class SampleNode *_sampleCtg, unsigned int bagCount);
+  Bottom *Spawn(class SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const;
+  bool StagedCell(unsigned int levelIdx, unsigned int predIdx, unsigned int &start, unsigned int &extent, unsigned int &bufBit) const;
   
-  Bottom(class SamplePred *_samplePred, class SplitPred *_splitPred, unsigned int bagCount, unsigned int _nPred, unsigned int _nPredFac);
+  Bottom(class SamplePred *_samplePred, class SplitPred *_splitPred, unsigned int bagCount, unsigned int _nPred, unsigned int _nPredFac, bool _serial = false);
   ~Bottom();
-  void LevelInit();
+  void LevelInit(class Arena *_arena);
   void Level(class Run *run, const bool splitFlags[], const class IndexNode indexNode[]);
   void Overlap(unsigned int _splitNext);
   void DeOverlap();
   void LevelClear();
   const std::vector<class SSNode*> LevelSplit(class Index *index, class IndexNode indexNode[]);
-  void Inherit(unsigned int _splitIdx, unsigned int nodeNext);
+  void Inherit(unsigned int _splitIdx, unsigned int nodeNext, bool isLH);
+  double *ExplSums(unsigned int levelIdx, bool isLH, unsigned int *&sCountExpl);
   unsigned int PathAccum(std::vector<RestageNode> &restageNode, unsigned int bottomIdx, unsigned int &_pathAccum);
   void SSWrite(unsigned int bottomIdx, int setIdx, unsigned int lhSampCount, unsigned lhIdxCount, double info);
+  void SSImplicit(unsigned int bottomIdx, unsigned int runPos, unsigned int runWidth, unsigned int implicit, const unsigned int rank[]);
   class Run *Runs();
   unsigned int BufBit(unsigned int levelIdx, unsigned int predIdx);
 
+
+
+  /**
+     @brief Accessor for serial status.
+
+     @return true iff level passes open no parallel regions.
+   */
+  inline bool Serial() const {
+    return serial;
+  }
+
   
   /**
      @brief Setter methods for sample path.
@@ -456,6 +526,33 @@ class Bottom {
     bottomNode[levelIdx * nPred + predIdx].RunCount(1);
   }
 
+
+  /**
+     @brief Looks up the count of explicit indices staged for a pair
+     at the current level.  Only defined for pairs restaged at this
+     level or, at the root, for all pairs.
+
+     @param levelIdx is the level-relative node index.
+
+     @param predIdx is the predictor index.
+
+     @return explicit index count:  the node's index count iff the
+     predictor has no implicit samples over the node.
+   */
+  inline unsigned int Explicit(unsigned int levelIdx, unsigned int predIdx) const {
+    return explLevel.back()[PairOffset(levelIdx, predIdx)];
+  }
+
+
+  /**
+     @brief Records the explicit index count of a newly-restaged pair.
+
+     @return void.
+   */
+  inline void SetExplicit(unsigned int levelIdx, unsigned int predIdx, unsigned int explCount) {
+    explLevel.back()[PairOffset(levelIdx, predIdx)] = explCount;
+  }
+
   
   inline void RunCount(unsigned int bottomIdx, int runCount) {
     bottomNode[bottomIdx].RunCount(runCount);
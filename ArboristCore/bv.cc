@@ -39,6 +39,21 @@ BV::BV(const std::vector<unsigned int> &_raw) : nSlot(_raw.size()), nBit(nSlot *
 }
 
 
+/**
+   @brief Copies slots from a raw buffer, such as a mapped model.
+
+   @param _raw holds the slots.
+
+   @param _nSlot is the slot count.
+ */
+BV::BV(const unsigned int _raw[], unsigned int _nSlot) : nSlot(_nSlot), nBit(nSlot * slotBits) {
+  raw = new unsigned int[nSlot];
+  for (unsigned int i = 0; i < nSlot; i++) {
+    raw[i] = _raw[i];
+  }
+}
+
+
 /**
  */
 BV::~BV() {
@@ -127,6 +142,21 @@ BVJagged::BVJagged(const std::vector<unsigned int> &_raw, const std::vector<unsi
 }
 
 
+/**
+   @brief Constructs from raw buffers, such as those of a mapped model.
+
+   @param _rawLen is the length of the slot buffer.
+
+   @param _nRow is the count of rows, each beginning at an origin.
+ */
+BVJagged::BVJagged(const unsigned int _raw[], size_t _rawLen, const unsigned int _rowOrigin[], unsigned int _nRow) : BV(_raw, _rawLen), nRow(_nRow) {
+  rowOrigin = new unsigned int[nRow];
+  for (unsigned int i = 0; i < nRow; i++) {
+    rowOrigin[i] = _rowOrigin[i];
+  }
+}
+
+
 /**
  */
 BVJagged::~BVJagged() {
@@ -18,6 +18,7 @@
 #define ARBORIST_BV_H
 
 #include <vector>
+#include <cstddef>
 
 class BV {
   unsigned int *raw;
@@ -27,6 +28,7 @@ class BV {
  public:
   BV(unsigned int len, bool slotWise = false);
   BV(const std::vector<unsigned int> &_raw);
+  BV(const unsigned int _raw[], unsigned int _nSlot);
   ~BV();
 
   inline unsigned int NBit() const {
@@ -45,6 +47,16 @@ class BV {
   unsigned int Slots() const {
     return nSlot;
   }
+
+
+  /**
+     @brief Accessor for storage footprint.
+
+     @return size of slot storage, in bytes.
+   */
+  size_t Bytes() const {
+    return size_t(nSlot) * sizeof(unsigned int);
+  }
   
   /**
      @brief Accessor for slotwise bit count.
@@ -182,6 +194,7 @@ class BVJagged : public BV {
   unsigned int RowHeight(unsigned int rowIdx) const;
  public:
   BVJagged(const std::vector<unsigned int> &_raw, const std::vector<unsigned int> _origin);
+  BVJagged(const unsigned int _raw[], size_t _rawLen, const unsigned int _origin[], unsigned int _nRow);
   ~BVJagged();
   static void Export(const std::vector<unsigned int> _origin, const std::vector<unsigned int> _raw, std::vector<std::vector<unsigned int> > &outVec);
 
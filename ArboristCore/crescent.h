@@ -0,0 +1,193 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file crescent.h
+
+   @brief Segmented, append-only storage for vectors growing during
+   training.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_CRESCENT_H
+#define ARBORIST_CRESCENT_H
+
+#include "memtrack.h"
+
+#include <vector>
+#include <algorithm>
+
+/**
+   @brief Appends to a front-end vector without reallocating it.
+
+   Appends fill the front-end vector up to its reserved capacity and
+   thereafter spill into trailing segments, each reserved in advance.
+   No segment is reallocated, so an underestimated reservation costs
+   no copying during training.  Finalize() consolidates the trailing
+   segments into the front-end vector, with at most a single
+   reallocation.
+
+   Each append is contiguous, so that a tree's span may be addressed
+   through a single base pointer.  Reserved capacity is accounted to
+   the subsystem with which the storage is tagged.
+ */
+template<typename T> class Crescent {
+  static constexpr size_t segMin = 1 << 12; // Minimal trailing segment.
+  std::vector<T> &base; // Leading segment and, once finalized, the whole.
+  std::vector<std::vector<T> > seg; // Trailing segments.
+  std::vector<size_t> segOff; // Starting index of each trailing segment.
+  size_t height; // Total element count.
+  unsigned int segCount; // Trailing segments opened.
+  unsigned int reallocCount; // Reallocating copies performed.
+  const unsigned int tag; // Accounting subsystem.
+  size_t footprint; // Bytes last accounted.
+
+
+  /**
+     @brief Accounts for any change in reserved capacity.
+
+     @return void.
+   */
+  void Account() {
+    size_t capacity = base.capacity();
+    for (auto & tail : seg) {
+      capacity += tail.capacity();
+    }
+    footprint = MemTrack::Resize(tag, footprint, capacity * sizeof(T));
+  }
+
+ public:
+  Crescent(std::vector<T> &_base, unsigned int _tag) : base(_base), height(_base.size()), segCount(0), reallocCount(0), tag(_tag), footprint(0) {
+    Account();
+  }
+
+
+  ~Crescent() {
+    MemTrack::Release(tag, footprint);
+  }
+
+
+  /**
+     @brief Reserves leading capacity from an estimate of final height.
+     Only effective before any spill has occurred.
+
+     @param heightEst is the estimated final height.
+
+     @return void.
+   */
+  void Reserve(size_t heightEst) {
+    if (seg.empty() && heightEst > base.capacity()) {
+      if (!base.empty())
+        reallocCount++;
+      base.reserve(heightEst);
+      Account();
+    }
+  }
+
+
+  /**
+     @brief Appends a contiguous span of initialized elements.
+
+     @param count is the length of the span.
+
+     @param init is the initial value of each element.
+
+     @return base of span, valid until finalization.
+   */
+  T *Append(size_t count, const T &init) {
+    T *span;
+    if (seg.empty() && base.size() + count <= base.capacity()) {
+      size_t off = base.size();
+      base.insert(base.end(), count, init);
+      span = base.data() + off;
+    }
+    else {
+      if (seg.empty() || seg.back().size() + count > seg.back().capacity()) {
+        // Segments grow geometrically with the total height.
+        seg.push_back(std::vector<T>());
+        seg.back().reserve(std::max(count, std::max(size_t(segMin), height / 2)));
+        segOff.push_back(height);
+        segCount++;
+        Account();
+      }
+      std::vector<T> &tail = seg.back();
+      size_t off = tail.size();
+      tail.insert(tail.end(), count, init);
+      span = tail.data() + off;
+    }
+    height += count;
+
+    return span;
+  }
+
+
+  /**
+     @brief Looks up an element by absolute index.  Recent indices are
+     found most quickly.
+
+     @param idx is the absolute index.
+
+     @return reference to element.
+   */
+  inline T &operator[](size_t idx) {
+    if (idx < base.size())
+      return base[idx];
+
+    size_t segIdx = seg.size() - 1;
+    while (idx < segOff[segIdx])
+      segIdx--;
+    return seg[segIdx][idx - segOff[segIdx]];
+  }
+
+
+  /**
+     @return total element count.
+   */
+  inline size_t Size() const {
+    return height;
+  }
+
+
+  /**
+     @brief Consolidates trailing segments onto the front-end vector.
+
+     @return void.
+   */
+  void Finalize() {
+    if (seg.empty())
+      return;
+
+    reallocCount++;
+    base.reserve(height);
+    Account(); // Segments still held.
+    for (auto & tail : seg) {
+      base.insert(base.end(), tail.begin(), tail.end());
+    }
+    seg.clear();
+    segOff.clear();
+    Account();
+  }
+
+
+  /**
+     @brief Accumulates counters.
+
+     @param segTot accumulates the count of trailing segments opened.
+
+     @param reallocTot accumulates the count of reallocating copies.
+
+     @return void, with output reference parameters.
+   */
+  void Tally(unsigned int &segTot, unsigned int &reallocTot) const {
+    segTot += segCount;
+    reallocTot += reallocCount;
+  }
+};
+
+#endif
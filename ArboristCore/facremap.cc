@@ -0,0 +1,135 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file facremap.cc
+
+   @brief Methods for remapping factor levels to those of training.
+
+   @author Mark Seligman
+ */
+
+#include "facremap.h"
+#include "levelindex.h"
+
+// Testing only:
+//#include <iostream>
+using namespace std;
+
+
+/**
+   @brief Indexes training levels given per factor.
+ */
+FacRemap::FacRemap(const std::vector<std::vector<std::string> > &levelTrain) {
+  for (auto &level : levelTrain) {
+    levelIndex.push_back(new LevelIndex(level));
+  }
+}
+
+
+/**
+   @brief Indexes training levels given flattened, as saved with a model.
+
+   @param predLevel concatenates the levels of all factors.
+
+   @param facCard gives the number of levels of each factor.
+ */
+FacRemap::FacRemap(const std::vector<std::string> &predLevel, const unsigned int facCard[], unsigned int nPredFac) {
+  size_t levelOff = 0;
+  for (unsigned int facIdx = 0; facIdx < nPredFac; facIdx++) {
+    std::vector<std::string> level(predLevel.begin() + levelOff, predLevel.begin() + levelOff + facCard[facIdx]);
+    levelIndex.push_back(new LevelIndex(level));
+    levelOff += facCard[facIdx];
+  }
+}
+
+
+FacRemap::~FacRemap() {
+  for (auto index : levelIndex)
+    delete index;
+}
+
+
+const std::vector<std::string> &FacRemap::Level(unsigned int facIdx) const {
+  return levelIndex[facIdx]->Levels();
+}
+
+
+/**
+   @brief Determines whether test levels coincide with those of training,
+   in which case no remapping is required.
+
+   @return true iff levels agree positionally.
+ */
+bool FacRemap::Identity(unsigned int facIdx, const std::vector<std::string> &levelTest) const {
+  return levelTest == levelIndex[facIdx]->Levels();
+}
+
+
+/**
+   @brief Builds the translation from test codes to training codes for a
+   single factor.  Cost is proportional to the number of test levels.
+
+   @param trans outputs the training code of each test code.
+
+   @return count of test levels unseen in training.
+ */
+unsigned int FacRemap::Translate(unsigned int facIdx, const std::vector<std::string> &levelTest, std::vector<int> &trans) const {
+  const LevelIndex *index = levelIndex[facIdx];
+  int proxy = index->Size();
+  unsigned int unseen = 0;
+  trans = std::vector<int>(levelTest.size());
+  for (unsigned int code = 0; code < levelTest.size(); code++) {
+    int trainCode = index->Find(levelTest[code]);
+    if (trainCode < 0) {
+      trans[code] = proxy;
+      unseen++;
+    }
+    else {
+      trans[code] = trainCode;
+    }
+  }
+
+  return unseen;
+}
+
+
+/**
+   @brief Remaps a column-major factor block in place, in parallel by
+   row within each column.  Codes outside the test levels are mapped
+   to the proxy.
+
+   @param blockFac holds zero-based test codes, remapped on output.
+
+   @param levelTest holds the test levels of each factor.
+
+   @return count of rows referencing levels unseen in training.
+ */
+size_t FacRemap::Remap(int blockFac[], unsigned int nRow, const std::vector<std::vector<std::string> > &levelTest) const {
+  size_t unseenRows = 0;
+  for (unsigned int facIdx = 0; facIdx < levelIndex.size(); facIdx++) {
+    if (Identity(facIdx, levelTest[facIdx]))
+      continue;
+
+    std::vector<int> trans;
+    (void) Translate(facIdx, levelTest[facIdx], trans);
+    int *col = &blockFac[size_t(facIdx) * nRow];
+    int nTrans = trans.size();
+    int proxy = levelIndex[facIdx]->Size();
+    size_t unseenCol = 0;
+    unsigned int row;
+#pragma omp parallel for default(shared) private(row) schedule(static) reduction(+ : unseenCol)
+    for (row = 0; row < nRow; row++) {
+      int code = col[row];
+      col[row] = (code >= 0 && code < nTrans) ? trans[code] : proxy;
+      unseenCol += col[row] == proxy;
+    }
+    unseenRows += unseenCol;
+  }
+
+  return unseenRows;
+}
@@ -0,0 +1,56 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file facremap.h
+
+   @brief Reconciliation of factor levels at prediction with those of
+   training.
+
+   @author Mark Seligman
+ */
+
+#ifndef ARBORIST_FACREMAP_H
+#define ARBORIST_FACREMAP_H
+
+#include <vector>
+#include <string>
+
+
+/**
+   @brief Hashed indices of the training levels of each factor, built
+   once per model and shared by all subsequent predictions.
+
+   Test levels absent from training are mapped to a proxy code equal to
+   the training cardinality, as in the front ends.  The proxy does not
+   satisfy any factor split, so such rows follow the false branch.
+ */
+class FacRemap {
+  std::vector<class LevelIndex *> levelIndex; // By factor.
+
+ public:
+  FacRemap(const std::vector<std::vector<std::string> > &levelTrain);
+  FacRemap(const std::vector<std::string> &predLevel, const unsigned int facCard[], unsigned int nPredFac);
+  ~FacRemap();
+
+  bool Identity(unsigned int facIdx, const std::vector<std::string> &levelTest) const;
+  unsigned int Translate(unsigned int facIdx, const std::vector<std::string> &levelTest, std::vector<int> &trans) const;
+  size_t Remap(int blockFac[], unsigned int nRow, const std::vector<std::vector<std::string> > &levelTest) const;
+
+
+  inline unsigned int NPredFac() const {
+    return levelIndex.size();
+  }
+
+
+  /**
+     @return training levels of a factor.
+   */
+  const std::vector<std::string> &Level(unsigned int facIdx) const;
+};
+
+#endif
@@ -27,16 +27,18 @@ using namespace std;
 /**
    @brief Crescent constructor for training.
 */
-Forest::Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, std::vector<unsigned int> &_facVec) : nTree(_origin.size()), forestNode(_forestNode), treeOrigin(_origin), facOrigin(_facOrigin), facVec(_facVec), predict(0) {
-  facSplit = new BVJagged(facVec, _facOrigin);
+Forest::Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, std::vector<unsigned int> &_facVec) : nTree(_origin.size()), forestNode(0), treeOrigin(_origin.data()), facSplit(0), nodeOrigin(&_origin), facOrigin(&_facOrigin), nodeCresc(new Crescent<ForestNode>(_forestNode, MemTrack::forest)), facCresc(new Crescent<unsigned int>(_facVec, MemTrack::forest)) {
 }
 
 
 /**
-   @brief Constructor for prediction.
+   @brief Constructor for prediction.  Nodes and origins are borrowed
+   rather than copied, and so must outlive the object.
+
+   @param _facLen is the length of the factor-splitting vector, in slots.
 */
-Forest::Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, std::vector<unsigned int> &_facVec, Predict *_predict) : nTree(_origin.size()), forestNode(_forestNode), treeOrigin(_origin), facOrigin(_facOrigin), facVec(_facVec), predict(_predict) {
-  facSplit = new BVJagged(facVec, _facOrigin);
+Forest::Forest(const ForestNode _forestNode[], const unsigned int _origin[], unsigned int _nTree, const unsigned int _facOrigin[], const unsigned int _facVec[], size_t _facLen) : nTree(_nTree), forestNode(_forestNode), treeOrigin(_origin), nodeOrigin(0), facOrigin(0), nodeCresc(0), facCresc(0) {
+  facSplit = new BVJagged(_facVec, _facLen, _facOrigin, _nTree);
 }
 
 
@@ -44,23 +46,27 @@ Forest::Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &
  */ 
 Forest::~Forest() {
   delete facSplit;
+  delete nodeCresc;
+  delete facCresc;
 }
 
 
 /**
    @brief Dispatches prediction method based on available predictor types.
 
+   @param predict records the leaves predicted.
+
    @param bag is the packed in-bag representation, if validating.
 
    @return void.
  */
-void Forest::PredictAcross(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
+void Forest::PredictAcross(Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
   if (PredBlock::NPredFac() == 0)
-    PredictAcrossNum(rowStart, rowEnd, bag);
+    PredictAcrossNum(predict, rowStart, rowEnd, bag);
   else if (PredBlock::NPredNum() == 0)
-    PredictAcrossFac(rowStart, rowEnd, bag);
+    PredictAcrossFac(predict, rowStart, rowEnd, bag);
   else
-    PredictAcrossMixed(rowStart, rowEnd, bag);
+    PredictAcrossMixed(predict, rowStart, rowEnd, bag);
 }
 
 
@@ -71,14 +77,14 @@ void Forest::PredictAcross(unsigned int rowStart, unsigned int rowEnd, const cla
 
    @return Void with output vector parameter.
  */
-void Forest::PredictAcrossNum(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
+void Forest::PredictAcrossNum(Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
   int row;
 
 #pragma omp parallel default(shared) private(row)
   {
 #pragma omp for schedule(dynamic, 1)
     for (row = int(rowStart); row < int(rowEnd); row++) {
-    PredictRowNum(row, PBPredict::RowNum(row), row - rowStart, bag);
+    PredictRowNum(predict, row, PBPredict::RowNum(row), row - rowStart, bag);
   }
   }
 }
@@ -91,14 +97,14 @@ void Forest::PredictAcrossNum(unsigned int rowStart, unsigned int rowEnd, const
 
    @return Void with output vector parameter.
  */
-void Forest::PredictAcrossFac(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
+void Forest::PredictAcrossFac(Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
   int row;
 
 #pragma omp parallel default(shared) private(row)
   {
 #pragma omp for schedule(dynamic, 1)
     for (row = int(rowStart); row < int(rowEnd); row++) {
-      PredictRowFac(row, PBPredict::RowFac(row), row - rowStart, bag);
+      PredictRowFac(predict, row, PBPredict::RowFac(row), row - rowStart, bag);
   }
   }
 
@@ -116,14 +122,14 @@ void Forest::PredictAcrossFac(unsigned int rowStart, unsigned int rowEnd, const
 
    @return Void with output vector parameter.
  */
-void Forest::PredictAcrossMixed(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
+void Forest::PredictAcrossMixed(Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const {
   int row;
 
 #pragma omp parallel default(shared) private(row)
   {
 #pragma omp for schedule(dynamic, 1)
     for (row = int(rowStart); row < int(rowEnd); row++) {
-    PredictRowMixed(row, PBPredict::RowNum(row), PBPredict::RowFac(row), row - rowStart, bag);
+    PredictRowMixed(predict, row, PBPredict::RowNum(row), PBPredict::RowFac(row), row - rowStart, bag);
   }
   }
 
@@ -142,7 +148,7 @@ void Forest::PredictAcrossMixed(unsigned int rowStart, unsigned int rowEnd, cons
    @return Void with output vector parameter.
  */
 
-void Forest::PredictRowNum(unsigned int row, const double rowT[], unsigned int blockRow, const class BitMatrix *bag) const {
+void Forest::PredictRowNum(Predict *predict, unsigned int row, const double rowT[], unsigned int blockRow, const class BitMatrix *bag) const {
   for (int tc = 0; tc < nTree; tc++) {
     if (bag->TestBit(row, tc)) {
       predict->BagIdx(blockRow, tc);
@@ -175,7 +181,7 @@ void Forest::PredictRowNum(unsigned int row, const double rowT[], unsigned int b
 
    @return Void with output vector parameter.
  */
-void Forest::PredictRowFac(unsigned int row, const int rowT[], unsigned int blockRow, const class BitMatrix *bag) const {
+void Forest::PredictRowFac(Predict *predict, unsigned int row, const int rowT[], unsigned int blockRow, const class BitMatrix *bag) const {
   int tc;
   for (tc = 0; tc < nTree; tc++) {
     if (bag->TestBit(row, tc)) {
@@ -212,7 +218,7 @@ void Forest::PredictRowFac(unsigned int row, const int rowT[], unsigned int bloc
 
    @return Void with output vector parameter.
  */
-void Forest::PredictRowMixed(unsigned int row, const double rowNT[], const int rowFT[], unsigned int blockRow, const class BitMatrix *bag) const {
+void Forest::PredictRowMixed(Predict *predict, unsigned int row, const double rowNT[], const int rowFT[], unsigned int blockRow, const class BitMatrix *bag) const {
   int tc;
   for (tc = 0; tc < nTree; tc++) {
     if (bag->TestBit(row, tc)) {
@@ -242,15 +248,26 @@ void Forest::PredictRowMixed(unsigned int row, const double rowNT[], const int r
 void Forest::NodeInit(unsigned int treeHeight) {
   ForestNode fn;
   fn.Init();
-  forestNode.insert(forestNode.end(), treeHeight, fn);
+  (void) nodeCresc->Append(treeHeight, fn);
 }
 
 
 /**
-   @brief Produces new splits for an entire tree.
+   @brief Produces new splits for an entire tree.  Only those slots
+   actually referenced by the tree are appended.
+
+   @param splitBits holds the tree's factor splitting bits.
+
+   @param bitEnd is one beyond the tree's highest bit position.
+
+   @return void.
  */
 void Forest::BitProduce(const BV *splitBits, unsigned int bitEnd) {
-  splitBits->Consume(facVec, bitEnd);
+  unsigned int slots = BV::SlotAlign(bitEnd);
+  unsigned int *facSpan = facCresc->Append(slots, 0);
+  for (unsigned int slot = 0; slot < slots; slot++) {
+    facSpan[slot] = splitBits->Slot(slot);
+  }
 }
 
 
@@ -258,13 +275,30 @@ void Forest::BitProduce(const BV *splitBits, unsigned int bitEnd) {
   @brief Reserves space in the relevant vectors for new trees.
  */
 void Forest::Reserve(unsigned int blockHeight, unsigned int blockFac, double slop) {
-  forestNode.reserve(slop * blockHeight);
+  nodeCresc->Reserve(slop * blockHeight);
   if (blockFac > 0) {
-    facVec.reserve(slop * blockFac);
+    facCresc->Reserve(slop * blockFac);
   }
 }
 
 
+/**
+   @brief Consolidates crescent storage into the front-end vectors.
+
+   @param segTot accumulates the count of overflow segments opened.
+
+   @param reallocTot accumulates the count of reallocating copies.
+
+   @return void, with output reference parameters.
+ */
+void Forest::Finalize(unsigned int &segTot, unsigned int &reallocTot) {
+  nodeCresc->Finalize();
+  facCresc->Finalize();
+  nodeCresc->Tally(segTot, reallocTot);
+  facCresc->Tally(segTot, reallocTot);
+}
+
+
 /**
    @brief Registers current vector sizes of crescent forest as origin values.
 
@@ -273,21 +307,22 @@ void Forest::Reserve(unsigned int blockHeight, unsigned int blockFac, double slo
    @return void.
  */
 void Forest::Origins(unsigned int tIdx) {
-  treeOrigin[tIdx] = Height();
-  facOrigin[tIdx] = SplitHeight();
+  (*nodeOrigin)[tIdx] = nodeCresc->Size();
+  (*facOrigin)[tIdx] = facCresc->Size();
 }
 
 
 /**
    @brief Post-pass to update numerical splitting values from ranks.
+   Crescent storage has been finalized, so lookup is direct.
 
    @param rowRank holds the presorted predictor values.
 
    @return void
  */
 void Forest::SplitUpdate(const RowRank *rowRank) const {
-  for (unsigned int i = 0; i < forestNode.size(); i++) {
-    forestNode[i].SplitUpdate(rowRank);
+  for (size_t i = 0; i < nodeCresc->Size(); i++) {
+    (*nodeCresc)[i].SplitUpdate(rowRank);
   }
 }
 
@@ -17,6 +17,8 @@
 #ifndef ARBORIST_FOREST_H
 #define ARBORIST_FOREST_H
 
+#include "crescent.h"
+
 #include <vector>
 
 /**
@@ -92,32 +94,36 @@ class ForestNode {
 
 /**
    @brief The decision forest is a collection of decision trees.  DecTree members and methods are currently all static.
+
+   Prediction reads the forest through borrowed pointers, so that nodes
+   may reside either in front-end vectors or in a mapped model file.
+   Training instead appends through crescent storage.
 */
 class Forest {
   const int nTree;
-
-  std::vector<ForestNode> &forestNode;
-  std::vector<unsigned int> &treeOrigin;
-  std::vector<unsigned int> &facOrigin;
-  std::vector<unsigned int> &facVec;
-  class Predict *predict;
-  class BVJagged *facSplit; // Consolidation of per-tree values.
-
-  void PredictAcrossNum(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
-  void PredictAcrossFac(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
-  void PredictAcrossMixed(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
+  const ForestNode *forestNode; // Prediction:  borrowed nodes.
+  const unsigned int *treeOrigin; // Node origin, by tree.
+  class BVJagged *facSplit; // Prediction:  consolidation of per-tree values.
+  std::vector<unsigned int> *nodeOrigin; // Training:  front-end origins.
+  std::vector<unsigned int> *facOrigin; // Training:  front-end origins.
+  Crescent<ForestNode> *nodeCresc; // Training:  appends to front-end nodes.
+  Crescent<unsigned int> *facCresc; // Training:  appends to front-end splits.
+
+  void PredictAcrossNum(class Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
+  void PredictAcrossFac(class Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
+  void PredictAcrossMixed(class Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
  public:
 
   void SplitUpdate(const class RowRank *rowRank) const;
 
-  void PredictAcross(unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const ;
+  void PredictAcross(class Predict *predict, unsigned int rowStart, unsigned int rowEnd, const class BitMatrix *bag) const;
   
-  void PredictRowNum(unsigned int row, const double rowT[], unsigned int rowBlock, const class BitMatrix *bag) const;
-  void PredictRowFac(unsigned int row, const int rowT[], unsigned int rowBlock, const class BitMatrix *bag) const;
-  void PredictRowMixed(unsigned int row, const double rowNT[], const int rowIT[], unsigned int rowBlock, const class BitMatrix *bag) const;
+  void PredictRowNum(class Predict *predict, unsigned int row, const double rowT[], unsigned int rowBlock, const class BitMatrix *bag) const;
+  void PredictRowFac(class Predict *predict, unsigned int row, const int rowT[], unsigned int rowBlock, const class BitMatrix *bag) const;
+  void PredictRowMixed(class Predict *predict, unsigned int row, const double rowNT[], const int rowIT[], unsigned int rowBlock, const class BitMatrix *bag) const;
 
   Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, std::vector<unsigned int> &_facVec);
-  Forest(std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, std::vector<unsigned int> &_facVec, class Predict *_predict);
+  Forest(const ForestNode _forestNode[], const unsigned int _origin[], unsigned int _nTree, const unsigned int _facOrigin[], const unsigned int _facVec[], size_t _facLen);
   ~Forest();
 
   void NodeInit(unsigned int treeHeight);
@@ -130,22 +136,15 @@ class Forest {
   }
 
   
-  /**
-   */
-  unsigned int *Origin() {
-    return &treeOrigin[0];
-  }
-  
-
   void TreeBlock(class PreTree *ptBlock[], int treeBlock, int treeStart);
 
 
-  inline unsigned Origin(int tIdx) {
+  inline unsigned Origin(int tIdx) const {
     return treeOrigin[tIdx];
   }
 
 
-  inline unsigned int NodeIdx(unsigned int tIdx, unsigned int nodeOffset) {
+  inline unsigned int NodeIdx(unsigned int tIdx, unsigned int nodeOffset) const {
     return treeOrigin[tIdx] + nodeOffset;
   }
 
@@ -156,7 +155,7 @@ class Forest {
      @return void.
   */
   inline void NonterminalProduce(unsigned int tIdx, unsigned int nodeIdx, unsigned int _predIdx, unsigned int _bump, double _split) {
-    forestNode[NodeIdx(tIdx, nodeIdx)].Set(_predIdx, _bump, _split);
+    (*nodeCresc)[NodeIdx(tIdx, nodeIdx)].Set(_predIdx, _bump, _split);
   }
 
 
@@ -167,91 +166,12 @@ class Forest {
 
   */
   inline void LeafProduce(unsigned int tIdx, unsigned int nodeIdx, unsigned int _leafIdx) {
-    forestNode[NodeIdx(tIdx, nodeIdx)].Set(_leafIdx, 0, 0.0);
+    (*nodeCresc)[NodeIdx(tIdx, nodeIdx)].Set(_leafIdx, 0, 0.0);
   }
 
 
   void Reserve(unsigned int nodeEst, unsigned int facEst, double slop);
-
-
-  /**
-     @return current size of (possibly crescent) forest.
-   */
-  inline unsigned int Height() const {
-    return forestNode.size();
-  }
-
-
-  /**
-     @brief Computes tree height from either of origin vector or,
-     if at the top or growing, the current height.
-
-     @parm tIdx is the tree number, if nonnegative, otherwise an
-     indication to return the forest heigght.
-
-     @return height of tree/forest.
-   */
-  inline unsigned int TreeHeight(int tIdx) const {
-    if (tIdx < 0)
-      return Height();
-
-    unsigned int heightInf = treeOrigin[tIdx];
-    if (tIdx < nTree - 1  && treeOrigin[tIdx + 1] > 0)
-      return treeOrigin[tIdx + 1] - heightInf;
-    else
-      return Height() - heightInf;
-  }
-
-
-  /**
-     @return current size of (possibly crescent) splitting vector.
-   */
-  inline unsigned int SplitHeight() const {
-    return facVec.size();
-  }
-
-
-  inline bool Nonterminal(unsigned int idx) const {
-    return forestNode[idx].Nonterminal();
-  }
-
-  
-  /**
-     @brief
-
-     @param tIdx is a tree index, if nonnegative, else a place holder
-     indicating that the offset is absolute.
-
-     @param off is the offset, either absolute or tree-relative.
-
-     @return true iff referenced node is non-terminal.
-   */
-  inline bool Nonterminal(int tIdx, unsigned int off) const {
-    unsigned int idx = tIdx >= 0 ? treeOrigin[tIdx] + off : off;
-    return Nonterminal(idx);
-  }
-  
-
-  inline unsigned int &LeafIdx(unsigned int idx) {
-    return forestNode[idx].LeafIdx();
-  }
-
-
-  /**
-     @brief Computes the extent of a leaf, that is, the number of
-     samples it subsumes.
-
-     @param tIdx is a tree index, if nonnegative, else a place holder
-     indicating that the offset is absolute.
-
-     @param off is the offset, either absolute or tree-relative.
-
-     @return referenced leaf index.
-   */
-  inline unsigned int &LeafIdx(int tIdx, unsigned int off) {
-    unsigned int idx = tIdx >= 0 ? treeOrigin[tIdx] + off : off;
-    return LeafIdx(idx);
-  }
+  void Finalize(unsigned int &segTot, unsigned int &reallocTot);
 
 
   void NodeProduce(unsigned int _predIdx, unsigned int _bump, double _split);
@@ -0,0 +1,658 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file frameload.cc
+
+   @brief Methods for reading observation frames from delimited text
+   and from the columnar binary format.
+
+   @author Mark Seligman
+ */
+
+#include "frameload.h"
+#include "levelindex.h"
+#include "facremap.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+// Testing only:
+//#include <iostream>
+using namespace std;
+
+const char FrameLoad::magic[8] = {'A', 'R', 'B', 'F', 'R', 'A', 'M', 'E'};
+
+
+/**
+   @brief Allocates blocks for a frame of known column types.  Numeric
+   columns are packed ahead of factors, each in front-end order.
+
+   @param isFactor indicates whether each front-end column is a factor.
+ */
+FrameLoad::FrameLoad(unsigned int _nRow, const std::vector<std::string> &_colName, const std::vector<bool> &isFactor) : nRow(_nRow), colName(_colName) {
+  for (unsigned int col = 0; col < isFactor.size(); col++) {
+    if (!isFactor[col])
+      predMap.push_back(col);
+  }
+  unsigned int nPredNum = predMap.size();
+  for (unsigned int col = 0; col < isFactor.size(); col++) {
+    if (isFactor[col])
+      predMap.push_back(col);
+  }
+  unsigned int nPredFac = predMap.size() - nPredNum;
+
+  blockNum = std::vector<double>(size_t(nRow) * nPredNum);
+  blockFac = std::vector<int>(size_t(nRow) * nPredFac);
+  facCard = std::vector<unsigned int>(nPredFac);
+  level = std::vector<std::vector<std::string> >(nPredFac);
+}
+
+
+/**
+   @brief Reads an entire file into memory, terminating the contents
+   with a newline and a NUL, so that field scans need no bounds check.
+
+   @return true iff read.
+ */
+bool FrameLoad::ReadFile(const char *path, std::vector<char> &text) {
+  FILE *file = fopen(path, "rb");
+  if (file == 0)
+    return false;
+
+  long fileLen = -1;
+  if (fseek(file, 0, SEEK_END) == 0)
+    fileLen = ftell(file);
+  if (fileLen < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    fclose(file);
+    return false;
+  }
+
+  text = std::vector<char>(size_t(fileLen) + 2);
+  bool ok = fread(&text[0], 1, fileLen, file) == size_t(fileLen);
+  fclose(file);
+  text[fileLen] = '\n';
+  text[fileLen + 1] = '\0';
+
+  return ok;
+}
+
+
+/**
+   @brief Reads a frame from file, selecting the format by inspection.
+
+   @return frame, or null on error, with diagnostic parameter.
+ */
+FrameLoad *FrameLoad::Read(const char *path, std::string &diag, char sep, bool header) {
+  char peek[sizeof(magic)];
+  FILE *file = fopen(path, "rb");
+  if (file == 0) {
+    diag = std::string("cannot open ") + path;
+    return 0;
+  }
+  bool isColumnar = fread(peek, 1, sizeof(peek), file) == sizeof(peek) && memcmp(peek, magic, sizeof(magic)) == 0;
+  fclose(file);
+
+  return isColumnar ? ReadColumnar(path, diag) : ReadCSV(path, diag, sep, header);
+}
+
+
+/**
+   @brief Locates the fields of a single line.  Separators within double
+   quotes are not field boundaries.  Embedded newlines are not
+   supported.
+
+   @param fieldOff outputs line-relative field offsets, terminated by
+   the offset one beyond the line's end.
+
+   @return true iff exactly 'nCol' fields found.
+ */
+bool FrameLoad::SplitFields(const std::vector<char> &text, size_t lineStart, size_t lineEnd, char sep, unsigned int nCol, unsigned int fieldOff[]) {
+  unsigned int fieldIdx = 0;
+  bool inQuote = false;
+  fieldOff[fieldIdx++] = 0;
+  for (size_t pos = lineStart; pos < lineEnd; pos++) {
+    char ch = text[pos];
+    if (ch == '"') {
+      inQuote = !inQuote;
+    }
+    else if (ch == sep && !inQuote) {
+      if (fieldIdx == nCol)
+        return false;
+      fieldOff[fieldIdx++] = pos + 1 - lineStart;
+    }
+  }
+  fieldOff[nCol] = lineEnd + 1 - lineStart;
+
+  return fieldIdx == nCol;
+}
+
+
+/**
+   @brief Trims surrounding blanks and, if present, enclosing quotes.
+
+   @param field is the start of the field, updated.
+
+   @param len is the length of the field, updated.
+
+   @param quoted outputs whether quotes were removed.
+
+   @return void, with output reference parameters.
+ */
+void FrameLoad::FieldBounds(const char *&field, size_t &len, bool &quoted) {
+  while (len > 0 && (field[0] == ' ' || field[0] == '\t')) {
+    field++;
+    len--;
+  }
+  while (len > 0 && (field[len - 1] == ' ' || field[len - 1] == '\t'))
+    len--;
+
+  quoted = len >= 2 && field[0] == '"' && field[len - 1] == '"';
+  if (quoted) {
+    field++;
+    len -= 2;
+  }
+}
+
+
+/**
+   @brief Copies a quoted field, collapsing doubled quotes.
+ */
+std::string FrameLoad::Unquote(const char *field, size_t len) {
+  std::string name;
+  for (size_t i = 0; i < len; i++) {
+    name += field[i];
+    if (field[i] == '"' && i + 1 < len && field[i + 1] == '"')
+      i++;
+  }
+  return name;
+}
+
+
+/**
+   @return true iff field is empty or reads "NA".
+ */
+bool FrameLoad::IsMissing(const char *field, size_t len) {
+  return len == 0 || (len == 2 && field[0] == 'N' && field[1] == 'A');
+}
+
+
+/**
+   @brief Reorders levels by name, recoding values accordingly.
+
+   @param levelFac holds levels in order of first appearance, sorted on
+   output.
+
+   @param code holds the codes to be remapped.
+
+   @return void, with output reference parameters.
+ */
+void FrameLoad::LevelSort(std::vector<std::string> &levelFac, std::vector<int> &code) {
+  std::vector<unsigned int> order(levelFac.size());
+  for (unsigned int i = 0; i < order.size(); i++)
+    order[i] = i;
+  sort(order.begin(), order.end(), [&levelFac](unsigned int a, unsigned int b) {
+      return levelFac[a] < levelFac[b];
+    });
+
+  std::vector<int> recode(order.size());
+  std::vector<std::string> sorted(order.size());
+  for (unsigned int i = 0; i < order.size(); i++) {
+    recode[order[i]] = i;
+    sorted[i] = levelFac[order[i]];
+  }
+  levelFac = sorted;
+  for (auto &val : code)
+    val = recode[val];
+}
+
+
+/**
+   @brief Reads a delimited text frame.  A column is numeric if all of
+   its fields parse as numbers, otherwise a factor.  Missing values,
+   either empty or "NA", are not supported.
+
+   @param sep is the field separator.
+
+   @param header indicates whether the first line holds column names.
+
+   @return frame, or null on error, with diagnostic parameter.
+ */
+FrameLoad *FrameLoad::ReadCSV(const char *path, std::string &diag, char sep, bool header) {
+  std::vector<char> text;
+  if (!ReadFile(path, text)) {
+    diag = std::string("cannot read ") + path;
+    return 0;
+  }
+
+  // Line boundaries, omitting carriage returns and blank lines.
+  std::vector<size_t> lineStart, lineEnd;
+  size_t textLen = text.size() - 1;
+  for (size_t pos = 0; pos < textLen; ) {
+    const char *nl = static_cast<const char *>(memchr(&text[pos], '\n', textLen - pos));
+    size_t end = nl - &text[0];
+    size_t trim = (end > pos && text[end - 1] == '\r') ? end - 1 : end;
+    if (trim > pos) {
+      lineStart.push_back(pos);
+      lineEnd.push_back(trim);
+    }
+    pos = end + 1;
+  }
+  if (lineStart.size() <= (header ? 1u : 0u)) {
+    diag = "no observations";
+    return 0;
+  }
+
+  unsigned int nCol = 1;
+  bool inQuote = false;
+  for (size_t pos = lineStart[0]; pos < lineEnd[0]; pos++) {
+    if (text[pos] == '"')
+      inQuote = !inQuote;
+    else if (text[pos] == sep && !inQuote)
+      nCol++;
+  }
+  std::vector<std::string> colName(nCol);
+  unsigned int lineFirst = header ? 1 : 0;
+  unsigned int nRow = lineStart.size() - lineFirst;
+  std::vector<unsigned int> fieldOff(size_t(nRow) * (nCol + 1));
+  if (header) {
+    std::vector<unsigned int> nameOff(nCol + 1);
+    (void) SplitFields(text, lineStart[0], lineEnd[0], sep, nCol, &nameOff[0]);
+    for (unsigned int col = 0; col < nCol; col++) {
+      const char *field = &text[lineStart[0] + nameOff[col]];
+      size_t len = nameOff[col + 1] - nameOff[col] - 1;
+      bool quoted;
+      FieldBounds(field, len, quoted);
+      colName[col] = quoted ? Unquote(field, len) : std::string(field, len);
+    }
+  }
+  else {
+    for (unsigned int col = 0; col < nCol; col++)
+      colName[col] = "V" + to_string(col + 1);
+  }
+
+  // Tokenizes in parallel by row.
+  std::vector<unsigned char> ragged(nRow);
+  unsigned int row;
+#pragma omp parallel for default(shared) private(row) schedule(static)
+  for (row = 0; row < nRow; row++) {
+    unsigned int line = lineFirst + row;
+    ragged[row] = !SplitFields(text, lineStart[line], lineEnd[line], sep, nCol, &fieldOff[size_t(row) * (nCol + 1)]);
+  }
+  for (row = 0; row < nRow; row++) {
+    if (ragged[row]) {
+      diag = "line " + to_string(lineFirst + row + 1) + ":  expecting " + to_string(nCol) + " fields";
+      return 0;
+    }
+  }
+
+  // Decodes in parallel by column.  A column is parsed as numeric until
+  // a non-numeric field is encountered, then reparsed as a factor.
+  std::vector<std::vector<double> > colNum(nCol);
+  std::vector<std::vector<int> > colCode(nCol);
+  std::vector<std::vector<std::string> > colLevel(nCol);
+  std::vector<long> missing(nCol, -1);
+  unsigned int col;
+#pragma omp parallel for default(shared) private(col) schedule(dynamic, 1)
+  for (col = 0; col < nCol; col++) {
+    std::vector<double> &num = colNum[col];
+    num = std::vector<double>(nRow);
+    bool isNum = true;
+    for (unsigned int rw = 0; rw < nRow && isNum; rw++) {
+      const unsigned int *off = &fieldOff[size_t(rw) * (nCol + 1)];
+      const char *field = &text[lineStart[lineFirst + rw] + off[col]];
+      size_t len = off[col + 1] - off[col] - 1;
+      bool quoted;
+      FieldBounds(field, len, quoted);
+      char *end;
+      num[rw] = strtod(field, &end);
+      if (IsMissing(field, len) || (end == field + len && std::isnan(num[rw]))) {
+        missing[col] = rw;
+        break;
+      }
+      isNum = (end == field + len);
+    }
+    if (isNum || missing[col] >= 0)
+      continue;
+
+    num.clear();
+    num.shrink_to_fit();
+    std::vector<int> &code = colCode[col];
+    code = std::vector<int>(nRow);
+    LevelIndex levelIndex;
+    for (unsigned int rw = 0; rw < nRow; rw++) {
+      const unsigned int *off = &fieldOff[size_t(rw) * (nCol + 1)];
+      const char *field = &text[lineStart[lineFirst + rw] + off[col]];
+      size_t len = off[col + 1] - off[col] - 1;
+      bool quoted;
+      FieldBounds(field, len, quoted);
+      if (IsMissing(field, len)) {
+        missing[col] = rw;
+        break;
+      }
+      if (quoted && memchr(field, '"', len) != 0) {
+        std::string name = Unquote(field, len);
+        code[rw] = levelIndex.Insert(name.data(), name.size());
+      }
+      else {
+        code[rw] = levelIndex.Insert(field, len);
+      }
+    }
+    colLevel[col] = levelIndex.Levels();
+    LevelSort(colLevel[col], code);
+  }
+  for (col = 0; col < nCol; col++) {
+    if (missing[col] >= 0) {
+      diag = "line " + to_string(lineFirst + missing[col] + 1) + ", column " + colName[col] + ":  missing values not supported";
+      return 0;
+    }
+  }
+  fieldOff.clear();
+  fieldOff.shrink_to_fit();
+  text.clear();
+  text.shrink_to_fit();
+
+  std::vector<bool> isFactor(nCol);
+  for (col = 0; col < nCol; col++)
+    isFactor[col] = colNum[col].empty();
+  FrameLoad *frame = new FrameLoad(nRow, colName, isFactor);
+  unsigned int nPredNum = frame->NPredNum();
+  unsigned int predIdx;
+#pragma omp parallel for default(shared) private(predIdx) schedule(dynamic, 1)
+  for (predIdx = 0; predIdx < frame->predMap.size(); predIdx++) {
+    unsigned int feCol = frame->predMap[predIdx];
+    if (predIdx < nPredNum) {
+      copy(colNum[feCol].begin(), colNum[feCol].end(), frame->blockNum.begin() + size_t(predIdx) * nRow);
+      std::vector<double>().swap(colNum[feCol]);
+    }
+    else {
+      unsigned int facIdx = predIdx - nPredNum;
+      copy(colCode[feCol].begin(), colCode[feCol].end(), frame->blockFac.begin() + size_t(facIdx) * nRow);
+      std::vector<int>().swap(colCode[feCol]);
+      frame->facCard[facIdx] = colLevel[feCol].size();
+      frame->level[facIdx].swap(colLevel[feCol]);
+    }
+  }
+
+  return frame;
+}
+
+
+/**
+   @brief Reads a frame in the columnar binary format:  a fixed header,
+   followed by each front-end column in turn.  A column consists of a
+   type tag, a length-prefixed name and, for factors, a count of levels
+   followed by length-prefixed level names.  The column's values follow,
+   either as doubles or as 32-bit zero-based codes.
+
+   @return frame, or null on error, with diagnostic parameter.
+ */
+FrameLoad *FrameLoad::ReadColumnar(const char *path, std::string &diag) {
+  std::vector<char> text;
+  if (!ReadFile(path, text)) {
+    diag = std::string("cannot read ") + path;
+    return 0;
+  }
+  size_t bytes = text.size() - 2;
+  Header hdr;
+  if (bytes < sizeof(Header)) {
+    diag = "truncated header";
+    return 0;
+  }
+  memcpy(&hdr, &text[0], sizeof(Header));
+  if (memcmp(hdr.magic, magic, sizeof(magic)) != 0 || hdr.version != version || hdr.byteOrder != byteOrder || hdr.nRow == 0 || hdr.nRow > 0xffffffffull) {
+    diag = "unrecognized or incompatible columnar header";
+    return 0;
+  }
+  unsigned int nRow = hdr.nRow;
+  unsigned int nCol = hdr.nCol;
+
+  // Walks the column descriptors, which are short, recording the
+  // offsets of the values, which are not.
+  size_t pos = sizeof(Header);
+  std::vector<std::string> colName(nCol);
+  std::vector<bool> isFactor(nCol);
+  std::vector<size_t> valOff(nCol);
+  std::vector<std::vector<std::string> > colLevel(nCol);
+  auto take = [&](void *out, size_t len) {
+    if (bytes - pos < len)
+      return false;
+    memcpy(out, &text[pos], len);
+    pos += len;
+    return true;
+  };
+  auto takeName = [&](std::string &name) {
+    uint32_t len;
+    if (!take(&len, sizeof(len)) || bytes - pos < len)
+      return false;
+    name.assign(&text[pos], len);
+    pos += len;
+    return true;
+  };
+  for (unsigned int col = 0; col < nCol; col++) {
+    uint32_t type;
+    if (!take(&type, sizeof(type)) || type > colFac || !takeName(colName[col])) {
+      diag = "malformed descriptor for column " + to_string(col + 1);
+      return 0;
+    }
+    isFactor[col] = type == colFac;
+    size_t elemSize = sizeof(double);
+    if (isFactor[col]) {
+      uint32_t nLevel;
+      if (!take(&nLevel, sizeof(nLevel)) || nLevel == 0 || nLevel > bytes - pos) {
+        diag = "malformed levels for column " + colName[col];
+        return 0;
+      }
+      colLevel[col] = std::vector<std::string>(nLevel);
+      for (auto &name : colLevel[col]) {
+        if (!takeName(name)) {
+          diag = "malformed levels for column " + colName[col];
+          return 0;
+        }
+      }
+      elemSize = sizeof(int32_t);
+    }
+    valOff[col] = pos;
+    if ((bytes - pos) / elemSize < nRow) {
+      diag = "truncated values for column " + colName[col];
+      return 0;
+    }
+    pos += elemSize * nRow;
+  }
+
+  FrameLoad *frame = new FrameLoad(nRow, colName, isFactor);
+  unsigned int nPredNum = frame->NPredNum();
+  std::vector<unsigned char> badCode(frame->predMap.size());
+  unsigned int predIdx;
+#pragma omp parallel for default(shared) private(predIdx) schedule(dynamic, 1)
+  for (predIdx = 0; predIdx < frame->predMap.size(); predIdx++) {
+    unsigned int feCol = frame->predMap[predIdx];
+    if (predIdx < nPredNum) {
+      memcpy(&frame->blockNum[size_t(predIdx) * nRow], &text[valOff[feCol]], sizeof(double) * nRow);
+    }
+    else {
+      unsigned int facIdx = predIdx - nPredNum;
+      int *code = &frame->blockFac[size_t(facIdx) * nRow];
+      memcpy(code, &text[valOff[feCol]], sizeof(int32_t) * nRow);
+      int card = colLevel[feCol].size();
+      for (unsigned int row = 0; row < nRow; row++) {
+        if (code[row] < 0 || code[row] >= card) {
+          badCode[predIdx] = 1;
+          break;
+        }
+      }
+      frame->facCard[facIdx] = card;
+      frame->level[facIdx].swap(colLevel[feCol]);
+    }
+  }
+  for (predIdx = 0; predIdx < badCode.size(); predIdx++) {
+    if (badCode[predIdx]) {
+      diag = "level code out of range in column " + colName[frame->predMap[predIdx]];
+      delete frame;
+      return 0;
+    }
+  }
+
+  return frame;
+}
+
+
+/**
+   @brief Writes the frame in the columnar binary format.
+
+   @return true iff written.
+ */
+bool FrameLoad::WriteColumnar(const char *path) const {
+  FILE *file = fopen(path, "wb");
+  if (file == 0)
+    return false;
+
+  Header hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, magic, sizeof(magic));
+  hdr.version = version;
+  hdr.byteOrder = byteOrder;
+  hdr.nRow = nRow;
+  hdr.nCol = colName.size();
+  bool ok = fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+
+  auto putName = [&](const std::string &name) {
+    uint32_t len = name.size();
+    ok = ok && fwrite(&len, sizeof(len), 1, file) == 1 && fwrite(name.data(), 1, len, file) == len;
+  };
+  std::vector<unsigned int> feToCore(colName.size());
+  for (unsigned int predIdx = 0; predIdx < predMap.size(); predIdx++)
+    feToCore[predMap[predIdx]] = predIdx;
+  unsigned int nPredNum = NPredNum();
+  for (unsigned int col = 0; col < colName.size() && ok; col++) {
+    unsigned int predIdx = feToCore[col];
+    uint32_t type = predIdx < nPredNum ? colNum : colFac;
+    ok = fwrite(&type, sizeof(type), 1, file) == 1;
+    putName(colName[col]);
+    if (type == colNum) {
+      ok = ok && fwrite(&blockNum[size_t(predIdx) * nRow], sizeof(double), nRow, file) == nRow;
+    }
+    else {
+      unsigned int facIdx = predIdx - nPredNum;
+      uint32_t nLevel = level[facIdx].size();
+      ok = ok && fwrite(&nLevel, sizeof(nLevel), 1, file) == 1;
+      for (auto &name : level[facIdx])
+        putName(name);
+      ok = ok && fwrite(&blockFac[size_t(facIdx) * nRow], sizeof(int32_t), nRow, file) == nRow;
+    }
+  }
+
+  return fclose(file) == 0 && ok;
+}
+
+
+/**
+   @brief Removes a column from the frame, as when the file also holds
+   the response.  Remaining columns keep their relative order.
+
+   @param name is the name of the column.
+
+   @param num outputs the column's values, if numeric.
+
+   @param code outputs the column's codes, if a factor, with 'levelOut'
+   receiving its levels.
+
+   @return front-end position of column removed, or -1 if not found.
+ */
+int FrameLoad::Extract(const std::string &name, std::vector<double> &num, std::vector<int> &code, std::vector<std::string> &levelOut) {
+  auto it = find(colName.begin(), colName.end(), name);
+  if (it == colName.end())
+    return -1;
+  unsigned int col = it - colName.begin();
+  unsigned int predIdx = find(predMap.begin(), predMap.end(), col) - predMap.begin();
+  unsigned int nPredNum = NPredNum();
+
+  num.clear();
+  code.clear();
+  levelOut.clear();
+  if (predIdx < nPredNum) {
+    auto colStart = blockNum.begin() + size_t(predIdx) * nRow;
+    num.assign(colStart, colStart + nRow);
+    blockNum.erase(colStart, colStart + nRow);
+  }
+  else {
+    unsigned int facIdx = predIdx - nPredNum;
+    auto colStart = blockFac.begin() + size_t(facIdx) * nRow;
+    code.assign(colStart, colStart + nRow);
+    blockFac.erase(colStart, colStart + nRow);
+    levelOut.swap(level[facIdx]);
+    level.erase(level.begin() + facIdx);
+    facCard.erase(facCard.begin() + facIdx);
+  }
+
+  predMap.erase(predMap.begin() + predIdx);
+  for (auto &feCol : predMap) {
+    if (feCol > col)
+      feCol--;
+  }
+  colName.erase(colName.begin() + col);
+
+  return col;
+}
+
+
+/**
+   @brief Recodes factors against the levels of training, which then
+   replace those read.
+
+   @param remap indexes the training levels.
+
+   @return count of rows referencing levels unseen in training.
+ */
+size_t FrameLoad::Conform(const FacRemap *remap) {
+  if (remap->NPredFac() != NPredFac() || NPredFac() == 0)
+    return 0;
+
+  size_t unseen = remap->Remap(&blockFac[0], nRow, level);
+  for (unsigned int facIdx = 0; facIdx < NPredFac(); facIdx++) {
+    level[facIdx] = remap->Level(facIdx);
+    facCard[facIdx] = level[facIdx].size();
+  }
+
+  return unseen;
+}
+
+
+/**
+   @brief Transposes the blocks into the row-major layout read by
+   PBPredict.
+
+   @return void, with output reference vectors.
+ */
+void FrameLoad::Transpose(std::vector<double> &numT, std::vector<int> &facT) const {
+  unsigned int nPredNum = NPredNum();
+  unsigned int nPredFac = NPredFac();
+  numT = std::vector<double>(blockNum.size());
+  facT = std::vector<int>(blockFac.size());
+  unsigned int row;
+#pragma omp parallel for default(shared) private(row) schedule(static)
+  for (row = 0; row < nRow; row++) {
+    for (unsigned int numIdx = 0; numIdx < nPredNum; numIdx++)
+      numT[size_t(row) * nPredNum + numIdx] = blockNum[size_t(numIdx) * nRow + row];
+    for (unsigned int facIdx = 0; facIdx < nPredFac; facIdx++)
+      facT[size_t(row) * nPredFac + facIdx] = blockFac[size_t(facIdx) * nRow + row];
+  }
+}
+
+
+/**
+   @return highest factor cardinality, or zero if no factors.
+ */
+unsigned int FrameLoad::CardMax() const {
+  unsigned int cardMax = 0;
+  for (auto card : facCard)
+    cardMax = max(cardMax, card);
+  return cardMax;
+}
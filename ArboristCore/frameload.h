@@ -0,0 +1,141 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file frameload.h
+
+   @brief Native loading of observation frames into predictor blocks.
+
+   @author Mark Seligman
+ */
+
+#ifndef ARBORIST_FRAMELOAD_H
+#define ARBORIST_FRAMELOAD_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+   @brief Observation frame read from file, already separated into the
+   numeric and factor blocks expected by PBTrain and PBPredict.
+
+   Blocks are column-major, with numeric predictors preceding factors
+   as in the front ends.  Factor values are zero-based codes into
+   levels sorted by name.  Two formats are read:  delimited text and a
+   simple columnar binary.  Either way the file is read in a single
+   pass and then decoded in parallel by column.
+ */
+class FrameLoad {
+  static const char magic[8];
+  static const unsigned int version = 1;
+  static const unsigned int byteOrder = 0x01020304;
+  static const unsigned int colNum = 0; // Columnar type tags.
+  static const unsigned int colFac = 1;
+
+  /**
+     @brief Fixed-width header of the columnar format.
+   */
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t nRow;
+    uint32_t nCol;
+    uint32_t reserved;
+  };
+
+  unsigned int nRow;
+  std::vector<std::string> colName; // Front-end order.
+  std::vector<unsigned int> predMap; // Front-end column of each core predictor.
+  std::vector<double> blockNum; // Column-major.
+  std::vector<int> blockFac; // Column-major, zero-based.
+  std::vector<unsigned int> facCard;
+  std::vector<std::vector<std::string> > level; // By factor.
+
+  FrameLoad(unsigned int _nRow, const std::vector<std::string> &_colName, const std::vector<bool> &isFactor);
+  static bool ReadFile(const char *path, std::vector<char> &text);
+  static bool SplitFields(const std::vector<char> &text, size_t lineStart, size_t lineEnd, char sep, unsigned int nCol, unsigned int fieldOff[]);
+  static void FieldBounds(const char *&field, size_t &len, bool &quoted);
+  static std::string Unquote(const char *field, size_t len);
+  static bool IsMissing(const char *field, size_t len);
+  static void LevelSort(std::vector<std::string> &levelFac, std::vector<int> &code);
+
+ public:
+  static FrameLoad *ReadCSV(const char *path, std::string &diag, char sep = ',', bool header = true);
+  static FrameLoad *ReadColumnar(const char *path, std::string &diag);
+  static FrameLoad *Read(const char *path, std::string &diag, char sep = ',', bool header = true);
+  bool WriteColumnar(const char *path) const;
+  int Extract(const std::string &name, std::vector<double> &num, std::vector<int> &code, std::vector<std::string> &levelOut);
+  size_t Conform(const class FacRemap *remap);
+  void Transpose(std::vector<double> &numT, std::vector<int> &facT) const;
+  unsigned int CardMax() const;
+
+
+  inline unsigned int NRow() const {
+    return nRow;
+  }
+
+
+  inline unsigned int NPredNum() const {
+    return predMap.size() - facCard.size();
+  }
+
+
+  inline unsigned int NPredFac() const {
+    return facCard.size();
+  }
+
+
+  /**
+     @return front-end column names.
+   */
+  inline const std::vector<std::string> &ColName() const {
+    return colName;
+  }
+
+
+  /**
+     @return front-end column of each core predictor.
+   */
+  inline const std::vector<unsigned int> &PredMap() const {
+    return predMap;
+  }
+
+
+  /**
+     @return numeric block, column-major.
+   */
+  inline const std::vector<double> &BlockNum() const {
+    return blockNum;
+  }
+
+
+  /**
+     @return factor block, column-major.
+   */
+  inline const std::vector<int> &BlockFac() const {
+    return blockFac;
+  }
+
+
+  inline const std::vector<unsigned int> &FacCard() const {
+    return facCard;
+  }
+
+
+  /**
+     @return level names of each factor, sorted.
+   */
+  inline const std::vector<std::vector<std::string> > &Level() const {
+    return level;
+  }
+};
+
+#endif
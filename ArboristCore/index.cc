@@ -21,6 +21,11 @@
 #include "splitsig.h"
 #include "samplepred.h"
 #include "bottom.h"
+#include "predblock.h"
+#include "memtrack.h"
+#include "proftrack.h"
+#include "splitpred.h"
+#include "arena.h"
 
 // Testing only:
 //#include <iostream>
@@ -30,6 +35,7 @@
 
 
 unsigned int Index::totLevels = 0;
+unsigned int Index::dfThreshold = 0;
 
 /**
    @brief Initialization of static invariants.
@@ -38,11 +44,22 @@ unsigned int Index::totLevels = 0;
 
    @param _totLevels is the maximum number of levels to evaluate.
 
+   @param _nPred is the number of predictors.
+
+   @param _dfBytes is the footprint within which a node's compact copy
+   must fit for the node to be finished depth-first:  zero disables.
+
    @return void.
  */
-void Index::Immutables(unsigned int _minNode, unsigned int _totLevels) {
+void Index::Immutables(unsigned int _minNode, unsigned int _totLevels, unsigned int _nPred, size_t _dfBytes) {
   NodeCache::Immutables(_minNode);
   totLevels = _totLevels;
+
+  // Nodes whose double-buffered, compact copy fits within '_dfBytes'
+  // are finished depth-first.  Thresholds not exceeding the minimum node
+  // size have no effect.  Sizing assumes ranks of the widest type.
+  //
+  dfThreshold = _dfBytes / (2 * _nPred * (sizeof(SPNode) + 2 * sizeof(unsigned int)));
 }
 
 
@@ -52,7 +69,7 @@ void Index::Immutables(unsigned int _minNode, unsigned int _totLevels) {
    @return void.
  */
 void Index::DeImmutables() {
-  totLevels = 0;
+  totLevels = dfThreshold = 0;
   NodeCache::DeImmutables();
 }
 
@@ -71,12 +88,23 @@ void NodeCache::DeImmutables() {
 
 /**
    @brief Per-tree constructor.  Sets up root node for level zero.
+
+   @param _minInfo is the information threshold for splitting the root.
+
+   @param _levelZero is the depth of the root within the containing tree.
+
+   @param _depthFirst is true iff small nodes may be finished depth-first.
+
+   @param _tIdx is the absolute index of the containing tree.
+
+   @param _levelSeq is the number of levels already trained within the
+   containing tree.
  */
-Index::Index(SamplePred *_samplePred, PreTree *_preTree, Bottom *_bottom, int _nSamp, int _bagCount, double _sum) : bagCount(_bagCount), samplePred(_samplePred), preTree(_preTree), bottom(_bottom) {
+Index::Index(SamplePred *_samplePred, PreTree *_preTree, Bottom *_bottom, int _nSamp, int _bagCount, double _sum, double _minInfo, unsigned int _levelZero, bool _depthFirst, unsigned int _tIdx, unsigned int _levelSeq) : levelZero(_levelZero), tIdx(_tIdx), levelSeq(_levelSeq), dfMax(_depthFirst ? dfThreshold : 0), level(0), sIdxLocal(0), arena(new Arena()), bagCount(_bagCount), samplePred(_samplePred), preTree(_preTree), bottom(_bottom) {
   levelBase = 0;
   levelWidth = 1;
   indexNode = new IndexNode[1];
-  indexNode[0].Init(0, 0, 0, _bagCount, _nSamp, _sum, 0.0, 0);
+  indexNode[0].Init(0, 0, 0, _bagCount, _nSamp, _sum, _minInfo, 0);
 }
 
 
@@ -86,6 +114,9 @@ Index::Index(SamplePred *_samplePred, PreTree *_preTree, Bottom *_bottom, int _n
    @return void.
  */
 Index::~Index() {
+  delete [] indexNode;
+  delete [] sIdxLocal;
+  delete arena;
 }
 
 
@@ -107,7 +138,11 @@ PreTree **Index::BlockTrees(Sample **sampleBlock, int treeBlock) {
 
   for (int blockIdx = 0; blockIdx < treeBlock; blockIdx ++) {
     Sample *sample = sampleBlock[blockIdx];
-    ptBlock[blockIdx] = OneTree(sample->SmpPred(), sample->Bot(), Sample::NSamp(), sample->BagCount(), sample->BagSum());
+    MemTrack::Tree();
+    ProfTrack::Tree();
+    ptBlock[blockIdx] = OneTree(sample->SmpPred(), sample->Bot(), Sample::NSamp(), sample->BagCount(), sample->BagSum(), sample->TreeIdx());
+    ProfTrack::TreeEnd();
+    MemTrack::TreeEnd();
   }
   
   return ptBlock;
@@ -119,9 +154,9 @@ PreTree **Index::BlockTrees(Sample **sampleBlock, int treeBlock) {
 
    @return void.
  */
-PreTree *Index::OneTree(SamplePred *_samplePred, Bottom *_bottom, int _nSamp, int _bagCount, double _sum) {
-  PreTree *_preTree = new PreTree(_bagCount);
-  Index *index = new Index(_samplePred, _preTree, _bottom, _nSamp, _bagCount, _sum);
+PreTree *Index::OneTree(SamplePred *_samplePred, Bottom *_bottom, int _nSamp, int _bagCount, double _sum, unsigned int _tIdx) {
+  PreTree *_preTree = PreTree::Acquire(_bagCount);
+  Index *index = new Index(_samplePred, _preTree, _bottom, _nSamp, _bagCount, _sum, 0.0, 0, true, _tIdx);
   index->Levels();
   delete index;
 
@@ -137,12 +172,15 @@ PreTree *Index::OneTree(SamplePred *_samplePred, Bottom *_bottom, int _nSamp, in
 */
 void  Index::Levels() {
   unsigned int levelCount = 1;
-  for (unsigned int level = 0; levelCount > 0; level++) {
-    bottom->LevelInit();
-    unsigned int splitNext, lhNext, leafNext;
-
-    NodeCache *nodeCache = LevelConsume(levelCount, splitNext, lhNext, leafNext);
-    if (splitNext != 0 && level + 1 != totLevels) {
+  for (level = 0; levelCount > 0; level++) {
+    MemTrack::Level(levelZero + level);
+    ProfTrack::Level(levelZero + level);
+    bottom->LevelInit(arena);
+    unsigned int splitNext, lhNext, leafNext, dfNext;
+
+    NodeCache *nodeCache = LevelConsume(levelCount, splitNext, lhNext, leafNext, dfNext);
+    levelSeq++; // Depth-first subtrees reserve positions beyond.
+    if (splitNext + dfNext != 0 && levelZero + level + 1 != totLevels) {
       LevelProduce(nodeCache, levelCount, splitNext, lhNext, leafNext);
       levelCount = splitNext;
     }
@@ -152,6 +190,7 @@ void  Index::Levels() {
     delete [] nodeCache;
     bottom->LevelClear();
   }
+  Graft();
 }
 //  ASSERTION:
 //   levelBase + levelWidth == preTree->TreeHeight()
@@ -171,6 +210,7 @@ NodeCache *Index::CacheNodes(const std::vector<SSNode*> &argMax) {
     nodeCache[splitIdx].Cache(&indexNode[splitIdx], argMax[splitIdx]);
   }
   delete [] indexNode;
+  indexNode = 0;
 
   return nodeCache;
 }
@@ -183,13 +223,15 @@ NodeCache *Index::CacheNodes(const std::vector<SSNode*> &argMax) {
 
    @leafNext outputs the number of leaves in the next level.
 
+   @dfNext outputs the number of leaves to be finished depth-first.
+
    @return total number of splits in the next level.
  */
-unsigned int Index::LevelCensus(NodeCache nodeCache[], unsigned int levelCount, unsigned int &lhSplitNext, unsigned int &leafNext) {
-  lhSplitNext = leafNext = 0;
+unsigned int Index::LevelCensus(NodeCache nodeCache[], unsigned int levelCount, unsigned int &lhSplitNext, unsigned int &leafNext, unsigned int &dfNext) {
+  lhSplitNext = leafNext = dfNext = 0;
   unsigned int rhSplitNext = 0;
   for (unsigned int splitIdx = 0; splitIdx < levelCount; splitIdx++)
-    nodeCache[splitIdx].SplitCensus(lhSplitNext, rhSplitNext, leafNext);
+    nodeCache[splitIdx].SplitCensus(lhSplitNext, rhSplitNext, leafNext, dfNext, dfMax);
   
   // Restaging is implemented as a patient stable partition.
   //
@@ -203,7 +245,8 @@ unsigned int Index::LevelCensus(NodeCache nodeCache[], unsigned int levelCount,
 
 /**
    @brief Splitable nodes only:  takes census next level's left, right split
-   nodes nodes and leaves.
+   nodes nodes and leaves.  Nodes to be finished depth-first are terminal
+   from the perspective of the next level.
 
    @param lhSplitNext outputs count of LH index nodes in next level.
 
@@ -211,9 +254,13 @@ unsigned int Index::LevelCensus(NodeCache nodeCache[], unsigned int levelCount,
 
    @param leafNext outputs count of pretree terminals in next level.
 
+   @param dfNext outputs count of terminals to be finished depth-first.
+
+   @param dfMax is the largest index count finished depth-first.
+
    @return void, plus output reference parameters.
 */
-void NodeCache::SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext, unsigned int &leafNext) const {
+void NodeCache::SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext, unsigned int &leafNext, unsigned int &dfNext, unsigned int dfMax) const {
   if (ssNode == 0)
     return;
   
@@ -221,18 +268,22 @@ void NodeCache::SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext
   unsigned int lhIdxCount;
   ssNode->LHSizes(lhSCount, lhIdxCount);
 
-  if (Splitable(lhIdxCount)) {
+  if (Frontier(lhIdxCount, dfMax)) {
     lhSplitNext++;
   }
   else {
     leafNext++;
+    dfNext += Splitable(lhIdxCount) ? 1 : 0;
   }
 
-  if (Splitable(idxCount - lhIdxCount)) {
+  unsigned int rhIdxCount = idxCount - lhIdxCount;
+  if (Frontier(rhIdxCount, dfMax)) {
     rhSplitNext++;
   }
-  else
+  else {
     leafNext++;
+    dfNext += Splitable(rhIdxCount) ? 1 : 0;
+  }
 }
 
 
@@ -244,22 +295,39 @@ void NodeCache::SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext
 
    @return count of nodes at next level:  zero if short-circuiting.
 */
-NodeCache *Index::LevelConsume(unsigned int levelCount, unsigned int &splitNext, unsigned int &lhSplitNext, unsigned int &leafNext) {
+NodeCache *Index::LevelConsume(unsigned int levelCount, unsigned int &splitNext, unsigned int &lhSplitNext, unsigned int &leafNext, unsigned int &dfNext) {
+  ProfTrack::Begin(ProfTrack::consume);
   NodeCache *nodeCache = CacheNodes(bottom->LevelSplit(this, indexNode));
-  splitNext = LevelCensus(nodeCache, levelCount, lhSplitNext, leafNext);
+  splitNext = LevelCensus(nodeCache, levelCount, lhSplitNext, leafNext, dfNext);
 
   // Next level of pre-tree needs sufficient space to consume splits
   // precipitated by cached nodes.
   preTree->CheckStorage(splitNext, leafNext);
+  ProfTrack::Begin(ProfTrack::replay);
+  std::vector<unsigned int> succImplicit(levelWidth);
+  bool anyImplicit = false;
   for (unsigned int splitIdx = 0; splitIdx < levelCount; splitIdx++) {
     nodeCache[splitIdx].Consume(preTree, samplePred, bottom);
+    unsigned int ptImplicit = nodeCache[splitIdx].PTImplicit();
+    if (ptImplicit != 0) {
+      succImplicit[LevelOffPT(nodeCache[splitIdx].ptId)] = ptImplicit;
+      anyImplicit = true;
+    }
   }
 
+  // Samples not replayed explicitly still reference their parents.
+  if (anyImplicit) {
+    preTree->ReplayImplicit(succImplicit, levelBase);
+  }
+  ProfTrack::End(levelCount);
+  ProfTrack::End(levelCount);
+
   return nodeCache;
 }
 
 
 void Index::LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned int splitNext, unsigned int lhSplitNext, unsigned int leafNext) {
+  ProfTrack::Begin(ProfTrack::produce);
   levelBase += levelWidth;
   levelWidth = splitNext + leafNext;
 
@@ -267,6 +335,7 @@ void Index::LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned
   ntRH = new bool[levelWidth];
   for (unsigned int i = 0; i < levelWidth; i++)
     ntLH[i] = ntRH[i] = false;
+  levelSampleOff.clear(); // Buckets refer to the previous level.
 
   unsigned int lhCount = 0;
   unsigned int rhCount = 0;
@@ -275,10 +344,12 @@ void Index::LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned
   // Next call guaranteed, so no dangling references:
   indexNode = new IndexNode[splitNext];
   for (unsigned int splitIdx = 0; splitIdx < levelCount; splitIdx++) {
-    nodeCache[splitIdx].Successors(this, preTree, samplePred, bottom, lhSplitNext, lhCount, rhCount);
+    nodeCache[splitIdx].Successors(this, lhSplitNext, lhCount, rhCount);
   }
   bottom->DeOverlap();
   LRLive(bottom);  
+  if (!subPending.empty())
+    GrowSubTrees();
 
   // Assigns start values to consecutive nodes at next level.
   /*
@@ -292,6 +363,7 @@ void Index::LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned
   delete [] ntLH;
   delete [] ntRH;
   ntLH = ntRH = 0;
+  ProfTrack::End(splitNext);
 }
 
 
@@ -302,7 +374,11 @@ void Index::LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned
 */
 void NodeCache::Consume(PreTree *preTree, SamplePred *samplePred, Bottom *bottom) {
   if (ssNode != 0) {
-    lhSum = ssNode->NonTerminal(samplePred, preTree, bottom, splitIdx, lhStart, lhStart + idxCount - 1, ptId, ptL, ptR);
+    unsigned int explCount = bottom->Explicit(splitIdx, ssNode->predIdx);
+    unsigned int implicit = idxCount - explCount;
+    lhSum = ssNode->NonTerminal(samplePred, preTree, bottom, splitIdx, lhStart, lhStart + explCount - 1, implicit, sum, ptId, ptL, ptR);
+    if (implicit > 0)
+      ptImplicit = ssNode->ImplicitLH() ? ptL : ptR;
   }
 }
 
@@ -325,6 +401,8 @@ void NodeCache::Consume(PreTree *preTree, SamplePred *samplePred, Bottom *bottom
    ordering as is assigned by restaging, which effects a stable partition of
    this level's predictor sample orderings (SampleOrd).
 
+   @param index is the Index context.
+
    @param lhSplitNext is the total number of LH index nodes in the next level.
 
    @param lhSplitCount outputs the accumulated number of next-level LH index nodes.
@@ -333,25 +411,196 @@ void NodeCache::Consume(PreTree *preTree, SamplePred *samplePred, Bottom *bottom
 
    @return void, plus output reference parameters.
 */
-void NodeCache::Successors(Index *index, PreTree *preTree, SamplePred *samplePred, Bottom *bottom, unsigned int lhSplitNext, unsigned int &lhSplitCount, unsigned int &rhSplitCount) {
+void NodeCache::Successors(Index *index, unsigned int lhSplitNext, unsigned int &lhSplitCount, unsigned int &rhSplitCount) {
   if (ssNode != 0) {
+    Bottom *bottom = index->bottom;
     unsigned int lhIdxCount, lhSCount;
     ssNode->LHSizes(lhSCount, lhIdxCount);
-    if (Splitable(lhIdxCount)) {
+    unsigned int end = lhStart + idxCount - 1;
+    if (Frontier(lhIdxCount, index->DFMax())) {
       unsigned int lNext = lhSplitCount++;
       index->NextLH(lNext, ptL, lhStart, lhIdxCount, lhSCount, lhSum, ssNode->MinInfo(), path);
-      bottom->Inherit(splitIdx, lNext);
+      bottom->Inherit(splitIdx, lNext, true);
+    }
+    else if (Splitable(lhIdxCount)) {
+      index->DepthFirst(splitIdx, ssNode->predIdx, lhStart, end, ptL, lhIdxCount, lhSCount, lhSum, ssNode->MinInfo());
     }
 
-    if (Splitable(idxCount - lhIdxCount)) {
+    unsigned int rhIdxCount = idxCount - lhIdxCount;
+    if (Frontier(rhIdxCount, index->DFMax())) {
       unsigned int rNext = lhSplitNext + rhSplitCount++;
-      index->NextRH(rNext, ptR, lhStart + lhIdxCount, idxCount - lhIdxCount, sCount - lhSCount, sum - lhSum, ssNode->MinInfo(), path);
-      bottom->Inherit(splitIdx, rNext);
+      index->NextRH(rNext, ptR, lhStart + lhIdxCount, rhIdxCount, sCount - lhSCount, sum - lhSum, ssNode->MinInfo(), path);
+      bottom->Inherit(splitIdx, rNext, false);
+    }
+    else if (Splitable(rhIdxCount)) {
+      index->DepthFirst(splitIdx, ssNode->predIdx, lhStart, end, ptR, rhIdxCount, sCount - lhSCount, sum - lhSum, ssNode->MinInfo());
     }
   }
 }
 
 
+/**
+   @brief Removes a small successor node from the level-wise frontier,
+   to be finished depth-first.
+
+   The node's samples are gathered from the splitting predictor's cell
+   or, should that cell omit implicit samples, from the level's bucketed
+   samples.  Then each predictor's cell is compacted into a private SamplePred
+   sized to the node alone.  The subtree is grown once the level has been
+   produced, and is grafted onto this tree once the level-wise pass
+   concludes.
+
+   @param splitIdx is the level index of the parent.
+
+   @param predIdx is the predictor on which the parent split.
+
+   @param start is the starting buffer index of the parent.
+
+   @param end is the final buffer index of the parent.
+
+   @param ptId is the pretree index of the successor.
+
+   @param idxCount is the count of indices subsumed by the successor.
+
+   @param sCount is the count of samples subsumed by the successor.
+
+   @param sum is the response sum over the successor.
+
+   @param minInfo is the information threshold for splitting the successor.
+
+   @return void, with subtree recorded for growing.
+ */
+void Index::DepthFirst(unsigned int splitIdx, unsigned int predIdx, unsigned int start, unsigned int end, unsigned int ptId, unsigned int idxCount, unsigned int sCount, double sum, double minInfo) {
+  if (sIdxLocal == 0) {
+    sIdxLocal = new unsigned int[bagCount];
+  }
+
+  // Replay has already mapped the successor's samples to 'ptId'.
+  SubTree sub;
+  sub.ptId = ptId;
+  sub.sIdxMap.reserve(idxCount);
+  unsigned int explCount = bottom->Explicit(splitIdx, predIdx);
+  if (explCount < end - start + 1) { // Splitting cell omits implicit samples.
+    if (levelSampleOff.empty())
+      BucketSamples();
+    unsigned int levelOff = LevelOffPT(ptId);
+    for (unsigned int i = levelSampleOff[levelOff]; i < levelSampleOff[levelOff + 1]; i++) {
+      unsigned int sIdx = levelSample[i];
+      sIdxLocal[sIdx] = sub.sIdxMap.size();
+      sub.sIdxMap.push_back(sIdx);
+    }
+  }
+  else {
+    unsigned int *sIdxSplit;
+    (void) samplePred->Buffers(predIdx, bottom->BufBit(splitIdx, predIdx), sIdxSplit);
+    for (unsigned int idx = start; idx <= end; idx++) {
+      unsigned int sIdx = sIdxSplit[idx];
+      if (preTree->Sample2Frontier(sIdx) == ptId) {
+        sIdxLocal[sIdx] = sub.sIdxMap.size();
+        sub.sIdxMap.push_back(sIdx);
+      }
+    }
+  }
+
+  // Singleton pairs stage nothing, and so remain singletons in the copy.
+  unsigned int nPred = PBTrain::NPred();
+  SamplePred *spLocal = SamplePred::Factory(nPred, idxCount, samplePred->RankWidths(), samplePred->RankDenses());
+  for (unsigned int pred = 0; pred < nPred; pred++) {
+    unsigned int cellStart, cellExtent, bufBit;
+    if (bottom->StagedCell(splitIdx, pred, cellStart, cellExtent, bufBit)) {
+      samplePred->Compact(spLocal, pred, bufBit, cellStart, cellExtent, preTree, ptId, sIdxLocal);
+    }
+  }
+
+  // A subtree trains no more levels than it has indices, so reserving
+  // as many positions in the sequence keeps its variates distinct from
+  // those of this tree and of its other subtrees.
+  Bottom *botLocal = bottom->Spawn(spLocal, idxCount, sub.sIdxMap);
+  sub.preTree = PreTree::Acquire(idxCount, 2 * idxCount);
+  sub.index = new Index(spLocal, sub.preTree, botLocal, sCount, idxCount, sum, minInfo, levelZero + level + 1, false, tIdx, levelSeq);
+  levelSeq += idxCount;
+
+  subPending.push_back(sub);
+}
+
+
+/**
+   @brief Grows the subtrees compacted at this level, in parallel across
+   subtrees.  Each trains serially over its own compact copy and arena,
+   opening no parallel regions of its own.  Tracking is suspended
+   meanwhile, so that the growth is charged to this level's production.
+
+   @return void, with grown subtrees recorded for grafting.
+ */
+void Index::GrowSubTrees() {
+  MemTrack::Suspend();
+  ProfTrack::Suspend();
+  int subIdx;
+
+#pragma omp parallel default(shared) private(subIdx)
+  {
+#pragma omp for schedule(dynamic, 1)
+    for (subIdx = 0; subIdx < int(subPending.size()); subIdx++) {
+      subPending[subIdx].index->Levels();
+    }
+  }
+  ProfTrack::Resume();
+  MemTrack::Resume();
+
+  for (auto & sub : subPending) {
+    delete sub.index->bottom;
+    delete sub.index->samplePred;
+    delete sub.index;
+    sub.index = 0;
+    subTree.push_back(sub);
+  }
+  subPending.clear();
+}
+
+
+/**
+   @brief Buckets the samples of the upcoming level by frontier node,
+   for successors of sparse splits, whose samples cannot be gathered
+   from the splitting cell alone.
+
+   @return void, with populated buckets.
+ */
+void Index::BucketSamples() {
+  levelSampleOff.assign(levelWidth + 1, 0);
+  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
+    unsigned int levelOff;
+    if (LevelOffSample(sIdx, levelOff))
+      levelSampleOff[levelOff + 1]++;
+  }
+  for (unsigned int i = 0; i < levelWidth; i++)
+    levelSampleOff[i + 1] += levelSampleOff[i];
+
+  levelSample.resize(levelSampleOff[levelWidth]);
+  std::vector<unsigned int> fill(levelSampleOff.begin(), levelSampleOff.end() - 1);
+  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
+    unsigned int levelOff;
+    if (LevelOffSample(sIdx, levelOff))
+      levelSample[fill[levelOff]++] = sIdx;
+  }
+}
+
+
+/**
+   @brief Grafts subtrees finished depth-first onto the pretree.  Deferred
+   until the level-wise pass completes, as grafted nodes would otherwise
+   interleave with the level-relative pretree numbering.
+
+   @return void, with side-effected pretree.
+ */
+void Index::Graft() {
+  for (auto & sub : subTree) {
+    preTree->Graft(sub.preTree, sub.ptId, sub.sIdxMap);
+    PreTree::Release(sub.preTree);
+  }
+  subTree.clear();
+}
+
+
 /**
    @brief Packs live lh/rh information into bit vectors and zero-pads up to the next slot boundary.
 
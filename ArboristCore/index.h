@@ -18,6 +18,7 @@
 #define ARBORIST_INDEX_H
 
 #include <vector>
+#include <cstddef>
 
 /**
    Index tree node fields associated with the response, viz., invariant across
@@ -163,12 +164,13 @@ class NodeCache : public IndexNode {
   double lhSum; // Sum of responses over LH:  splits only.
   unsigned int ptL; // LH index into pre-tree:  splits only.
   unsigned int ptR; // RH index into pre-tree:  splits only.
+  unsigned int ptImplicit; // Successor receiving implicit samples, if any.
  public:
   static void Immutables(unsigned int _minNode);
   static void DeImmutables();
   void Consume(class PreTree *preTree, class SamplePred *samplePred, class Bottom *bottom);
-  void Successors(class Index *index, class PreTree *preTree, class SamplePred *samplePred, class Bottom *bottom, unsigned int lhSplitNext, unsigned int &lhCount, unsigned int &rhCount);
-  void SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext, unsigned int &leafNext) const;
+  void Successors(class Index *index, unsigned int lhSplitNext, unsigned int &lhCount, unsigned int &rhCount);
+  void SplitCensus(unsigned int &lhSplitNext, unsigned int &rhSplitNext, unsigned int &leafNext, unsigned int &dfNext, unsigned int dfMax) const;
 
   /**
      @brief Copies indexNode entry into corresponding nodeCache.
@@ -186,11 +188,22 @@ class NodeCache : public IndexNode {
     ptId = nd->ptId;
     minInfo = nd->minInfo;
     path = nd->path,
-    ptL = ptR = 0; // Terminal until shown otherwise.
+    ptL = ptR = ptImplicit = 0; // Terminal until shown otherwise.
     SS() = argMax;
   }
 
 
+  /**
+     @brief Reports the successor to which the implicit samples of the
+     splitting predictor are assigned.
+
+     @return pretree index of successor, zero if no implicit samples.
+   */
+  inline unsigned int PTImplicit() const {
+    return ptImplicit;
+  }
+
+
   inline class SSNode *&SS() {
     return ssNode;
   }
@@ -212,15 +225,60 @@ class NodeCache : public IndexNode {
   }
 
 
+  /**
+     @brief Determines whether a splitable successor remains in the
+     level-wise frontier or is instead finished depth-first.
+
+     @param _idxCount is the count of indices subsumed by the successor.
+
+     @param dfMax is the largest index count finished depth-first.
+
+     @return true iff the successor is to be split at the next level.
+   */
+  inline bool Frontier(unsigned int _idxCount, unsigned int dfMax) const {
+    return Splitable(_idxCount) && _idxCount > dfMax;
+  }
+};
+
+
+/**
+   @brief Subtree finished depth-first from a compact copy of a small
+   frontier node.  Grown once its level has been produced, then held
+   until the level-wise pass completes, at which point it is grafted
+   onto the containing pretree.
+ */
+class SubTree {
+ public:
+  class Index *index; // Trains over the compact copy:  null once grown.
+  class PreTree *preTree; // Pretree built over the compact copy.
+  unsigned int ptId; // Grafting point in the containing pretree.
+  std::vector<unsigned int> sIdxMap; // Compact to containing sample indices.
 };
 
+
 class Index {
+  friend class KernelBench; // Steps single levels, as does Levels().
   static unsigned int totLevels;
+  static unsigned int dfThreshold; // Index count at or below which nodes are finished depth-first.
+  const unsigned int levelZero; // Depth of root within the containing tree.
+  const unsigned int tIdx; // Absolute index of the containing tree.
+  unsigned int levelSeq; // Position of level in the tree's training sequence.
+  const unsigned int dfMax; // Zero iff no depth-first finishing.
+  unsigned int level; // Current level, relative to root.
+  unsigned int *sIdxLocal; // Lazily-allocated compaction map.
+  class Arena *arena; // Per-level scratch, private to this tree.
+  std::vector<SubTree> subPending; // Subtrees compacted at this level.
+  std::vector<SubTree> subTree; // Subtrees awaiting grafting.
+  std::vector<unsigned int> levelSample; // Samples bucketed by frontier node:  lazy.
+  std::vector<unsigned int> levelSampleOff; // Bucket offsets, by level offset.
+  void BucketSamples();
   NodeCache *CacheNodes(const std::vector<class SSNode*> &argMax);
   void ArgMax(NodeCache nodeCache[]);
-  unsigned int LevelCensus(NodeCache nodeCache[], unsigned int levelCount, unsigned int &lhSplitNext, unsigned int &leafNext);
-  NodeCache *LevelConsume(unsigned int levelCount, unsigned int &splitNext, unsigned int &lhSplitNext, unsigned int &leafNext);
+  unsigned int LevelCensus(NodeCache nodeCache[], unsigned int levelCount, unsigned int &lhSplitNext, unsigned int &leafNext, unsigned int &dfNext);
+  NodeCache *LevelConsume(unsigned int levelCount, unsigned int &splitNext, unsigned int &lhSplitNext, unsigned int &leafNext, unsigned int &dfNext);
   void LevelProduce(NodeCache *nodeCache, unsigned int levelCount, unsigned int splitNext, unsigned int lhSplitNext, unsigned int leafNext);
+  void GrowSubTrees();
+  void Graft();
  protected:
   IndexNode *indexNode;  
   const unsigned int bagCount;
@@ -228,15 +286,15 @@ class Index {
   unsigned int levelWidth; // Count of pretree nodes at frontier.
   bool *ntLH;
   bool *ntRH;
-  static class PreTree *OneTree(class SamplePred *_samplePred, class Bottom *_bottom, int _nSamp, int _bagCount, double _bagSum);
+  static class PreTree *OneTree(class SamplePred *_samplePred, class Bottom *_bottom, int _nSamp, int _bagCount, double _bagSum, unsigned int _tIdx);
 
  public:
-  static void Immutables(unsigned int _minNode, unsigned int _totLevels);
+  static void Immutables(unsigned int _minNode, unsigned int _totLevels, unsigned int _nPred, size_t _dfBytes);
   static void DeImmutables();
   class SamplePred *samplePred;
   class PreTree *preTree;
   class Bottom *bottom;
-  Index(class SamplePred *_samplePred, class PreTree *_preTree, class Bottom *_bottom, int _nSamp, int _bagCount, double _sum);
+  Index(class SamplePred *_samplePred, class PreTree *_preTree, class Bottom *_bottom, int _nSamp, int _bagCount, double _sum, double _minInfo = 0.0, unsigned int _levelZero = 0, bool _depthFirst = true, unsigned int _tIdx = 0, unsigned int _levelSeq = 0);
   ~Index();
 
   static class PreTree **BlockTrees(class Sample **sampleBlock, int _treeBlock);
@@ -244,6 +302,41 @@ class Index {
   void Levels();
   void PredicateBits(class BV *bitsLH, class BV *bitsRH, int &lhIdxTot, int &rhIdxTot) const;
   void LRLive(const class Bottom *bottom) const;
+  void DepthFirst(unsigned int splitIdx, unsigned int predIdx, unsigned int start, unsigned int end, unsigned int ptId, unsigned int idxCount, unsigned int sCount, double sum, double minInfo);
+
+
+  /**
+     @brief Accessor for the tree's scratch arena.
+
+     @return arena from which per-level workspace is drawn.
+   */
+  inline class Arena *LevelArena() const {
+    return arena;
+  }
+
+
+  /**
+     @brief Accessor for depth-first threshold.
+
+     @return largest index count finished depth-first, zero if none.
+   */
+  inline unsigned int DFMax() const {
+    return dfMax;
+  }
+
+
+  /**
+     @brief Accessors for the coordinates of the level's random
+     variates.
+   */
+  inline unsigned int TreeIdx() const {
+    return tIdx;
+  }
+
+
+  inline unsigned int LevelSeq() const {
+    return levelSeq;
+  }
 
 
   /**
@@ -23,17 +23,67 @@ using namespace std;
 
 //#include <iostream>
 
-Leaf::Leaf(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow) : origin(_origin), nTree(origin.size()), leafNode(_leafNode), bagRow(_bagRow) {
+/**
+   @brief Crescent constructor for training.  The origin vector is
+   sized in advance, so its base remains fixed.
+ */
+Leaf::Leaf(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack) : nTree(_origin.size()), origin(_origin.data()), leafNode(0), leafTot(0), bagPack(0), originTrain(&_origin), leafCresc(new Crescent<LeafNode>(_leafNode, MemTrack::leaf)), bagCresc(new Crescent<unsigned char>(_bagPack, MemTrack::leaf)) {
+}
+
+
+/**
+   @brief Constructor for prediction.  Buffers are borrowed rather
+   than copied, and so must outlive the object.
+
+   @param _leafCount is the forest-wide count of leaves.
+ */
+Leaf::Leaf(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[]) : nTree(_nTree), origin(_origin), leafNode(_leafNode), leafTot(_leafCount), bagPack(_bagPack), originTrain(0), leafCresc(0), bagCresc(0) {
+}
+
+
+/**
+ */
+Leaf::~Leaf() {
+  delete leafCresc;
+  delete bagCresc;
+}
+
+
+/**
+   @brief Constructor for training.
+ */
+LeafReg::LeafReg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank) : Leaf(_origin, _leafNode, _bagPack), rank(0), rankWidth(RankHeader(_rank)), rankCresc(new Crescent<unsigned int>(_rank, MemTrack::leaf)) {
+}
+
+
+/**
+   @brief Constructor for prediction.
+
+   @param _rank is the packed rank buffer, led by its packing width.
+ */
+LeafReg::LeafReg(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[], const unsigned int _rank[]) : Leaf(_origin, _nTree, _leafNode, _leafCount, _bagPack), rank(_rank), rankWidth(_rank[0]), rankCresc(0) {
 }
 
 
 /**
+   @brief Reads the packing width from the rank vector's leading word.
+   An empty vector is initialized for training, with a width sufficient
+   for the training rows.
+
+   @param _rank is the packed rank vector.
+
+   @return packing width.
  */
-LeafReg::LeafReg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank) : Leaf(_origin, _leafNode, _bagRow),  rank(_rank) {
+unsigned int LeafReg::RankHeader(std::vector<unsigned int> &_rank) {
+  if (_rank.empty())
+    _rank.push_back(BagPack::RankWidth(PredBlock::NRow() - 1));
+
+  return _rank[0];
 }
 
 
 LeafReg::~LeafReg() {
+  delete rankCresc;
 }
 
 
@@ -43,8 +93,25 @@ LeafReg::~LeafReg() {
    @return void.
  */
 void Leaf::Reserve(unsigned int leafEst, unsigned int bagEst) {
-  leafNode.reserve(leafEst);
-  bagRow.reserve(bagEst);
+  leafCresc->Reserve(leafEst);
+  bagCresc->Reserve(BagPack::BytesEst(PredBlock::NRow(), leafEst, bagEst));
+}
+
+
+/**
+   @brief Consolidates crescent storage into the front-end vectors.
+
+   @param segTot accumulates the count of overflow segments opened.
+
+   @param reallocTot accumulates the count of reallocating copies.
+
+   @return void, with output reference parameters.
+ */
+void Leaf::Finalize(unsigned int &segTot, unsigned int &reallocTot) {
+  leafCresc->Finalize();
+  bagCresc->Finalize();
+  leafCresc->Tally(segTot, reallocTot);
+  bagCresc->Tally(segTot, reallocTot);
 }
 
 
@@ -55,7 +122,14 @@ void Leaf::Reserve(unsigned int leafEst, unsigned int bagEst) {
  */
 void LeafReg::Reserve(unsigned int leafEst, unsigned int bagEst) {
   Leaf::Reserve(leafEst, bagEst);
-  rank.reserve(bagEst);
+  rankCresc->Reserve(1 + BagPack::RankWords(bagEst, rankWidth) + NTree());
+}
+
+
+void LeafReg::Finalize(unsigned int &segTot, unsigned int &reallocTot) {
+  Leaf::Finalize(segTot, reallocTot);
+  rankCresc->Finalize();
+  rankCresc->Tally(segTot, reallocTot);
 }
 
 
@@ -63,25 +137,35 @@ void LeafReg::Reserve(unsigned int leafEst, unsigned int bagEst) {
  */
 void LeafCtg::Reserve(unsigned int leafEst, unsigned int bagEst) {
   Leaf::Reserve(leafEst, bagEst);
-  weight.reserve(leafEst * ctgWidth);
+  weightCresc->Reserve(leafEst * ctgWidth);
+}
+
+
+void LeafCtg::Finalize(unsigned int &segTot, unsigned int &reallocTot) {
+  Leaf::Finalize(segTot, reallocTot);
+  weightCresc->Finalize();
+  weightCresc->Tally(segTot, reallocTot);
 }
 
 
 /**
    @brief Constructor for incipient forest.
  */
-LeafCtg::LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight, unsigned int _ctgWidth) : Leaf(_origin, _leafNode, _bagRow), weight(_weight), ctgWidth(_ctgWidth) {
+LeafCtg::LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight, unsigned int _ctgWidth) : Leaf(_origin, _leafNode, _bagPack), weight(0), weightCresc(new Crescent<double>(_weight, MemTrack::leaf)), ctgWidth(_ctgWidth) {
 }
 
 
 /**
-   @brief Constructor for trained forest:  vector lengths final.
+   @brief Constructor for trained forest:  buffer lengths final.
+
+   @param _weight holds 'ctgWidth' weights per leaf.
  */
-LeafCtg::LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight) : Leaf(_origin, _leafNode, _bagRow), weight(_weight), ctgWidth(weight.size() / NodeCount()) {
+LeafCtg::LeafCtg(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[], const double _weight[], unsigned int _ctgWidth) : Leaf(_origin, _nTree, _leafNode, _leafCount, _bagPack), weight(_weight), weightCresc(0), ctgWidth(_ctgWidth) {
 }
 
 
 LeafCtg::~LeafCtg() {
+  delete weightCresc;
 }
 
 
@@ -94,17 +178,23 @@ LeafCtg::~LeafCtg() {
 
    @return bagged bit matrix.
  */
-BitMatrix *Leaf::ForestBag(unsigned int bagTrain) {
+BitMatrix *Leaf::ForestBag(unsigned int bagTrain) const {
   if (bagTrain == 0) // Not using bag.
     return new BitMatrix(0, 0);
   
-  unsigned int nTree = origin.size();
   BitMatrix *forestBag = new BitMatrix(bagTrain, nTree); 
-  unsigned int sIdx = 0;
+  std::vector<unsigned int> row;
+  const unsigned char *in = bagPack;
   for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
-    unsigned int bagCount = BagCount(origin, leafNode, tIdx);
-    for (unsigned int idx = 0; idx < bagCount; idx++) {
-      forestBag->SetBit(bagRow[sIdx++].Row(), tIdx);
+    unsigned int leafSup = tIdx < nTree - 1 ? origin[tIdx + 1] : leafTot;
+    for (unsigned int leafIdx = origin[tIdx]; leafIdx < leafSup; leafIdx++) {
+      unsigned int extent = leafNode[leafIdx].Extent();
+      if (extent > row.size())
+        row.resize(extent);
+      (void) BagPack::LeafDecode(in, extent, &row[0], 0);
+      for (unsigned int idx = 0; idx < extent; idx++) {
+        forestBag->SetBit(row[idx], tIdx);
+      }
     }
   }
 
@@ -161,27 +251,27 @@ void LeafReg::Scores(const Sample *sample, const std::vector<unsigned int> &leaf
    @void, with count-adjusted leaf nodes.
  */
 void Leaf::NodeExtent(const Sample *sample, std::vector<unsigned int> leafMap, unsigned int leafCount, unsigned int tIdx) {
-  unsigned int leafBase = leafNode.size();
-  origin[tIdx] = leafBase;
+  (*originTrain)[tIdx] = leafCresc->Size();
 
   LeafNode init;
   init.Init();
-  leafNode.insert(leafNode.end(), leafCount, init);
+  LeafNode *leafSpan = leafCresc->Append(leafCount, init);
   for (unsigned int sIdx = 0; sIdx < sample->BagCount(); sIdx++) {
     unsigned int leafIdx = leafMap[sIdx];
-    leafNode[leafBase + leafIdx].Count()++;
+    leafSpan[leafIdx].Count()++;
   }
 }
 
 
 /**
-   @brief Records bagged rows, by index, and sets any parallel auxilliary vectors.
+   @brief Encodes bagged rows and sample counts, leaf by leaf, and packs
+   any parallel auxilliary vectors.
 
    @param sample is the sampling record for the current tree.
 
    @param leafMap maps sample indices to their frontier (leaf) positions.
 
-   @param bagCount is the
+   @param leafCount is the number of leaves in the tree.
 
    @return void.
  */
@@ -190,36 +280,118 @@ void Leaf::RowBag(const Sample *sample, const std::vector<unsigned int> &leafMap
   std::vector<unsigned int> sample2Row(bagCount);
   sample->RowInvert(sample2Row);
   
+  // Orders the samples by leaf.  Sample indices increase with row, so
+  // rows increase within each leaf.
+  const LeafNode *leafSpan = &(*leafCresc)[Origin(tIdx)];
   std::vector<unsigned int> sampleOffset(leafCount);
-  SampleOffset(sampleOffset, Origin(tIdx), leafCount, bagRow.size());
+  unsigned int countAccum = 0;
+  for (unsigned int leafIdx = 0; leafIdx < leafCount; leafIdx++) {
+    sampleOffset[leafIdx] = countAccum;
+    countAccum += leafSpan[leafIdx].Extent();
+  }
+  std::vector<unsigned int> sOrder(bagCount);
+  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
+    sOrder[sampleOffset[leafMap[sIdx]]++] = sIdx;
+  }
+
+  // Sizes the encoding, then writes it as a single span.
+  size_t bagBytes = 0;
+  unsigned int sOff = 0;
+  for (unsigned int leafIdx = 0; leafIdx < leafCount; leafIdx++) {
+    unsigned int rowPrev = 0;
+    for (unsigned int i = 0; i < leafSpan[leafIdx].Extent(); i++, sOff++) {
+      unsigned int sIdx = sOrder[sOff];
+      bagBytes += BagPack::TokenLen(sample2Row[sIdx] - rowPrev, sample->SCount(sIdx));
+      rowPrev = sample2Row[sIdx];
+    }
+  }
+  unsigned char *out = bagCresc->Append(bagBytes, 0);
+  sOff = 0;
+  for (unsigned int leafIdx = 0; leafIdx < leafCount; leafIdx++) {
+    unsigned int rowPrev = 0;
+    for (unsigned int i = 0; i < leafSpan[leafIdx].Extent(); i++, sOff++) {
+      unsigned int sIdx = sOrder[sOff];
+      out = BagPack::TokenPut(out, sample2Row[sIdx] - rowPrev, sample->SCount(sIdx));
+      rowPrev = sample2Row[sIdx];
+    }
+  }
 
-  BagRow brInit;
-  brInit.Init();
-  bagRow.insert(bagRow.end(), bagCount, brInit);
-  RankInit(bagCount, 0);
+  Ranks(sample, sOrder);
+}
 
-  std::vector<unsigned int> leafSeen(leafCount);
-  std::fill(leafSeen.begin(), leafSeen.end(), 0);
-  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
-    unsigned int leafIdx = leafMap[sIdx];
-    unsigned int sOff = sampleOffset[leafIdx] + leafSeen[leafIdx]++;
-    bagRow[sOff].Set(sample2Row[sIdx], sample->SCount(sIdx));
-    RankSet(sOff, sample, sIdx);
+
+/**
+   @brief Packs the current tree's sample ranks, beginning on a fresh word.
+
+   @param sOrder lists the tree's sample indices in leaf order.
+
+   @return void.
+ */
+void LeafReg::Ranks(const Sample *sample, const std::vector<unsigned int> &sOrder) {
+  unsigned int bagCount = sOrder.size();
+  std::vector<unsigned int> rankTree(bagCount);
+  for (unsigned int sOff = 0; sOff < bagCount; sOff++) {
+    rankTree[sOff] = ((SampleReg *) sample)->Rank(sOrder[sOff]);
   }
-  // post-condition:  sum(leafSeen) == bagCount
+
+  unsigned int *out = rankCresc->Append(BagPack::RankWords(bagCount, rankWidth), 0);
+  BagPack::RankPack(&rankTree[0], bagCount, rankWidth, out);
 }
 
 
-void LeafReg::RankInit(unsigned int bagCount, unsigned int init) {
-  rank.insert(rank.end(), bagCount, 0);
+/**
+   @brief Computes the position of each leaf's samples within the
+   packed bag.
+
+   @param bagOffset outputs the byte offset of each leaf, forest-wide.
+
+   @return void, with output reference vector.
+ */
+void Leaf::BagOffset(std::vector<size_t> &bagOffset) const {
+  const unsigned char *base = bagPack;
+  const unsigned char *in = base;
+  for (unsigned int leafIdx = 0; leafIdx < leafTot; leafIdx++) {
+    bagOffset[leafIdx] = in - base;
+    BagPack::LeafSkip(in, leafNode[leafIdx].Extent());
+  }
 }
 
 
-void LeafReg::RankSet(unsigned int sOff, const class Sample *sample, unsigned int sIdx) {
-  rank[sOff] = ((SampleReg *) sample)->Rank(sIdx);
+/**
+   @brief Computes sum of all bag sizes.
+
+   @return count of bagged samples over the forest.
+ */
+unsigned int Leaf::BagTot() const {
+  unsigned int bagTot = 0;
+  for (unsigned int leafIdx = 0; leafIdx < leafTot; leafIdx++) {
+    bagTot += leafNode[leafIdx].Extent();
+  }
+
+  return bagTot;
 }
 
 
+/**
+   @brief Computes the position of each leaf's ranks within the packed
+   rank vector.
+
+   @param rankOffset outputs the bit offset of each leaf, forest-wide.
+
+   @return void, with output reference vector.
+ */
+void LeafReg::RankOffset(std::vector<size_t> &rankOffset) const {
+  size_t treeBit = 0;
+  for (unsigned int tIdx = 0; tIdx < NTree(); tIdx++) {
+    unsigned int leafSup = tIdx < NTree() - 1 ? NodeIdx(tIdx + 1, 0) : NodeCount();
+    size_t bitOff = treeBit;
+    for (unsigned int leafIdx = NodeIdx(tIdx, 0); leafIdx < leafSup; leafIdx++) {
+      rankOffset[leafIdx] = bitOff;
+      bitOff += size_t(Extent(leafIdx)) * rankWidth;
+    }
+    treeBit += BagPack::RankWords((bitOff - treeBit) / rankWidth, rankWidth) * 8 * sizeof(unsigned int);
+  }
+}
 
 
 /**
@@ -334,7 +506,7 @@ unsigned int Leaf::BagCount(const std::vector<unsigned int> &_origin, const std:
  */
 void LeafCtg::ForestWeight(double *defaultWeight) const {
   unsigned int idx = 0;
-  unsigned int forestLeaves = weight.size() / ctgWidth;
+  unsigned int forestLeaves = NodeCount();
   for (unsigned int forestIdx = 0; forestIdx < forestLeaves; forestIdx++) {
     for (unsigned int ctg = 0; ctg < ctgWidth; ctg++) {
       defaultWeight[ctg] += weight[idx++];
@@ -348,33 +520,34 @@ void LeafCtg::ForestWeight(double *defaultWeight) const {
 
 /**
  */
-void LeafReg::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const vector<BagRow> &_bagRow, const std::vector<unsigned int> &_rank, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> >&extentTree, std::vector< std::vector<unsigned int> > &rankTree) {
-  Leaf::Export(_origin, _leafNode, _bagRow, rowTree, sCountTree);
+void LeafReg::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const vector<unsigned char> &_bagPack, const std::vector<unsigned int> &_rank, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> >&extentTree, std::vector< std::vector<unsigned int> > &rankTree) {
+  Leaf::Export(_origin, _leafNode, _bagPack, rowTree, sCountTree);
   LeafNode::Export(_origin, _leafNode, scoreTree, extentTree);
-  unsigned int bagOrig = 0;
+  unsigned int width = _rank[0];
+  size_t wordOrig = 0;
   for (unsigned int tIdx = 0; tIdx < _origin.size(); tIdx++) {
     unsigned int bagCount = BagCount(_origin, _leafNode, tIdx);
     rankTree[tIdx] = std::vector<unsigned int>(bagCount);
-    TreeExport(_rank, bagOrig, bagCount, rankTree[tIdx]);
-    bagOrig += bagCount;
+    if (bagCount > 0)
+      BagPack::RankUnpack(&_rank[0], wordOrig * 8 * sizeof(unsigned int), width, bagCount, &rankTree[tIdx][0]);
+    wordOrig += BagPack::RankWords(bagCount, width);
   }
 }
 
 
 /**
-   @brief Static exporter of BagRow vector into per-tree vector of vectors.
+   @brief Static exporter of packed bag into per-tree vector of vectors.
 
    @return void, with output reference parameters.
  */
-void Leaf::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<BagRow> &_bagRow, std::vector< std::vector<unsigned int> > &rowTree, std::vector< std::vector<unsigned int> >&sCountTree) {
+void Leaf::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<unsigned char> &_bagPack, std::vector< std::vector<unsigned int> > &rowTree, std::vector< std::vector<unsigned int> >&sCountTree) {
   unsigned int nTree = _origin.size();
-  unsigned int bagOrig = 0;
+  const unsigned char *in = _bagPack.data();
   for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
     unsigned int bagCount = BagCount(_origin, _leafNode, tIdx);
     rowTree[tIdx] = std::vector<unsigned int>(bagCount);
     sCountTree[tIdx] = std::vector<unsigned int>(bagCount);
-    TreeExport(_bagRow, bagOrig, bagCount, rowTree[tIdx], sCountTree[tIdx]);
-    bagOrig += bagCount;
+    TreeExport(in, _leafNode, _origin[tIdx], LeafNode::LeafCount(_origin, _leafNode.size(), tIdx), rowTree[tIdx], sCountTree[tIdx]);
   }
 }
 
@@ -394,21 +567,21 @@ void LeafNode::Export(const std::vector<unsigned int> &_origin, const std::vecto
 }
 
 
-void Leaf::TreeExport(const std::vector<BagRow> &_bagRow, unsigned int bagOrig, unsigned int bagCount, std::vector<unsigned int> &rowTree, std::vector<unsigned int> &sCountTree) {
-  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
-    _bagRow[bagOrig + sIdx].Ref(rowTree[sIdx], sCountTree[sIdx]);
-  }
-}
-
-
 /**
-   @brief Copies sections of forest-wide fields to per-tree vectors.
+   @brief Decodes a tree's bagged rows and counts, leaf by leaf.
 
-   @return void.
+   @param in is the position of the tree's first sample, advanced past
+   its last.
+
+   @return void, with output reference parameters.
  */
-void LeafReg::TreeExport(const std::vector<unsigned int> &_rank, unsigned int bagOrig, unsigned int bagCount, std::vector<unsigned int> &rankTree) {
-  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
-    rankTree[sIdx] = _rank[bagOrig + sIdx];
+void Leaf::TreeExport(const unsigned char *&in, const std::vector<LeafNode> &_leafNode, unsigned int leafOrig, unsigned int leafCount, std::vector<unsigned int> &rowTree, std::vector<unsigned int> &sCountTree) {
+  unsigned int sOff = 0;
+  for (unsigned int leafIdx = leafOrig; leafIdx < leafOrig + leafCount; leafIdx++) {
+    unsigned int extent = _leafNode[leafIdx].Extent();
+    if (extent > 0)
+      (void) BagPack::LeafDecode(in, extent, &rowTree[sOff], &sCountTree[sOff]);
+    sOff += extent;
   }
 }
 /**
@@ -425,8 +598,8 @@ void LeafNode::TreeExport(const std::vector<LeafNode> &_leafNode, unsigned int t
 
 /**
  */
-void LeafCtg::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<BagRow> &_bagRow, const std::vector<double> &_weight, unsigned int _ctgWidth, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> > &extentTree, std::vector<std::vector<double> > &weightTree) {
-  Leaf::Export(_origin, _leafNode, _bagRow, rowTree, sCountTree);
+void LeafCtg::Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<unsigned char> &_bagPack, const std::vector<double> &_weight, unsigned int _ctgWidth, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> > &extentTree, std::vector<std::vector<double> > &weightTree) {
+  Leaf::Export(_origin, _leafNode, _bagPack, rowTree, sCountTree);
   LeafNode::Export(_origin, _leafNode, scoreTree, extentTree);
   for (unsigned int tIdx = 0; tIdx < _origin.size(); tIdx++) {
     unsigned int leafCount = LeafCount(_origin, _weight.size(), _ctgWidth, tIdx);
@@ -17,60 +17,16 @@
 #define ARBORIST_LEAF_H
 
 #include "sample.h"
-#include <vector>
-
-
-/**
-   @brief Transmits bagged row information for post-training use.
- */
-class BagRow {
-  unsigned int row;
-  unsigned int sCount;
- public:
-  void Init() {
-    row = sCount = 0;
-  }
-  
-
-  /**
-     @brief Sets both members.
-   */
-  void Set(unsigned int _row, unsigned int _sCount) {
-    row = _row;
-    sCount = _sCount;
-  }
-
-
-  /**
-     @brief Accessor for row.
-   */
-  inline unsigned int Row() const {
-    return row;
-  }
-
-
-  /**
-     @brief Accessor for sample count.
-   */
-  inline unsigned int SCount() const {
-    return sCount;
-  }
+#include "crescent.h"
+#include "bagpack.h"
 
-  
-  /**
-     @brief Accessor for both members.
-   */
-  inline void Ref(unsigned int &_row, unsigned int &_sCount) const {
-    _row = row;
-    _sCount = sCount;
-  }
-
-};
+#include <vector>
 
 
 class LeafNode {
   double score;
   unsigned int extent; // count of sample-index slots.
+  unsigned int pad; // Explicitly zeroed, so that saved models are reproducible.
   static void TreeExport(const std::vector<LeafNode> &_leafNode, unsigned int treeOff, unsigned int leafCount, std::vector<double> &_score, std::vector<unsigned int> &_extent);
 
 
@@ -101,6 +57,7 @@ class LeafNode {
   inline void Init() {
     score = 0.0;
     extent = 0;
+    pad = 0;
   }
 
   
@@ -132,32 +89,49 @@ class LeafNode {
 
 
 class Leaf {
-  std::vector<unsigned int> &origin; // Starting position, per tree.
   const unsigned int nTree;
-  std::vector<LeafNode> &leafNode;
-  std::vector<BagRow> &bagRow; // bagged row/count:  per sample.
-  static void TreeExport(const std::vector<BagRow> &_bagRow, unsigned int bagOrig, unsigned int bagCount, std::vector<unsigned int> &rowTree, std::vector<unsigned int> &sCountTree);
+  const unsigned int *origin; // Starting position, per tree.
+  const LeafNode *leafNode; // Prediction:  borrowed leaves.
+  const unsigned int leafTot; // Prediction:  forest-wide leaf count.
+  const unsigned char *bagPack; // Prediction:  packed bagged rows and counts, by leaf.
+  std::vector<unsigned int> *originTrain; // Training:  receives origins.
+  Crescent<LeafNode> *leafCresc; // Training:  appends to front-end leaves.
+  Crescent<unsigned char> *bagCresc; // Training:  appends to front-end bag.
+  static void TreeExport(const unsigned char *&in, const std::vector<LeafNode> &_leafNode, unsigned int leafOrig, unsigned int leafCount, std::vector<unsigned int> &rowTree, std::vector<unsigned int> &sCountTree);
 
  protected:
   void RowBag(const class Sample *sample, const std::vector<unsigned int> &leafMap, unsigned int leafCount, unsigned int tIdx);
   static unsigned int BagCount(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, unsigned int tIdx);
-  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<BagRow> &_bagRow, std::vector< std::vector<unsigned int> > &rowTree, std::vector< std::vector<unsigned int> >&sCountTree);
+  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<unsigned char> &_bagPack, std::vector< std::vector<unsigned int> > &rowTree, std::vector< std::vector<unsigned int> >&sCountTree);
   void NodeExtent(const class Sample *sample, std::vector<unsigned int> leafMap, unsigned int leafCount, unsigned int tIdx);
 
+
+  /**
+     @brief Training accessor for score of the crescent forest.
+
+     @return reference to score of referenced leaf.
+   */
+  inline double &ScoreTrain(unsigned int tIdx, unsigned int leafIdx) {
+    return (*leafCresc)[NodeIdx(tIdx, leafIdx)].Score();
+  }
+
  public:
-  Leaf(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow);
-  virtual ~Leaf() {}
+  Leaf(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack);
+  Leaf(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[]);
+  virtual ~Leaf();
   
   virtual void Reserve(unsigned int leafEst, unsigned int bagEst);
+  virtual void Finalize(unsigned int &segTot, unsigned int &reallocTot);
   virtual void Leaves(const class Sample *sample, const std::vector<unsigned int> &leafMap, unsigned int tIdx) = 0;
-  virtual void RankInit(unsigned int bagCount, unsigned int init) = 0;
-  virtual void RankSet(unsigned int sOff, const class Sample *sample, unsigned int sIdx) = 0;
+  virtual void Ranks(const class Sample *sample, const std::vector<unsigned int> &sOrder) = 0;
 
-  class BitMatrix *ForestBag(unsigned int rowTrain);
+  class BitMatrix *ForestBag(unsigned int rowTrain) const;
   
   void SampleOffset(std::vector<unsigned int> &sampleOffset, unsigned int leafBase, unsigned int leafCount, unsigned int sampleBase) const;
+  void BagOffset(std::vector<size_t> &bagOffset) const;
+  unsigned int BagTot() const;
 
-  inline unsigned Origin(unsigned int tIdx) {
+  inline unsigned Origin(unsigned int tIdx) const {
     return origin[tIdx];
   }
 
@@ -169,15 +143,10 @@ class Leaf {
   /**
      @brief computes total number of leaves in forest.
 
-     @return size of leafNode vector.
+     @return count of leaves.
    */
   inline unsigned int NodeCount() const {
-    return leafNode.size();
-  }
-
-  
-  inline double &Score(unsigned int idx) {
-    return leafNode[idx].Score();
+    return leafTot;
   }
 
   
@@ -186,10 +155,6 @@ class Leaf {
   }
 
   
-  inline double &Score(int tIdx, unsigned int leafIdx) {
-    return Score(NodeIdx(tIdx, leafIdx));
-  }
-
   inline double GetScore(int tIdx, unsigned int leafIdx) const {
     return leafNode[NodeIdx(tIdx, leafIdx)].GetScore();
   }
@@ -199,7 +164,7 @@ class Leaf {
     @brief Sets score.
   */
   inline void ScoreSet(unsigned int tIdx, unsigned int leafIdx, double score) {
-    Score(tIdx, leafIdx) = score;
+    ScoreTrain(tIdx, leafIdx) = score;
   }
 
 
@@ -213,15 +178,33 @@ class Leaf {
     return Extent(idx);
   }
 
-  inline unsigned int SCount(unsigned int idx) const {
-    return bagRow[idx].SCount();
+
+  /**
+     @brief Decodes the bagged rows and sample counts of a leaf.
+
+     @param bagOff is the leaf's offset, as computed by BagOffset().
+
+     @param extent is the leaf's extent.
+
+     @param row outputs the rows, if nonnull.
+
+     @param sCount outputs the sample counts, if nonnull.
+
+     @return sum of sample counts over the leaf.
+   */
+  inline unsigned int LeafDecode(size_t bagOff, unsigned int extent, unsigned int row[], unsigned int sCount[]) const {
+    const unsigned char *in = &bagPack[bagOff];
+    return BagPack::LeafDecode(in, extent, row, sCount);
   }
 };
 
 
 class LeafReg : public Leaf {
-  std::vector<unsigned int> &rank;
-  static void TreeExport(const std::vector<unsigned int> &_rank, unsigned int bagOrig, unsigned int bagCount, std::vector<unsigned int> &rankTree);
+  const unsigned int *rank; // Prediction:  packed sample ranks, by leaf.
+  const unsigned int rankWidth; // Bits per packed rank.
+  Crescent<unsigned int> *rankCresc; // Training:  appends to front-end ranks.
+
+  static unsigned int RankHeader(std::vector<unsigned int> &_rank);
 
   void Scores(const class Sample *sample, const std::vector<unsigned int> &leafMap, unsigned int leafCount, unsigned int tIdx);
 
@@ -237,7 +220,7 @@ class LeafReg : public Leaf {
      @return void, with side-effected leaf-node score.
   */
   void ScoreAccum(unsigned int tIdx, unsigned int leafIdx, double incr) {
-    Leaf::Score(tIdx, leafIdx) += incr;
+    ScoreTrain(tIdx, leafIdx) += incr;
   }
 
 
@@ -252,44 +235,44 @@ class LeafReg : public Leaf {
      @return void, with final leaf-node score.
   */
   inline void ScoreScale(unsigned int tIdx, unsigned int leafIdx, unsigned int sCount) {
-    Leaf::Score(tIdx, leafIdx) /= sCount;
+    ScoreTrain(tIdx, leafIdx) /= sCount;
   }
 
 
  public:
-  LeafReg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank);
+  LeafReg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank);
+  LeafReg(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[], const unsigned int _rank[]);
   ~LeafReg();
-  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<BagRow> &_bagRow, const std::vector<unsigned int> &_rank, std::vector<std::vector<unsigned int> >&rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> >&extentTree, std::vector< std::vector<unsigned int> > &rankTree);
+  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<unsigned char> &_bagPack, const std::vector<unsigned int> &_rank, std::vector<std::vector<unsigned int> >&rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> >&extentTree, std::vector< std::vector<unsigned int> > &rankTree);
   
   void Reserve(unsigned int leafEst, unsigned int bagEst);
+  void Finalize(unsigned int &segTot, unsigned int &reallocTot);
   void Leaves(const class Sample *sample, const std::vector<unsigned int> &leafMap, unsigned int tIdx);
-  void RankInit(unsigned int bagCount, unsigned int init);
-  void RankSet(unsigned int sOff, const class Sample *sample, unsigned int sIdx);
+  void Ranks(const class Sample *sample, const std::vector<unsigned int> &sOrder);
+  void RankOffset(std::vector<size_t> &rankOffset) const;
 
-  
-  /**
-     @brief Accessor for rank.
-   */
-  inline unsigned int Rank(unsigned int idx) const {
-    return rank[idx];
-  }
 
-  
   /**
-     @brief Computes sum of all bag sizes.
+     @brief Decodes the sample ranks of a leaf.
+
+     @param rankOff is the leaf's offset, as computed by RankOffset().
+
+     @param extent is the leaf's extent.
 
-     @return size of information vector, which represents all bagged samples.
+     @param rankLeaf outputs the ranks.
+
+     @return void, with output vector.
    */
-  inline unsigned int BagTot() const {
-    return rank.size();
+  inline void RankDecode(size_t rankOff, unsigned int extent, unsigned int rankLeaf[]) const {
+    BagPack::RankUnpack(rank, rankOff, rankWidth, extent, rankLeaf);
   }
-  
 };
 
 
 class LeafCtg : public Leaf {
-  std::vector<double> &weight;
-  unsigned int ctgWidth;
+  const double *weight; // Prediction:  category weights, by leaf.
+  Crescent<double> *weightCresc; // Training:  appends to front-end weights.
+  const unsigned int ctgWidth;
 
   static void TreeExport(const std::vector<double> &leafWeight, unsigned int _ctgWidth, unsigned int treeOffset, unsigned int leafCount, std::vector<double> &_weight);
   static unsigned int LeafCount(std::vector<unsigned int> _origin, unsigned int weightLen, unsigned int _ctgWidth, unsigned int tIdx);
@@ -305,21 +288,21 @@ class LeafCtg : public Leaf {
    */
   double &WeightSlot(unsigned int tIdx, unsigned int leafIdx, unsigned int ctg) {
     unsigned int idx = NodeIdx(tIdx, leafIdx);
-    return weight[ctgWidth * idx + ctg];
+    return (*weightCresc)[ctgWidth * idx + ctg];
   }
   
   void Scores(const class SampleCtg *sample, const std::vector<unsigned int> &leafMap, unsigned int leafCount, unsigned int tIdx);
  public:
-  LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight, unsigned int _ctgWdith);
-  LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight);
+  LeafCtg(std::vector<unsigned int> &_origin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight, unsigned int _ctgWdith);
+  LeafCtg(const unsigned int _origin[], unsigned int _nTree, const LeafNode _leafNode[], unsigned int _leafCount, const unsigned char _bagPack[], const double _weight[], unsigned int _ctgWidth);
   ~LeafCtg();
 
-  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<BagRow> &_bagRow, const std::vector<double> &_weight, unsigned int _ctgWidth, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> > &extentTree, std::vector<std::vector<double> > &_weightTree);
+  static void Export(const std::vector<unsigned int> &_origin, const std::vector<LeafNode> &_leafNode, const std::vector<unsigned char> &_bagPack, const std::vector<double> &_weight, unsigned int _ctgWidth, std::vector<std::vector<unsigned int> > &rowTree, std::vector<std::vector<unsigned int> > &sCountTree, std::vector<std::vector<double> > &scoreTree, std::vector<std::vector<unsigned int> > &extentTree, std::vector<std::vector<double> > &_weightTree);
 
   void Reserve(unsigned int leafEst, unsigned int bagEst);
+  void Finalize(unsigned int &segTot, unsigned int &reallocTot);
   
-  void RankInit(unsigned int bagCount, unsigned int init) {}
-  void RankSet(unsigned int sOff, const class Sample *sample, unsigned int sIdx) {}
+  void Ranks(const class Sample *, const std::vector<unsigned int> &) {}
 
   
   inline unsigned int CtgWidth() const {
@@ -333,7 +316,7 @@ class LeafCtg : public Leaf {
 
 
   inline void WeightInit(unsigned int leafCount) {
-    weight.insert(weight.end(), ctgWidth * leafCount, 0.0);
+    (void) weightCresc->Append(ctgWidth * leafCount, 0.0);
   }
 
 
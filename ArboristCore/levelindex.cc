@@ -0,0 +1,125 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file levelindex.cc
+
+   @brief Methods for hashed lookup of factor level names.
+
+   @author Mark Seligman
+ */
+
+#include "levelindex.h"
+
+#include <cstring>
+
+
+/**
+   @brief Constructs an empty index.
+
+   @param expect is a hint as to the eventual number of levels.
+ */
+LevelIndex::LevelIndex(unsigned int expect) {
+  unsigned int slotCount = 16;
+  while (slotCount < 2 * expect)
+    slotCount <<= 1;
+  slot = std::vector<unsigned int>(slotCount);
+  mask = slotCount - 1;
+}
+
+
+/**
+   @brief Indexes an existing level set, such as that seen in training.
+   Duplicated names resolve to their first position.
+ */
+LevelIndex::LevelIndex(const std::vector<std::string> &_level) : LevelIndex(_level.size()) {
+  for (auto name : _level) {
+    unsigned int hash = Hash(name.data(), name.size());
+    level.push_back(name);
+    levelHash.push_back(hash);
+    unsigned int pos = Probe(name.data(), name.size(), hash);
+    if (slot[pos] == 0)
+      slot[pos] = level.size();
+  }
+}
+
+
+/**
+   @brief FNV-1a over the name's bytes.
+ */
+unsigned int LevelIndex::Hash(const char *name, size_t len) {
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= (unsigned char) name[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+/**
+   @brief Linear probe for a name.
+
+   @return slot either holding the name or else empty.
+ */
+unsigned int LevelIndex::Probe(const char *name, size_t len, unsigned int hash) const {
+  unsigned int pos = hash & mask;
+  while (slot[pos] != 0) {
+    unsigned int idx = slot[pos] - 1;
+    if (levelHash[idx] == hash && level[idx].size() == len && memcmp(level[idx].data(), name, len) == 0)
+      break;
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+
+/**
+   @brief Doubles the slot count and reinserts.  Holds load below one
+   half.
+ */
+void LevelIndex::Grow() {
+  slot = std::vector<unsigned int>(2 * slot.size());
+  mask = slot.size() - 1;
+  for (unsigned int idx = 0; idx < level.size(); idx++) {
+    unsigned int pos = levelHash[idx] & mask;
+    while (slot[pos] != 0)
+      pos = (pos + 1) & mask;
+    slot[pos] = idx + 1;
+  }
+}
+
+
+/**
+   @brief Looks up a level by byte range.
+
+   @return position of level, or -1 if absent.
+ */
+int LevelIndex::Find(const char *name, size_t len) const {
+  unsigned int pos = Probe(name, len, Hash(name, len));
+  return int(slot[pos]) - 1;
+}
+
+
+/**
+   @brief Looks up a level, appending it if absent.
+
+   @return position of level.
+ */
+unsigned int LevelIndex::Insert(const char *name, size_t len) {
+  unsigned int hash = Hash(name, len);
+  unsigned int pos = Probe(name, len, hash);
+  if (slot[pos] != 0)
+    return slot[pos] - 1;
+
+  level.emplace_back(name, len);
+  levelHash.push_back(hash);
+  slot[pos] = level.size();
+  if (2 * level.size() > slot.size())
+    Grow();
+  return level.size() - 1;
+}
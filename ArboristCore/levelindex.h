@@ -0,0 +1,74 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file levelindex.h
+
+   @brief Hashed lookup of factor level names.
+
+   @author Mark Seligman
+ */
+
+#ifndef ARBORIST_LEVELINDEX_H
+#define ARBORIST_LEVELINDEX_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+/**
+   @brief Open-addressed index from level name to level position.
+
+   Lookup is by byte range, so that names are probed directly from
+   their source text without first being copied into strings.
+ */
+class LevelIndex {
+  std::vector<std::string> level; // Positional.
+  std::vector<unsigned int> levelHash; // Hash value of each level.
+  std::vector<unsigned int> slot; // One-based level position, zero iff empty.
+  unsigned int mask; // Slot count, less one.
+
+  static unsigned int Hash(const char *name, size_t len);
+  unsigned int Probe(const char *name, size_t len, unsigned int hash) const;
+  void Grow();
+
+ public:
+  LevelIndex(unsigned int expect = 16);
+  LevelIndex(const std::vector<std::string> &_level);
+
+  int Find(const char *name, size_t len) const;
+  unsigned int Insert(const char *name, size_t len);
+
+
+  /**
+     @brief Looks up a level by string.
+
+     @return position of level, or -1 if absent.
+   */
+  inline int Find(const std::string &name) const {
+    return Find(name.data(), name.size());
+  }
+
+
+  /**
+     @return count of levels indexed.
+   */
+  inline unsigned int Size() const {
+    return level.size();
+  }
+
+
+  /**
+     @return level names, in positional order.
+   */
+  inline const std::vector<std::string> &Levels() const {
+    return level;
+  }
+};
+
+#endif
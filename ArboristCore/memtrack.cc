@@ -0,0 +1,207 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file memtrack.cc
+
+   @brief Methods for accounting training memory by subsystem.
+
+   @author Mark Seligman
+ */
+
+#include "memtrack.h"
+
+#ifdef ARBORIST_MEMTRACK
+std::vector<size_t> MemTrack::current(subCount);
+std::vector<size_t> MemTrack::peak(subCount);
+std::vector<size_t> MemTrack::treePeak;
+std::vector<size_t> MemTrack::levelPeak;
+size_t MemTrack::total = 0;
+unsigned int MemTrack::depth = 0;
+bool MemTrack::treeOpen = false;
+bool MemTrack::suspended = false;
+const unsigned int MemTrack::subCount;
+
+
+/**
+   @brief Clears the tallies of any previous training.  Tallies survive
+   training, so that the front end may collect the report.
+
+   @return void.
+ */
+void MemTrack::Immutables() {
+  current.assign(subCount, 0);
+  peak.assign(subCount, 0);
+  treePeak.clear();
+  levelPeak.clear();
+  total = 0;
+  depth = 0;
+  treeOpen = false;
+  suspended = false;
+}
+
+
+/**
+   @brief Records an allocation.  Depth-first subtrees allocate while
+   training in parallel, so allocations are serialized.
+
+   @param sub is the subsystem tag.
+
+   @param bytes is the size of the allocation.
+
+   @return void.
+ */
+void MemTrack::Charge(unsigned int sub, size_t bytes) {
+#pragma omp critical(memTrack)
+  {
+    current[sub] += bytes;
+    total += bytes;
+    Mark();
+  }
+}
+
+
+/**
+   @brief Records a deallocation.
+
+   @param sub is the subsystem tag.
+
+   @param bytes is the size of the deallocation.
+
+   @return void.
+ */
+void MemTrack::Release(unsigned int sub, size_t bytes) {
+#pragma omp critical(memTrack)
+  {
+    bytes = bytes < current[sub] ? bytes : current[sub];
+    current[sub] -= bytes;
+    total -= bytes;
+  }
+}
+
+
+/**
+   @brief Raises the high-water marks to the current footprint.
+
+   @return void.
+ */
+void MemTrack::Mark() {
+  for (unsigned int sub = 0; sub < subCount; sub++) {
+    if (current[sub] > peak[sub])
+      peak[sub] = current[sub];
+  }
+  if (treeOpen) {
+    if (total > treePeak.back())
+      treePeak.back() = total;
+    if (total > levelPeak[depth])
+      levelPeak[depth] = total;
+  }
+}
+
+
+/**
+   @brief Opens the accounting window of the next tree.  Trees are
+   trained in order, so the window's position is the tree's index.
+
+   @return void.
+ */
+void MemTrack::Tree() {
+  treePeak.push_back(total);
+  treeOpen = true;
+  Level(0);
+}
+
+
+/**
+   @brief Closes the accounting window of the current tree.  Storage
+   grown in consuming the tree is charged only to its subsystem.
+
+   @return void.
+ */
+void MemTrack::TreeEnd() {
+  treeOpen = false;
+}
+
+
+/**
+   @brief Notes the depth of the level about to be trained.
+
+   @param _depth is the level's depth within its tree.
+
+   @return void.
+ */
+void MemTrack::Level(unsigned int _depth) {
+  if (suspended)
+    return;
+
+  depth = _depth;
+  if (depth >= levelPeak.size())
+    levelPeak.resize(depth + 1, 0);
+  Mark();
+}
+
+
+/**
+   @brief Ignores level notices until resumed, as while subtrees train
+   in parallel.  Their storage is charged at the depth of the parent's
+   level.
+
+   @return void.
+ */
+void MemTrack::Suspend() {
+  suspended = true;
+}
+
+
+void MemTrack::Resume() {
+  suspended = false;
+}
+#endif
+
+
+/**
+   @brief Names a subsystem, for reporting.
+
+   @param sub is the subsystem tag.
+
+   @return subsystem name.
+ */
+const char *MemTrack::SubName(unsigned int sub) {
+  static const char *subName[subCount] = {"samplePred", "bottom", "preTree", "forest", "leaf", "rowRank"};
+
+  return sub < subCount ? subName[sub] : "";
+}
+
+
+/**
+   @brief Reports the tallies of the most recent training.  Reports are
+   empty unless accounting has been compiled in.
+
+   @param _current outputs bytes still held, by subsystem.
+
+   @param _peak outputs high-water bytes, by subsystem.
+
+   @param _treePeak outputs the high-water total within each tree.
+
+   @param _levelPeak outputs the high-water total at each depth, over
+   all trees.
+
+   @return void, with output reference parameters.
+ */
+void MemTrack::Report(std::vector<size_t> &_current, std::vector<size_t> &_peak, std::vector<size_t> &_treePeak, std::vector<size_t> &_levelPeak) {
+#ifdef ARBORIST_MEMTRACK
+  _current = current;
+  _peak = peak;
+  _treePeak = treePeak;
+  _levelPeak = levelPeak;
+#else
+  _current.clear();
+  _peak.clear();
+  _treePeak.clear();
+  _levelPeak.clear();
+#endif
+}
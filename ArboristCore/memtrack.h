@@ -0,0 +1,103 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file memtrack.h
+
+   @brief Accounting of training memory by subsystem.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_MEMTRACK_H
+#define ARBORIST_MEMTRACK_H
+
+#include <vector>
+#include <cstddef>
+
+
+/**
+   @brief Tallies the bytes held by the principal training structures,
+   recording current and high-water footprints for each subsystem, as
+   well as the high-water total reached within each tree and at each
+   tree depth.
+
+   Accounting is compiled in only when ARBORIST_MEMTRACK is defined.
+   Otherwise the charging methods are empty inlines and the report is
+   empty, so that instrumented call sites cost nothing.
+ */
+class MemTrack {
+#ifdef ARBORIST_MEMTRACK
+  static std::vector<size_t> current; // Bytes held, by subsystem.
+  static std::vector<size_t> peak; // High-water bytes, by subsystem.
+  static std::vector<size_t> treePeak; // High-water total, by tree.
+  static std::vector<size_t> levelPeak; // High-water total, by depth.
+  static size_t total; // Bytes held across subsystems.
+  static unsigned int depth; // Depth of the level under training.
+  static bool treeOpen; // Whether a tree is under training.
+  static bool suspended; // Whether level notices are ignored.
+
+  static void Mark();
+#endif
+
+ public:
+  // Subsystem tags.
+  static const unsigned int samplePred = 0; // Staged sample buffers.
+  static const unsigned int bottom = 1; // Restaging bit matrices.
+  static const unsigned int preTree = 2; // Pooled pretrees.
+  static const unsigned int forest = 3; // Forest nodes and factor splits.
+  static const unsigned int leaf = 4; // Leaf nodes, bags and scores.
+  static const unsigned int rowRank = 5; // Predictor rank blocks.
+  static const unsigned int subCount = 6;
+
+  static const char *SubName(unsigned int sub);
+  static void Report(std::vector<size_t> &_current, std::vector<size_t> &_peak, std::vector<size_t> &_treePeak, std::vector<size_t> &_levelPeak);
+
+#ifdef ARBORIST_MEMTRACK
+  static void Immutables();
+  static void Charge(unsigned int sub, size_t bytes);
+  static void Release(unsigned int sub, size_t bytes);
+  static void Tree();
+  static void Level(unsigned int _depth);
+  static void TreeEnd();
+  static void Suspend();
+  static void Resume();
+#else
+  static inline void Immutables() {}
+  static inline void Charge(unsigned int, size_t) {}
+  static inline void Release(unsigned int, size_t) {}
+  static inline void Tree() {}
+  static inline void Level(unsigned int) {}
+  static inline void TreeEnd() {}
+  static inline void Suspend() {}
+  static inline void Resume() {}
+#endif
+
+
+  /**
+     @brief Charges or releases the change in a footprint.
+
+     @param sub is the subsystem tag.
+
+     @param bytesPrev is the footprint last accounted.
+
+     @param bytes is the new footprint.
+
+     @return new footprint, to be retained by caller.
+   */
+  static inline size_t Resize(unsigned int sub, size_t bytesPrev, size_t bytes) {
+    if (bytes > bytesPrev)
+      Charge(sub, bytes - bytesPrev);
+    else if (bytes < bytesPrev)
+      Release(sub, bytesPrev - bytes);
+
+    return bytes;
+  }
+};
+
+#endif
@@ -0,0 +1,432 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file modelmap.cc
+
+   @brief Methods for saving and loading the binary model format.
+
+   @author Mark Seligman
+ */
+
+#include "modelmap.h"
+#include "forest.h"
+#include "leaf.h"
+#include "facremap.h"
+
+#include <cstdio>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#define ARBORIST_MODELMAP_MMAP
+#include <sys/mman.h>
+#endif
+
+const char ModelMap::magic[8] = {'A', 'R', 'B', 'M', 'O', 'D', 'E', 'L'};
+
+
+/**
+   @brief Private constructor:  sections are located by Validate().
+ */
+ModelMap::ModelMap(const unsigned char *_base, size_t _bytes, bool _mapped) : base(_base), bytes(_bytes), mapped(_mapped), header(reinterpret_cast<const Header *>(_base)), facRemap(0) {
+  for (unsigned int tag = 0; tag < tagCount; tag++) {
+    sectionBase[tag] = 0;
+    sectionCount[tag] = 0;
+  }
+}
+
+
+ModelMap::~ModelMap() {
+  delete facRemap;
+#ifdef ARBORIST_MODELMAP_MMAP
+  if (mapped) {
+    munmap(const_cast<unsigned char *>(base), bytes);
+    return;
+  }
+#endif
+  delete [] base;
+}
+
+
+/**
+   @brief Expected element size of each section.
+
+   @param tag is the section tag.
+
+   @return element size, in bytes.
+ */
+unsigned int ModelMap::ElemSize(unsigned int tag) {
+  switch (tag) {
+  case forestNodeTag:
+    return sizeof(ForestNode);
+  case leafNodeTag:
+    return sizeof(LeafNode);
+  case bagPackTag:
+  case predLevelTag:
+  case ctgLevelTag:
+    return sizeof(char);
+  case yRankedTag:
+  case weightTag:
+    return sizeof(double);
+  default:
+    return sizeof(unsigned int);
+  }
+}
+
+
+/**
+   @brief Saves a trained regression forest.
+
+   @param rowTrain is the number of rows used in training.
+
+   @param predMap gives the front-end position of each core predictor.
+
+   @param facCard gives the training cardinality of each factor.
+
+   @param predLevel concatenates the level names of each factor.
+
+   @return true iff file written in full.
+ */
+bool ModelMap::SaveReg(const char *path, unsigned int nPredNum, unsigned int nPredFac, unsigned int rowTrain, const std::vector<ForestNode> &forestNode, const std::vector<unsigned int> &origin, const std::vector<unsigned int> &facOrigin, const std::vector<unsigned int> &facSplit, const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, const std::vector<unsigned int> &rank, const std::vector<double> &yRanked, const std::vector<unsigned int> &predMap, const std::vector<unsigned int> &facCard, const std::vector<std::string> &predLevel) {
+  Header hdr;
+  hdr.nTree = origin.size();
+  hdr.nPredNum = nPredNum;
+  hdr.nPredFac = nPredFac;
+  hdr.nRowTrain = rowTrain;
+  hdr.ctgWidth = 0;
+
+  std::vector<char> predText;
+  Levels(predLevel, predText);
+  std::vector<Pending> pending = {
+    {forestNodeTag, ElemSize(forestNodeTag), forestNode.size(), forestNode.data()},
+    {originTag, ElemSize(originTag), origin.size(), origin.data()},
+    {facOriginTag, ElemSize(facOriginTag), facOrigin.size(), facOrigin.data()},
+    {facSplitTag, ElemSize(facSplitTag), facSplit.size(), facSplit.data()},
+    {leafOriginTag, ElemSize(leafOriginTag), leafOrigin.size(), leafOrigin.data()},
+    {leafNodeTag, ElemSize(leafNodeTag), leafNode.size(), leafNode.data()},
+    {bagPackTag, ElemSize(bagPackTag), bagPack.size(), bagPack.data()},
+    {rankTag, ElemSize(rankTag), rank.size(), rank.data()},
+    {yRankedTag, ElemSize(yRankedTag), yRanked.size(), yRanked.data()},
+    {predMapTag, ElemSize(predMapTag), predMap.size(), predMap.data()},
+    {facCardTag, ElemSize(facCardTag), facCard.size(), facCard.data()},
+    {predLevelTag, ElemSize(predLevelTag), predText.size(), predText.data()}
+  };
+
+  return Save(path, hdr, pending);
+}
+
+
+/**
+   @brief Saves a trained classification forest.
+
+   @param weight holds the per-category weights of each leaf.
+
+   @param ctgLevel names the response categories, in core order.
+
+   @return true iff file written in full.
+ */
+bool ModelMap::SaveCtg(const char *path, unsigned int nPredNum, unsigned int nPredFac, unsigned int rowTrain, const std::vector<ForestNode> &forestNode, const std::vector<unsigned int> &origin, const std::vector<unsigned int> &facOrigin, const std::vector<unsigned int> &facSplit, const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, const std::vector<double> &weight, const std::vector<unsigned int> &predMap, const std::vector<unsigned int> &facCard, const std::vector<std::string> &predLevel, const std::vector<std::string> &ctgLevel) {
+  if (leafNode.empty())
+    return false;
+
+  Header hdr;
+  hdr.nTree = origin.size();
+  hdr.nPredNum = nPredNum;
+  hdr.nPredFac = nPredFac;
+  hdr.nRowTrain = rowTrain;
+  hdr.ctgWidth = weight.size() / leafNode.size();
+
+  std::vector<char> predText, ctgText;
+  Levels(predLevel, predText);
+  Levels(ctgLevel, ctgText);
+  std::vector<Pending> pending = {
+    {forestNodeTag, ElemSize(forestNodeTag), forestNode.size(), forestNode.data()},
+    {originTag, ElemSize(originTag), origin.size(), origin.data()},
+    {facOriginTag, ElemSize(facOriginTag), facOrigin.size(), facOrigin.data()},
+    {facSplitTag, ElemSize(facSplitTag), facSplit.size(), facSplit.data()},
+    {leafOriginTag, ElemSize(leafOriginTag), leafOrigin.size(), leafOrigin.data()},
+    {leafNodeTag, ElemSize(leafNodeTag), leafNode.size(), leafNode.data()},
+    {bagPackTag, ElemSize(bagPackTag), bagPack.size(), bagPack.data()},
+    {weightTag, ElemSize(weightTag), weight.size(), weight.data()},
+    {predMapTag, ElemSize(predMapTag), predMap.size(), predMap.data()},
+    {facCardTag, ElemSize(facCardTag), facCard.size(), facCard.data()},
+    {predLevelTag, ElemSize(predLevelTag), predText.size(), predText.data()},
+    {ctgLevelTag, ElemSize(ctgLevelTag), ctgText.size(), ctgText.data()}
+  };
+
+  return Save(path, hdr, pending);
+}
+
+
+/**
+   @brief Concatenates level names, each terminated by a null.
+
+   @return void, with output reference vector.
+ */
+void ModelMap::Levels(const std::vector<std::string> &level, std::vector<char> &text) {
+  for (auto & name : level) {
+    text.insert(text.end(), name.begin(), name.end());
+    text.push_back('\0');
+  }
+}
+
+
+/**
+   @brief Lays out and writes the header, section table and sections.
+
+   @param hdr has its model fields set by the caller.
+
+   @param pending lists the sections in order of output.
+
+   @return true iff file written in full.
+ */
+bool ModelMap::Save(const char *path, Header &hdr, std::vector<Pending> &pending) {
+  memcpy(hdr.magic, magic, sizeof(hdr.magic));
+  hdr.version = version;
+  hdr.byteOrder = byteOrder;
+  hdr.nodeSize = sizeof(ForestNode);
+  hdr.leafSize = sizeof(LeafNode);
+  hdr.sectionCount = pending.size();
+  for (unsigned int i = 0; i < sizeof(hdr.reserved) / sizeof(hdr.reserved[0]); i++)
+    hdr.reserved[i] = 0;
+
+  std::vector<Section> table(pending.size());
+  size_t offset = sizeof(Header) + table.size() * sizeof(Section);
+  for (unsigned int i = 0; i < pending.size(); i++) {
+    offset = sectionAlign * ((offset + sectionAlign - 1) / sectionAlign);
+    table[i].tag = pending[i].tag;
+    table[i].elemSize = pending[i].elemSize;
+    table[i].offset = offset;
+    table[i].count = pending[i].count;
+    offset += pending[i].count * pending[i].elemSize;
+  }
+
+  FILE *file = fopen(path, "wb");
+  if (file == 0)
+    return false;
+
+  bool ok = fwrite(&hdr, sizeof(Header), 1, file) == 1;
+  ok = ok && fwrite(table.data(), sizeof(Section), table.size(), file) == table.size();
+  size_t written = sizeof(Header) + table.size() * sizeof(Section);
+  static const unsigned char pad[sectionAlign] = {0};
+  for (unsigned int i = 0; ok && i < pending.size(); i++) {
+    ok = fwrite(pad, 1, table[i].offset - written, file) == table[i].offset - written;
+    size_t len = pending[i].count * pending[i].elemSize;
+    ok = ok && (len == 0 || fwrite(pending[i].data, 1, len, file) == len);
+    written = table[i].offset + len;
+  }
+
+  return fclose(file) == 0 && ok;
+}
+
+
+/**
+   @brief Loads a saved model, mapping the file if possible.
+
+   @param path is the file's path.
+
+   @param doMap is false to read the file onto the heap instead.
+
+   @return loaded model, or null if file unreadable or malformed.
+ */
+ModelMap *ModelMap::Load(const char *path, bool doMap) {
+  FILE *file = fopen(path, "rb");
+  if (file == 0)
+    return 0;
+
+  long fileLen = -1;
+  if (fseek(file, 0, SEEK_END) == 0)
+    fileLen = ftell(file);
+  if (fileLen < long(sizeof(Header))) {
+    fclose(file);
+    return 0;
+  }
+  size_t len = fileLen;
+
+  const unsigned char *fileBase = 0;
+  bool isMapped = false;
+#ifdef ARBORIST_MODELMAP_MMAP
+  if (doMap) {
+    void *addr = mmap(0, len, PROT_READ, MAP_SHARED, fileno(file), 0);
+    if (addr != MAP_FAILED) {
+      fileBase = static_cast<const unsigned char *>(addr);
+      isMapped = true;
+    }
+  }
+#endif
+  if (!isMapped) {
+    unsigned char *buf = new unsigned char[len];
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(buf, 1, len, file) != len) {
+      delete [] buf;
+      fclose(file);
+      return 0;
+    }
+    fileBase = buf;
+  }
+  fclose(file); // Mapping retains the file.
+
+  ModelMap *model = new ModelMap(fileBase, len, isMapped);
+  if (!model->Validate()) {
+    delete model;
+    return 0;
+  }
+  if (model->NPredFac() > 0) { // Levels must tally with cardinalities.
+    std::vector<std::string> predLevel;
+    model->PredLevel(predLevel);
+    size_t cardTot = 0;
+    for (unsigned int facIdx = 0; facIdx < model->NPredFac(); facIdx++)
+      cardTot += model->FacCard()[facIdx];
+    if (cardTot != predLevel.size()) {
+      delete model;
+      return 0;
+    }
+    model->facRemap = new FacRemap(predLevel, model->FacCard(), model->NPredFac());
+  }
+
+  return model;
+}
+
+
+/**
+   @brief Checks the header and section table against the file, and
+   locates the sections.  Only structure is checked:  the cost is
+   independent of forest size.
+
+   @return true iff structurally sound.
+ */
+bool ModelMap::Validate() {
+  if (memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version || header->byteOrder != byteOrder || header->nodeSize != sizeof(ForestNode) || header->leafSize != sizeof(LeafNode))
+    return false;
+  if (header->nTree == 0 || header->sectionCount > tagCount || sizeof(Header) + header->sectionCount * sizeof(Section) > bytes)
+    return false;
+
+  const Section *table = reinterpret_cast<const Section *>(base + sizeof(Header));
+  for (unsigned int i = 0; i < header->sectionCount; i++) {
+    const Section &sec = table[i];
+    if (sec.tag >= tagCount || sectionBase[sec.tag] != 0 || sec.elemSize != ElemSize(sec.tag))
+      return false;
+    if (sec.offset % sectionAlign != 0 || sec.offset > bytes || sec.count > (bytes - sec.offset) / sec.elemSize)
+      return false;
+    sectionBase[sec.tag] = base + sec.offset;
+    sectionCount[sec.tag] = sec.count;
+  }
+
+  bool isReg = IsRegression();
+  for (unsigned int tag = 0; tag < tagCount; tag++) {
+    bool required = (tag != rankTag && tag != yRankedTag && tag != weightTag && tag != ctgLevelTag) || (isReg == (tag == rankTag || tag == yRankedTag));
+    if (required && sectionBase[tag] == 0)
+      return false;
+  }
+
+  unsigned int nTree = header->nTree;
+  if (sectionCount[originTag] != nTree || sectionCount[facOriginTag] != nTree || sectionCount[leafOriginTag] != nTree)
+    return false;
+  if (sectionCount[predMapTag] != size_t(header->nPredNum) + header->nPredFac || sectionCount[facCardTag] != header->nPredFac)
+    return false;
+  if (isReg) {
+    const unsigned int *rank = Sec<unsigned int>(rankTag);
+    if (sectionCount[rankTag] == 0 || rank[0] == 0 || rank[0] > 8 * sizeof(unsigned int) || sectionCount[yRankedTag] != header->nRowTrain)
+      return false;
+  }
+  else if (sectionCount[weightTag] != sectionCount[leafNodeTag] * header->ctgWidth) {
+    return false;
+  }
+
+  // Origins must be nondecreasing and lie within their vectors.
+  const unsigned int origTag[3] = {originTag, facOriginTag, leafOriginTag};
+  const unsigned int vecTag[3] = {forestNodeTag, facSplitTag, leafNodeTag};
+  for (unsigned int k = 0; k < 3; k++) {
+    const unsigned int *orig = Sec<unsigned int>(origTag[k]);
+    for (unsigned int tIdx = 0; tIdx < nTree; tIdx++) {
+      unsigned int origSup = tIdx + 1 < nTree ? orig[tIdx + 1] : sectionCount[vecTag[k]];
+      if (orig[tIdx] > origSup)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+   @brief Builds a forest reading directly from the model's sections.
+
+   @return forest, to be deleted by caller.
+ */
+Forest *ModelMap::ForestFactory() const {
+  return new Forest(Sec<ForestNode>(forestNodeTag), Sec<unsigned int>(originTag), NTree(), Sec<unsigned int>(facOriginTag), Sec<unsigned int>(facSplitTag), sectionCount[facSplitTag]);
+}
+
+
+/**
+   @brief Builds regression leaves reading directly from the model's
+   sections.
+
+   @return leaves, to be deleted by caller, or null if not regression.
+ */
+LeafReg *ModelMap::LeafRegFactory() const {
+  if (!IsRegression())
+    return 0;
+
+  return new LeafReg(Sec<unsigned int>(leafOriginTag), NTree(), Sec<LeafNode>(leafNodeTag), sectionCount[leafNodeTag], Sec<unsigned char>(bagPackTag), Sec<unsigned int>(rankTag));
+}
+
+
+/**
+   @brief Builds classification leaves reading directly from the model's
+   sections.
+
+   @return leaves, to be deleted by caller, or null if not classification.
+ */
+LeafCtg *ModelMap::LeafCtgFactory() const {
+  if (IsRegression())
+    return 0;
+
+  return new LeafCtg(Sec<unsigned int>(leafOriginTag), NTree(), Sec<LeafNode>(leafNodeTag), sectionCount[leafNodeTag], Sec<unsigned char>(bagPackTag), Sec<double>(weightTag), CtgWidth());
+}
+
+
+/**
+   @brief Splits a section of null-terminated names.
+
+   @return void, with output reference vector.
+ */
+void ModelMap::Levels(unsigned int tag, std::vector<std::string> &level) const {
+  level.clear();
+  const char *text = Sec<char>(tag);
+  size_t len = sectionCount[tag];
+  size_t start = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (text[i] == '\0') {
+      level.push_back(std::string(text + start, i - start));
+      start = i + 1;
+    }
+  }
+}
+
+
+/**
+   @brief Recovers the factor level names, concatenated over factors in
+   core order.  Each factor contributes its training cardinality.
+
+   @return void, with output reference vector.
+ */
+void ModelMap::PredLevel(std::vector<std::string> &predLevel) const {
+  Levels(predLevelTag, predLevel);
+}
+
+
+/**
+   @brief Recovers the response category names.
+
+   @return void, with output reference vector.
+ */
+void ModelMap::CtgLevel(std::vector<std::string> &ctgLevel) const {
+  if (IsRegression())
+    ctgLevel.clear();
+  else
+    Levels(ctgLevelTag, ctgLevel);
+}
@@ -0,0 +1,237 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file modelmap.h
+
+   @brief Versioned binary model format, readable in place.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_MODELMAP_H
+#define ARBORIST_MODELMAP_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+   @brief Trained forest, leaves and predictor signature, saved as a
+   single file in the native layout of the core's own structures.
+
+   The file consists of a fixed header, a table of sections and the
+   sections themselves, each aligned to a 64-byte boundary.  Sections
+   hold the front-end vectors verbatim, so that a loaded model is
+   predicted upon directly from the file's pages:  loading maps the
+   file and checks its structure, but neither parses nor copies the
+   trees.  Where mapping is unavailable, the file is read onto the heap
+   as a single block.
+
+   Files are tied to the byte order and structure layout of the build
+   writing them, and are rejected elsewhere.
+ */
+class ModelMap {
+  static const char magic[8];
+  static const unsigned int version = 1;
+  static const unsigned int byteOrder = 0x01020304;
+  static const size_t sectionAlign = 64;
+
+  // Section tags.
+  static const unsigned int forestNodeTag = 0;
+  static const unsigned int originTag = 1;
+  static const unsigned int facOriginTag = 2;
+  static const unsigned int facSplitTag = 3;
+  static const unsigned int leafOriginTag = 4;
+  static const unsigned int leafNodeTag = 5;
+  static const unsigned int bagPackTag = 6;
+  static const unsigned int rankTag = 7; // Regression only.
+  static const unsigned int yRankedTag = 8; // Regression only.
+  static const unsigned int weightTag = 9; // Classification only.
+  static const unsigned int predMapTag = 10;
+  static const unsigned int facCardTag = 11;
+  static const unsigned int predLevelTag = 12;
+  static const unsigned int ctgLevelTag = 13;
+  static const unsigned int tagCount = 14;
+
+  /**
+     @brief Fixed-width file header.
+   */
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeSize; // sizeof(ForestNode) of writer.
+    uint32_t leafSize; // sizeof(LeafNode) of writer.
+    uint32_t nTree;
+    uint32_t nPredNum;
+    uint32_t nPredFac;
+    uint32_t nRowTrain;
+    uint32_t ctgWidth; // Zero iff regression.
+    uint32_t sectionCount;
+    uint32_t reserved[4];
+  };
+
+  /**
+     @brief Section table entry.
+   */
+  struct Section {
+    uint32_t tag;
+    uint32_t elemSize;
+    uint64_t offset; // From start of file.
+    uint64_t count; // Elements.
+  };
+
+  /**
+     @brief Section contents awaiting output.
+   */
+  struct Pending {
+    unsigned int tag;
+    unsigned int elemSize;
+    size_t count;
+    const void *data;
+  };
+
+  const unsigned char *base;
+  const size_t bytes;
+  const bool mapped; // Whether 'base' is a file mapping.
+  const Header *header;
+  const unsigned char *sectionBase[tagCount]; // Null iff absent.
+  size_t sectionCount[tagCount];
+  class FacRemap *facRemap; // Training levels, indexed on load.
+
+  ModelMap(const unsigned char *_base, size_t _bytes, bool _mapped);
+  bool Validate();
+  static unsigned int ElemSize(unsigned int tag);
+  static bool Save(const char *path, Header &hdr, std::vector<Pending> &pending);
+  static void Levels(const std::vector<std::string> &level, std::vector<char> &text);
+  void Levels(unsigned int tag, std::vector<std::string> &level) const;
+
+
+  /**
+     @brief Typed accessor for section contents.
+
+     @param tag is the section tag.
+
+     @return base of section.
+   */
+  template<typename T> inline const T *Sec(unsigned int tag) const {
+    return reinterpret_cast<const T *>(sectionBase[tag]);
+  }
+
+ public:
+  ~ModelMap();
+
+  static bool SaveReg(const char *path, unsigned int nPredNum, unsigned int nPredFac, unsigned int rowTrain, const std::vector<class ForestNode> &forestNode, const std::vector<unsigned int> &origin, const std::vector<unsigned int> &facOrigin, const std::vector<unsigned int> &facSplit, const std::vector<unsigned int> &leafOrigin, const std::vector<class LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, const std::vector<unsigned int> &rank, const std::vector<double> &yRanked, const std::vector<unsigned int> &predMap, const std::vector<unsigned int> &facCard, const std::vector<std::string> &predLevel);
+
+  static bool SaveCtg(const char *path, unsigned int nPredNum, unsigned int nPredFac, unsigned int rowTrain, const std::vector<ForestNode> &forestNode, const std::vector<unsigned int> &origin, const std::vector<unsigned int> &facOrigin, const std::vector<unsigned int> &facSplit, const std::vector<unsigned int> &leafOrigin, const std::vector<LeafNode> &leafNode, const std::vector<unsigned char> &bagPack, const std::vector<double> &weight, const std::vector<unsigned int> &predMap, const std::vector<unsigned int> &facCard, const std::vector<std::string> &predLevel, const std::vector<std::string> &ctgLevel);
+
+  static ModelMap *Load(const char *path, bool doMap = true);
+
+  class Forest *ForestFactory() const;
+  class LeafReg *LeafRegFactory() const;
+  class LeafCtg *LeafCtgFactory() const;
+
+  void PredLevel(std::vector<std::string> &predLevel) const;
+  void CtgLevel(std::vector<std::string> &ctgLevel) const;
+
+
+  /**
+     @return true iff model is of regression type.
+   */
+  inline bool IsRegression() const {
+    return header->ctgWidth == 0;
+  }
+
+
+  /**
+     @return true iff contents are read from a file mapping.
+   */
+  inline bool Mapped() const {
+    return mapped;
+  }
+
+
+  /**
+     @return size of the model, in bytes.
+   */
+  inline size_t Bytes() const {
+    return bytes;
+  }
+
+
+  inline unsigned int NTree() const {
+    return header->nTree;
+  }
+
+
+  inline unsigned int NPredNum() const {
+    return header->nPredNum;
+  }
+
+
+  inline unsigned int NPredFac() const {
+    return header->nPredFac;
+  }
+
+
+  /**
+     @return number of rows used in training.
+   */
+  inline unsigned int NRowTrain() const {
+    return header->nRowTrain;
+  }
+
+
+  /**
+     @return count of response categories:  zero iff regression.
+   */
+  inline unsigned int CtgWidth() const {
+    return header->ctgWidth;
+  }
+
+
+  /**
+     @brief Accessor for the training response, by rank.  Regression only.
+   */
+  inline const double *YRanked() const {
+    return Sec<double>(yRankedTag);
+  }
+
+
+  /**
+     @brief Accessor for the front-end position of each core predictor.
+     Numeric predictors precede factors.
+   */
+  inline const unsigned int *PredMap() const {
+    return Sec<unsigned int>(predMapTag);
+  }
+
+
+  /**
+     @brief Accessor for the training cardinality of each factor.
+   */
+  inline const unsigned int *FacCard() const {
+    return Sec<unsigned int>(facCardTag);
+  }
+
+
+  /**
+     @brief Accessor for the training level index, for remapping factors
+     at prediction.
+
+     @return level index, or null if no factors.
+   */
+  inline const FacRemap *Remap() const {
+    return facRemap;
+  }
+};
+
+#endif
@@ -0,0 +1,113 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file philox.cc
+
+   @brief Methods for counter-based generation of uniform variates.
+
+   @author Mark Seligman
+ */
+
+#include "philox.h"
+
+unsigned int Philox::key[2] = {0, 0};
+
+
+/**
+   @brief Keys the generator from the training seed.
+
+   @param seed is the training seed.
+
+   @return void.
+ */
+void Philox::Immutables(unsigned int seed) {
+  key[0] = seed;
+  key[1] = 0;
+}
+
+
+/**
+   @brief Finalizer.
+
+   @return void.
+ */
+void Philox::DeImmutables() {
+  key[0] = key[1] = 0;
+}
+
+
+/**
+   @brief Applies ten rounds of the keyed bijection to a counter.
+
+   @param ctr is the counter.
+
+   @param out outputs four 32-bit words.
+
+   @return void, with output parameter vector.
+ */
+void Philox::Block(const unsigned int ctr[4], unsigned int out[4]) {
+  const unsigned long long mult0 = 0xD2511F53ull;
+  const unsigned long long mult1 = 0xCD9E8D57ull;
+  unsigned int x0 = ctr[0];
+  unsigned int x1 = ctr[1];
+  unsigned int x2 = ctr[2];
+  unsigned int x3 = ctr[3];
+  unsigned int k0 = key[0];
+  unsigned int k1 = key[1];
+  for (int round = 0; round < 10; round++) {
+    unsigned long long prod0 = mult0 * x0;
+    unsigned long long prod1 = mult1 * x2;
+    x0 = (unsigned int) (prod1 >> 32) ^ x1 ^ k0;
+    x1 = (unsigned int) prod1;
+    x2 = (unsigned int) (prod0 >> 32) ^ x3 ^ k1;
+    x3 = (unsigned int) prod0;
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  out[0] = x0;
+  out[1] = x1;
+  out[2] = x2;
+  out[3] = x3;
+}
+
+
+/**
+   @brief Fills a stream of uniform variates on the open unit interval,
+   at 32-bit resolution.
+
+   @param tIdx is the absolute index of the tree.
+
+   @param levelSeq is the level's position in the tree's training
+   sequence.
+
+   @param purpose tags the use to which the variates are put.
+
+   @param len is the number of variates to generate.
+
+   @param out outputs the variates.
+
+   @return void, with output parameter vector.
+ */
+void Philox::Uniform(unsigned int tIdx, unsigned int levelSeq, unsigned int purpose, size_t len, double out[]) {
+  const double recip32 = 1.0 / 4294967296.0;
+  int blockCount = int((len + 3) / 4);
+  int blockIdx;
+#pragma omp parallel default(shared) private(blockIdx) if (blockCount > 0x4000)
+  {
+#pragma omp for schedule(static)
+  for (blockIdx = 0; blockIdx < blockCount; blockIdx++) {
+    unsigned int ctr[4] = {(unsigned int) blockIdx, levelSeq, tIdx, purpose};
+    unsigned int word[4];
+    Block(ctr, word);
+    size_t base = size_t(blockIdx) * 4;
+    for (size_t i = base; i < len && i < base + 4; i++) {
+      out[i] = (word[i - base] + 0.5) * recip32;
+    }
+  }
+  }
+}
@@ -0,0 +1,52 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file philox.h
+
+   @brief Counter-based generation of uniform variates.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_PHILOX_H
+#define ARBORIST_PHILOX_H
+
+#include <cstddef>
+
+
+/**
+   @brief Philox4x32-10 generator, after Salmon et al., "Parallel random
+   numbers:  as easy as 1, 2, 3" (SC '11).
+
+   Each block of four variates is a keyed bijection of its counter,
+   with no state carried between blocks.  The key derives from the
+   training seed, while the counter names the variate's position:  the
+   tree, the level sequence within the tree, the purpose to which the
+   variates are put and the block offset within the stream.  Variates
+   therefore depend only upon the seed and their position, and not upon
+   the order or the thread in which they are drawn.
+ */
+class Philox {
+  static unsigned int key[2];
+
+  static void Block(const unsigned int ctr[4], unsigned int out[4]);
+
+ public:
+  // Stream purposes.
+  static const unsigned int sample = 0; // Row sampling.
+  static const unsigned int predSelect = 1; // Splitting predictors.
+  static const unsigned int mono = 2; // Monotone constraints.
+  static const unsigned int runWide = 3; // Wide factor runs.
+
+  static void Immutables(unsigned int seed);
+  static void DeImmutables();
+  static void Uniform(unsigned int tIdx, unsigned int levelSeq, unsigned int purpose, size_t len, double out[]);
+};
+
+#endif
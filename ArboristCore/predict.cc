@@ -18,6 +18,7 @@
 #include "leaf.h"
 #include "predict.h"
 #include "quant.h"
+#include "modelmap.h"
 #include "bv.h"
 
 #include <cfloat>
@@ -29,20 +30,48 @@
 /**
    @brief Static entry for regression case.
  */
-void Predict::Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, unsigned int bagTrain) {
-  int nTree = _origin.size();
+void Predict::Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, unsigned int bagTrain) {
+  unsigned int nTree = _origin.size();
+  Forest *forest = new Forest(_forestNode.data(), _origin.data(), nTree, _facOff.data(), _facSplit.data(), _facSplit.size());
+  LeafReg *leafReg = new LeafReg(_leafOrigin.data(), nTree, _leafNode.data(), _leafNode.size(), _bagPack.data(), _rank.data());
+  Regression(_blockNumT, _blockFacT, _nPredNum, _nPredFac, forest, leafReg, yRanked.data(), yRanked.size(), yPred, bagTrain);
+
+  delete forest;
+  delete leafReg;
+}
+
+
+/**
+   @brief Static entry for regression over a mapped model.
+ */
+void Predict::Regression(const ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<double> &yPred, unsigned int bagTrain) {
+  Forest *forest = model->ForestFactory();
+  LeafReg *leafReg = model->LeafRegFactory();
+  Regression(_blockNumT, _blockFacT, model->NPredNum(), model->NPredFac(), forest, leafReg, model->YRanked(), model->NRowTrain(), yPred, bagTrain);
+
+  delete forest;
+  delete leafReg;
+}
+
+
+/**
+   @brief Predicts regression over the forest and leaves passed.
+
+   @param yRanked holds the training response, by rank.
+
+   @param rowTrain is the number of rows trained.
+
+   @return void, with output vector parameter.
+ */
+void Predict::Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const Forest *forest, const LeafReg *leafReg, const double yRanked[], unsigned int rowTrain, std::vector<double> &yPred, unsigned int bagTrain) {
   unsigned int _nRow = yPred.size();
   PBPredict::Immutables(_blockNumT, _blockFacT, _nPredNum, _nPredFac, _nRow);
-  LeafReg *leafReg = new LeafReg(_leafOrigin, _leafNode, _bagRow, _rank);
-  PredictReg *predictReg = new PredictReg(leafReg, yRanked, nTree, _nRow, _leafNode.size());
-  Forest *forest =  new Forest(_forestNode, _origin, _facOff, _facSplit, predictReg);
+  PredictReg *predictReg = new PredictReg(leafReg, yRanked, rowTrain, forest->NTree(), _nRow, leafReg->NodeCount());
   BitMatrix *bag = leafReg->ForestBag(bagTrain);
   predictReg->PredictAcross(forest, yPred, bag);
 
   delete bag;
   delete predictReg;
-  delete forest;
-  delete leafReg;
   PBPredict::DeImmutables();
 }
 
@@ -50,22 +79,47 @@ void Predict::Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPre
 /**
    @brief Static entry for regression case.
  */
-void Predict::Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain) {
-  int nTree = _origin.size();
+void Predict::Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain) {
+  unsigned int nTree = _origin.size();
+  Forest *forest = new Forest(_forestNode.data(), _origin.data(), nTree, _facOff.data(), _facSplit.data(), _facSplit.size());
+  LeafReg *leafReg = new LeafReg(_leafOrigin.data(), nTree, _leafNode.data(), _leafNode.size(), _bagPack.data(), _rank.data());
+  Quantiles(_blockNumT, _blockFacT, _nPredNum, _nPredFac, forest, leafReg, yRanked.data(), yRanked.size(), yPred, quantVec, qBin, qPred, bagTrain);
+
+  delete forest;
+  delete leafReg;
+}
+
+
+/**
+   @brief Static entry for quantiles over a mapped model.
+ */
+void Predict::Quantiles(const ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain) {
+  Forest *forest = model->ForestFactory();
+  LeafReg *leafReg = model->LeafRegFactory();
+  Quantiles(_blockNumT, _blockFacT, model->NPredNum(), model->NPredFac(), forest, leafReg, model->YRanked(), model->NRowTrain(), yPred, quantVec, qBin, qPred, bagTrain);
+
+  delete forest;
+  delete leafReg;
+}
+
+
+/**
+   @brief Predicts regression and quantiles over the forest and leaves
+   passed.
+
+   @return void, with output vector parameters.
+ */
+void Predict::Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const Forest *forest, const LeafReg *leafReg, const double yRanked[], unsigned int rowTrain, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain) {
   unsigned int _nRow = yPred.size();
   PBPredict::Immutables(_blockNumT, _blockFacT, _nPredNum, _nPredFac, _nRow);
-  LeafReg *leafReg = new LeafReg(_leafOrigin, _leafNode, _bagRow, _rank);
-  PredictReg *predictReg = new PredictReg(leafReg, yRanked, nTree, _nRow, _leafNode.size());
-  Forest *forest =  new Forest(_forestNode, _origin, _facOff, _facSplit, predictReg);
+  PredictReg *predictReg = new PredictReg(leafReg, yRanked, rowTrain, forest->NTree(), _nRow, leafReg->NodeCount());
   BitMatrix *bag = leafReg->ForestBag(bagTrain);
   Quant *quant = new Quant(predictReg, leafReg, quantVec, qBin);
   predictReg->PredictAcross(forest, yPred, quant, &qPred[0], bag);
 
   delete bag;
   delete predictReg;
-  delete leafReg;
   delete quant;
-  delete forest;
   
   PBPredict::DeImmutables();
 }
@@ -74,19 +128,43 @@ void Predict::Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPred
 /**
    @brief Entry for separate classification prediction.
  */
-void Predict::Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_leafInfoCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain) {
-  int nTree = _origin.size();
+void Predict::Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_leafInfoCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain) {
+  unsigned int nTree = _origin.size();
+  Forest *forest = new Forest(_forestNode.data(), _origin.data(), nTree, _facOff.data(), _facSplit.data(), _facSplit.size());
+  LeafCtg *leafCtg = new LeafCtg(_leafOrigin.data(), nTree, _leafNode.data(), _leafNode.size(), _bagPack.data(), _leafInfoCtg.data(), _leafInfoCtg.size() / _leafNode.size());
+  Classification(_blockNumT, _blockFacT, _nPredNum, _nPredFac, forest, leafCtg, yPred, _census, _yTest, _conf, _error, _prob, bagTrain);
+
+  delete forest;
+  delete leafCtg;
+}
+
+
+/**
+   @brief Entry for classification over a mapped model.
+ */
+void Predict::Classification(const ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain) {
+  Forest *forest = model->ForestFactory();
+  LeafCtg *leafCtg = model->LeafCtgFactory();
+  Classification(_blockNumT, _blockFacT, model->NPredNum(), model->NPredFac(), forest, leafCtg, yPred, _census, _yTest, _conf, _error, _prob, bagTrain);
+
+  delete forest;
+  delete leafCtg;
+}
+
+
+/**
+   @brief Predicts classification over the forest and leaves passed.
+
+   @return void, with output parameters.
+ */
+void Predict::Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const Forest *forest, const LeafCtg *leafCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain) {
   unsigned int _nRow = yPred.size();
   PBPredict::Immutables(_blockNumT, _blockFacT, _nPredNum, _nPredFac, _nRow);
-  LeafCtg *leafCtg = new LeafCtg(_leafOrigin, _leafNode, _bagRow, _leafInfoCtg);
-  PredictCtg *predictCtg = new PredictCtg(leafCtg, nTree, _nRow, _leafNode.size());
-  Forest *forest = new Forest(_forestNode, _origin, _facOff, _facSplit, predictCtg);
+  PredictCtg *predictCtg = new PredictCtg(leafCtg, forest->NTree(), _nRow, leafCtg->NodeCount());
   BitMatrix *bag = leafCtg->ForestBag(bagTrain);
   predictCtg->PredictAcross(forest, bag, _census, yPred, _yTest, _conf, _error, _prob);
 
   delete predictCtg;
-  delete forest;
-  delete leafCtg;
   delete bag;
   PBPredict::DeImmutables();
 }
@@ -99,7 +177,7 @@ PredictCtg::PredictCtg(const LeafCtg *_leafCtg, int _nTree, unsigned int _nRow,
 }
 
 
-PredictReg::PredictReg(const LeafReg *_leafReg, const std::vector<double> &_yRanked, int _nTree, unsigned int _nRow, unsigned int _nonLeafIdx) : Predict(_nTree, _nRow, _nonLeafIdx), leafReg(_leafReg), yRanked(_yRanked), defaultScore(-DBL_MAX) {
+PredictReg::PredictReg(const LeafReg *_leafReg, const double _yRanked[], unsigned int _rowTrain, int _nTree, unsigned int _nRow, unsigned int _nonLeafIdx) : Predict(_nTree, _nRow, _nonLeafIdx), leafReg(_leafReg), yRanked(_yRanked), rowTrain(_rowTrain), defaultScore(-DBL_MAX) {
 }
 
 
@@ -112,10 +190,10 @@ PredictReg::PredictReg(const LeafReg *_leafReg, const std::vector<double> &_yRan
 double PredictReg::DefaultScore() {
   if (defaultScore == -DBL_MAX) {
     double sum = 0.0;
-    for (unsigned int i = 0; i < yRanked.size(); i++) {
+    for (unsigned int i = 0; i < rowTrain; i++) {
       sum += yRanked[i];
     }
-    defaultScore = sum / yRanked.size();
+    defaultScore = sum / rowTrain;
   }
 
   return defaultScore;
@@ -189,7 +267,7 @@ void PredictCtg::PredictAcross(const Forest *forest, const BitMatrix *bag, int *
     votes[i] = 0;
   for (unsigned int rowStart = 0; rowStart < nRow; rowStart += rowBlock) {
     unsigned int rowEnd = std::min(rowStart + rowBlock, nRow);
-    forest->PredictAcross(rowStart, rowEnd, bag);
+    forest->PredictAcross(this, rowStart, rowEnd, bag);
     Score(votes, rowStart, rowEnd);
     if (prob != 0)
       Prob(prob, rowStart, rowEnd);
@@ -336,7 +414,7 @@ void PredictCtg::Prob(double *prob, unsigned int rowStart, unsigned int rowEnd)
 void PredictReg::PredictAcross(const Forest *forest, std::vector<double> &yPred, const BitMatrix *bag) {
   for (unsigned int rowStart = 0; rowStart < nRow; rowStart += rowBlock) {
     unsigned int rowEnd = std::min(rowStart + rowBlock, nRow);
-    forest->PredictAcross(rowStart, rowEnd, bag);
+    forest->PredictAcross(this, rowStart, rowEnd, bag);
     Score(rowStart, rowEnd, &yPred[rowStart]);
   }
 }
@@ -350,7 +428,7 @@ void PredictReg::PredictAcross(const Forest *forest, std::vector<double> &yPred,
 void PredictReg::PredictAcross(const Forest *forest, std::vector<double> &yPred, Quant *quant, double qPred[], const BitMatrix *bag) {
   for (unsigned int rowStart = 0; rowStart < nRow; rowStart += rowBlock) {
     unsigned int rowEnd = std::min(rowStart + rowBlock, nRow);
-    forest->PredictAcross(rowStart, rowEnd, bag);
+    forest->PredictAcross(this, rowStart, rowEnd, bag);
     Score(rowStart, rowEnd, &yPred[rowStart]);
     quant->PredictAcross(rowStart, rowEnd, qPred);
   }
@@ -20,6 +20,10 @@
 
 class Predict {
   const unsigned int nonLeafIdx; // Inattainable leaf index value.
+
+  static void Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const class Forest *forest, const class LeafReg *leafReg, const double yRanked[], unsigned int rowTrain, std::vector<double> &yPred, unsigned int bagTrain);
+  static void Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const Forest *forest, const LeafReg *leafReg, const double yRanked[], unsigned int rowTrain, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain);
+  static void Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, const Forest *forest, const class LeafCtg *leafCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain);
  protected:
   static const int rowBlock = 8192;
   const int nTree;
@@ -31,12 +35,16 @@ class Predict {
   Predict(int _nTree, unsigned int _nRow, unsigned int _nonLeafIdx);
   virtual ~Predict();
 
-  static void Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, unsigned int bagTrain);
+  static void Regression(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, unsigned int bagTrain);
+
 
+  static void Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain);
 
-  static void Quantiles(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<unsigned int> &_rank, const std::vector<double> &yRanked, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain);
+  static void Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_leafInfoCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain);
 
-  static void Classification(double *_blockNumT, int *_blockFacT, unsigned int _nPredNum, unsigned int _nPredFac, std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOff, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<double> &_leafInfoCtg, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain);
+  static void Regression(const class ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<double> &yPred, unsigned int bagTrain);
+  static void Quantiles(const ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<double> &yPred, const std::vector<double> &quantVec, unsigned int qBin, std::vector<double> &qPred, unsigned int bagTrain);
+  static void Classification(const ModelMap *model, double *_blockNumT, int *_blockFacT, std::vector<int> &yPred, int *_census, const std::vector<unsigned int> &_yTest, int *_conf, std::vector<double> &_error, double *_prob, unsigned int bagTrain);
 
   /**
      @brief Assigns a proxy leaf index at the prediction coordinates passed.
@@ -76,12 +84,13 @@ class Predict {
 
 class PredictReg : public Predict {
   const class LeafReg *leafReg;
-  const std::vector<double> &yRanked;
+  const double *yRanked; // Training response, by rank.
+  const unsigned int rowTrain; // Length of 'yRanked'.
   double defaultScore;
   void Score(unsigned int rowStart, unsigned int rowEnd, double yPred[]);
   double DefaultScore();
  public:
-  PredictReg(const class LeafReg *_leafReg, const std::vector<double> &_yRanked, int _nTree, unsigned int _nRow, unsigned int _nonLeafIdx);
+  PredictReg(const class LeafReg *_leafReg, const double _yRanked[], unsigned int _rowTrain, int _nTree, unsigned int _nRow, unsigned int _nonLeafIdx);
   ~PredictReg() {}
 
   void PredictAcross(const class Forest *forest, std::vector<double> &yPred, const class BitMatrix *bag);
@@ -92,7 +101,7 @@ class PredictReg : public Predict {
      @return number of rows used in training.
    */
   inline unsigned int TrainRows() const {
-    return yRanked.size();
+    return rowTrain;
   }
 
 
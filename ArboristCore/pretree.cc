@@ -19,6 +19,9 @@
 #include "forest.h"
 #include "predblock.h"
 #include "samplepred.h"
+#include "memtrack.h"
+
+#include <algorithm>
 
 //#include <iostream>
 using namespace std;
@@ -32,6 +35,7 @@ using namespace std;
 
 unsigned int PreTree::nPred = 0;
 unsigned int PreTree::heightEst = 0;
+std::vector<PreTree *> PreTree::pool;
 
 /**
    @brief Caches the row count and computes an initial estimate of node count.
@@ -63,31 +67,126 @@ void PreTree::Immutables(unsigned int _nPred, unsigned int _nSamp, unsigned int
 }
 
 
+/**
+   @brief Frees pooled PreTrees, together with their storage.
+
+   @return void.
+ */
 void PreTree::DeImmutables() {
+  for (auto preTree : pool)
+    delete preTree;
+  pool.clear();
   nPred = heightEst = 0;
 }
 
 
+/**
+   @brief Obtains a PreTree, recycling the storage of a released one
+   when available.
+
+   @param _bagCount is the number of samples subsumed by the root.
+
+   @param _nodeCount is a known bound on the node count, if nonzero.
+
+   @return initialized PreTree, to be returned via Release().
+ */
+PreTree *PreTree::Acquire(unsigned int _bagCount, unsigned int _nodeCount) {
+  if (pool.empty())
+    return new PreTree(_bagCount, _nodeCount);
+
+  PreTree *preTree = pool.back();
+  pool.pop_back();
+  preTree->Reset(_bagCount, _nodeCount);
+
+  return preTree;
+}
+
+
+/**
+   @brief Returns a consumed PreTree to the pool.  Storage is retained
+   until DeImmutables().
+
+   @param preTree is the PreTree to retire.
+
+   @return void.
+ */
+void PreTree::Release(PreTree *preTree) {
+  pool.push_back(preTree);
+}
+
+
 /**
    @brief Per-tree initializations.
 
-   @param _treeBlock is the number of PreTree initialize.
+   @param _bagCount is the number of samples subsumed by the root.
+
+   @param _nodeCount is a known bound on the node count, if nonzero.
+
+   @return void.
+ */
+PreTree::PreTree(unsigned int _bagCount, unsigned int _nodeCount) : nodeVec(0), nodeCount(0), bitEnd(0), sample2PT(0), sampleCount(0), splitBits(0), footprint(0) {
+  info = new double[nPred];
+  Reset(_bagCount, _nodeCount);
+}
+
+
+/**
+   @brief Reinitializes for a new tree.  Vectors grow geometrically, as
+   needed, but never shrink.
+
+   @param _bagCount is the number of samples subsumed by the root.
+
+   @param _nodeCount is a known bound on the node count, if nonzero.
 
    @return void.
  */
-PreTree::PreTree(unsigned int _bagCount) : height(1), leafCount(1), bitEnd(0), bagCount(_bagCount) {
-  sample2PT = new unsigned int[bagCount];
+void PreTree::Reset(unsigned int _bagCount, unsigned int _nodeCount) {
+  height = 1;
+  leafCount = 1;
+  bagCount = _bagCount;
+  if (bagCount > sampleCount) {
+    delete [] sample2PT;
+    sampleCount = max(bagCount, 2 * sampleCount);
+    sample2PT = new unsigned int[sampleCount];
+  }
   for (unsigned int i = 0; i < bagCount; i++) {
     sample2PT[i] = 0;
   }
-  nodeCount = heightEst;   // Initial height estimate.
-  nodeVec = new PTNode[nodeCount];
+
+  int nodeMin = _nodeCount > 0 ? _nodeCount : heightEst;   // Initial height estimate.
+  if (nodeMin > nodeCount) {
+    delete [] nodeVec;
+    nodeCount = max(nodeMin, 2 * nodeCount);
+    nodeVec = new PTNode[nodeCount];
+  }
   nodeVec[0].id = 0; // Root.
   nodeVec[0].lhId = 0; // Initializes as terminal.
-  info = new double[nPred];
   for (unsigned int i = 0; i < nPred; i++)
     info[i] = 0.0;
-  splitBits = BitFactory();
+
+  if (splitBits == 0) {
+    splitBits = BitFactory();
+  }
+  else { // Clears only those slots dirtied by the previous tree.
+    for (unsigned int slot = 0; slot < BV::SlotAlign(bitEnd); slot++)
+      splitBits->SetSlot(slot, 0);
+    // Widens to the bound BitFactory() would have applied.
+    splitBits = splitBits->Resize(nodeCount * PBTrain::CardMax());
+  }
+  bitEnd = 0;
+  Account();
+}
+
+
+/**
+   @brief Accounts for any change in the footprint of this tree's
+   storage.
+
+   @return void.
+ */
+void PreTree::Account() {
+  size_t bytes = size_t(nodeCount) * sizeof(PTNode) + size_t(sampleCount) * sizeof(unsigned int) + nPred * sizeof(double) + splitBits->Bytes();
+  footprint = MemTrack::Resize(MemTrack::preTree, footprint, bytes);
 }
 
 
@@ -135,9 +234,11 @@ BV *PreTree::BitFactory() {
    @brief Per-tree finalizer.
  */
 PreTree::~PreTree() {
+  MemTrack::Release(MemTrack::preTree, footprint);
   delete [] nodeVec;
   delete [] sample2PT;
   delete [] info;
+  delete splitBits;
 }
 
 /**
@@ -207,8 +308,29 @@ void PreTree::NonTerminalNum(double _info, unsigned int _predIdx, unsigned int _
 }
 
 
-double PreTree::Replay(SamplePred *samplePred, unsigned int predIdx, unsigned int bufBit, int start, int end, unsigned int ptId) {
-  return samplePred->Replay(sample2PT, predIdx, bufBit, start, end, ptId);
+double PreTree::Replay(SamplePred *samplePred, unsigned int predIdx, unsigned int bufBit, int start, int end, unsigned int ptId, double ctgSum[], unsigned int sCountCtg[]) {
+  return samplePred->Replay(sample2PT, predIdx, bufBit, start, end, ptId, ctgSum, sCountCtg);
+}
+
+
+/**
+   @brief Reassigns samples left unreplayed by sparse splits, which
+   continue to reference their parents, to their implicit successors.
+
+   @param succ maps level-relative parent offsets to successors, zero if
+   none.
+
+   @param ptBase is the pretree index of the level's first node.
+
+   @return void.
+ */
+void PreTree::ReplayImplicit(const std::vector<unsigned int> &succ, unsigned int ptBase) {
+  for (unsigned int sIdx = 0; sIdx < bagCount; sIdx++) {
+    unsigned int ptId = sample2PT[sIdx];
+    if (ptId >= ptBase && ptId - ptBase < succ.size() && succ[ptId - ptBase] != 0) {
+      sample2PT[sIdx] = succ[ptId - ptBase];
+    }
+  }
 }
 
 
@@ -233,6 +355,7 @@ void PreTree::CheckStorage(int splitNext, int leafNext) {
   unsigned int bitMin = bitEnd + splitNext * PBTrain::CardMax();
   if (bitMin > 0) {
     splitBits = splitBits->Resize(bitMin);
+    Account();
   }
 }
 
@@ -250,6 +373,64 @@ void PreTree::ReNodes() {
 
   delete [] nodeVec;
   nodeVec = PTtemp;
+  Account();
+}
+
+
+/**
+   @brief Consumes a subtree built over a compact sample copy, grafting it
+   onto this tree at a terminal node.
+
+   @param sub is the subtree.
+
+   @param ptId is the terminal at which to graft the subtree's root.
+
+   @param sIdxMap maps the subtree's sample indices to those of this tree.
+
+   @return void, with side-effected pretree.
+ */
+void PreTree::Graft(PreTree *sub, unsigned int ptId, const std::vector<unsigned int> &sIdxMap) {
+  if (sub->height > 1) {
+    while (height + sub->height - 1 > nodeCount) {
+      ReNodes();
+    }
+    if (sub->bitEnd > 0) {
+      splitBits = splitBits->Resize(bitEnd + sub->bitEnd);
+      Account();
+      for (unsigned int pos = 0; pos < sub->bitEnd; pos++) {
+        if (sub->splitBits->TestBit(pos))
+          splitBits->SetBit(bitEnd + pos);
+      }
+    }
+
+    // Root maps to the graft point, successors to the current height.
+    unsigned int idBase = height - 1;
+    for (int idx = 0; idx < sub->height; idx++) {
+      const PTNode &subNode = sub->nodeVec[idx];
+      unsigned int id = idx == 0 ? ptId : idBase + idx;
+      PTNode *ptS = &nodeVec[id];
+      ptS->id = id;
+      ptS->lhId = subNode.lhId > 0 ? idBase + subNode.lhId : 0;
+      if (subNode.lhId > 0) {
+        ptS->predIdx = subNode.predIdx;
+	if (PredBlock::IsFactor(subNode.predIdx))
+	  ptS->splitVal.offset = bitEnd + subNode.splitVal.offset;
+	else
+	  ptS->splitVal.rkMean = subNode.splitVal.rkMean;
+      }
+    }
+    for (unsigned int sIdx = 0; sIdx < sub->bagCount; sIdx++) {
+      unsigned int subId = sub->sample2PT[sIdx];
+      sample2PT[sIdxMap[sIdx]] = subId == 0 ? ptId : idBase + subId;
+    }
+    for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
+      info[predIdx] += sub->info[predIdx];
+    }
+
+    height += sub->height - 1;
+    leafCount += sub->leafCount - 1;
+    bitEnd += sub->bitEnd;
+  }
 }
 
 
@@ -269,7 +450,6 @@ const std::vector<unsigned int> PreTree::DecTree(Forest *forest, unsigned int tI
   forest->NodeInit(height);
   NodeConsume(forest, tIdx);
   forest->BitProduce(splitBits, bitEnd);
-  delete splitBits;
 
   for (unsigned int i = 0; i < nPred; i++)
     predInfo[i] += info[i];
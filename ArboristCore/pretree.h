@@ -18,6 +18,7 @@
 #define ARBORIST_PRETREE_H
 
 #include <vector>
+#include <cstddef>
 
 /**
  @brief Serialized representation of the pre-tree, suitable for tranfer between
@@ -45,25 +46,32 @@ class PTNode {
 class PreTree {
   static unsigned int nPred;
   static unsigned int heightEst;
+  static std::vector<PreTree *> pool; // Idle PreTrees, retaining storage.
   PTNode *nodeVec; // Vector of tree nodes.
   int nodeCount; // Allocation height of node vector.
   int height;
   unsigned int leafCount;
   unsigned int bitEnd; // Next free slot in factor bit vector.
   unsigned int *sample2PT; // Public accessor is Sample2Frontier().
+  unsigned int sampleCount; // Allocation length of 'sample2PT'.
   double *info; // Aggregates info value of nonterminals, by predictor.
   class BV *splitBits;
+  size_t footprint; // Bytes last accounted.
   class BV *BitFactory();
+  void Account();
   void TerminalOffspring(unsigned int _parId, unsigned int &ptLH, unsigned int &ptRH);
   const std::vector<unsigned int> FrontierToLeaf(class Forest *forest, unsigned int tIdx);
   unsigned int bagCount;
+  void Reset(unsigned int _bagCount, unsigned int _nodeCount);
 
  public:
-  PreTree(unsigned int _bagCount);
+  PreTree(unsigned int _bagCount, unsigned int _nodeCount = 0);
   ~PreTree();
   static void Immutables(unsigned int _nPred, unsigned int _nSamp, unsigned int _minH);
   static void DeImmutables();
   static void Reserve(unsigned int height);
+  static PreTree *Acquire(unsigned int _bagCount, unsigned int _nodeCount = 0);
+  static void Release(PreTree *preTree);
 
   const std::vector<unsigned int> DecTree(class Forest *forest, unsigned int tIdx, double predInfo[]);
   void NodeConsume(class Forest *forest, unsigned int tIdx);
@@ -101,10 +109,12 @@ class PreTree {
   void NonTerminalFac(double _info, unsigned int _predIdx, unsigned int _id, unsigned int &ptLH, unsigned int &ptRH);
   void NonTerminalNum(double _info, unsigned int _predIdx, unsigned int _rkLow, unsigned int _rkHigh, unsigned int _id, unsigned int &ptLH, unsigned int &ptRH);
 
-  double Replay(class SamplePred *samplePred, unsigned int predIdx, unsigned int targBit, int start, int end, unsigned int ptId);
+  double Replay(class SamplePred *samplePred, unsigned int predIdx, unsigned int targBit, int start, int end, unsigned int ptId, double ctgSum[] = 0, unsigned int sCountCtg[] = 0);
+  void ReplayImplicit(const std::vector<unsigned int> &succ, unsigned int ptBase);
   
   void CheckStorage(int splitNext, int leafNext);
   void ReNodes();
+  void Graft(PreTree *sub, unsigned int ptId, const std::vector<unsigned int> &sIdxMap);
 };
 
 #endif
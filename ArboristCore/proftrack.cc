@@ -0,0 +1,302 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file proftrack.cc
+
+   @brief Methods for timing training phases by level and tree.
+
+   @author Mark Seligman
+ */
+
+#include "proftrack.h"
+
+#include <cstdio>
+
+#ifdef ARBORIST_PROFILE
+#include <chrono>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+std::vector<ProfTrack::Event> ProfTrack::open;
+std::vector<ProfTrack::Event> ProfTrack::event;
+std::vector<unsigned long long> ProfTrack::phaseCycles(phaseCount);
+std::vector<unsigned long long> ProfTrack::levelCycles;
+std::vector<unsigned long long> ProfTrack::treeCycles;
+std::vector<size_t> ProfTrack::levelPairs;
+std::vector<size_t> ProfTrack::levelVolume;
+unsigned int ProfTrack::depth = 0;
+int ProfTrack::tree = -1;
+bool ProfTrack::suspended = false;
+unsigned long long ProfTrack::cycleBase = 0;
+double ProfTrack::secBase = 0.0;
+const unsigned int ProfTrack::phaseCount;
+
+
+/**
+   @brief Reads the time-stamp counter, where available, otherwise the
+   monotonic clock in nanoseconds.
+
+   @return current cycle count.
+ */
+unsigned long long ProfTrack::Cycles() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+/**
+   @return monotonic clock time, in seconds.
+ */
+double ProfTrack::Clock() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+   @brief Calibrates the cycle counter against the clock, over the span
+   since initialization.
+
+   @return cycles per second.
+ */
+double ProfTrack::CyclesPerSec() {
+  double sec = Clock() - secBase;
+  unsigned long long cycles = Cycles() - cycleBase;
+  return sec > 0.0 && cycles > 0 ? cycles / sec : 1.0e9;
+}
+
+
+/**
+   @brief Clears the tallies of any previous training.  Tallies survive
+   training, so that the front end may collect the report.
+
+   @return void.
+ */
+void ProfTrack::Immutables() {
+  open.clear();
+  event.clear();
+  phaseCycles.assign(phaseCount, 0);
+  levelCycles.clear();
+  treeCycles.clear();
+  levelPairs.clear();
+  levelVolume.clear();
+  tree = -1;
+  suspended = false;
+  Level(0);
+  secBase = Clock();
+  cycleBase = Cycles();
+}
+
+
+/**
+   @brief Opens the next tree.  Trees are trained in order, so the
+   tree's index is its position.  The tree itself is retained as an
+   event, tagged as the phase following the last.
+
+   @return void.
+ */
+void ProfTrack::Tree() {
+  tree = treeCycles.size() / phaseCount;
+  treeCycles.resize(treeCycles.size() + phaseCount, 0);
+  Level(0);
+  Begin(phaseCount);
+}
+
+
+/**
+   @brief Closes the current tree.
+
+   @return void.
+ */
+void ProfTrack::TreeEnd() {
+  End();
+  tree = -1;
+}
+
+
+/**
+   @brief Notes the depth of the level about to be trained.
+
+   @param _depth is the level's depth within its tree.
+
+   @return void.
+ */
+void ProfTrack::Level(unsigned int _depth) {
+  if (suspended)
+    return;
+
+  depth = _depth;
+  size_t levelTop = size_t(depth + 1) * phaseCount;
+  if (levelTop > levelCycles.size()) {
+    levelCycles.resize(levelTop, 0);
+    levelPairs.resize(levelTop, 0);
+    levelVolume.resize(levelTop, 0);
+  }
+}
+
+
+/**
+   @brief Opens a phase at the current depth.
+
+   @param phase is the phase tag.
+
+   @return void.
+ */
+void ProfTrack::Begin(unsigned int phase) {
+  if (suspended)
+    return;
+
+  Event ev;
+  ev.phase = phase;
+  ev.depth = depth;
+  ev.tree = tree;
+  ev.child = ev.cycles = 0;
+  ev.pairs = ev.volume = 0;
+  ev.start = Cycles();
+  open.push_back(ev);
+}
+
+
+/**
+   @brief Closes the innermost open phase, tallying its cycles net of
+   nested phases.
+
+   @param pairs is the count of pairs, or of nodes, visited.
+
+   @param volume is the count of bytes restaged or of split candidates.
+
+   @return void.
+ */
+void ProfTrack::End(size_t pairs, size_t volume) {
+  unsigned long long now = Cycles();
+  if (suspended || open.empty())
+    return;
+
+  Event ev = open.back();
+  open.pop_back();
+  ev.cycles = now - ev.start;
+  ev.pairs = pairs;
+  ev.volume = volume;
+  if (!open.empty())
+    open.back().child += ev.cycles;
+
+  if (ev.phase < phaseCount) {
+    unsigned long long self = ev.cycles - ev.child;
+    phaseCycles[ev.phase] += self;
+    size_t levelOff = size_t(ev.depth) * phaseCount + ev.phase;
+    levelCycles[levelOff] += self;
+    levelPairs[levelOff] += pairs;
+    levelVolume[levelOff] += volume;
+    if (ev.tree >= 0)
+      treeCycles[size_t(ev.tree) * phaseCount + ev.phase] += self;
+  }
+  event.push_back(ev);
+}
+
+
+/**
+   @brief Ignores level and phase notices until resumed, as while
+   subtrees train in parallel.  Called outside of parallel regions.
+
+   @return void.
+ */
+void ProfTrack::Suspend() {
+  suspended = true;
+}
+
+
+void ProfTrack::Resume() {
+  suspended = false;
+}
+#endif
+
+
+/**
+   @brief Names a phase, for reporting.
+
+   @param phase is the phase tag.
+
+   @return phase name.
+ */
+const char *ProfTrack::PhaseName(unsigned int phase) {
+  static const char *phaseName[phaseCount] = {"levelInit", "restage", "split", "argMax", "consume", "replay", "produce"};
+
+  return phase < phaseCount ? phaseName[phase] : "";
+}
+
+
+/**
+   @brief Reports the tallies of the most recent training, in seconds.
+   Reports are empty unless timing has been compiled in.  Tallies by
+   depth and by tree are flattened, with phase varying fastest.
+
+   @param _phaseSec outputs the time spent in each phase.
+
+   @param _levelSec outputs the time spent in each phase, by depth.
+
+   @param _treeSec outputs the time spent in each phase, by tree.
+
+   @param _levelPairs outputs the pairs or nodes visited by each phase,
+   by depth.
+
+   @param _levelVolume outputs the bytes restaged or candidates split by
+   each phase, by depth.
+
+   @return void, with output reference parameters.
+ */
+void ProfTrack::Report(std::vector<double> &_phaseSec, std::vector<double> &_levelSec, std::vector<double> &_treeSec, std::vector<size_t> &_levelPairs, std::vector<size_t> &_levelVolume) {
+  _phaseSec.clear();
+  _levelSec.clear();
+  _treeSec.clear();
+  _levelPairs.clear();
+  _levelVolume.clear();
+#ifdef ARBORIST_PROFILE
+  double recipRate = 1.0 / CyclesPerSec();
+  for (auto cycles : phaseCycles)
+    _phaseSec.push_back(cycles * recipRate);
+  for (auto cycles : levelCycles)
+    _levelSec.push_back(cycles * recipRate);
+  for (auto cycles : treeCycles)
+    _treeSec.push_back(cycles * recipRate);
+  _levelPairs = levelPairs;
+  _levelVolume = levelVolume;
+#endif
+}
+
+
+/**
+   @brief Renders the events of the most recent training in Chrome's
+   trace-event format, as complete events timed in microseconds.  Trees
+   are rendered as spans enclosing their phases.
+
+   @param json outputs the trace, empty unless timing has been compiled
+   in.
+
+   @return void, with output reference parameter.
+ */
+void ProfTrack::Trace(std::string &json) {
+  json.clear();
+#ifdef ARBORIST_PROFILE
+  double usPerCycle = 1.0e6 / CyclesPerSec();
+  json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buf[256];
+  bool first = true;
+  for (auto & ev : event) {
+    const char *name = ev.phase < phaseCount ? PhaseName(ev.phase) : "tree";
+    snprintf(buf, sizeof(buf), "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tree\":%d,\"depth\":%u,\"pairs\":%zu,\"volume\":%zu}}", first ? "" : ",", name, ev.phase < phaseCount ? "level" : "tree", (ev.start - cycleBase) * usPerCycle, ev.cycles * usPerCycle, ev.tree, ev.depth, ev.pairs, ev.volume);
+    json += buf;
+    first = false;
+  }
+  json += "\n]}\n";
+#endif
+}
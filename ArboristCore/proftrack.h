@@ -0,0 +1,111 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file proftrack.h
+
+   @brief Timing of training phases by level and tree.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_PROFTRACK_H
+#define ARBORIST_PROFTRACK_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+/**
+   @brief Counts cycles spent in each phase of level training, tallied
+   by phase, by tree depth and by tree, together with the work each
+   phase performs:  pairs visited and bytes restaged or candidates
+   split.  Each phase instance is also retained as an event, for export
+   as a trace.
+
+   Phases nest, tallies being exclusive of nested phases while events
+   span them.  Phases begin and end outside of parallel regions.
+   Depth-first subtrees, which train in parallel, do so while tracking
+   is suspended, so are charged to the parent's production phase.
+
+   Timing is compiled in only when ARBORIST_PROFILE is defined.
+   Otherwise the timing methods are empty inlines and the report is
+   empty.
+ */
+class ProfTrack {
+#ifdef ARBORIST_PROFILE
+  /**
+     @brief Phase instance, whether open or concluded.
+   */
+  struct Event {
+    unsigned long long start; // Cycle count.
+    unsigned long long cycles; // Inclusive of nested phases.
+    unsigned long long child; // Cycles within nested phases.
+    size_t pairs;
+    size_t volume;
+    unsigned int phase;
+    unsigned int depth;
+    int tree; // Negative if outside a tree.
+  };
+
+  static std::vector<Event> open; // Stack of open phases.
+  static std::vector<Event> event; // Concluded phases, in order of conclusion.
+  static std::vector<unsigned long long> phaseCycles; // By phase.
+  static std::vector<unsigned long long> levelCycles; // Depth-major.
+  static std::vector<unsigned long long> treeCycles; // Tree-major.
+  static std::vector<size_t> levelPairs; // Depth-major.
+  static std::vector<size_t> levelVolume; // Depth-major.
+  static unsigned int depth; // Depth of the level under training.
+  static int tree; // Index of tree under training, if any.
+  static bool suspended; // Whether level and phase notices are ignored.
+  static unsigned long long cycleBase; // Cycle count at initialization.
+  static double secBase; // Clock time at initialization.
+
+  static unsigned long long Cycles();
+  static double Clock();
+  static double CyclesPerSec();
+#endif
+
+ public:
+  // Phase tags.
+  static const unsigned int levelInit = 0; // SplitPred::LevelInit.
+  static const unsigned int restage = 1; // Bottom::Level, up to splitting.
+  static const unsigned int split = 2; // Bottom::Split.
+  static const unsigned int argMax = 3; // SplitSig::ArgMax, over nodes.
+  static const unsigned int consume = 4; // Index::LevelConsume, less nested phases.
+  static const unsigned int replay = 5; // Replay of splits onto the pretree.
+  static const unsigned int produce = 6; // Index::LevelProduce.
+  static const unsigned int phaseCount = 7;
+
+  static const char *PhaseName(unsigned int phase);
+  static void Report(std::vector<double> &_phaseSec, std::vector<double> &_levelSec, std::vector<double> &_treeSec, std::vector<size_t> &_levelPairs, std::vector<size_t> &_levelVolume);
+  static void Trace(std::string &json);
+
+#ifdef ARBORIST_PROFILE
+  static void Immutables();
+  static void Tree();
+  static void TreeEnd();
+  static void Level(unsigned int _depth);
+  static void Begin(unsigned int phase);
+  static void End(size_t pairs = 0, size_t volume = 0);
+  static void Suspend();
+  static void Resume();
+#else
+  static inline void Immutables() {}
+  static inline void Tree() {}
+  static inline void TreeEnd() {}
+  static inline void Level(unsigned int) {}
+  static inline void Begin(unsigned int) {}
+  static inline void End(size_t = 0, size_t = 0) {}
+  static inline void Suspend() {}
+  static inline void Resume() {}
+#endif
+};
+
+#endif
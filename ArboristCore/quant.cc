@@ -24,12 +24,19 @@ using namespace std;
 
 /**
    @brief Constructor.  Caches parameter values and computes compressed
-   leaf indices.
+   leaf indices, including the positions of each leaf's packed samples
+   and ranks.
  */
-Quant::Quant(const PredictReg *_predictReg, const LeafReg *_leafReg, const std::vector<double> &_qVec, unsigned int qBin) : predictReg(_predictReg), leafReg(_leafReg), qVec(_qVec), qCount(qVec.size()), logSmudge(0), sCountSmudge(0) {
+Quant::Quant(const PredictReg *_predictReg, const LeafReg *_leafReg, const std::vector<double> &_qVec, unsigned int qBin) : predictReg(_predictReg), leafReg(_leafReg), qVec(_qVec), qCount(qVec.size()), extentMax(0), logSmudge(0), sCountSmudge(0) {
   unsigned int trainRow = predictReg->TrainRows();
   sampleOffset = std::vector<unsigned int>(leafReg->NodeCount());
   leafReg->SampleOffset(sampleOffset, 0, leafReg->NodeCount(), 0);
+  bagOffset = std::vector<size_t>(leafReg->NodeCount());
+  leafReg->BagOffset(bagOffset);
+  rankOffset = std::vector<size_t>(leafReg->NodeCount());
+  leafReg->RankOffset(rankOffset);
+  for (unsigned int i = 0; i < leafReg->NodeCount(); i++)
+    extentMax = max(extentMax, leafReg->Extent(i));
   binSize = BinSize(trainRow, qBin, logSmudge);
   if (binSize < trainRow) {
     SmudgeLeaves();
@@ -60,10 +67,19 @@ void Quant::PredictAcross(unsigned int rowStart, unsigned int rowEnd, double qPr
   int row;
 #pragma omp parallel default(shared) private(row)
   {
+    // Working buffers are allocated once per thread, not per row.
+    unsigned int *sampRanks = new unsigned int[binSize];
+    unsigned int *sCountLeaf = new unsigned int[extentMax];
+    unsigned int *rankLeaf = new unsigned int[extentMax];
+    double *countThreshold = new double[qCount];
 #pragma omp for schedule(dynamic, 1)
     for (row = rowStart; row < int(rowEnd); row++) {
-      Leaves(row - rowStart, &qPred[qCount * row]);
+      Leaves(row - rowStart, &qPred[qCount * row], sampRanks, sCountLeaf, rankLeaf, countThreshold);
     }
+    delete [] sampRanks;
+    delete [] sCountLeaf;
+    delete [] rankLeaf;
+    delete [] countThreshold;
   }
 }
 
@@ -94,19 +110,18 @@ unsigned int Quant::BinSize(unsigned int trainRow, unsigned int qBin, unsigned i
  */
 void Quant::SmudgeLeaves() {    
   sCountSmudge = new unsigned int[leafReg->BagTot()];
-  for (unsigned int i = 0; i < leafReg->BagTot(); i++)
-    sCountSmudge[i] = leafReg->SCount(i);
+  unsigned int *rankLeaf = new unsigned int[extentMax];
   for (unsigned int i = 0; i < leafReg->NodeCount(); i++) {
     unsigned int infoOff = sampleOffset[i];
     unsigned int extent = leafReg->Extent(i);
+    (void) leafReg->LeafDecode(bagOffset[i], extent, 0, &sCountSmudge[infoOff]);
     if (extent > binSize) {
       int *binTemp = new int[binSize];
       for (unsigned int j = 0; j < binSize; j++)
 	binTemp[j] = 0;
+      leafReg->RankDecode(rankOffset[i], extent, rankLeaf);
       for (unsigned int j = 0; j < extent; j++) {
-	unsigned int sCount = leafReg->SCount(infoOff + j);
-	unsigned int rank = leafReg->Rank(infoOff + j);
-	binTemp[rank >> logSmudge] += sCount;
+	binTemp[rankLeaf[j] >> logSmudge] += sCountSmudge[infoOff + j];
       }
       for (unsigned int j = 0; j < binSize; j++) {
 	sCountSmudge[infoOff + j] = binTemp[j];
@@ -114,6 +129,7 @@ void Quant::SmudgeLeaves() {
       delete [] binTemp;
     }
   }
+  delete [] rankLeaf;
 }
 
 
@@ -124,11 +140,17 @@ void Quant::SmudgeLeaves() {
 
    @param qRow[] outputs quantile values.
 
+   @param sampRanks is a buffer for the row's rank counts, 'binSize' wide.
+
+   @param sCountLeaf and rankLeaf are buffers for a leaf's decoded sample
+   counts and ranks, 'extentMax' wide.
+
+   @param countThreshold is a buffer for the row's rank-count
+   thresholds, one per quantile.
 
    @return void, with output vector parameter.
  */
-void Quant::Leaves(unsigned int blockRow, double qRow[]) {
-  unsigned int *sampRanks = new unsigned int[binSize];
+void Quant::Leaves(unsigned int blockRow, double qRow[], unsigned int sampRanks[], unsigned int sCountLeaf[], unsigned int rankLeaf[], double countThreshold[]) {
   for (unsigned int i = 0; i < binSize; i++)
     sampRanks[i] = 0;
 
@@ -138,11 +160,10 @@ void Quant::Leaves(unsigned int blockRow, double qRow[]) {
   for (unsigned int tn = 0; tn < leafReg->NTree(); tn++) {
     if (!predictReg->IsBagged(blockRow, tn)) {
       unsigned int leafIdx = predictReg->LeafIdx(blockRow, tn);
-      totRanks += (logSmudge == 0) ? RanksExact(tn, leafIdx, sampRanks) : RanksSmudge(tn, leafIdx, sampRanks);
+      totRanks += (logSmudge == 0) ? RanksExact(tn, leafIdx, sampRanks, sCountLeaf, rankLeaf) : RanksSmudge(tn, leafIdx, sampRanks, rankLeaf);
     }
   }
 
-  double *countThreshold = new double[qCount];
   for (unsigned int i = 0; i < qCount; i++) {
     countThreshold[i] = totRanks * qVec[i];  // Rounding properties?
   }
@@ -162,8 +183,6 @@ void Quant::Leaves(unsigned int blockRow, double qRow[]) {
   // TODO:  For binning, rerun, restricting to "hot" bins observed
   // over sample set.  This should improve resolution for hot
   // bins.
-  delete [] sampRanks;
-  delete [] countThreshold;
 }
 
 
@@ -176,16 +195,19 @@ void Quant::Leaves(unsigned int blockRow, double qRow[]) {
 
    @param sampRanks outputs the count of samples at a given rank.
 
+   @param sCountLeaf is a buffer for the leaf's decoded sample counts.
+
+   @param rankLeaf is a buffer for the leaf's decoded ranks.
+
    @return count of ranks introduced by leaf.
  */
-unsigned int Quant::RanksExact(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[]) {
-  int rankTot = 0;
-  unsigned int infoOff = sampleOffset[leafReg->NodeIdx(tIdx, leafIdx)];
-  for (unsigned int i = 0; i < leafReg->Extent(tIdx, leafIdx); i++) {
-    unsigned int sCount = leafReg->SCount(infoOff + i);
-    unsigned int rank = leafReg->Rank(infoOff + i);
-    sampRanks[rank] += sCount;
-    rankTot += sCount;
+unsigned int Quant::RanksExact(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[], unsigned int sCountLeaf[], unsigned int rankLeaf[]) {
+  unsigned int nodeIdx = leafReg->NodeIdx(tIdx, leafIdx);
+  unsigned int extent = leafReg->Extent(nodeIdx);
+  unsigned int rankTot = leafReg->LeafDecode(bagOffset[nodeIdx], extent, 0, sCountLeaf);
+  leafReg->RankDecode(rankOffset[nodeIdx], extent, rankLeaf);
+  for (unsigned int i = 0; i < extent; i++) {
+    sampRanks[rankLeaf[i]] += sCountLeaf[i];
   }
 
   return rankTot;
@@ -201,15 +223,19 @@ unsigned int Quant::RanksExact(unsigned int tIdx, unsigned int leafIdx, unsigned
 
    @param sampRanks[] outputs the binned rank counts.
 
+   @param rankLeaf is a buffer for the leaf's decoded ranks.
+
    @return count of ranks introduced by leaf.
  */
-unsigned int Quant::RanksSmudge(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[]) {
+unsigned int Quant::RanksSmudge(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[], unsigned int rankLeaf[]) {
   unsigned int rankTot = 0;
-  unsigned int extent = leafReg->Extent(tIdx, leafIdx);
-  unsigned int infoOff = sampleOffset[leafReg->NodeIdx(tIdx, leafIdx)];
+  unsigned int nodeIdx = leafReg->NodeIdx(tIdx, leafIdx);
+  unsigned int extent = leafReg->Extent(nodeIdx);
+  unsigned int infoOff = sampleOffset[nodeIdx];
   if (extent <= binSize) {
+    leafReg->RankDecode(rankOffset[nodeIdx], extent, rankLeaf);
     for (unsigned int i = 0; i < extent; i++) {
-      unsigned int rankIdx = (leafReg->Rank(infoOff + i) >> logSmudge);
+      unsigned int rankIdx = (rankLeaf[i] >> logSmudge);
       unsigned int rankCount = sCountSmudge[infoOff + i];
       sampRanks[rankIdx] += rankCount;
       rankTot += rankCount;
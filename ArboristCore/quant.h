@@ -18,17 +18,22 @@
 #define ARBORIST_QUANT_H
 
 #include <vector>
+#include <cstddef>
 
 
 /**
  @brief Quantile signature.
 */
 class Quant {
+  friend class KernelBench; // Times Leaves() apart from prediction.
   const class PredictReg *predictReg;
   const class LeafReg *leafReg;
   const std::vector<double> &qVec;
   std::vector<unsigned int> sampleOffset;
+  std::vector<size_t> bagOffset; // Per-leaf position in packed bag.
+  std::vector<size_t> rankOffset; // Per-leaf position in packed ranks.
   const unsigned int qCount;
+  unsigned int extentMax; // Widest leaf.
   unsigned int logSmudge;
   unsigned int binSize;
   unsigned int *sCountSmudge;
@@ -37,9 +42,9 @@ class Quant {
   
   unsigned int BinSize(unsigned int nRow, unsigned int qBin, unsigned int &_logSmudge);
   void SmudgeLeaves();
-  void Leaves(unsigned int rowBlock, double qRow[]);
-  unsigned int RanksExact(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[]);
-  unsigned int RanksSmudge(unsigned int tIdx, unsigned int LeafIdx, unsigned int sampRanks[]);
+  void Leaves(unsigned int rowBlock, double qRow[], unsigned int sampRanks[], unsigned int sCountLeaf[], unsigned int rankLeaf[], double countThreshold[]);
+  unsigned int RanksExact(unsigned int tIdx, unsigned int leafIdx, unsigned int sampRanks[], unsigned int sCountLeaf[], unsigned int rankLeaf[]);
+  unsigned int RanksSmudge(unsigned int tIdx, unsigned int LeafIdx, unsigned int sampRanks[], unsigned int rankLeaf[]);
  public:
   Quant(const class PredictReg *_predictReg, const class LeafReg *_leafReg, const std::vector<double> &_qVec, unsigned int qBin);
   ~Quant();
@@ -22,6 +22,8 @@
 #include "index.h"
 #include "pretree.h"
 
+#include <algorithm>
+
 //#include <iostream>
 using namespace std;
 
@@ -35,8 +37,8 @@ using namespace std;
 
    @return void.
 */
-ResponseCtg *Response::FactoryCtg(const std::vector<unsigned int> &feCtg, const std::vector<double> &feProxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<BagRow> &bagRow, std::vector<double> &weight, unsigned int ctgWidth) {
-  return new ResponseCtg(feCtg, feProxy, leafOrigin, leafNode, bagRow, weight, ctgWidth);
+ResponseCtg *Response::FactoryCtg(const std::vector<unsigned int> &feCtg, const std::vector<double> &feProxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<double> &weight, unsigned int ctgWidth) {
+  return new ResponseCtg(feCtg, feProxy, leafOrigin, leafNode, bagPack, weight, ctgWidth);
 }
 
 
@@ -46,7 +48,7 @@ ResponseCtg *Response::FactoryCtg(const std::vector<unsigned int> &feCtg, const
  @param _proxy is the associated numerical proxy response.
 
 */
-ResponseCtg::ResponseCtg(const std::vector<unsigned int> &_yCtg, const std::vector<double> &_proxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<BagRow> &bagRow, std::vector<double> &weight, unsigned int ctgWidth) : Response(_proxy, leafOrigin, leafNode, bagRow, weight, ctgWidth), yCtg(_yCtg) {
+ResponseCtg::ResponseCtg(const std::vector<unsigned int> &_yCtg, const std::vector<double> &_proxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<double> &weight, unsigned int ctgWidth) : Response(_proxy, leafOrigin, leafNode, bagPack, weight, ctgWidth), yCtg(_yCtg) {
 }
 
 
@@ -56,7 +58,7 @@ ResponseCtg::ResponseCtg(const std::vector<unsigned int> &_yCtg, const std::vect
    @param _y is the vector numerical/proxy response values.
 
  */
-Response::Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<BagRow> &bagRow, std::vector<double> &weight, unsigned int ctgWidth) : y(_y), leaf(new LeafCtg(leafOrigin, leafNode, bagRow, weight, ctgWidth)) {
+Response::Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<double> &weight, unsigned int ctgWidth) : y(_y), leaf(new LeafCtg(leafOrigin, leafNode, bagPack, weight, ctgWidth)) {
 }
 
 
@@ -66,7 +68,7 @@ Response::Response(const std::vector<double> &_y, std::vector<unsigned int> &lea
    @param _y is the vector numerical/proxy response values.
 
  */
-Response::Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<BagRow> &bagRow, std::vector<unsigned int> &rank) : y(_y), leaf(new LeafReg(leafOrigin, leafNode, bagRow, rank)) {
+Response::Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &rank) : y(_y), leaf(new LeafReg(leafOrigin, leafNode, bagPack, rank)) {
 }
 
 
@@ -92,8 +94,8 @@ ResponseReg::~ResponseReg() {
 
    @return void, with output reference vector.
  */
-ResponseReg *Response::FactoryReg(const std::vector<double> &yNum, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &bagRow, std::vector<unsigned int> &_rank) {
-  return new ResponseReg(yNum, _row2Rank, _leafOrigin, _leafNode, bagRow, _rank);
+ResponseReg *Response::FactoryReg(const std::vector<double> &yNum, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &_rank) {
+  return new ResponseReg(yNum, _row2Rank, _leafOrigin, _leafNode, bagPack, _rank);
 }
 
 
@@ -104,7 +106,7 @@ ResponseReg *Response::FactoryReg(const std::vector<double> &yNum, const std::ve
 
    @param yRanked outputs the sorted response needed for quantile ranking.
  */
-ResponseReg::ResponseReg(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<BagRow> &bagRow, std::vector<unsigned int> &rank) : Response(_y, leafOrigin, leafNode, bagRow, rank), row2Rank(_row2Rank) {
+ResponseReg::ResponseReg(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &rank) : Response(_y, leafOrigin, leafNode, bagPack, rank), row2Rank(_row2Rank) {
 }
 
 
@@ -113,14 +115,16 @@ ResponseReg::ResponseReg(const std::vector<double> &_y, const std::vector<unsign
 
    @param rowRank is the predictor rank information.
 
+   @param blockStart is the absolute index of the first tree in the block.
+
    @param blockSize is the number of trees in the block.
 
    @return block of SampleCtg instances.
  */
-PreTree **Response::BlockTree(const RowRank *rowRank, unsigned int blockSize) {
+PreTree **Response::BlockTree(const RowRank *rowRank, unsigned int blockStart, unsigned int blockSize) {
   sampleBlock = new Sample*[blockSize];
   for (unsigned int i = 0; i < blockSize; i++) {
-    sampleBlock[i] = Sampler(rowRank);
+    sampleBlock[i] = Sampler(rowRank, blockStart + i);
   }
 
   return Index::BlockTrees(sampleBlock, blockSize);
@@ -128,18 +132,39 @@ PreTree **Response::BlockTree(const RowRank *rowRank, unsigned int blockSize) {
 
 
 /**
+   @param tIdx is the absolute index of the tree.
+
    @return Regression-style Sample object.
  */
-Sample *ResponseReg::Sampler(const class RowRank *rowRank) {
-  return Sample::FactoryReg(Y(), rowRank, row2Rank);
+Sample *ResponseReg::Sampler(const class RowRank *rowRank, unsigned int tIdx) {
+  return Sample::FactoryReg(Y(), rowRank, row2Rank, tIdx);
 }
 
 
 /**
+   @param tIdx is the absolute index of the tree.
+
    @return Classification-style Sample object.
  */
-Sample *ResponseCtg::Sampler(const class RowRank *rowRank) {
-  return Sample::FactoryCtg(Y(), rowRank, yCtg);
+Sample *ResponseCtg::Sampler(const class RowRank *rowRank, unsigned int tIdx) {
+  return Sample::FactoryCtg(Y(), rowRank, yCtg, tIdx);
+}
+
+
+/**
+   @brief Measures the largest tree footprint in the current block.
+
+   @param blockSize is the number of trees in the current block.
+
+   @return largest per-tree footprint, in bytes.
+ */
+size_t Response::BlockBytes(unsigned int blockSize) const {
+  size_t treeBytes = 0;
+  for (unsigned int blockIdx = 0; blockIdx < blockSize; blockIdx++) {
+    treeBytes = max(treeBytes, sampleBlock[blockIdx]->Bytes());
+  }
+
+  return treeBytes;
 }
 
 
@@ -199,3 +224,13 @@ const BV *Response::TreeBag(unsigned int blockIdx) {
 void Response::LeafReserve(unsigned int leafEst, unsigned int bagEst) {
   leaf->Reserve(leafEst, bagEst);
 }
+
+
+/**
+   @brief Consolidates crescent leaf storage following training.
+
+   @return void, with output reference parameters.
+ */
+void Response::LeafFinalize(unsigned int &segTot, unsigned int &reallocTot) {
+  leaf->Finalize(segTot, reallocTot);
+}
@@ -19,6 +19,7 @@
 #define ARBORIST_RESPONSE_H
 
 #include <vector>
+#include <cstddef>
 
 /**
    @brief Methods and members for management of response-related computations.
@@ -28,23 +29,25 @@ class Response {
   class Leaf *leaf;
   class Sample** sampleBlock;
  public:
-  Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<class BagRow> &bagRow, std::vector<double> &weight, unsigned int ctgWidth);
-  Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<class BagRow> &bagRow, std::vector<unsigned int> &rank);
+  Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<double> &weight, unsigned int ctgWidth);
+  Response(const std::vector<double> &_y, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &rank);
   virtual ~Response();
 
   const std::vector<double> &Y() {
     return y;
   }
-  static class ResponseReg *FactoryReg(const std::vector<double> &yNum, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &bagRow, std::vector<unsigned int> &_rank);
-  static class ResponseCtg *FactoryCtg(const std::vector<unsigned int> &feCtg, const std::vector<double> &feProxy, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<class BagRow> &bagRow,std::vector<double> &weight, unsigned int ctgWidth);
+  static class ResponseReg *FactoryReg(const std::vector<double> &yNum, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &_rank);
+  static class ResponseCtg *FactoryCtg(const std::vector<unsigned int> &feCtg, const std::vector<double> &feProxy, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<unsigned char> &bagPack,std::vector<double> &weight, unsigned int ctgWidth);
 
-  class PreTree **BlockTree(const class RowRank *rowRank, unsigned int blockSize);
+  class PreTree **BlockTree(const class RowRank *rowRank, unsigned int blockStart, unsigned int blockSize);
   const class BV *TreeBag(unsigned int blockIdx);
   void LeafReserve(unsigned int leafEst, unsigned int bagEst);
+  void LeafFinalize(unsigned int &segTot, unsigned int &reallocTot);
   void DeBlock(unsigned int blockSize);
+  size_t BlockBytes(unsigned int blockSize) const;
   void Leaves(const std::vector<unsigned int> &leafMap, unsigned int blockIdx, unsigned int tIdx);
 
-  virtual class Sample* Sampler(const class RowRank *rowRank) = 0;
+  virtual class Sample* Sampler(const class RowRank *rowRank, unsigned int tIdx) = 0;
 };
 
 
@@ -55,9 +58,9 @@ class ResponseReg : public Response {
   const std::vector<unsigned int> &row2Rank; // Facilitates rank[] output.
  public:
 
-  ResponseReg(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<class BagRow> &bagRow, std::vector<unsigned int> &rank);
+  ResponseReg(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &leafOrigin, std::vector<class LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<unsigned int> &rank);
   ~ResponseReg();
-  class Sample *Sampler(const class RowRank *rowRank);
+  class Sample *Sampler(const class RowRank *rowRank, unsigned int tIdx);
 };
 
 /**
@@ -67,9 +70,9 @@ class ResponseCtg : public Response {
   const std::vector<unsigned int> &yCtg; // 0-based factor-valued response.
  public:
 
-  ResponseCtg(const std::vector<unsigned int> &_yCtg, const std::vector<double> &_proxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<class BagRow> &bagRow, std::vector<double> &weight, unsigned int ctgWidth);
+  ResponseCtg(const std::vector<unsigned int> &_yCtg, const std::vector<double> &_proxy, std::vector<unsigned int> &leafOrigin, std::vector<LeafNode> &leafNode, std::vector<unsigned char> &bagPack, std::vector<double> &weight, unsigned int ctgWidth);
   ~ResponseCtg();
-  class Sample *Sampler(const class RowRank *rowRank);
+  class Sample *Sampler(const class RowRank *rowRank, unsigned int tIdx);
 };
 
 #endif
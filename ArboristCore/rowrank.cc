@@ -15,8 +15,16 @@
 
 #include "rowrank.h"
 #include "predblock.h"
-#include "callback.h"
 #include "math.h"
+#include "memtrack.h"
+
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 // Testing only:
 //#include <iostream>
@@ -41,16 +49,19 @@ using namespace std;
 
    @param feInvNum outputs a rank-to-row map.
 
+   @param _rankMax caps the number of distinct ranks per predictor, by
+   quantile binning of the sorted values.  Zero ranks exactly.
+
    @output void, with output vector parameters.
  */
-void RowRank::PreSortNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRow, int _row[], int _rank[], int _feInvNum[]) {
+void RowRank::PreSortNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRow, int _row[], int _rank[], int _feInvNum[], unsigned int _rankMax) {
   // Builds the ranked numeric block.
   //
-  double *numOrd = new double[_nRow * _nPredNum];
-  for (unsigned int i = 0; i < _nRow * _nPredNum; i++)
+  double *numOrd = new double[size_t(_nRow) * _nPredNum];
+  for (size_t i = 0; i < size_t(_nRow) * _nPredNum; i++)
     numOrd[i] = _feNum[i];
   Sort(_nRow, _nPredNum, numOrd, _row);
-  Ranks(_nRow, _nPredNum, numOrd, _row, _rank, _feInvNum);
+  Ranks(_nRow, _nPredNum, numOrd, _row, _rank, _feInvNum, _rankMax);
   delete [] numOrd;
 }
 
@@ -66,7 +77,7 @@ void RowRank::PreSortNum(const double _feNum[], unsigned int _nPredNum, unsigned
 
    @param nRow is the number of observation rows. 
 
-   @param row Outputs the (unstably) sorted row indices.
+   @param row Outputs the sorted row indices, ties ordered by row.
 
    @param rank Outputs the tie-classed predictor ranks.
 
@@ -77,17 +88,308 @@ void RowRank::PreSortFac(const int _feFac[], unsigned int _facStart, unsigned in
   // Builds the ranked factor block.  Assumes 0-justification has been 
   // performed by bridge.
   //
-  int *facOrd = new int[_nRow * _nPredFac];
-  for (unsigned int i = 0; i < _nRow * _nPredFac; i++)
+  int *facOrd = new int[size_t(_nRow) * _nPredFac];
+  for (size_t i = 0; i < size_t(_nRow) * _nPredFac; i++)
     facOrd[i] = _feFac[i];
-  Sort(_nRow, _nPredFac, facOrd, _row + _facStart * _nRow);
-  Ranks(_nRow, _nPredFac, facOrd, _rank + _facStart * _nRow);
+  Sort(_nRow, _nPredFac, facOrd, _row + size_t(_facStart) * _nRow);
+  Ranks(_nRow, _nPredFac, facOrd, _rank + size_t(_facStart) * _nRow);
   delete [] facOrd;
 }
 
 
+/**
+   @brief Numeric predictor presort of a block to which rows have been
+   appended since a prior presort.  The prior orderings are merged with
+   the appended rows, rather than sorted afresh, and ranks renumbered.
+   Agrees with PreSortNum() over the whole block.
+
+   @param _feNum is a block of numeric predictor values, appended rows last.
+
+   @param _nRowOld is the number of rows in the prior presort.
+
+   @param _nRow is the number of rows, including those appended.
+
+   @param _rowOld is the prior presort's row vector.
+
+   @param _row outputs the sorted row indices.
+
+   @param _rank outputs the tie-classed predictor ranks.
+
+   @param _feInvNum outputs a rank-to-row map.
+
+   @param _rankMax caps the number of distinct ranks, as in PreSortNum().
+
+   @return void, with output vector parameters.
+ */
+void RowRank::MergeNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRowOld, unsigned int _nRow, const int _rowOld[], int _row[], int _rank[], int _feInvNum[], unsigned int _rankMax) {
+  double *numOrd = new double[size_t(_nRow) * _nPredNum];
+  Merge(_nRowOld, _nRow, _nPredNum, _feNum, _rowOld, numOrd, _row);
+  Ranks(_nRow, _nPredNum, numOrd, _row, _rank, _feInvNum, _rankMax);
+  delete [] numOrd;
+}
+
+
+/**
+   @brief As above, but for factor predictors.  Factor codes of prior
+   rows may be revised, provided their relative order is preserved.
+
+   @param _facStart is the starting position of factors, in both the
+   prior and output vectors.
+
+   @return void, with output vector parameters.
+ */
+void RowRank::MergeFac(const int _feFac[], unsigned int _facStart, unsigned int _nPredFac, unsigned int _nRowOld, unsigned int _nRow, const int _rowOld[], int _row[], int _rank[]) {
+  int *facOrd = new int[size_t(_nRow) * _nPredFac];
+  Merge(_nRowOld, _nRow, _nPredFac, _feFac, _rowOld + size_t(_facStart) * _nRowOld, facOrd, _row + size_t(_facStart) * _nRow);
+  Ranks(_nRow, _nPredFac, facOrd, _rank + size_t(_facStart) * _nRow);
+  delete [] facOrd;
+}
+
+
+/**
+   @brief Maps a double onto an unsigned key of like ordering.  Negative
+   zero is keyed as zero and all NaNs as a single value above infinity.
+
+   @param x is the value to map.
+
+   @return order-preserving key.
+ */
+static inline uint64_t SortKey(double x) {
+  if (x == 0.0)
+    x = 0.0;
+  uint64_t bits;
+  if (x != x)
+    bits = 0x7ff8000000000000ull;
+  else
+    memcpy(&bits, &x, sizeof(bits));
+
+  return (bits >> 63) != 0 ? ~bits : bits | (1ull << 63);
+}
+
+
+/**
+   @brief Inverts the double key mapping.
+
+   @param key is a key produced by SortKey().
+
+   @return double value keyed.
+ */
+static inline double KeyVal(uint64_t key) {
+  uint64_t bits = (key >> 63) != 0 ? key & ~(1ull << 63) : ~key;
+  double x;
+  memcpy(&x, &bits, sizeof(x));
+
+  return x;
+}
+
+
+/**
+   @brief Maps an int onto an unsigned key of like ordering.
+
+   @param x is the value to map.
+
+   @return order-preserving key.
+ */
+static inline uint32_t SortKey(int x) {
+  return uint32_t(x) ^ 0x80000000u;
+}
+
+
+/**
+   @brief Inverts the int key mapping.
+
+   @return int value keyed.
+ */
+static inline int KeyVal(uint32_t key) {
+  return int(key ^ 0x80000000u);
+}
+
+
+/**
+   @brief Stable least-significant-digit radix sort of keys, with a
+   parallel permutation.  Passes over digits on which all keys agree
+   are skipped.  Columns spanning several chunks are counted and
+   scattered chunkwise in parallel, with each chunk's offsets preceding
+   those of its successors so that stability is preserved.
+
+   @param key are the keys to sort in place.
+
+   @param perm is the permutation to apply in place.
+
+   @param nRow is the number of keys.
+
+   @param chunkParallel is true iff chunks may be processed concurrently.
+
+   @return void, with output reference parameters.
+ */
+template<typename keyType> static void RadixSort(keyType key[], int perm[], unsigned int nRow, bool chunkParallel) {
+  static const unsigned int radixBits = 8;
+  static const unsigned int radix = 1 << radixBits;
+  static const unsigned int chunkRows = 1 << 16;
+  unsigned int nChunk = chunkParallel ? (nRow + chunkRows - 1) / chunkRows : 1;
+  unsigned int chunkSize = (nRow + nChunk - 1) / nChunk;
+
+  keyType *keySrc = key;
+  int *permSrc = perm;
+  keyType *keyDest = new keyType[nRow];
+  int *permDest = new int[nRow];
+  std::vector<unsigned int> count(size_t(nChunk) * radix);
+  for (unsigned int shift = 0; shift < 8 * sizeof(keyType); shift += radixBits) {
+    unsigned int chunk;
+#pragma omp parallel for default(shared) private(chunk) schedule(static) if(nChunk > 1)
+    for (chunk = 0; chunk < nChunk; chunk++) {
+      unsigned int *chunkCount = &count[size_t(chunk) * radix];
+      for (unsigned int digit = 0; digit < radix; digit++)
+	chunkCount[digit] = 0;
+      unsigned int idxEnd = std::min(nRow, (chunk + 1) * chunkSize);
+      for (unsigned int idx = chunk * chunkSize; idx < idxEnd; idx++)
+	chunkCount[(keySrc[idx] >> shift) & (radix - 1)]++;
+    }
+
+    // Converts counts to starting offsets, digit-major then chunk-major.
+    unsigned int off = 0;
+    bool trivial = false;
+    for (unsigned int digit = 0; digit < radix; digit++) {
+      unsigned int digitStart = off;
+      for (chunk = 0; chunk < nChunk; chunk++) {
+	unsigned int digitCount = count[size_t(chunk) * radix + digit];
+	count[size_t(chunk) * radix + digit] = off;
+	off += digitCount;
+      }
+      trivial = trivial || off - digitStart == nRow;
+    }
+    if (trivial) // All keys share this digit.
+      continue;
+
+#pragma omp parallel for default(shared) private(chunk) schedule(static) if(nChunk > 1)
+    for (chunk = 0; chunk < nChunk; chunk++) {
+      unsigned int *chunkOff = &count[size_t(chunk) * radix];
+      unsigned int idxEnd = std::min(nRow, (chunk + 1) * chunkSize);
+      for (unsigned int idx = chunk * chunkSize; idx < idxEnd; idx++) {
+	unsigned int dest = chunkOff[(keySrc[idx] >> shift) & (radix - 1)]++;
+	keyDest[dest] = keySrc[idx];
+	permDest[dest] = permSrc[idx];
+      }
+    }
+    std::swap(keySrc, keyDest);
+    std::swap(permSrc, permDest);
+  }
+
+  if (keySrc != key) { // Odd number of scatters.
+    std::copy(keySrc, keySrc + nRow, key);
+    std::copy(permSrc, permSrc + nRow, perm);
+    std::swap(keySrc, keyDest);
+    std::swap(permSrc, permDest);
+  }
+  delete [] keyDest;
+  delete [] permDest;
+}
+
+
+/**
+   @brief Sorts a single column by value, in place, together with its
+   row permutation.
+
+   @param col is the column of values.
+
+   @param perm outputs the permutation of rows.
+
+   @return void, with output vector parameters.
+ */
+template<typename valType, typename keyType> static void SortColumn(valType col[], int perm[], unsigned int nRow, bool chunkParallel) {
+  keyType *key = new keyType[nRow];
+  for (unsigned int i = 0; i < nRow; i++) {
+    key[i] = SortKey(col[i]);
+    perm[i] = i;
+  }
+  RadixSort(key, perm, nRow, chunkParallel);
+  for (unsigned int i = 0; i < nRow; i++)
+    col[i] = KeyVal(key[i]);
+  delete [] key;
+}
+
+
+/**
+   @brief Merges rows appended to a column into the column's prior
+   ordering.  The appended rows are sorted and merged with the prior
+   rows, which precede them on ties, so that the result agrees with a
+   sort of the whole column.  If the prior rows are found not to be in
+   order, as when their values have been revised, the column is sorted
+   afresh.
+
+   @param col is the column of values, appended rows last.
+
+   @param nRowOld is the number of rows previously ordered.
+
+   @param rowOld is the prior ordering of the leading rows.
+
+   @param colOrd outputs the column's values in order.
+
+   @param perm outputs the permutation of rows.
+
+   @return void, with output vector parameters.
+ */
+template<typename valType, typename keyType> static void MergeColumn(const valType col[], unsigned int nRowOld, unsigned int nRow, const int rowOld[], valType colOrd[], int perm[], bool chunkParallel) {
+  bool ordered = true;
+  for (unsigned int i = 0; i < nRowOld && ordered; i++) {
+    ordered = (unsigned int) rowOld[i] < nRowOld && (i == 0 || SortKey(col[rowOld[i - 1]]) <= SortKey(col[rowOld[i]]));
+  }
+  if (!ordered) {
+    std::copy(col, col + nRow, colOrd);
+    SortColumn<valType, keyType>(colOrd, perm, nRow, chunkParallel);
+    return;
+  }
+
+  unsigned int nRowNew = nRow - nRowOld;
+  keyType *keyNew = new keyType[nRowNew];
+  int *permNew = new int[nRowNew];
+  for (unsigned int i = 0; i < nRowNew; i++) {
+    keyNew[i] = SortKey(col[nRowOld + i]);
+    permNew[i] = nRowOld + i;
+  }
+  RadixSort(keyNew, permNew, nRowNew, chunkParallel);
+
+  unsigned int idxOld = 0;
+  unsigned int idxNew = 0;
+  for (unsigned int idx = 0; idx < nRow; idx++) {
+    keyType key;
+    if (idxNew == nRowNew || (idxOld < nRowOld && SortKey(col[rowOld[idxOld]]) <= keyNew[idxNew])) {
+      perm[idx] = rowOld[idxOld++];
+      key = SortKey(col[perm[idx]]);
+    }
+    else {
+      perm[idx] = permNew[idxNew];
+      key = keyNew[idxNew++];
+    }
+    colOrd[idx] = KeyVal(key);
+  }
+
+  delete [] keyNew;
+  delete [] permNew;
+}
+
+
+/**
+   @brief Decides how to divide sorting among threads:  predictors are
+   sorted concurrently when there are enough to occupy the threads,
+   otherwise in turn, with large columns divided among the threads.
+
+   @param nPred is the number of predictors to sort.
+
+   @return true iff predictors are to be sorted concurrently.
+ */
+static bool PredParallel(unsigned int nPred) {
+#ifdef _OPENMP
+  return nPred >= (unsigned int) omp_get_max_threads();
+#else
+  return true;
+#endif
+}
+
+
 /**
  @brief Sorts each column of predictors, saving value and permutation vectors.
+ Ties are ordered by row.
 
  @param numOrd outputs the sorted numeric values.
 
@@ -95,16 +397,14 @@ void RowRank::PreSortFac(const int _feFac[], unsigned int _facStart, unsigned in
 
  @return void, with output vector parameters.
 */
-void RowRank::Sort(int _nRow, int _nPredNum, double numOrd[], int perm[]) {
-  int colOff = 0;  
-  for (int numIdx = 0; numIdx < _nPredNum; numIdx++, colOff += _nRow) {
-    /* Sort-with-index requires a vector of rows to permute.*/
-    for (int i = 0; i < _nRow; i++)
-      perm[colOff + i] = i;
-    // TODO:  Replace with thread-safe sort to permit parallel execution.
-    // Row consistency does not appear necessary:  unstable sort suffices.
-    //
-    CallBack::QSortD(numOrd + colOff, perm + colOff, 1, _nRow);
+void RowRank::Sort(unsigned int _nRow, unsigned int _nPredNum, double numOrd[], int perm[]) {
+  bool predParallel = PredParallel(_nPredNum);
+  unsigned int numIdx;
+
+#pragma omp parallel for default(shared) private(numIdx) schedule(dynamic, 1) if(predParallel)
+  for (numIdx = 0; numIdx < _nPredNum; numIdx++) {
+    size_t colOff = size_t(numIdx) * _nRow;
+    SortColumn<double, uint64_t>(numOrd + colOff, perm + colOff, _nRow, !predParallel);
   }
 }
 
@@ -114,13 +414,57 @@ void RowRank::Sort(int _nRow, int _nPredNum, double numOrd[], int perm[]) {
 
    @return void, with output reference parameters.
  */
-void RowRank::Sort(int _nRow, int _nPredFac, int facOrd[], int perm[]) {
-  int colOff = 0;
-  for (int facIdx = 0; facIdx < _nPredFac; facIdx++, colOff += _nRow) {
-    for (int i = 0; i < _nRow; i++)
-      perm[colOff + i] = i;
-    // TODO:  Replace with thread-safe sort to permit parallel execution.
-    CallBack::QSortI(facOrd + colOff, perm + colOff, 1, _nRow);
+void RowRank::Sort(unsigned int _nRow, unsigned int _nPredFac, int facOrd[], int perm[]) {
+  bool predParallel = PredParallel(_nPredFac);
+  unsigned int facIdx;
+
+#pragma omp parallel for default(shared) private(facIdx) schedule(dynamic, 1) if(predParallel)
+  for (facIdx = 0; facIdx < _nPredFac; facIdx++) {
+    size_t colOff = size_t(facIdx) * _nRow;
+    SortColumn<int, uint32_t>(facOrd + colOff, perm + colOff, _nRow, !predParallel);
+  }
+}
+
+
+/**
+   @brief Merges appended rows into the prior orderings of numeric
+   predictors.
+
+   @param _feNum is the block of numeric values, over all rows.
+
+   @param _rowOld is the prior row ordering, over the leading rows.
+
+   @param numOrd outputs the ordered numeric values.
+
+   @param perm outputs the permutation vectors.
+
+   @return void, with output vector parameters.
+ */
+void RowRank::Merge(unsigned int _nRowOld, unsigned int _nRow, unsigned int _nPredNum, const double _feNum[], const int _rowOld[], double numOrd[], int perm[]) {
+  bool predParallel = PredParallel(_nPredNum);
+  unsigned int numIdx;
+
+#pragma omp parallel for default(shared) private(numIdx) schedule(dynamic, 1) if(predParallel)
+  for (numIdx = 0; numIdx < _nPredNum; numIdx++) {
+    size_t colOff = size_t(numIdx) * _nRow;
+    MergeColumn<double, uint64_t>(_feNum + colOff, _nRowOld, _nRow, _rowOld + size_t(numIdx) * _nRowOld, numOrd + colOff, perm + colOff, !predParallel);
+  }
+}
+
+
+/**
+   @brief Same as above, but with factor-valued predictors.
+
+   @return void, with output vector parameters.
+ */
+void RowRank::Merge(unsigned int _nRowOld, unsigned int _nRow, unsigned int _nPredFac, const int _feFac[], const int _rowOld[], int facOrd[], int perm[]) {
+  bool predParallel = PredParallel(_nPredFac);
+  unsigned int facIdx;
+
+#pragma omp parallel for default(shared) private(facIdx) schedule(dynamic, 1) if(predParallel)
+  for (facIdx = 0; facIdx < _nPredFac; facIdx++) {
+    size_t colOff = size_t(facIdx) * _nRow;
+    MergeColumn<int, uint32_t>(_feFac + colOff, _nRowOld, _nRow, _rowOld + size_t(facIdx) * _nRowOld, facOrd + colOff, perm + colOff, !predParallel);
   }
 }
 
@@ -130,18 +474,17 @@ void RowRank::Sort(int _nRow, int _nPredFac, int facOrd[], int perm[]) {
 
    @param rowRank outputs the matrix of predictor-order objects.
 
+   @param _rankMax is the cap on distinct ranks, zero if uncapped.
+
    @return void, with output parameter matrix.
 */
-void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredNum, double _numOrd[], int _row[], int _rank[], int _invRank[]) {
-  unsigned int colOff = 0;
-  unsigned int numIdx; 
-
-  //#pragma omp parallel default(shared) private(predIdx)//, baseOff, rankOff)
-  {
-    //  #pragma omp for schedule(static, 1) nowait
-    for (numIdx = 0; numIdx < _nPredNum; numIdx++, colOff += _nRow) {
-      Ranks(_nRow, _numOrd + colOff, _row + colOff, _rank + colOff, _invRank + colOff);
-    }
+void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredNum, double _numOrd[], int _row[], int _rank[], int _invRank[], unsigned int _rankMax) {
+  unsigned int numIdx;
+
+#pragma omp parallel for default(shared) private(numIdx) schedule(dynamic, 1)
+  for (numIdx = 0; numIdx < _nPredNum; numIdx++) {
+    size_t colOff = size_t(numIdx) * _nRow;
+    Ranks(_nRow, _numOrd + colOff, _row + colOff, _rank + colOff, _invRank + colOff, _rankMax);
   }
 }
 
@@ -150,15 +493,12 @@ void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredNum, double _numOrd[]
    @brief As above, but i) looping over factor predictors and ii) no inverse map computed.
  */
 void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredFac, int _facOrd[], int _rank[]) {
-  unsigned int colOff = 0;
   unsigned int facIdx;
-  
-  //#pragma omp parallel default(shared) private(predIdx)//, baseOff, rankOff)
-  {    // Factors:
-    //#pragma omp for schedule(static, 1) nowait
-    for (facIdx = 0; facIdx < _nPredFac; facIdx++, colOff += _nRow) {
-      Ranks(_nRow, _facOrd + colOff, _rank + colOff);
-    }
+
+#pragma omp parallel for default(shared) private(facIdx) schedule(dynamic, 1)
+  for (facIdx = 0; facIdx < _nPredFac; facIdx++) {
+    size_t colOff = size_t(facIdx) * _nRow;
+    Ranks(_nRow, _facOrd + colOff, _rank + colOff);
   }
 }
 
@@ -166,6 +506,13 @@ void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredFac, int _facOrd[], i
 /**
    @brief Walks sorted predictor rows, assigning rank, row and inverse maps.
 
+   When ranks are capped, the sorted positions are divided into
+   '_rankMax' bins of equal count, and a new rank begins only where the
+   value changes within a bin later than that in which the current rank
+   began.  Ranks therefore remain dense, ties continue to share a rank,
+   and at most '_rankMax' ranks are assigned, each spanning a range of
+   values.
+
    @param xCol[] are the sorted values of a numeric predictor.
 
    @param row is the permutation vector defined by the sort.
@@ -176,14 +523,31 @@ void RowRank::Ranks(unsigned int _nRow, unsigned int _nPredFac, int _facOrd[], i
 
    @param invRank[] maps ranks to one (of possibly many) associated row.
 
+   @param _rankMax is the cap on distinct ranks, zero if uncapped.
+
    @return void, with output vector parameters.
 */
-void RowRank::Ranks(unsigned int _nRow, const double xCol[], const int row[], int rank[], int invRank[]) {
+void RowRank::Ranks(unsigned int _nRow, const double xCol[], const int row[], int rank[], int invRank[], unsigned int _rankMax) {
+  if (_nRow == 0)
+    return;
+
   unsigned int rk = 0;
+  uint64_t binRank = 0; // Bin in which current rank began.
   double prevX = xCol[0];
   for (unsigned int rw = 0; rw < _nRow; rw++) {
     double curX = xCol[rw];
-    rk = curX == prevX ? rk : rk + 1;
+    if (curX != prevX) {
+      if (_rankMax == 0) {
+        rk++;
+      }
+      else {
+        uint64_t bin = (uint64_t(rw) * _rankMax) / _nRow;
+        if (bin > binRank) {
+          binRank = bin;
+          rk++;
+        }
+      }
+    }
     rank[rw] = rk;
     invRank[rk] = row[rw];  // Assignment of row within a run is arbitrary.
     prevX = curX;
@@ -211,6 +575,9 @@ void RowRank::Ranks(unsigned int _nRow, const int xCol[], int rank[]) {
 
 /**
    @brief Constructor for row, rank passed from front end as parallel arrays.
+   The arrays are borrowed rather than copied, and so must outlive the
+   object.  Numeric predictors dominated by a single rank are staged
+   without their dominant run, which is recorded as implicit.
 
    @param _feRow is the vector of rows allocated by the front end.
 
@@ -218,30 +585,68 @@ void RowRank::Ranks(unsigned int _nRow, const int xCol[], int rank[]) {
 
    @param _feInvNum is the rank-to-row mapping for numeric predictors.
  */
-RowRank::RowRank(const int _feRow[], const int _feRank[], const int _feInvNum[], unsigned int _nRow, unsigned int _nPredDense) : nRow(_nRow), nBlock(0), nPredDense(_nPredDense), invNum(_feInvNum) {
-  int dim = nRow * nPredDense;
+RowRank::RowRank(const int _feRow[], const int _feRank[], const int _feInvNum[], unsigned int _nRow, unsigned int _nPred) : nRow(_nRow), nPred(_nPred), nBlock(0), feRow(_feRow), feRank(_feRank), invNum(_feInvNum) {
+  blockRank = new BlockRank[nPred];
+  MemTrack::Charge(MemTrack::rowRank, nPred * sizeof(BlockRank));
+  unsigned int nPredNum = PBTrain::NPredNum();
+  for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
+    unsigned int runStart = 0;
+    unsigned int extent = 0;
+    if (predIdx < nPredNum) {
+      extent = Plurality(feRank + size_t(predIdx) * nRow, nRow, runStart);
+      if (extent < autoCompress * nRow)
+	extent = 0;
+    }
+    nBlock += extent > 0 ? 1 : 0;
+    blockRank[predIdx].Init(runStart, extent, feRank[size_t(predIdx) * nRow + runStart]);
+  }
+}
+
+
+/**
+   @brief Finds the longest run of a single rank within a presorted
+   column.  As ranks are nondecreasing, equal ranks are consecutive.
 
-  rowRank = new RRNode[dim];
-  for (int i = 0; i < dim; i++) {
-    rowRank[i].Set(_feRow[i], _feRank[i]);
+   @param rank is the column of ranks.
+
+   @param runStart outputs the starting position of the longest run.
+
+   @return length of the longest run.
+ */
+unsigned int RowRank::Plurality(const int rank[], unsigned int _nRow, unsigned int &runStart) {
+  unsigned int runMax = 0;
+  unsigned int start = 0;
+  for (unsigned int idx = 1; idx <= _nRow; idx++) {
+    if (idx == _nRow || rank[idx] != rank[start]) {
+      if (idx - start > runMax) {
+	runMax = idx - start;
+	runStart = start;
+      }
+      start = idx;
+    }
   }
 
-  //  blockRank = new BlockRank[nBlock];
+  return runMax;
 }
 
 
 /**
-   @brief Deallocates and resets.
+   @brief Deallocates and resets.  Front-end arrays remain the caller's.
 
    @return void.
  */
 RowRank::~RowRank() {
-  delete [] rowRank;
+  MemTrack::Release(MemTrack::rowRank, nPred * sizeof(BlockRank));
+  delete [] blockRank;
 }
 
 
 /**
-  @brief Derives split values for a numerical predictor.
+  @brief Derives split values for a numerical predictor.  The split
+  falls midway between the greatest value of the low rank and the least
+  value of the high rank, which are located by search of the
+  predictor's rank-ordered column.  With exact ranks the values of a
+  rank coincide, but capped ranks span ranges of values.
 
   @param predIdx is the preditor index.
 
@@ -250,7 +655,11 @@ RowRank::~RowRank() {
   @return predictor value at mean rank, computed by PredBlock method.
 */
 double RowRank::MeanRank(unsigned int predIdx, double rkMean) const {
-  unsigned int rankLow = floor(rkMean);
-  unsigned int rankHigh = ceil(rkMean);
-  return PBTrain::MeanVal(predIdx, Rank2Row(predIdx, rankLow), Rank2Row(predIdx, rankHigh));
+  int rankLow = floor(rkMean);
+  int rankHigh = ceil(rkMean);
+  size_t colOff = size_t(predIdx) * nRow;
+  const int *colRank = feRank + colOff;
+  unsigned int idxLow = std::upper_bound(colRank, colRank + nRow, rankLow) - colRank - 1;
+  unsigned int idxHigh = std::lower_bound(colRank, colRank + nRow, rankHigh) - colRank;
+  return PBTrain::MeanVal(predIdx, feRow[colOff + idxLow], feRow[colOff + idxHigh]);
 }
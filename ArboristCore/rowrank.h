@@ -16,29 +16,51 @@
 #ifndef ARBORIST_ROWRANK_H
 #define ARBORIST_ROWRANK_H
 
-class RRNode {
-  unsigned int row;
-  unsigned int rank;
+#include <cstddef>
+
+/**
+   @brief Represents ranks for sparsely-expressed predictors.  A
+   predictor's most frequent rank, if sufficiently dominant, is held as
+   a single implicit run, with only the remaining entries enumerated
+   explicitly.
+ */
+class BlockRank {
+  unsigned int runStart; // Column position of implicit run, if any.
+  unsigned int extent; // Length of implicit run:  zero iff none.
+  unsigned int rank; // Rank of implicit run, if any.
  public:
-  unsigned int Lookup(unsigned int &_rank) {
-    _rank = rank;
-    return row;
-  }
-  void Set(int _row, int _rank) {
-    row = _row;
+  void Init(unsigned int _runStart, unsigned int _extent, unsigned int _rank) {
+    runStart = _runStart;
+    extent = _extent;
     rank = _rank;
   }
-};
 
 
-/**
-   @brief Represents ranks for sparsely-expressed predictors.
- */
-class BlockRank {
-  unsigned int predIdx;
-  unsigned int extent;
-  unsigned int row; // Starting row.
-  unsigned int rank;
+  /**
+     @brief Maps an explicit index to its position within the column.
+     The run is contiguous, as the column is ordered by rank, so
+     explicit entries are those preceding and following it.
+
+     @param idx is the explicit index.
+
+     @return column position.
+   */
+  inline unsigned int ColIdx(unsigned int idx) const {
+    return idx < runStart ? idx : idx + extent;
+  }
+
+
+  /**
+     @brief Accessor for implicit run.
+
+     @param _rank outputs the rank of the run.  Undefined if no run.
+
+     @return length of run, zero if none.
+   */
+  inline unsigned int Implicit(unsigned int &_rank) const {
+    _rank = rank;
+    return extent;
+  }
 };
 
 
@@ -47,25 +69,35 @@ class BlockRank {
 
 */
 class RowRank {
+  // Numeric predictors whose most frequent rank covers at least this
+  // fraction of rows are represented sparsely.
+  static constexpr double autoCompress = 0.5;
+
   const unsigned int nRow;
-  const unsigned int nBlock; // Number of BlockRank objects.
-  const unsigned int nPredDense; // Number of non-sparse predictors.
+  const unsigned int nPred;
+  unsigned int nBlock; // Number of predictors having an implicit run.
+  const int *feRow; // Borrowed from front end:  predictor-major.
+  const int *feRank; // Borrowed, parallel to 'feRow'.
   const int *invNum; // Numeric predictors only:  split assignment.
-  RRNode *rowRank;
-  BlockRank *blockRank;
-
-  static void Sort(int _nRow, int _nPredNum, double numOrd[], int perm[]);
-  static void Sort(int _nRow, int _nPredFac, int facOrd[], int perm[]);
-  static void Ranks(unsigned int _nRow, unsigned int _nPredNum, double _numOrd[], int _row[], int _rank[], int _invRank[]);
+  BlockRank *blockRank; // Per-predictor implicit runs.
+
+  static unsigned int Plurality(const int rank[], unsigned int _nRow, unsigned int &runStart);
+  static void Sort(unsigned int _nRow, unsigned int _nPredNum, double numOrd[], int perm[]);
+  static void Sort(unsigned int _nRow, unsigned int _nPredFac, int facOrd[], int perm[]);
+  static void Merge(unsigned int _nRowOld, unsigned int _nRow, unsigned int _nPredNum, const double _feNum[], const int _rowOld[], double numOrd[], int perm[]);
+  static void Merge(unsigned int _nRowOld, unsigned int _nRow, unsigned int _nPredFac, const int _feFac[], const int _rowOld[], int facOrd[], int perm[]);
+  static void Ranks(unsigned int _nRow, unsigned int _nPredNum, double _numOrd[], int _row[], int _rank[], int _invRank[], unsigned int _rankMax);
   static void Ranks(unsigned int _nRow, unsigned int _nPredFac, int _facOrd[], int _rank[]);
-  static void Ranks(unsigned int _nRow, const double xCol[], const int row[], int rank[], int invRank[]);
+  static void Ranks(unsigned int _nRow, const double xCol[], const int row[], int rank[], int invRank[], unsigned int _rankMax);
   static void Ranks(unsigned int _nRow, const int xCol[], int rank[]);
 
  public:
-  static void PreSortNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRow, int _row[], int _rank[], int _invNum[]);
+  static void PreSortNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRow, int _row[], int _rank[], int _invNum[], unsigned int _rankMax = 0);
   static void PreSortFac(const int _feFac[], unsigned int _nPredNum, unsigned int _nPredFac, unsigned int _nRow, int _row[], int _rank[]);
+  static void MergeNum(const double _feNum[], unsigned int _nPredNum, unsigned int _nRowOld, unsigned int _nRow, const int _rowOld[], int _row[], int _rank[], int _invNum[], unsigned int _rankMax = 0);
+  static void MergeFac(const int _feFac[], unsigned int _facStart, unsigned int _nPredFac, unsigned int _nRowOld, unsigned int _nRow, const int _rowOld[], int _row[], int _rank[]);
 
-  RowRank(const int _feRow[], const int _feRank[], const int _feInvNum[], unsigned int _nRow, unsigned int _nPredDense);
+  RowRank(const int _feRow[], const int _feRank[], const int _feInvNum[], unsigned int _nRow, unsigned int _nPred);
   ~RowRank();
 
   /**
@@ -73,23 +105,76 @@ class RowRank {
 
      @param predIdx is the predictor index.
 
-     @param idx is the index into a RowRank predictor column.
+     @param idx is the index into the predictor's explicit entries.
 
-     @param _row outputs the looked-up row.
+     @param _rank outputs the looked-up rank.
 
-     @return rank at predictor/row.
+     @return row at predictor/index.
    */
   unsigned int inline Lookup(unsigned int predIdx, unsigned int idx, unsigned int &_rank) const {
-    return rowRank[predIdx * nRow + idx].Lookup(_rank);
+    size_t colIdx = size_t(predIdx) * nRow + blockRank[predIdx].ColIdx(idx);
+    _rank = feRank[colIdx];
+    return feRow[colIdx];
+  }
+
+
+  /**
+     @brief Counts the entries of a predictor enumerated explicitly.
+
+     @param predIdx is the predictor index.
+
+     @return count of explicit entries:  'nRow' iff no implicit run.
+   */
+  unsigned int inline ExplicitCount(unsigned int predIdx) const {
+    unsigned int rank;
+    return nRow - blockRank[predIdx].Implicit(rank);
+  }
+
+
+  /**
+     @brief Looks up the rank of a predictor's implicit run.
+
+     @param predIdx is the predictor index.
+
+     @return rank of run, if any, otherwise undefined.
+   */
+  unsigned int inline RankDense(unsigned int predIdx) const {
+    unsigned int rank;
+    (void) blockRank[predIdx].Implicit(rank);
+    return rank;
+  }
+
+
+  /**
+     @brief Accessor for count of sparsely-represented predictors.
+
+     @return count of predictors having an implicit run.
+   */
+  unsigned int inline NBlock() const {
+    return nBlock;
+  }
+
+
+  /**
+     @brief Looks up the highest rank of a predictor, which is held at
+     the final position of its column.
+
+     @param predIdx is the predictor index.
+
+     @return highest rank.
+   */
+  unsigned int inline RankMax(unsigned int predIdx) const {
+    return feRank[size_t(predIdx) * nRow + nRow - 1];
   }
 
+
   /**
      @brief asssumes numerical predictor.
 
      @return a (possibly nonunique) row index at which predictor has rank passed.
    */
   inline unsigned int Rank2Row(unsigned int predIdx, int _rank) const {
-    return invNum[predIdx * nRow + _rank];
+    return invNum[size_t(predIdx) * nRow + _rank];
   }
   
   double MeanRank(unsigned int predIdx, double rkMean) const;
@@ -14,7 +14,8 @@
  */
 
 #include "runset.h"
-#include "callback.h"
+#include "philox.h"
+#include "arena.h"
 
 // Testing only:
 //#include <iostream>
@@ -69,20 +70,25 @@ Run::Run(unsigned int _ctgWidth) : ctgWidth(_ctgWidth) {
   lhOut = 0;
   rvWide = 0;
   ctgSum = 0;
+  arena = 0;
 }
 
 
 /**
    @brief Initializes the run counts to conservative values.
 
+   @param _arena is the tree's arena, from which the level's run
+   workspace is drawn.
+
    @param safeCount is a vector of run counts.
 
    @return void.
  */
-void Run::RunSets(const std::vector<unsigned int> &safeCount) {
+void Run::RunSets(Arena *_arena, const std::vector<unsigned int> &safeCount) {
+  arena = _arena;
   setCount = safeCount.size();
   if (setCount > 0) {
-    runSet = new RunSet[setCount];
+    runSet = arena->Alloc<RunSet>(setCount);
     for (unsigned int setIdx = 0; setIdx < setCount; setIdx++) {
       CountSafe(setIdx) = safeCount[setIdx];
     }
@@ -105,9 +111,9 @@ void Run::OffsetsReg() {
     runCount += runSet[i].CountSafe();
   }
 
-  facRun = new FRNode[runCount];
-  bHeap = new BHPair[runCount];
-  lhOut = new unsigned int[runCount];
+  facRun = arena->Alloc<FRNode>(runCount);
+  bHeap = arena->Alloc<BHPair>(runCount);
+  lhOut = arena->Alloc<unsigned int>(runCount);
 
   ResetRuns();
 }
@@ -116,10 +122,15 @@ void Run::OffsetsReg() {
 /**
    @brief Classification:  only wide run sets use the heap.
 
+   @param tIdx is the absolute index of the tree.
+
+   @param levelSeq is the level's position in the tree's training
+   sequence.
+
    @return void.
 
 */
-void Run::OffsetsCtg() {
+void Run::OffsetsCtg(unsigned int tIdx, unsigned int levelSeq) {
   if (setCount == 0)
     return;
 
@@ -147,18 +158,18 @@ void Run::OffsetsCtg() {
   }
 
   unsigned int boardWidth = runCount * ctgWidth; // Checkerboard.
-  ctgSum = new double[boardWidth];
+  ctgSum = arena->Alloc<double>(boardWidth);
   for (unsigned int i = 0; i < boardWidth; i++)
     ctgSum[i] = 0.0;
 
   if (ctgWidth > 2 && heapRuns > 0) { // Wide non-binary:  w.o. replacement.
-    rvWide = new double[heapRuns];
-    CallBack::RUnif(heapRuns, rvWide);
+    rvWide = arena->Alloc<double>(heapRuns);
+    Philox::Uniform(tIdx, levelSeq, Philox::runWide, heapRuns, rvWide);
   }
 
-  facRun = new FRNode[runCount];
-  bHeap = new BHPair[heapRuns];
-  lhOut = new unsigned int[outRuns];
+  facRun = arena->Alloc<FRNode>(runCount);
+  bHeap = arena->Alloc<BHPair>(heapRuns);
+  lhOut = arena->Alloc<unsigned int>(outRuns);
 
   ResetRuns();
 }
@@ -176,17 +187,14 @@ void Run::ResetRuns() {
 }
 
 
+/**
+   @brief Relinquishes level's workspace, which is reclaimed with the
+   arena.
+
+   @return void.
+ */
 void Run::LevelClear() {
   if (setCount > 0) {
-    delete [] runSet;
-    delete [] facRun;
-    delete [] lhOut;
-    if (rvWide != 0)
-      delete [] rvWide;
-    if (ctgSum != 0)
-      delete [] ctgSum;
-    if (bHeap != 0)
-      delete [] bHeap;
     runSet = 0;
     facRun = 0;
     lhOut = 0;
@@ -290,7 +298,7 @@ unsigned int RunSet::DeWide() {
 
   HeapRandom();
   FRNode tempRun[maxWidth];
-  double *tempSum = new double(ctgWidth * maxWidth);
+  double *tempSum = new double[ctgWidth * maxWidth];
   // Copies runs referenced by the slot list to a temporary area.
   DePop(maxWidth);
   for (unsigned int i = 0; i < maxWidth; i++) {
@@ -226,6 +226,7 @@ class Run {
   unsigned int *lhOut; // Vector of lh-bound slot indices.
   double *rvWide;
   double *ctgSum;
+  class Arena *arena; // Source of level's workspace.
 
   void ResetRuns();
 
@@ -235,7 +236,7 @@ class Run {
 
   void LevelClear();
   void OffsetsReg();
-  void OffsetsCtg();
+  void OffsetsCtg(unsigned int tIdx, unsigned int levelSeq);
 
   inline RunSet *RSet(unsigned int rsIdx) {
     return &runSet[rsIdx];
@@ -251,7 +252,7 @@ class Run {
   }
 
   
-  void RunSets(const std::vector<unsigned int> &safeCount);
+  void RunSets(class Arena *_arena, const std::vector<unsigned int> &safeCount);
 
   /**
      @brief Presets runCount field to a conservative value for
@@ -15,11 +15,14 @@
 
 #include "sample.h"
 #include "bv.h"
-#include "callback.h"
 #include "rowrank.h"
 #include "samplepred.h"
 #include "bottom.h"
 #include "forest.h"
+#include "philox.h"
+
+#include <cmath>
+#include <algorithm>
 
 //#include <iostream>
 using namespace std;
@@ -29,6 +32,8 @@ using namespace std;
 unsigned int Sample::nRow = 0;
 unsigned int Sample::nPred = 0;
 int Sample::nSamp = -1;
+bool Sample::withRepl = true;
+std::vector<double> Sample::sampleWeight;
 
 unsigned int SampleCtg::ctgWidth = 0;
 
@@ -39,22 +44,27 @@ unsigned int SampleCtg::ctgWidth = 0;
 
  @param _nSamp is the number of samples.
 
+ @param _feSampleWeight is the user-specified weighting of rows.
+
+ @param _withRepl is true iff sampling with replacement.
+
  @return void.
 */
-void Sample::Immutables(unsigned int _nRow, unsigned int _nPred, int _nSamp, double _feSampleWeight[], bool _withRepl, unsigned int _ctgWidth, int _nTree) {
+void Sample::Immutables(unsigned int _nRow, unsigned int _nPred, int _nSamp, double _feSampleWeight[], bool _withRepl, unsigned int _ctgWidth) {
   nRow = _nRow;
   nPred = _nPred;
   nSamp = _nSamp;
-  CallBack::SampleInit(nRow, _feSampleWeight, _withRepl);
+  withRepl = _withRepl;
+  WeightInit(_feSampleWeight);
   if (_ctgWidth > 0)
-    SampleCtg::Immutables(_ctgWidth, _nTree);
+    SampleCtg::Immutables(_ctgWidth);
 }
 
 
 /**
    @return void.
  */
-void SampleCtg::Immutables(unsigned int _ctgWidth, int _nTree) {
+void SampleCtg::Immutables(unsigned int _ctgWidth) {
   ctgWidth = _ctgWidth;
 }
 
@@ -75,11 +85,54 @@ void Sample::DeImmutables() {
   nRow = 0;
   nPred = 0;
   nSamp = -1;
+  withRepl = true;
+  sampleWeight.clear();
   SampleCtg::DeImmutables();
 }
 
 
-Sample::Sample() {
+/**
+   @brief Estimates a tree's training footprint in advance of sampling.
+   The bag count is taken at its expectation.
+
+   @return estimated footprint, in bytes.
+ */
+size_t Sample::BytesEst() {
+  unsigned int bagEst;
+  if (withRepl)
+    bagEst = ceil(nRow * (1.0 - exp(-double(nSamp) / nRow)));
+  else
+    bagEst = min(unsigned(nSamp), nRow);
+
+  return Overhead(bagEst) + SamplePred::BytesEst(nPred, bagEst);
+}
+
+
+/**
+   @brief Reports the footprint of this sample's training structures.
+
+   @return footprint, in bytes.
+ */
+size_t Sample::Bytes() const {
+  return Overhead(bagCount) + samplePred->Bytes();
+}
+
+
+/**
+   @brief Sizes those per-tree structures other than the SamplePred
+   workspace:  row and sample maps, the in-bag bits, the sample paths
+   and the pretree frontier.
+
+   @param _bagCount is the bag count.
+
+   @return footprint, in bytes.
+ */
+size_t Sample::Overhead(unsigned int _bagCount) {
+  return size_t(nRow) * sizeof(int) + BV::SlotAlign(nRow) * sizeof(unsigned int) + size_t(nSamp) * sizeof(SampleNode) + size_t(_bagCount) * (sizeof(SamplePath) + 2 * sizeof(unsigned int));
+}
+
+
+Sample::Sample(unsigned int _tIdx) : tIdx(_tIdx) {
   treeBag = new BV(nRow);
   row2Sample = new int[nRow];
   sampleNode = new SampleNode[nSamp]; // Lives until scoring.
@@ -95,13 +148,53 @@ Sample::~Sample() {
 }
 
 
+/**
+   @brief Retains the sample weights in the form sampling consults:
+   cumulative, with replacement, otherwise as given.  Uniform weights
+   sampled with replacement are not retained, as rows are then drawn
+   directly.
+
+   @param _feSampleWeight is the user-specified weighting of rows.
+
+   @return void.
+ */
+void Sample::WeightInit(const double _feSampleWeight[]) {
+  sampleWeight.clear();
+  bool uniform = true;
+  for (unsigned int row = 1; row < nRow; row++) {
+    if (_feSampleWeight[row] != _feSampleWeight[0]) {
+      uniform = false;
+      break;
+    }
+  }
+  if (withRepl && uniform)
+    return;
+
+  sampleWeight.assign(_feSampleWeight, _feSampleWeight + nRow);
+  if (withRepl) {
+    double sum = 0.0;
+    for (unsigned int row = 0; row < nRow; row++) {
+      sum += sampleWeight[row];
+      sampleWeight[row] = sum;
+    }
+  }
+}
+
+
 /**
    @brief Samples and enumerates instances of each row index.
-   'bagCount'.
+   Variates are drawn from the tree's sampling stream.
+
+   With replacement, rows are drawn by inverting the cumulative
+   weights.  Without replacement, the rows having the smallest
+   exponential keys are taken, the keys being scaled by the reciprocal
+   weights.
+
+   @param tIdx is the absolute index of the tree.
 
    @return vector of sample counts, by row.
 */
-unsigned int *Sample::RowSample() {
+unsigned int *Sample::RowSample(unsigned int tIdx) {
   unsigned int *sCountRow = new unsigned int[nRow];
   for (unsigned int row = 0; row < nRow; row++) {
     sCountRow[row] = 0;
@@ -110,13 +203,40 @@ unsigned int *Sample::RowSample() {
   // Counts occurrences of the rank associated with each target 'row' of the
   // sampling vector.
   //
-  int *rvRow = new int[nSamp];
-  CallBack::SampleRows(nSamp, rvRow);
-  for (int i = 0; i < nSamp; i++) {
-    int row = rvRow[i];
-    sCountRow[row]++;
+  if (withRepl) {
+    double *rvRow = new double[nSamp];
+    Philox::Uniform(tIdx, 0, Philox::sample, nSamp, rvRow);
+    if (sampleWeight.empty()) {
+      for (int i = 0; i < nSamp; i++) {
+        unsigned int row = rvRow[i] * nRow;
+        sCountRow[row < nRow ? row : nRow - 1]++;
+      }
+    }
+    else {
+      double weightTot = sampleWeight.back();
+      for (int i = 0; i < nSamp; i++) {
+        unsigned int row = upper_bound(sampleWeight.begin(), sampleWeight.end(), rvRow[i] * weightTot) - sampleWeight.begin();
+        sCountRow[row < nRow ? row : nRow - 1]++;
+      }
+    }
+    delete [] rvRow;
+  }
+  else {
+    double *rvKey = new double[nRow];
+    Philox::Uniform(tIdx, 0, Philox::sample, nRow, rvKey);
+    vector<pair<double, unsigned int> > key(nRow);
+    for (unsigned int row = 0; row < nRow; row++) {
+      double weight = sampleWeight[row];
+      key[row] = make_pair(weight > 0.0 ? -log(rvKey[row]) / weight : HUGE_VAL, row);
+    }
+    delete [] rvKey;
+    unsigned int sampMax = min(unsigned(nSamp), nRow);
+    if (sampMax > 0)
+      nth_element(key.begin(), key.begin() + (sampMax - 1), key.end());
+    for (unsigned int i = 0; i < sampMax; i++) {
+      sCountRow[key[i].second]++;
+    }
   }
-  delete [] rvRow;
 
   return sCountRow;
 }
@@ -124,9 +244,11 @@ unsigned int *Sample::RowSample() {
 
 /**
    @brief Static entry for classification.
+
+   @param _tIdx is the absolute index of the tree.
  */
-SampleCtg *Sample::FactoryCtg(const std::vector<double> &y, const RowRank *rowRank,  const std::vector<unsigned int> &yCtg) {
-  SampleCtg *sampleCtg = new SampleCtg();
+SampleCtg *Sample::FactoryCtg(const std::vector<double> &y, const RowRank *rowRank,  const std::vector<unsigned int> &yCtg, unsigned int _tIdx) {
+  SampleCtg *sampleCtg = new SampleCtg(_tIdx);
   sampleCtg->Stage(yCtg, y, rowRank);
 
   return sampleCtg;
@@ -136,9 +258,10 @@ SampleCtg *Sample::FactoryCtg(const std::vector<double> &y, const RowRank *rowRa
 /**
    @brief Static entry for regression response.
 
+   @param _tIdx is the absolute index of the tree.
  */
-SampleReg *Sample::FactoryReg(const std::vector<double> &y, const RowRank *rowRank, const std::vector<unsigned int> &row2Rank) {
-  SampleReg *sampleReg = new SampleReg();
+SampleReg *Sample::FactoryReg(const std::vector<double> &y, const RowRank *rowRank, const std::vector<unsigned int> &row2Rank, unsigned int _tIdx) {
+  SampleReg *sampleReg = new SampleReg(_tIdx);
   sampleReg->Stage(y, row2Rank, rowRank);
 
   return sampleReg;
@@ -148,7 +271,7 @@ SampleReg *Sample::FactoryReg(const std::vector<double> &y, const RowRank *rowRa
 /**
    @brief Constructor.
  */
-SampleReg::SampleReg() : Sample() {
+SampleReg::SampleReg(unsigned int _tIdx) : Sample(_tIdx) {
 }
 
 
@@ -196,7 +319,7 @@ void SampleReg::SetRank(const std::vector<unsigned int> &row2Rank) {
 /**
    @brief Constructor.
  */
-SampleCtg::SampleCtg() : Sample() {
+SampleCtg::SampleCtg(unsigned int _tIdx) : Sample(_tIdx) {
 }
 
 
@@ -228,7 +351,7 @@ void SampleCtg::Stage(const std::vector<unsigned int> &yCtg, const std::vector<d
    @return vector of compressed indices into sample data structures.
  */
 void Sample::PreStage(const std::vector<double> &y, const std::vector<unsigned int> &yCtg, const RowRank *rowRank) {
-  unsigned int *sCountRow = RowSample();
+  unsigned int *sCountRow = RowSample(tIdx);
   unsigned int slotBits = BV::SlotBits();
 
   bagSum = 0.0;
@@ -256,7 +379,15 @@ void Sample::PreStage(const std::vector<double> &y, const std::vector<unsigned i
   bagCount = sIdx;
   delete [] sCountRow;
 
-  samplePred = SamplePred::Factory(nPred, bagCount);
+  // Ranks are staged at the narrowest width admitted by each
+  // predictor's cardinality.
+  std::vector<unsigned int> rankWidth(nPred);
+  std::vector<unsigned int> rankDense(nPred);
+  for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
+    rankWidth[predIdx] = SamplePred::RankWidth(rowRank->RankMax(predIdx));
+    rankDense[predIdx] = rowRank->RankDense(predIdx);
+  }
+  samplePred = SamplePred::Factory(nPred, bagCount, rankWidth, rankDense);
   PreStage(rowRank);
 }
 
@@ -287,14 +418,16 @@ void Sample::PreStage(const RowRank *rowRank) {
    @return void.
 */
 void Sample::PreStage(const RowRank *rowRank, int predIdx) {
-  // TODO:  For sparse predictors, stage to DenseRank.
-
   // Predictor orderings recorded by RowRank may be built with an unstable sort.
   // Lookup() therefore need not map to 'idx', and results vary by predictor.
   //
+  // Only explicit entries are staged.  Samples belonging to a predictor's
+  // implicit run, if any, are accounted for by splitting.
+  //
+  unsigned int explCount = rowRank->ExplicitCount(predIdx);
   unsigned int spIdx = 0;
-  std::vector<StagePack> stagePack(bagCount);
-  for (unsigned int idx = 0; idx < nRow; idx++) {
+  std::vector<StagePack> stagePack(min(bagCount, explCount));
+  for (unsigned int idx = 0; idx < explCount; idx++) {
     unsigned int predRank;
     unsigned int row = rowRank->Lookup(predIdx, idx, predRank);
     int sIdx = SampleIdx(row);
@@ -305,6 +438,7 @@ void Sample::PreStage(const RowRank *rowRank, int predIdx) {
       stagePack[spIdx++].Set(sIdx, predRank, sCount, ctg, ySum);
     }
   }
+  stagePack.resize(spIdx);
   samplePred->Stage(stagePack, predIdx);
 }
 
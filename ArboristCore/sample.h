@@ -17,6 +17,7 @@
 #define ARBORIST_SAMPLE_H
 
 #include <vector>
+#include <cstddef>
 #include "param.h"
 
 
@@ -85,6 +86,8 @@ class SampleNode {
  @brief Run of instances of a given row obtained from sampling for an individual tree.
 */
 class Sample {
+  friend class KernelBench; // Times PreStage() apart from training.
+  const unsigned int tIdx; // Absolute index of tree.
   int *row2Sample;
   void PreStage(const class RowRank *rowRank);
   void PreStage(const class RowRank *rowRank, int predIdx);
@@ -92,6 +95,8 @@ class Sample {
   static unsigned int nRow;
   static unsigned int nPred;
   static int nSamp;
+  static bool withRepl;
+  static std::vector<double> sampleWeight; // Cumulative iff with replacement.
   SampleNode *sampleNode;
   unsigned int bagCount;
   double bagSum;
@@ -100,16 +105,20 @@ class Sample {
   class Bottom *bottom;
   void PreStage(const std::vector<double> &y, const std::vector<unsigned int> &yCtg, const class RowRank *rowRank);
 
-  static unsigned int *RowSample();
+  static void WeightInit(const double _feSampleWeight[]);
+  static unsigned int *RowSample(unsigned int tIdx);
+  static size_t Overhead(unsigned int _bagCount);
 
  public:
-  static class SampleCtg *FactoryCtg(const std::vector<double> &y, const class RowRank *rowRank, const std::vector<unsigned int> &yCtg);
-  static class SampleReg *FactoryReg(const std::vector<double> &y, const class RowRank *rowRank, const std::vector<unsigned int> &row2Rank);
+  static class SampleCtg *FactoryCtg(const std::vector<double> &y, const class RowRank *rowRank, const std::vector<unsigned int> &yCtg, unsigned int _tIdx);
+  static class SampleReg *FactoryReg(const std::vector<double> &y, const class RowRank *rowRank, const std::vector<unsigned int> &row2Rank, unsigned int _tIdx);
 
-  static void Immutables(unsigned int _nRow, unsigned int _nPred, int _nSamp, double _feSampleWeight[], bool _withRepl, unsigned int _ctgWidth, int _nTree);
+  static void Immutables(unsigned int _nRow, unsigned int _nPred, int _nSamp, double _feSampleWeight[], bool _withRepl, unsigned int _ctgWidth);
   static void DeImmutables();
+  static size_t BytesEst();
 
-  Sample();
+  Sample(unsigned int _tIdx);
+  size_t Bytes() const;
   void RowInvert(std::vector<unsigned int> &sample2Row) const;
   
   /**
@@ -130,6 +139,14 @@ class Sample {
   }
   
   
+  /**
+     @brief Accessor for tree index.
+   */
+  inline unsigned int TreeIdx() const {
+    return tIdx;
+  }
+
+  
   /**
      @brief Accessor for bag count.
    */
@@ -184,7 +201,7 @@ class SampleReg : public Sample {
   unsigned int *sample2Rank; // Only client currently leaf-based methods.
   void SetRank(const std::vector<unsigned int> &row2Rank);
  public:
-  SampleReg();
+  SampleReg(unsigned int _tIdx);
   ~SampleReg();
 
   inline unsigned int Rank(unsigned int sIdx) const {
@@ -202,9 +219,9 @@ class SampleReg : public Sample {
 class SampleCtg : public Sample {
   static unsigned int ctgWidth;
  public:
-  SampleCtg();
+  SampleCtg(unsigned int _tIdx);
   ~SampleCtg();
-  static void Immutables(unsigned int _ctgWidth, int _nTree);
+  static void Immutables(unsigned int _ctgWidth);
   static void DeImmutables();
 
   
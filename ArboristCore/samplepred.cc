@@ -14,6 +14,9 @@
  */
 
 #include "samplepred.h"
+#include "pretree.h"
+#include "spill.h"
+#include "memtrack.h"
 
 //#include <iostream>
 using namespace std;
@@ -48,11 +51,20 @@ void SPNode::DeImmutables() {
 
 
 /**
-   @brief Base class constructor.
+   @brief Base class constructor.  Lays out both buffers as consecutive
+   per-predictor cells within a single backing region.
  */
-SamplePred::SamplePred(unsigned int _nPred, unsigned int _bagCount) : bagCount(_bagCount), nPred(_nPred), bufferSize(_nPred * _bagCount), pitchSP(_bagCount * sizeof(SamplePred)), pitchSIdx(_bagCount * sizeof(unsigned int)) {
-  sampleIdx = new unsigned int[2* bufferSize];
-  nodeVec = new SPNode[2 * bufferSize];
+SamplePred::SamplePred(unsigned int _nPred, unsigned int _bagCount, const std::vector<unsigned int> &_rankWidth, const std::vector<unsigned int> &_rankDense) : bagCount(_bagCount), nPred(_nPred), nodeBytes(size_t(_bagCount) * sizeof(SPNode)), sIdxBytes(size_t(_bagCount) * sizeof(unsigned int)), rankWidth(_rankWidth), rankDense(_rankDense), stageCount(std::vector<unsigned int>(_nPred)), cellOff(std::vector<size_t>(_nPred)) {
+  bufBytes = 0;
+  for (unsigned int predIdx = 0; predIdx < nPred; predIdx++) {
+    cellOff[predIdx] = bufBytes;
+    size_t cellBytes = nodeBytes + sIdxBytes + size_t(bagCount) * rankWidth[predIdx];
+    bufBytes += ((cellBytes + cellAlign - 1) / cellAlign) * cellAlign;
+  }
+  spill = new Spill(2 * bufBytes);
+  spill->Sequential();
+  base = spill->Base();
+  MemTrack::Charge(MemTrack::samplePred, spill->Bytes());
 }
 
 
@@ -60,27 +72,101 @@ SamplePred::SamplePred(unsigned int _nPred, unsigned int _bagCount) : bagCount(_
   @brief Base class destructor.
  */
 SamplePred::~SamplePred() {
-  delete [] nodeVec;
-  delete [] sampleIdx;
+  MemTrack::Release(MemTrack::samplePred, spill->Bytes());
+  delete spill;
 }
 
 
 /**
    @brief Static entry for sample staging.
 
+   @param _rankWidth is the rank width of each predictor, in bytes.
+
+   @param _rankDense is the implicit rank of each predictor, if any.
+
    @return SamplePred object for tree.
  */
-SamplePred *SamplePred::Factory(unsigned int _nPred, unsigned int _bagCount) {
-  SamplePred *samplePred = new SamplePred(_nPred, _bagCount);
+SamplePred *SamplePred::Factory(unsigned int _nPred, unsigned int _bagCount, const std::vector<unsigned int> &_rankWidth, const std::vector<unsigned int> &_rankDense) {
+  SamplePred *samplePred = new SamplePred(_nPred, _bagCount, _rankWidth, _rankDense);
 
   return samplePred;
 }
 
 
+/**
+   @brief Determines the narrowest width sufficient to hold a predictor's
+   ranks.
+
+   @param rankMax is the predictor's highest rank.
+
+   @return rank width, in bytes.
+ */
+unsigned int SamplePred::RankWidth(unsigned int rankMax) {
+  if (rankMax <= 0xff)
+    return 1;
+  else if (rankMax <= 0xffff)
+    return 2;
+  else
+    return 4;
+}
+
+
+/**
+   @brief Reports the size of the double-buffered workspace.
+
+   @return workspace size, in bytes.
+ */
+size_t SamplePred::Bytes() const {
+  return spill->Bytes();
+}
+
+
+/**
+   @brief Bounds the size of the workspace in advance of staging, when
+   rank widths are not yet known.
+
+   @param _nPred is the number of predictors.
+
+   @param _bagCount is the anticipated bag count.
+
+   @return workspace size, in bytes, assuming widest ranks.
+ */
+size_t SamplePred::BytesEst(unsigned int _nPred, unsigned int _bagCount) {
+  return 2 * size_t(_nPred) * (_bagCount * (sizeof(SPNode) + 2 * sizeof(unsigned int)) + cellAlign);
+}
+
+
+/**
+   @brief Requests that the range of a predictor's cell about to be
+   scanned be paged in.  Only effective for file-backed buffers.
+
+   @param predIdx is the predictor index.
+
+   @param bufBit is the containing buffer, currently 0/1.
+
+   @param start is the starting index of the range.
+
+   @param extent is the number of positions in the range.
+
+   @return void.
+ */
+void SamplePred::Prefetch(unsigned int predIdx, unsigned int bufBit, unsigned int start, unsigned int extent) const {
+  if (!spill->Mapped())
+    return;
+
+  unsigned int *sIdx;
+  SPNode *spn = Buffers(predIdx, bufBit, sIdx);
+  spill->WillNeed(spn + start, extent * sizeof(SPNode));
+  spill->WillNeed(sIdx + start, extent * sizeof(unsigned int));
+  spill->WillNeed(Ranks(predIdx, bufBit).Col<unsigned char>() + start * rankWidth[predIdx], extent * rankWidth[predIdx]);
+}
+
+
 /**
    @brief Initializes column pertaining to a single predictor.
 
-   @param stagePack is a vector of rank/index pairs.
+   @param stagePack is a vector of rank/index pairs, exclusive of any
+   implicit run.
 
    @param predIdx is the predictor index at which to initialize.
 
@@ -89,12 +175,13 @@ SamplePred *SamplePred::Factory(unsigned int _nPred, unsigned int _bagCount) {
 void SamplePred::Stage(const std::vector<StagePack> &stagePack, unsigned int predIdx) {
   unsigned int *smpIdx;
   SPNode *spn = Buffers(predIdx, 0, smpIdx);
+  SPRank spRank = Ranks(predIdx, 0);
 
-  // TODO:  For sparse predictors, stage to DenseRank.
-
+  stageCount[predIdx] = stagePack.size();
   for (unsigned int idx = 0; idx < stagePack.size(); idx++) {
-    unsigned int sIdx = spn++->Init(stagePack[idx]);
-    *smpIdx++ = sIdx;
+    unsigned int rank;
+    smpIdx[idx] = spn[idx].Init(stagePack[idx], rank);
+    spRank.Set(idx, rank);
   }
 }
 
@@ -104,9 +191,11 @@ void SamplePred::Stage(const std::vector<StagePack> &stagePack, unsigned int pre
 
    @param stagePack holds packed staging values.
 
+   @param rank outputs the predictor rank, for staging apart.
+
    @return upacked sample index.
  */
-unsigned int SPNode::Init(const StagePack &stagePack) {
+unsigned int SPNode::Init(const StagePack &stagePack, unsigned int &rank) {
   unsigned int sIdx, ctg;
   stagePack.Ref(sIdx, rank, sCount, ctg, ySum);
   sCount = (sCount << runShift) | ctg; // Packed representation.
@@ -131,9 +220,9 @@ unsigned int SPNode::Init(const StagePack &stagePack) {
    @return void, with output reference parameters.
  */
 void SamplePred::SplitRanks(unsigned int predIdx, unsigned int sourceBit, int spPos, unsigned int &rkLow, unsigned int &rkHigh) {
-  SPNode *spn = SplitBuffer(predIdx, sourceBit);
-  rkLow = spn[spPos].Rank();
-  rkHigh = spn[spPos + 1].Rank();
+  SPRank spRank = Ranks(predIdx, sourceBit);
+  rkLow = spRank[spPos];
+  rkHigh = spRank[spPos + 1];
 }
 
 
@@ -150,18 +239,83 @@ void SamplePred::SplitRanks(unsigned int predIdx, unsigned int sourceBit, int sp
 
    @param ptId is the pretree node index to which to map the block.
 
+   @param ctgSum, if non-null, accumulates the block's response sums by
+   category.
+
+   @param sCountCtg accumulates the block's sample counts by category,
+   alongside 'ctgSum'.
+
    @return sum of response values associated with each replayed index.
 */
-double SamplePred::Replay(unsigned int sample2PT[], unsigned int predIdx, unsigned int sourceBit, int start, int end, unsigned int ptId) {
+double SamplePred::Replay(unsigned int sample2PT[], unsigned int predIdx, unsigned int sourceBit, int start, int end, unsigned int ptId, double ctgSum[], unsigned int sCountCtg[]) {
   unsigned int *sIdx;
   SPNode *spn = Buffers(predIdx, sourceBit, sIdx);
 
   double sum = 0.0;
-  for (int idx = start; idx <= end; idx++) {
-    sum += spn[idx].YSum();
-    unsigned int sampleIdx = sIdx[idx];
-    sample2PT[sampleIdx] = ptId;
+  if (ctgSum == 0) {
+    for (int idx = start; idx <= end; idx++) {
+      sum += spn[idx].YSum();
+      unsigned int sampleIdx = sIdx[idx];
+      sample2PT[sampleIdx] = ptId;
+    }
+  }
+  else {
+    for (int idx = start; idx <= end; idx++) {
+      FltVal ySum;
+      unsigned int yCtg;
+      unsigned int sCount = spn[idx].CtgFields(ySum, yCtg);
+      sum += ySum;
+      ctgSum[yCtg] += ySum;
+      sCountCtg[yCtg] += sCount;
+      unsigned int sampleIdx = sIdx[idx];
+      sample2PT[sampleIdx] = ptId;
+    }
   }
 
   return sum;
 }
+
+
+/**
+   @brief Copies the samples of a single frontier node into buffer zero of
+   a compact SamplePred, preserving their order.
+
+   @param targ is the compact SamplePred receiving the copy.
+
+   @param predIdx is the predictor to copy.
+
+   @param bufBit (0/1) indicates which buffer holds the source cell.
+
+   @param start is the starting index of the source cell.
+
+   @param extent is the count of explicit samples in the source cell.
+
+   @param preTree maps samples to their frontier nodes.
+
+   @param ptId is the pretree index of the node being copied.
+
+   @param sIdxLocal maps sample indices to their compact counterparts.
+
+   @return count of samples copied.
+ */
+unsigned int SamplePred::Compact(SamplePred *targ, unsigned int predIdx, unsigned int bufBit, unsigned int start, unsigned int extent, const PreTree *preTree, unsigned int ptId, const unsigned int sIdxLocal[]) const {
+  unsigned int *sIdxSource;
+  const SPNode *source = Buffers(predIdx, bufBit, sIdxSource);
+  SPRank rkSource = Ranks(predIdx, bufBit);
+  unsigned int *sIdxTarg;
+  SPNode *spTarg = targ->Buffers(predIdx, 0, sIdxTarg);
+  SPRank rkTarg = targ->Ranks(predIdx, 0);
+
+  unsigned int destIdx = 0;
+  for (unsigned int idx = start; idx < start + extent; idx++) {
+    unsigned int sIdx = sIdxSource[idx];
+    if (preTree->Sample2Frontier(sIdx) == ptId) {
+      spTarg[destIdx] = source[idx];
+      rkTarg.Set(destIdx, rkSource[idx]);
+      sIdxTarg[destIdx++] = sIdxLocal[sIdx];
+    }
+  }
+  targ->stageCount[predIdx] = destIdx;
+
+  return destIdx;
+}
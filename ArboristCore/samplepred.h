@@ -21,6 +21,7 @@
 #include "param.h"
 
 #include <vector>
+#include <cstddef>
 
 /**
    @brief Container for staging initialization, viz. minimizing communication
@@ -52,17 +53,18 @@ class StagePack {
 
 
 /**
+   @brief Response and multiplicity of a staged sample.  Predictor ranks
+   are maintained separately, at per-predictor width, by SPRank.
  */
 class SPNode {
   static unsigned int runShift; // Pack:  nonzero iff categorical response.
  protected:
   FltVal ySum; // sum of response values associated with sample.
-  unsigned int rank; // True rank, with ties identically receiving lowest applicable value.
   unsigned int sCount; // # occurrences of row sampled.  << # rows.
  public:
   static void Immutables(unsigned int ctgWidth);
   static void DeImmutables();
-  unsigned int Init(const StagePack &stagePack);
+  unsigned int Init(const StagePack &stagePack, unsigned int &rank);
 
   // These methods should only be called when the response is known
   // to be regression, as it relies on a packed representation specific
@@ -76,15 +78,12 @@ class SPNode {
 
      @param _ySum outputs the response value.
 
-     @param _rank outputs the predictor rank.
-
      @param _sCount outputs the multiplicity of the row in this sample.
 
      @return void.
    */
-  inline void RegFields(FltVal &_ySum, unsigned int &_rank, unsigned int &_sCount) const {
+  inline void RegFields(FltVal &_ySum, unsigned int &_sCount) const {
     _ySum = ySum;
-    _rank = rank;
     _sCount = sCount;
   }
 
@@ -99,73 +98,121 @@ class SPNode {
 
      @param _ySum outputs the proxy response value.
 
-     @param _rank outputs the predictor rank.
-
      @param _yCtg outputs the response value.
 
-     @return sample count, with output reference parameters.
+     @return sample count of node, with output reference parameters.
    */
-  inline unsigned int CtgFields(FltVal &_ySum, unsigned int &_rank, unsigned int &_yCtg) const {
+  inline unsigned int CtgFields(FltVal &_ySum, unsigned int &_yCtg) const {
     _ySum = ySum;
-    _rank = rank;
     _yCtg = sCount & ((1 << runShift) - 1);
 
     return sCount >> runShift;
   }
 
 
-    /**
-     @brief Variant of above, for which rank determined separately.
+  /**
+     @brief Accessor for 'ySum' field
 
-     @param _ySum outputs the proxy response value.
+     @return sum of y-values for sample.
+   */
+  inline FltVal YSum() {
+    return ySum;
+  }
+};
 
-     @param _sCount outputs the multiplicity of the row in this sample.
 
-     @param _yCtg outputs the response value.
+/**
+   @brief Rank column of a single predictor within a SamplePred buffer.
+   Ranks are stored at the narrowest width, in bytes, admitted by the
+   predictor's cardinality.
+ */
+class SPRank {
+  unsigned char *base;
+  unsigned int width; // 1, 2 or 4.
+ public:
+  SPRank(unsigned char *_base, unsigned int _width) : base(_base), width(_width) {
+  }
 
-     @return sample count of node, with output reference parameters.
-   */
-  inline unsigned int CtgFields(FltVal &_ySum, unsigned int &_yCtg) const {
-    _ySum = ySum;
-    _yCtg = sCount & ((1 << runShift) - 1);
 
-    return sCount >> runShift;
+  /**
+     @brief Accessor for rank width.
+
+     @return width, in bytes.
+   */
+  inline unsigned int Width() const {
+    return width;
   }
 
-  
-  /**
-   @brief Determines whether the consecutive index positions are a run of predictor values.
 
-   @param start is starting index position of potential run.
+  /**
+     @brief Exposes the column at its storage type, for loops dispatched
+     once per cell on the width.
 
-   @param end is the ending index position of potential run.
+     @param rankType is the storage type corresponding to the width.
 
-   @return whether a run is encountered.
-  */
-  inline bool IsRun(int start, int end) const {
-    return (this + start)->rank == (this + end)->rank;
+     @return typed column base.
+   */
+  template<typename rankType> inline rankType *Col() const {
+    return reinterpret_cast<rankType *>(base);
   }
 
 
   /**
-     @brief Accessor for 'rank' field
+     @brief Reads a rank.
+
+     @param idx is the position within the column.
 
-     @return rank value.
+     @return rank at position.
    */
-  inline unsigned int Rank() const {
-    return rank;
+  inline unsigned int operator[](unsigned int idx) const {
+    switch (width) {
+    case 1:
+      return base[idx];
+    case 2:
+      return reinterpret_cast<const unsigned short *>(base)[idx];
+    default:
+      return reinterpret_cast<const unsigned int *>(base)[idx];
+    }
   }
 
 
   /**
-     @brief Accessor for 'ySum' field
+     @brief Writes a rank.  Ranks of singletons need not be known,
+     and may be staged as zero.
 
-     @return sum of y-values for sample.
+     @param idx is the position within the column.
+
+     @param rank is the value to write.
+
+     @return void.
    */
-  inline FltVal YSum() {
-    return ySum;
+  inline void Set(unsigned int idx, unsigned int rank) const {
+    switch (width) {
+    case 1:
+      base[idx] = rank;
+      break;
+    case 2:
+      reinterpret_cast<unsigned short *>(base)[idx] = rank;
+      break;
+    default:
+      reinterpret_cast<unsigned int *>(base)[idx] = rank;
+      break;
+    }
   }
 
+
+  /**
+   @brief Determines whether the consecutive index positions are a run of predictor values.
+
+   @param start is starting index position of potential run.
+
+   @param end is the ending index position of potential run.
+
+   @return whether a run is encountered.
+  */
+  inline bool IsRun(int start, int end) const {
+    return (*this)[start] == (*this)[end];
+  }
 };
 
 
@@ -182,70 +229,156 @@ class SamplePred {
 
   // Predictor-based sample orderings, double-buffered by level value.
   //
-  const int bufferSize; // bagCount * nPred.
-  const unsigned int pitchSP; // Pitch of SPNode vector, in bytes.
-  const unsigned int pitchSIdx; // Pitch of SIdx vector, in bytes.
-
-  SPNode* nodeVec;
+  // Each buffer is partitioned into per-predictor cells, each of which
+  // holds the predictor's SPNode, sample index and rank columns
+  // consecutively.  Restaging and splitting a predictor therefore touch
+  // a single contiguous region, which matters chiefly when the buffers
+  // are paged from disk.  Cells are aligned to 'cellAlign' bytes.
+  //
+  static constexpr unsigned int cellAlign = 64;
+  const size_t nodeBytes; // Bytes per SPNode column.
 
-  // 'sampleIdx' could be boxed with SPNode.  While it is used in both
+  // The sample index could be boxed with SPNode.  While it is used in both
   // replaying and restaging, though, it plays no role in splitting.  Maintaining
-  // a separate vector permits a 16-byte stride to be used for splitting.  More
+  // a separate column permits an 8-byte stride to be used for splitting.  More
   // significantly, it reduces memory traffic incurred by transposition on the
   // coprocessor.
   //
-  unsigned int *sampleIdx; // RV index for this row.  Used by CTG as well as on replay.
+  const size_t sIdxBytes; // Bytes per sample-index column.
+
+  // Ranks are held apart from SPNode so that each predictor's may be
+  // stored at its own width.
+  //
+  const std::vector<unsigned int> rankWidth; // Bytes per rank, by predictor.
+
+  // Sparse predictors stage only those samples lying outside their
+  // implicit run.  Each node's explicit samples occupy a prefix of the
+  // node's index range, the remainder going unwritten.
+  //
+  const std::vector<unsigned int> rankDense; // Rank of implicit run, by predictor.
+  std::vector<unsigned int> stageCount; // Count of explicit samples staged.
+  std::vector<size_t> cellOff; // Byte offset of predictor's cell.
+  size_t bufBytes; // Bytes per buffer.
+  class Spill *spill; // Backing store for both buffers.
+  unsigned char *base;
+
+  /**
+     @brief Locates a predictor's cell.
+
+     @param predIdx is the predictor index.
+
+     @param bufBit is the containing buffer, currently 0/1.
+
+     @return base address of cell.
+   */
+  inline unsigned char *Cell(unsigned int predIdx, unsigned int bufBit) const {
+    return base + ((bufBit & 1) == 0 ? 0 : bufBytes) + cellOff[predIdx];
+  }
+
  public:
-  SamplePred(unsigned int _nPred, unsigned int _bagCount);
+  SamplePred(unsigned int _nPred, unsigned int _bagCount, const std::vector<unsigned int> &_rankWidth, const std::vector<unsigned int> &_rankDense);
   ~SamplePred();
-  static SamplePred *Factory(unsigned int _nPred, unsigned int _bagCount);
+  static SamplePred *Factory(unsigned int _nPred, unsigned int _bagCount, const std::vector<unsigned int> &_rankWidth, const std::vector<unsigned int> &_rankDense);
+  static unsigned int RankWidth(unsigned int rankMax);
+  static size_t BytesEst(unsigned int _nPred, unsigned int _bagCount);
+  size_t Bytes() const;
+  void Prefetch(unsigned int predIdx, unsigned int bufBit, unsigned int start, unsigned int extent) const;
 
-  void Stage(const std::vector<StagePack> &stagePack, unsigned int predIdx);
- 
-  inline unsigned int PitchSP() {
-    return pitchSP;
+  /**
+     @brief Accessor for per-predictor rank widths, as when staging a
+     compact copy.
+
+     @return vector of rank widths, in bytes.
+   */
+  inline const std::vector<unsigned int> &RankWidths() const {
+    return rankWidth;
   }
 
-  inline unsigned int PitchSIdx() {
-    return pitchSIdx;
+
+  /**
+     @brief Computes the footprint of a single staged sample, as when
+     accounting restaged volume.
+
+     @return byte count of node, sample index and rank.
+   */
+  inline size_t ElementBytes(unsigned int predIdx) const {
+    return sizeof(SPNode) + sizeof(unsigned int) + rankWidth[predIdx];
   }
-  
-  // The category could, alternatively, be recorded in an object subclassed
-  // under class SamplePred.  This would require that the value be restaged,
-  // which happens for all predictors at all splits.  It would also require
-  // that distinct SamplePred classes be maintained for SampleReg and
-  // SampleCtg.  Recomputing the category value on demand, then, seems an
-  // easier way to go.
-  //
+
 
   /**
-     @brief Toggles between positions in workspace double buffer, by level.
+     @brief Accessor for per-predictor implicit ranks, as above.
 
-     @return workspace starting position for this level.
+     @return vector of implicit ranks.
    */
-  inline int BuffOffset(unsigned int bufferBit) const {
-    return (bufferBit & 1) == 0 ? 0 : bufferSize;
+  inline const std::vector<unsigned int> &RankDenses() const {
+    return rankDense;
   }
 
+
   /**
+     @brief Looks up the rank of a predictor's implicit run.
 
-     @param predIdx is the predictor coordinate.
+     @param predIdx is the predictor index.
 
-     @param level is the current level.
+     @return implicit rank:  undefined if the predictor has none.
+   */
+  inline unsigned int RankDense(unsigned int predIdx) const {
+    return rankDense[predIdx];
+  }
 
-     @return starting position within workspace.
+
+  /**
+     @brief Reports the count of samples staged explicitly.
+
+     @param predIdx is the predictor index.
+
+     @return count of explicit samples:  the bag count iff no implicit run.
    */
-  inline unsigned int BufferOff(unsigned int predIdx, unsigned int bufBit) const {
-    return bagCount * predIdx + BuffOffset(bufBit);
+  inline unsigned int StageCount(unsigned int predIdx) const {
+    return stageCount[predIdx];
   }
 
-  
+
+  /**
+     @brief Looks up the rank column of a predictor's cell.
+
+     @param predIdx is the predictor index.
+
+     @param bufBit is the containing buffer, currently 0/1.
+
+     @return rank column for the cell.
+   */
+  inline SPRank Ranks(unsigned int predIdx, unsigned int bufBit) const {
+    return SPRank(Cell(predIdx, bufBit) + nodeBytes + sIdxBytes, rankWidth[predIdx]);
+  }
+
+  void Stage(const std::vector<StagePack> &stagePack, unsigned int predIdx);
+ 
+  // The category could, alternatively, be recorded in an object subclassed
+  // under class SamplePred.  This would require that the value be restaged,
+  // which happens for all predictors at all splits.  It would also require
+  // that distinct SamplePred classes be maintained for SampleReg and
+  // SampleCtg.  Recomputing the category value on demand, then, seems an
+  // easier way to go.
+  //
+
   /**
+     @brief Looks up the SPNode and sample-index columns of a predictor's
+     cell.
+
+     @param predIdx is the predictor index.
+
+     @param bufBit is the containing buffer, currently 0/1.
+
+     @param sIdx outputs the sample-index column.
+
+     @return SPNode column, with output reference parameter.
    */
-  inline SPNode* Buffers(unsigned int predIdx, unsigned int bufBit, unsigned int*& sIdx) {
-    unsigned int offset = BufferOff(predIdx, bufBit);
-    sIdx = sampleIdx + offset;
-    return nodeVec + offset;
+  inline SPNode* Buffers(unsigned int predIdx, unsigned int bufBit, unsigned int*& sIdx) const {
+    unsigned char *cell = Cell(predIdx, bufBit);
+    sIdx = reinterpret_cast<unsigned int *>(cell + nodeBytes);
+    return reinterpret_cast<SPNode *>(cell);
   }
 
 
@@ -259,7 +392,7 @@ class SamplePred {
      @return node vector section for this predictor.
    */
   SPNode* PredBase(unsigned int predIdx, unsigned int bufBit) const {
-    return nodeVec + BufferOff(predIdx, bufBit);
+    return reinterpret_cast<SPNode *>(Cell(predIdx, bufBit));
   }
   
 
@@ -267,7 +400,7 @@ class SamplePred {
      @brief Returns buffer containing splitting information.
    */
   inline SPNode* SplitBuffer(unsigned int predIdx, unsigned int bufBit) {
-    return nodeVec + BufferOff(predIdx, bufBit);
+    return PredBase(predIdx, bufBit);
   }
 
 
@@ -286,7 +419,8 @@ class SamplePred {
   }
 
   void SplitRanks(unsigned int predIdx, unsigned int targBit, int spIdx, unsigned int &rkLow, unsigned int &rkHigh);
-  double Replay(unsigned int sample2PT[], unsigned int predIdx, unsigned int targBit, int start, int end, unsigned int ptId);
+  double Replay(unsigned int sample2PT[], unsigned int predIdx, unsigned int targBit, int start, int end, unsigned int ptId, double ctgSum[] = 0, unsigned int sCountCtg[] = 0);
+  unsigned int Compact(SamplePred *targ, unsigned int predIdx, unsigned int bufBit, unsigned int start, unsigned int extent, const class PreTree *preTree, unsigned int ptId, const unsigned int sIdxLocal[]) const;
 
   // TODO:  Move somewhere appropriate.
   /**
@@ -0,0 +1,162 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file spill.cc
+
+   @brief Methods for heap- or file-backed training buffers.
+
+   @author Mark Seligman
+ */
+
+#include "spill.h"
+
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#define ARBORIST_SPILL_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+
+std::string Spill::dir;
+size_t Spill::spillMin = 0;
+size_t Spill::pageSize = 4096;
+
+
+/**
+   @brief Sets the spill directory.
+
+   @param _dir is the directory in which to create backing files, or
+   null/empty to keep all regions on the heap.
+
+   @param _spillMin is the size below which regions remain on the heap.
+
+   @return void.
+ */
+void Spill::Immutables(const char *_dir, size_t _spillMin) {
+  dir = _dir == 0 ? "" : _dir;
+  spillMin = _spillMin;
+#ifdef ARBORIST_SPILL_MMAP
+  long sysPage = sysconf(_SC_PAGESIZE);
+  if (sysPage > 0)
+    pageSize = sysPage;
+#endif
+}
+
+
+void Spill::DeImmutables() {
+  dir.clear();
+  spillMin = 0;
+}
+
+
+/**
+   @brief Maps a file-backed region if so configured, otherwise, or on
+   failure to map, allocates from the heap.
+ */
+Spill::Spill(size_t _bytes) : bytes(_bytes), base(0), mapped(false) {
+  if (dir.empty() || bytes < spillMin || !Map())
+    base = new unsigned char[bytes];
+}
+
+
+Spill::~Spill() {
+#ifdef ARBORIST_SPILL_MMAP
+  if (mapped) {
+    munmap(base, bytes);
+    return;
+  }
+#endif
+  delete [] base;
+}
+
+
+/**
+   @brief Maps the region onto an anonymous file in the spill directory.
+   The file is unlinked on creation, so that no trace survives the
+   process.
+
+   @return true iff region successfully mapped.
+ */
+bool Spill::Map() {
+#ifdef ARBORIST_SPILL_MMAP
+  std::string path = dir + "/arborist.XXXXXX";
+  std::vector<char> name(path.begin(), path.end());
+  name.push_back('\0');
+  int fd = mkstemp(&name[0]);
+  if (fd < 0)
+    return false;
+  unlink(&name[0]);
+
+  void *addr = MAP_FAILED;
+  if (ftruncate(fd, bytes) == 0)
+    addr = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd); // Mapping retains the file.
+  if (addr == MAP_FAILED)
+    return false;
+
+  base = static_cast<unsigned char *>(addr);
+  mapped = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+/**
+   @brief Advises the pager of access intent over a page-rounded range.
+
+   @param offset is the starting byte offset within the region.
+
+   @param len is the length of the range, in bytes.
+
+   @param advice is the system advice value.
+
+   @return void.
+ */
+void Spill::Advise(size_t offset, size_t len, int advice) const {
+#ifdef ARBORIST_SPILL_MMAP
+  size_t start = (offset / pageSize) * pageSize;
+  size_t end = offset + len < bytes ? offset + len : bytes;
+  if (end > start)
+    (void) madvise(base + start, end - start, advice);
+#endif
+}
+
+
+/**
+   @brief Advises that the region will be read mostly sequentially, so
+   that the pager may read ahead aggressively and release pages behind.
+
+   @return void.
+ */
+void Spill::Sequential() const {
+#ifdef ARBORIST_SPILL_MMAP
+  if (mapped)
+    Advise(0, bytes, MADV_SEQUENTIAL);
+#endif
+}
+
+
+/**
+   @brief Requests that a range be paged in ahead of its use.  Ranges
+   shorter than a page are left to demand paging.
+
+   @param start is the starting address, within the region.
+
+   @param len is the length of the range, in bytes.
+
+   @return void.
+ */
+void Spill::WillNeed(const void *start, size_t len) const {
+#ifdef ARBORIST_SPILL_MMAP
+  if (mapped && len >= pageSize)
+    Advise(static_cast<const unsigned char *>(start) - base, len, MADV_WILLNEED);
+#endif
+}
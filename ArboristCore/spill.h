@@ -0,0 +1,90 @@
+// This file is part of ArboristCore.
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/**
+   @file spill.h
+
+   @brief Backing store for training buffers too large to hold in memory.
+
+   @author Mark Seligman
+
+ */
+
+#ifndef ARBORIST_SPILL_H
+#define ARBORIST_SPILL_H
+
+#include <string>
+#include <cstddef>
+
+
+/**
+   @brief Fixed-size byte region, either allocated from the heap or, when
+   a spill directory has been configured, mapped onto a temporary file
+   within it.  Mapped regions are paged by the operating system, so that
+   the training working set may exceed physical memory at the cost of
+   disk traffic.
+
+   Consumers lay out their data so that the regions touched together are
+   contiguous, and advise the pager of their intent:  whole regions are
+   read mostly sequentially, and ranges about to be scanned are requested
+   ahead of time.  Advice is a no-op for heap regions.
+ */
+class Spill {
+  static std::string dir; // Directory for backing files:  empty iff none.
+  static size_t spillMin; // Smallest region worth mapping, in bytes.
+  static size_t pageSize;
+
+  const size_t bytes;
+  unsigned char *base;
+  bool mapped; // Whether 'base' is backed by a file.
+
+  bool Map();
+  void Advise(size_t offset, size_t len, int advice) const;
+
+ public:
+  Spill(size_t _bytes);
+  ~Spill();
+
+  static void Immutables(const char *_dir, size_t _spillMin = 1 << 20);
+  static void DeImmutables();
+
+
+  /**
+     @brief Accessor for region base.
+
+     @return base address.
+   */
+  inline unsigned char *Base() const {
+    return base;
+  }
+
+
+  /**
+     @brief Accessor for region size.
+
+     @return size, in bytes.
+   */
+  inline size_t Bytes() const {
+    return bytes;
+  }
+
+
+  /**
+     @brief Reports whether region is file-backed.
+
+     @return true iff mapped.
+   */
+  inline bool Mapped() const {
+    return mapped;
+  }
+
+
+  void Sequential() const;
+  void WillNeed(const void *start, size_t len) const;
+};
+
+#endif
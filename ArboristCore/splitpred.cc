@@ -22,9 +22,10 @@ using namespace std;
 #include "bottom.h"
 #include "runset.h"
 #include "samplepred.h"
-#include "callback.h"
 #include "sample.h"
 #include "predblock.h"
+#include "arena.h"
+#include "philox.h"
 
 unsigned int SplitPred::nPred = 0;
 int SplitPred::predFixed = 0;
@@ -33,11 +34,13 @@ std::vector<double> SplitPred::predProb(0);
 double *SPReg::mono = 0;
 unsigned int SPReg::predMono = 0;
 unsigned int SPCtg::ctgWidth = 0;
+void (SPCtg::*SPCtg::sumsAndSquares)(const Index *, bool[]) = 0;
+void (SPCtg::*SPCtg::splitNumGini)(unsigned int, const IndexNode *, const SPNode[], const SPRank &) = 0;
 
 /**
   @brief Constructor.  Initializes 'runFlags' to zero for the single-split root.
  */
-SplitPred::SplitPred(SamplePred *_samplePred, unsigned int bagCount) : samplePred(_samplePred) {
+SplitPred::SplitPred(SamplePred *_samplePred, unsigned int bagCount) : arena(0), samplePred(_samplePred) {
 }
 
 
@@ -98,13 +101,64 @@ void SPReg::DeImmutables() {
 }
 
 
+/**
+   @brief Records the category width and selects the kernels specialized
+   to it.  Widths beyond 'ctgUnroll' employ the generic kernels,
+   instantiated with zero width.
+
+   @param _ctgWidth is the response cardinality.
+
+   @return void.
+ */
 void SPCtg::Immutables(unsigned int _ctgWidth) {
   ctgWidth = _ctgWidth;
+  switch (ctgWidth) {
+  case 1:
+    Specialize<1>();
+    break;
+  case 2:
+    Specialize<2>();
+    break;
+  case 3:
+    Specialize<3>();
+    break;
+  case 4:
+    Specialize<4>();
+    break;
+  case 5:
+    Specialize<5>();
+    break;
+  case 6:
+    Specialize<6>();
+    break;
+  case 7:
+    Specialize<7>();
+    break;
+  case 8:
+    Specialize<8>();
+    break;
+  default:
+    Specialize<0>();
+    break;
+  }
+}
+
+
+/**
+   @brief Points the width-dependent kernels at their 'ctgW' instances.
+
+   @return void.
+ */
+template<unsigned int ctgW> void SPCtg::Specialize() {
+  sumsAndSquares = &SPCtg::SumsAndSquares<ctgW>;
+  splitNumGini = &SPCtg::SplitNumGini<ctgW>;
 }
 
 
 void SPCtg::DeImmutables() {
   ctgWidth = 0;
+  sumsAndSquares = 0;
+  splitNumGini = 0;
 }
 
 
@@ -124,12 +178,42 @@ SPReg::SPReg(SamplePred *_samplePred, unsigned int bagCount) : SplitPred(_sample
    @param samplePred holds (re)staged node contents.
 
    @param sampleCtg is the sample vector for the tree, included for category lookup.
+
+   @param _owned is true iff the sample vector is to be deleted on destruction.
  */
-SPCtg::SPCtg(SamplePred *_samplePred, SampleNode _sampleCtg[], unsigned int bagCount): SplitPred(_samplePred, bagCount), sampleCtg(_sampleCtg) {
+SPCtg::SPCtg(SamplePred *_samplePred, SampleNode _sampleCtg[], unsigned int bagCount, bool _owned): SplitPred(_samplePred, bagCount), ctgSumNext(0), sCountNext(0), sampleCtg(_sampleCtg), sampleLocal(_owned ? _sampleCtg : 0) {
   run = new Run(ctgWidth);
 }
 
 
+/**
+   @brief Creates a regression splitter over a compact copy of samples.
+
+   @return new splitter, owned by caller.
+ */
+SplitPred *SPReg::Spawn(SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &) const {
+  return new SPReg(_samplePred, _bagCount);
+}
+
+
+/**
+   @brief Creates a categorical splitter over a compact copy of samples,
+   with category lookup compacted alongside.
+
+   @param sIdxMap maps compact sample indices to those of this splitter.
+
+   @return new splitter, owned by caller.
+ */
+SplitPred *SPCtg::Spawn(SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const {
+  SampleNode *sampleCompact = new SampleNode[_bagCount];
+  for (unsigned int sIdx = 0; sIdx < _bagCount; sIdx++) {
+    sampleCompact[sIdx] = sampleCtg[sIdxMap[sIdx]];
+  }
+
+  return new SPCtg(_samplePred, sampleCompact, _bagCount, true);
+}
+
+
 /**
    @brief Sets per-level state enabling pre-bias computation.
 
@@ -142,6 +226,9 @@ SPCtg::SPCtg(SamplePred *_samplePred, SampleNode _sampleCtg[], unsigned int bagC
 bool *SplitPred::LevelInit(Index *index, IndexNode indexNode[], Bottom *_bottom, unsigned int _levelCount, Run *&_run) {
   bottom = _bottom;
   levelCount = _levelCount;
+  tIdx = index->TreeIdx();
+  levelSeq = index->LevelSeq();
+  arena = index->LevelArena();
   bool *unsplitable = LevelPreset(index);
   SplitFlags(unsplitable);
   SetPrebias(indexNode); // Depends on state from LevelPreset()
@@ -178,8 +265,8 @@ bool *SPReg::LevelInit(Index *index, IndexNode indexNode[], Bottom *bottom, unsi
   (void) SplitPred::LevelInit(index, indexNode, bottom, _levelCount, _run);
   if (predMono > 0) {
     unsigned int monoCount = _levelCount * nPred; // Clearly too big.
-    ruMono = new double[monoCount];
-    CallBack::RUnif(monoCount, ruMono);
+    ruMono = arena->Alloc<double>(monoCount);
+    Philox::Uniform(tIdx, levelSeq, Philox::mono, monoCount, ruMono);
   }
   else {
     ruMono = 0;
@@ -203,7 +290,7 @@ void SPReg::RunOffsets() {
    @brief Sets quick lookup offsets for Run object.
  */
 void SPCtg::RunOffsets() {
-  run->OffsetsCtg();
+  run->OffsetsCtg(tIdx, levelSeq);
 }
 
 
@@ -216,39 +303,52 @@ void SPCtg::RunOffsets() {
 */
 void SplitPred::SplitFlags(bool unsplitable[]) {
   int cellCount = levelCount * nPred;
-  double *ruPred = new double[cellCount];
-  CallBack::RUnif(cellCount, ruPred);
-  splitFlags = new bool[cellCount];
+  double *ruPred = arena->Alloc<double>(cellCount);
+  Philox::Uniform(tIdx, levelSeq, Philox::predSelect, cellCount, ruPred);
+  splitFlags = arena->Alloc<bool>(cellCount);
 
   BHPair *heap;
   if (predFixed > 0)
-    heap = new BHPair[cellCount];
+    heap = arena->Alloc<BHPair>(cellCount);
   else
     heap = 0;
 
   int levelIdx;
-  unsigned int splitOff;
-#pragma omp parallel default(shared) private(splitOff, levelIdx)
+  if (bottom->Serial()) {
+    for (levelIdx = 0; levelIdx < int(levelCount); levelIdx++) {
+      NodeFlags(levelIdx, unsplitable, ruPred, heap);
+    }
+    return;
+  }
+
+#pragma omp parallel default(shared) private(levelIdx)
   {
 #pragma omp for schedule(dynamic, 1)
   for (levelIdx = 0; levelIdx < int(levelCount); levelIdx++) {
-    splitOff = levelIdx * nPred;
-    if (unsplitable[levelIdx]) { // No predictor splitable
-      SplitPredNull(&splitFlags[splitOff]);
-    }
-    else if (predFixed == 0) { // Probability of predictor splitable.
-      SplitPredProb(&ruPred[splitOff], &splitFlags[splitOff]);
-    }
-    else { // Fixed number of predictors splitable.
-      SplitPredFixed(&ruPred[splitOff], &heap[splitOff], &splitFlags[splitOff]);
-    }
+    NodeFlags(levelIdx, unsplitable, ruPred, heap);
   }
   }
+}
+
+
+/**
+   @brief Sets the split flags of a single node's predictors.
 
-  if (heap != 0)
-    delete [] heap;
-  delete [] ruPred;
-  delete [] unsplitable;
+   @param levelIdx is the level-relative index of the node.
+
+   @return void.
+ */
+void SplitPred::NodeFlags(unsigned int levelIdx, const bool unsplitable[], const double ruPred[], BHPair heap[]) {
+  unsigned int splitOff = levelIdx * nPred;
+  if (unsplitable[levelIdx]) { // No predictor splitable
+    SplitPredNull(&splitFlags[splitOff]);
+  }
+  else if (predFixed == 0) { // Probability of predictor splitable.
+    SplitPredProb(&ruPred[splitOff], &splitFlags[splitOff]);
+  }
+  else { // Fixed number of predictors splitable.
+    SplitPredFixed(&ruPred[splitOff], &heap[splitOff], &splitFlags[splitOff]);
+  }
 }
 
 
@@ -304,25 +404,42 @@ void SplitPred::SplitPredFixed(const double ruPred[], BHPair heap[], bool flags[
 
 
 /**
-   @brief Base method.  Deletes per-level run and split-flags vectors.
+   @brief Base method.  Clears per-level run and split-flags vectors,
+   whose storage is reclaimed with the arena.
 
    @return void.
  */
 void SplitPred::LevelClear() {
   run->LevelClear();
-  delete [] splitFlags;
   splitFlags = 0;
 }
 
 
+/**
+   @brief Base methods.  Statistics carried between levels, if any, are
+   the responsibility of the response-specific splitter.
+
+   @return null sums from ExplSums(), otherwise void.
+ */
+double *SplitPred::ExplSums(unsigned int, bool, unsigned int *&sCountNode) {
+  sCountNode = 0;
+  return 0;
+}
+
+
+void SplitPred::Overlap(unsigned int) {
+}
+
+
+void SplitPred::Inherit(unsigned int, unsigned int, bool) {
+}
+
+
 /**
    @brief Run objects should not be deleted until after splits have been consumed.
  */
 void SPReg::LevelClear() {
-  if (ruMono != 0) {
-    delete [] ruMono;
-    ruMono = 0;
-  }
+  ruMono = 0;
   SplitPred::LevelClear();
 }
 
@@ -332,16 +449,16 @@ SPReg::~SPReg() {
 
 
 SPCtg::~SPCtg() {
+  delete [] sampleLocal;
+  delete [] ctgSumNext;
+  delete [] sCountNext;
 }
 
 
 void SPCtg::LevelClear() {
-  if (PredBlock::NPredNum() > 0) {
-    delete [] ctgSumR;
-  }
-  delete [] ctgSum;
-  delete [] sumSquares;
-  ctgSum = sumSquares = ctgSumR = 0;
+  ctgSum = sumSquares = ctgSumR = sumExpl = 0;
+  sCountCtg = sCountExpl = 0;
+  lhExpl = 0;
   SplitPred::LevelClear();
 }
 
@@ -356,7 +473,7 @@ void SPCtg::LevelClear() {
    @return vector of unsplitable indices.
 */
 bool *SPReg::LevelPreset(const Index *index) {
-  bool* unsplitable = new bool[levelCount];
+  bool *unsplitable = arena->Alloc<bool>(levelCount);
   for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++)
     unsplitable[levelIdx] = false;
 
@@ -389,27 +506,91 @@ wells as FacRun vectors.
    @return vector of unsplitable indices.
 */
 bool *SPCtg::LevelPreset(const Index *index) {
-  if (PredBlock::NPredNum() > 0)
+  if (PredBlock::NPredNum() > 0 && ctgWidth > ctgUnroll) // Generic kernel.
     LevelInitSumR();
 
-  bool *unsplitable = new bool[levelCount];
+  bool *unsplitable = arena->Alloc<bool>(levelCount);
   for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++)
     unsplitable[levelIdx] = false;
-  SumsAndSquares(index, unsplitable);
+  (this->*sumsAndSquares)(index, unsplitable);
 
   return unsplitable;
 }
 
 
 /**
+   @brief Accumulates per-category sums and sums of squares for each
+   splitable node in the level.  Sums carried from the previous level
+   are adopted when available; otherwise they are computed by a pass
+   over the bag.
+
+   @param ctgW is the category width, if specialized, otherwise zero.
+
+   @param unsplitable outputs nodes having a singleton response.
+
+   @return void.
+ */
+template<unsigned int ctgW> void SPCtg::SumsAndSquares(const Index *index, bool unsplitable[]) {
+  const unsigned int width = ctgW > 0 ? ctgW : ctgWidth;
+  if (ctgSumNext != 0) {
+    unsigned int sumCount = levelCount * width;
+    ctgSum = arena->Alloc<double>(sumCount);
+    sCountCtg = arena->Alloc<unsigned int>(sumCount);
+    for (unsigned int i = 0; i < sumCount; i++) {
+      ctgSum[i] = ctgSumNext[i];
+      sCountCtg[i] = sCountNext[i];
+    }
+    delete [] ctgSumNext;
+    delete [] sCountNext;
+    ctgSumNext = 0;
+    sCountNext = 0;
+  }
+  else {
+    SumsScan(index, width);
+  }
+
+  sumSquares = arena->Alloc<double>(levelCount);
+  for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++) {
+    unsigned int indexSCount = index->SCount(levelIdx);
+    double ss = 0.0;
+    for (unsigned int ctg = 0; ctg < width; ctg++) {
+      if (sCountCtg[levelIdx * width + ctg] == indexSCount) { // Singleton response:  avoid splitting.
+	unsplitable[levelIdx] = true;
+      }
+      double sum = ctgSum[levelIdx * width + ctg];
+      ss += sum * sum;
+    }
+    sumSquares[levelIdx] = ss;
+  }
+
+  unsigned int explCount = levelCount * width;
+  sumExpl = arena->Alloc<double>(explCount);
+  sCountExpl = arena->Alloc<unsigned int>(explCount);
+  for (unsigned int i = 0; i < explCount; i++) {
+    sumExpl[i] = 0.0;
+    sCountExpl[i] = 0;
+  }
+  lhExpl = arena->Alloc<bool>(levelCount);
+}
+
+
+/**
+   @brief Computes per-category sums and sample counts directly, by a
+   pass over all samples in the bag.  Employed at the root and wherever
+   sums have not been carried from a parent level.
+
+   @param width is the category width.
+
+   @return void.
  */
-void SPCtg::SumsAndSquares(const Index *index, bool unsplitable[]) {
-  sumSquares = new double[levelCount];
-  ctgSum = new double[levelCount * ctgWidth];
+void SPCtg::SumsScan(const Index *index, unsigned int width) {
+  ctgSum = arena->Alloc<double>(levelCount * width);
+  sCountCtg = arena->Alloc<unsigned int>(levelCount * width);
   unsigned int levelWidth = index->LevelWidth();
-  double *sumTemp = new double[levelWidth * ctgWidth];
-  unsigned int *sCountTemp = new unsigned int[levelWidth * ctgWidth];
-  for (unsigned int i = 0; i < levelWidth * ctgWidth; i++) {
+  ArenaMark tempMark = arena->Mark(); // Temporaries released on exit.
+  double *sumTemp = arena->Alloc<double>(levelWidth * width);
+  unsigned int *sCountTemp = arena->Alloc<unsigned int>(levelWidth * width);
+  for (unsigned int i = 0; i < levelWidth * width; i++) {
     sumTemp[i] = 0.0;
     sCountTemp[i] = 0;
   }
@@ -426,8 +607,8 @@ void SPCtg::SumsAndSquares(const Index *index, bool unsplitable[]) {
       FltVal sum;
       unsigned int sCount;
       unsigned int ctg = sampleCtg[sIdx].Ref(sum, sCount);
-      sumTemp[levelOff * ctgWidth + ctg] += sum;
-      sCountTemp[levelOff * ctgWidth + ctg] += sCount;
+      sumTemp[levelOff * width + ctg] += sum;
+      sCountTemp[levelOff * width + ctg] += sCount;
     }
   }
 
@@ -437,22 +618,77 @@ void SPCtg::SumsAndSquares(const Index *index, bool unsplitable[]) {
   //
   for (unsigned int levelIdx = 0; levelIdx < levelCount; levelIdx++) {
     int levelOff = index->LevelOffSplit(levelIdx);
-    unsigned int indexSCount = index->SCount(levelIdx);
-    double ss = 0.0;
-    for (unsigned int ctg = 0; ctg < ctgWidth; ctg++) {
-      unsigned int sCount = sCountTemp[levelOff * ctgWidth + ctg];
-      if (sCount == indexSCount) { // Singleton response:  avoid splitting.
-	unsplitable[levelIdx] = true;
-      }
-      double sum = sumTemp[levelOff * ctgWidth + ctg];
-      ctgSum[levelIdx * ctgWidth + ctg] = sum;
-      ss += sum * sum;
+    for (unsigned int ctg = 0; ctg < width; ctg++) {
+      sCountCtg[levelIdx * width + ctg] = sCountTemp[levelOff * width + ctg];
+      ctgSum[levelIdx * width + ctg] = sumTemp[levelOff * width + ctg];
     }
-    sumSquares[levelIdx] = ss;
   }
+  arena->Release(tempMark);
+}
 
-  delete [] sumTemp;
-  delete [] sCountTemp;
+
+/**
+   @brief Designates the successor of a splitting node whose per-category
+   sums are accumulated as its samples are replayed.  The other
+   successor's sums are later derived by subtraction from the node's own.
+
+   @param levelIdx is the level-relative index of the splitting node.
+
+   @param isLH is true iff the accumulated successor is left-hand.
+
+   @param sCountNode outputs the node's per-category sample counts.
+
+   @return the node's per-category response sums.
+ */
+double *SPCtg::ExplSums(unsigned int levelIdx, bool isLH, unsigned int *&sCountNode) {
+  lhExpl[levelIdx] = isLH;
+  sCountNode = sCountExpl + levelIdx * ctgWidth;
+  return sumExpl + levelIdx * ctgWidth;
+}
+
+
+/**
+   @brief Allocates the next level's per-category sums.
+
+   @param splitNext is the number of splitable nodes in the next level.
+
+   @return void.
+ */
+void SPCtg::Overlap(unsigned int splitNext) {
+  ctgSumNext = new double[splitNext * ctgWidth];
+  sCountNext = new unsigned int[splitNext * ctgWidth];
+}
+
+
+/**
+   @brief Sets a successor's per-category sums, either directly from the
+   explicitly-walked side or as the parent's sums less these.
+
+   @param levelIdx is the level-relative index of the parent.
+
+   @param nodeNext is the successor's index in the next level.
+
+   @param isLH is true iff the successor is left-hand.
+
+   @return void.
+ */
+void SPCtg::Inherit(unsigned int levelIdx, unsigned int nodeNext, bool isLH) {
+  unsigned int parOff = levelIdx * ctgWidth;
+  unsigned int nextOff = nodeNext * ctgWidth;
+  if (isLH == lhExpl[levelIdx]) {
+    for (unsigned int ctg = 0; ctg < ctgWidth; ctg++) {
+      ctgSumNext[nextOff + ctg] = sumExpl[parOff + ctg];
+      sCountNext[nextOff + ctg] = sCountExpl[parOff + ctg];
+    }
+  }
+  else {
+    for (unsigned int ctg = 0; ctg < ctgWidth; ctg++) {
+      unsigned int sCount = sCountCtg[parOff + ctg] - sCountExpl[parOff + ctg];
+      // Absent categories are pinned to zero, free of rounding residue.
+      ctgSumNext[nextOff + ctg] = sCount == 0 ? 0.0 : ctgSum[parOff + ctg] - sumExpl[parOff + ctg];
+      sCountNext[nextOff + ctg] = sCount;
+    }
+  }
 }
 
 
@@ -479,7 +715,7 @@ double SPCtg::Prebias(unsigned int levelIdx, unsigned int sCount, double sum) {
  */
 void SPCtg::LevelInitSumR() {
   unsigned int length = PredBlock::NPredNum() * ctgWidth * levelCount;
-  ctgSumR = new double[length];
+  ctgSumR = arena->Alloc<double>(length);
   for (unsigned int i = 0; i < length; i++)
     ctgSumR[i] = 0.0;
 }
@@ -502,13 +738,34 @@ void SPCtg::LevelInitSumR() {
 
    @return void.
  */
-void SPReg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[]) {
+void SPReg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
+  switch (rank.Width()) {
+  case 1:
+    SplitNum<unsigned char>(bottomIdx, indexNode, spn, rank.Col<unsigned char>());
+    break;
+  case 2:
+    SplitNum<unsigned short>(bottomIdx, indexNode, spn, rank.Col<unsigned short>());
+    break;
+  default:
+    SplitNum<unsigned int>(bottomIdx, indexNode, spn, rank.Col<unsigned int>());
+    break;
+  }
+}
+
+
+/**
+   @brief Selects constrained or unconstrained splitting, over ranks
+   read at their storage type.
+
+   @return void.
+ */
+template<typename rankType> void SPReg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const rankType rank[]) {
   int monoMode = MonoMode(bottomIdx);
   if (monoMode != 0) {
-    SplitNumMono(bottomIdx, indexNode, spn, monoMode > 0);
+    SplitNumMono(bottomIdx, indexNode, spn, rank, monoMode > 0);
   }
   else {
-    SplitNumWV(bottomIdx, indexNode, spn);
+    SplitNumWV(bottomIdx, indexNode, spn, rank);
   }
 }
 
@@ -539,8 +796,8 @@ int SPReg::MonoMode(unsigned int bottomIdx) {
 
    @return void.
  */
-void SPReg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode indexNode[], const SPNode spn[]) {
-  SplitFacWV(bottomIdx, setIdx, indexNode, spn);
+void SPReg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode indexNode[], const SPNode spn[], const SPRank &rank) {
+  SplitFacWV(bottomIdx, setIdx, indexNode, spn, rank);
 }
 
 
@@ -553,8 +810,8 @@ void SPReg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode indexNo
 
    @return void.
  */
-void SPCtg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[]) {
-  SplitNumGini(bottomIdx, indexNode, spn);
+void SPCtg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
+  (this->*splitNumGini)(bottomIdx, indexNode, spn, rank);
 }
 
 
@@ -567,8 +824,117 @@ void SPCtg::SplitNum(unsigned int bottomIdx, const IndexNode *indexNode, const S
 
    @return void.
  */
-void SPCtg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[]) {
-  SplitFacGini(bottomIdx, setIdx, indexNode, spn);
+void SPCtg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
+  SplitFacGini(bottomIdx, setIdx, indexNode, spn, rank);
+}
+
+
+/**
+   @brief Splits a numeric pair whose cell holds only the node's explicit
+   samples.  The implicit samples, sharing a single rank, are summarized
+   by a short run of nodes merged into a copy of the explicit samples at
+   their rank position, over which the customary numeric splitting
+   method is applied.
+
+   @param explCount is the count of explicit samples in the cell.
+
+   @param rankDense is the rank of the implicit samples.
+
+   @return void.
+ */
+void SplitPred::SplitImplicit(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank, unsigned int explCount, unsigned int rankDense) {
+  unsigned int levelIdx, predIdx;
+  bottom->SplitCoords(bottomIdx, levelIdx, predIdx);
+  vector<SPNode> runNode;
+  ImplicitRun(levelIdx, indexNode, spn, explCount, rankDense, runNode);
+
+  unsigned int start = indexNode->lhStart;
+  unsigned int runPos = 0;
+  while (runPos < explCount && rank[start + runPos] < rankDense)
+    runPos++;
+
+  unsigned int runWidth = runNode.size();
+  vector<SPNode> spMerge(explCount + runWidth);
+  vector<unsigned int> rkMerge(explCount + runWidth);
+  for (unsigned int idx = 0; idx < explCount; idx++) {
+    unsigned int mergeIdx = idx < runPos ? idx : idx + runWidth;
+    spMerge[mergeIdx] = spn[start + idx];
+    rkMerge[mergeIdx] = rank[start + idx];
+  }
+  for (unsigned int i = 0; i < runWidth; i++) {
+    spMerge[runPos + i] = runNode[i];
+    rkMerge[runPos + i] = rankDense;
+  }
+
+  IndexNode nodeMerge = *indexNode;
+  nodeMerge.lhStart = 0;
+  nodeMerge.idxCount = explCount + runWidth;
+  SplitNum(bottomIdx, &nodeMerge, &spMerge[0], SPRank(reinterpret_cast<unsigned char *>(&rkMerge[0]), sizeof(unsigned int)));
+  bottom->SSImplicit(bottomIdx, runPos, runWidth, indexNode->idxCount - explCount, &rkMerge[0]);
+}
+
+
+/**
+   @brief Summarizes a node's implicit samples as a single node, whose
+   response sum and sample count are the residuals of the explicit
+   samples'.
+
+   @param runNode outputs the summary node.
+
+   @return void, with output vector.
+ */
+void SPReg::ImplicitRun(unsigned int, const IndexNode *indexNode, const SPNode spn[], unsigned int explCount, unsigned int rankDense, vector<SPNode> &runNode) {
+  unsigned int sCountNode = indexNode->sCount;
+  double sumNode = indexNode->sum;
+  unsigned int start = indexNode->lhStart;
+  for (unsigned int idx = start; idx < start + explCount; idx++) {
+    FltVal ySum;
+    unsigned int sCount;
+    spn[idx].RegFields(ySum, sCount);
+    sumNode -= ySum;
+    sCountNode -= sCount;
+  }
+
+  StagePack stagePack;
+  stagePack.Set(0, rankDense, sCountNode, 0, sumNode);
+  SPNode spNode;
+  unsigned int rank;
+  (void) spNode.Init(stagePack, rank);
+  runNode.push_back(spNode);
+}
+
+
+/**
+   @brief Summarizes a node's implicit samples as one node per category
+   represented, from the residuals of the explicit samples' per-category
+   sums and sample counts.
+
+   @param runNode outputs the summary nodes, in category order.
+
+   @return void, with output vector.
+ */
+void SPCtg::ImplicitRun(unsigned int levelIdx, const IndexNode *indexNode, const SPNode spn[], unsigned int explCount, unsigned int rankDense, vector<SPNode> &runNode) {
+  vector<double> sumImpl(ctgSum + levelIdx * ctgWidth, ctgSum + (levelIdx + 1) * ctgWidth);
+  vector<unsigned int> sCountImpl(sCountCtg + levelIdx * ctgWidth, sCountCtg + (levelIdx + 1) * ctgWidth);
+  unsigned int start = indexNode->lhStart;
+  for (unsigned int idx = start; idx < start + explCount; idx++) {
+    FltVal ySum;
+    unsigned int yCtg;
+    unsigned int sCount = spn[idx].CtgFields(ySum, yCtg);
+    sCountImpl[yCtg] -= sCount;
+    sumImpl[yCtg] -= ySum;
+  }
+
+  for (unsigned int ctg = 0; ctg < ctgWidth; ctg++) {
+    if (sCountImpl[ctg] > 0) {
+      StagePack stagePack;
+      stagePack.Set(0, rankDense, sCountImpl[ctg], ctg, sumImpl[ctg]);
+      SPNode spNode;
+      unsigned int rank;
+      (void) spNode.Init(stagePack, rank);
+      runNode.push_back(spNode);
+    }
+  }
 }
 
 
@@ -577,7 +943,7 @@ void SPCtg::SplitFac(unsigned int bottomIdx, int setIdx, const IndexNode *indexN
 
    @return void.
 */
-void SPReg::SplitNumWV(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[]) {
+template<typename rankType> void SPReg::SplitNumWV(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const rankType rank[]) {
   // Walks samples backward from the end of nodes so that ties are not split.
   unsigned int _start, _end;
   unsigned int sCount;
@@ -585,9 +951,10 @@ void SPReg::SplitNumWV(unsigned int bottomIdx, const IndexNode *indexNode, const
   FltVal preBias, maxGini;
   maxGini = preBias = indexNode->SplitFields(_start, _end, sCount, sum);
 
-  unsigned int rkRight, sampleCount;
+  unsigned int sampleCount;
   FltVal ySum;
-  spn[_end].RegFields(ySum, rkRight, sampleCount);
+  spn[_end].RegFields(ySum, sampleCount);
+  unsigned int rkRight = rank[_end];
   double sumR = ySum;
   int sCountL = sCount - sampleCount; // >= 1: counts up to, including, this index. 
   int lhSampCt = 0;
@@ -600,8 +967,8 @@ void SPReg::SplitNumWV(unsigned int bottomIdx, const IndexNode *indexNode, const
     int sCountR = sCount - sCountL;
     double sumL = sum - sumR;
     double idxGini = (sumL * sumL) / sCountL + (sumR * sumR) / sCountR;
-    unsigned int rkThis;
-    spn[i].RegFields(ySum, rkThis, sampleCount);
+    unsigned int rkThis = rank[i];
+    spn[i].RegFields(ySum, sampleCount);
     if (idxGini > maxGini && rkThis != rkRight) {
       lhSampCt = sCountL;
       lhSup = i;
@@ -623,7 +990,7 @@ void SPReg::SplitNumWV(unsigned int bottomIdx, const IndexNode *indexNode, const
 
    @return void.
 */
-void SPReg::SplitNumMono(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], bool increasing) {
+template<typename rankType> void SPReg::SplitNumMono(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const rankType rank[], bool increasing) {
   // Walks samples backward from the end of nodes so that ties are not split.
   unsigned int _start, _end;
   unsigned int sCount;
@@ -631,9 +998,10 @@ void SPReg::SplitNumMono(unsigned int bottomIdx, const IndexNode *indexNode, con
   FltVal preBias, maxGini;
   maxGini = preBias = indexNode->SplitFields(_start, _end, sCount, sum);
 
-  unsigned int rkRight, sampleCount;
+  unsigned int sampleCount;
   FltVal yVal;
-  spn[_end].RegFields(yVal, rkRight, sampleCount);
+  spn[_end].RegFields(yVal, sampleCount);
+  unsigned int rkRight = rank[_end];
   double sumR = yVal;
   int sCountL = sCount - sampleCount; // >= 1: counts up to, including, this index. 
   int lhSampCt = 0;
@@ -646,8 +1014,8 @@ void SPReg::SplitNumMono(unsigned int bottomIdx, const IndexNode *indexNode, con
     int sCountR = sCount - sCountL;
     FltVal sumL = sum - sumR;
     FltVal idxGini = (sumL * sumL) / sCountL + (sumR * sumR) / sCountR;
-    unsigned int rkThis;
-    spn[i].RegFields(yVal, rkThis, sampleCount);
+    unsigned int rkThis = rank[i];
+    spn[i].RegFields(yVal, sampleCount);
     if (idxGini > maxGini && rkThis != rkRight) {
       FltVal meanL = sumL / sCountL;
       FltVal meanR = sumR / sCountR;
@@ -670,25 +1038,131 @@ void SPReg::SplitNumMono(unsigned int bottomIdx, const IndexNode *indexNode, con
 
 
 /**
-   @brief Gini-based splitting method.
+   @brief Per-category sums accumulated by the numeric Gini scan.  When
+   'ctgW' is nonzero, the sums to the right are held locally, otherwise
+   in the level-wide checkerboard.
+ */
+template<unsigned int ctgW> class SPCtg::CtgAccum {
+  double sumR[ctgW];
+  double sumCtg[ctgW];
+ public:
+  CtgAccum(SPCtg *spCtg, unsigned int levelIdx, unsigned int) {
+    for (unsigned int ctg = 0; ctg < ctgW; ctg++) {
+      sumR[ctg] = 0.0;
+      sumCtg[ctg] = spCtg->CtgSum(levelIdx, ctg);
+    }
+  }
+
+
+  /**
+     @brief Right sum is post-incremented with 'ySum', hence is exclusive.
+     Left sum is inclusive.
+
+     @return void, with output reference parameters.
+   */
+  inline void Update(unsigned int yCtg, double ySum, double &sumRCtg, double &sumLCtg) {
+    sumRCtg = sumR[yCtg];
+    sumR[yCtg] = sumRCtg + ySum;
+    sumLCtg = sumCtg[yCtg] - sumRCtg;
+  }
+};
+
+
+/**
+   @brief Binary response:  the two right-hand sums are held as scalars,
+   with the category selecting between them.
+ */
+template<> class SPCtg::CtgAccum<2> {
+  double sumR0;
+  double sumR1;
+  const double ctgSum0;
+  const double ctgSum1;
+ public:
+  CtgAccum(SPCtg *spCtg, unsigned int levelIdx, unsigned int) : sumR0(0.0), sumR1(0.0), ctgSum0(spCtg->CtgSum(levelIdx, 0)), ctgSum1(spCtg->CtgSum(levelIdx, 1)) {
+  }
+
+
+  inline void Update(unsigned int yCtg, double ySum, double &sumRCtg, double &sumLCtg) {
+    if (yCtg == 0) {
+      sumRCtg = sumR0;
+      sumR0 += ySum;
+      sumLCtg = ctgSum0 - sumRCtg;
+    }
+    else {
+      sumRCtg = sumR1;
+      sumR1 += ySum;
+      sumLCtg = ctgSum1 - sumRCtg;
+    }
+  }
+};
+
+
+/**
+   @brief Generic width:  sums to the right accumulate in the checkerboard.
+ */
+template<> class SPCtg::CtgAccum<0> {
+  SPCtg *spCtg;
+  const unsigned int levelIdx;
+  const unsigned int numIdx;
+ public:
+  CtgAccum(SPCtg *_spCtg, unsigned int _levelIdx, unsigned int _numIdx) : spCtg(_spCtg), levelIdx(_levelIdx), numIdx(_numIdx) {
+  }
+
+
+  inline void Update(unsigned int yCtg, double ySum, double &sumRCtg, double &sumLCtg) {
+    sumRCtg = spCtg->CtgSumRight(levelIdx, numIdx, yCtg, ySum);
+    sumLCtg = spCtg->CtgSum(levelIdx, yCtg) - sumRCtg;
+  }
+};
+
+
+/**
+   @brief Dispatches the Gini scan on the width of the cell's ranks.
+
+   @param ctgW is the category width, if specialized, otherwise zero.
 
    @return void.
  */
-void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[]) {
+template<unsigned int ctgW> void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
+  switch (rank.Width()) {
+  case 1:
+    SplitNumGini<ctgW, unsigned char>(bottomIdx, indexNode, spn, rank.Col<unsigned char>());
+    break;
+  case 2:
+    SplitNumGini<ctgW, unsigned short>(bottomIdx, indexNode, spn, rank.Col<unsigned short>());
+    break;
+  default:
+    SplitNumGini<ctgW, unsigned int>(bottomIdx, indexNode, spn, rank.Col<unsigned int>());
+    break;
+  }
+}
+
+
+/**
+   @brief Gini-based splitting method.  Only the accumulation of
+   per-category sums depends upon 'ctgW'.
+
+   @param ctgW is the category width, if specialized, otherwise zero.
+
+   @param rank holds the cell's ranks at their storage type.
+
+   @return void.
+ */
+template<unsigned int ctgW, typename rankType> void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, const SPNode spn[], const rankType rank[]) {
   unsigned int levelIdx, predIdx;
   bottom->SplitCoords(bottomIdx, levelIdx, predIdx);
-  int numIdx = PredBlock::NumIdx(predIdx);
   unsigned int _start, _end;
   unsigned int sCountL;
   double sum;
   FltVal preBias, maxGini;
   maxGini = preBias = indexNode->SplitFields(_start, _end, sCountL, sum);
 
+  CtgAccum<ctgW> accum(this, levelIdx, PredBlock::NumIdx(predIdx));
   double ssL = sumSquares[levelIdx];
   double ssR = 0.0;
   double sumL = sum;
-  unsigned int rkRight = spn[_end].Rank();
-  unsigned int rkStart = spn[_start].Rank();
+  unsigned int rkRight = rank[_end];
+  unsigned int rkStart = rank[_start];
   unsigned int lhSampCt = 0;
 
   // Signing values avoids decrementing below zero.
@@ -696,7 +1170,7 @@ void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, con
   int end = _end;
   int lhSup = end;
   for (int i = end; i >= start; i--) {
-    unsigned int rkThis = spn[i].Rank();
+    unsigned int rkThis = rank[i];
     FltVal sumR = sum - sumL;
     if (rkThis != rkRight && sumL > minDenom && sumR > minDenom) {
       FltVal cutGini = ssL / sumL + ssR / sumR;
@@ -715,11 +1189,8 @@ void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, con
 
     // Maintains sums of category squares incrementally, via update.
     //
-    // Right sum is post-incremented with 'ySum', hence is exclusive.
-    // Left sum is inclusive.
-    //
-    double sumRCtg = CtgSumRight(levelIdx, numIdx, yCtg, ySum);
-    double sumLCtg = CtgSum(levelIdx, yCtg) - sumRCtg;
+    double sumRCtg, sumLCtg;
+    accum.Update(yCtg, ySum, sumRCtg, sumLCtg);
     ssR += ySum * (ySum + 2.0 * sumRCtg);
     ssL += ySum * (ySum - 2.0 * sumLCtg);
     sumL -= ySum;
@@ -737,7 +1208,7 @@ void SPCtg::SplitNumGini(unsigned int bottomIdx, const IndexNode *indexNode, con
 
    @return void.
  */
-void SPCtg::SplitFacGini(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[]) {
+void SPCtg::SplitFacGini(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
   unsigned int start, end;
   unsigned int dummy;
   double sum, preBias, maxGini;
@@ -746,7 +1217,7 @@ void SPCtg::SplitFacGini(unsigned int bottomIdx, int setIdx, const IndexNode *in
   unsigned int levelIdx, predIdx;
   bottom->SplitCoords(bottomIdx, levelIdx, predIdx);
   RunSet *runSet = run->RSet(setIdx);
-  bottom->RunCount(bottomIdx, BuildRuns(runSet, spn, start, end));
+  bottom->RunCount(bottomIdx, BuildRuns(runSet, spn, rank, start, end));
   
   unsigned int lhIdxCount, lhSampCt;
   if (ctgWidth == 2)  {
@@ -768,11 +1239,11 @@ void SPCtg::SplitFacGini(unsigned int bottomIdx, int setIdx, const IndexNode *in
    when run count has been estimated to be wide:
 
 */
-unsigned int SPCtg::BuildRuns(RunSet *runSet, const SPNode spn[], unsigned int _start, unsigned int _end) {
+unsigned int SPCtg::BuildRuns(RunSet *runSet, const SPNode spn[], const SPRank &rank, unsigned int _start, unsigned int _end) {
   unsigned int frEnd = _end;
   double sum = 0.0;
   unsigned int sCount = 0;
-  unsigned int rkThis = spn[_end].Rank();
+  unsigned int rkThis = rank[_end];
 
   // Signing values avoids decrementing below zero.
   int start = _start;
@@ -781,7 +1252,8 @@ unsigned int SPCtg::BuildRuns(RunSet *runSet, const SPNode spn[], unsigned int _
     unsigned int rkRight = rkThis;
     unsigned int yCtg;
     FltVal ySum;
-    unsigned int sampleCount = spn[i].CtgFields(ySum, rkThis, yCtg);
+    unsigned int sampleCount = spn[i].CtgFields(ySum, yCtg);
+    rkThis = rank[i];
 
     if (rkThis == rkRight) { // Current run's counters accumulate.
       sum += ySum;
@@ -909,7 +1381,7 @@ unsigned int SPCtg::SplitBinary(RunSet *runSet, unsigned int levelIdx, double su
 
    @return void.
  */
-void SPReg::SplitFacWV(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[]) {
+void SPReg::SplitFacWV(unsigned int bottomIdx, int setIdx, const IndexNode *indexNode, const SPNode spn[], const SPRank &rank) {
   unsigned int start, end;
   unsigned int sCount;
   double sum, preBias, maxGini;
@@ -918,7 +1390,7 @@ void SPReg::SplitFacWV(unsigned int bottomIdx, int setIdx, const IndexNode *inde
   unsigned int levelIdx, predIdx;
   bottom->SplitCoords(bottomIdx, levelIdx, predIdx);
   RunSet *runSet = run->RSet(setIdx);
-  bottom->RunCount(bottomIdx, BuildRuns(runSet, spn, start, end));
+  bottom->RunCount(bottomIdx, BuildRuns(runSet, spn, rank, start, end));
   runSet->HeapMean();
 
   unsigned int idxCountL;
@@ -932,11 +1404,11 @@ void SPReg::SplitFacWV(unsigned int bottomIdx, int setIdx, const IndexNode *inde
 /**
    Regression runs always maintained by heap.
 */
-unsigned int SPReg::BuildRuns(RunSet *runSet, const SPNode spn[], unsigned int _start, unsigned int _end) {
+unsigned int SPReg::BuildRuns(RunSet *runSet, const SPNode spn[], const SPRank &rank, unsigned int _start, unsigned int _end) {
   unsigned int frEnd = _end;
   double sum = 0.0;
   unsigned int sCount = 0;
-  unsigned int rkThis = spn[_end].Rank();
+  unsigned int rkThis = rank[_end];
 
   // Signing values avoids decrementing below zero.
   int start = _start;
@@ -945,7 +1417,8 @@ unsigned int SPReg::BuildRuns(RunSet *runSet, const SPNode spn[], unsigned int _
     unsigned int rkRight = rkThis;
     unsigned int sampleCount;
     FltVal ySum;
-    spn[i].RegFields(ySum, rkThis, sampleCount);
+    rkThis = rank[i];
+    spn[i].RegFields(ySum, sampleCount);
 
     if (rkThis == rkRight) { // Same run:  counters accumulate.
       sum += ySum;
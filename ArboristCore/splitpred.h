@@ -34,6 +34,7 @@ class SplitPred {
 
   void SetPrebias(class IndexNode indexNode[]);
   void SplitFlags(bool unsplitable[]);
+  void NodeFlags(unsigned int levelIdx, const bool unsplitable[], const double ruPred[], class BHPair heap[]);
   void SplitPredNull(bool splitFlags[]);
   void SplitPredProb(const double ruPred[], bool splitFlags[]);
   void SplitPredFixed(const double ruPred[], class BHPair heap[], bool splitFlags[]);
@@ -41,6 +42,9 @@ class SplitPred {
   static unsigned int nPred;
   class Bottom *bottom;
   unsigned int levelCount; // # subtree nodes at current level.
+  unsigned int tIdx; // Absolute index of tree under training.
+  unsigned int levelSeq; // Position of level in the tree's training sequence.
+  class Arena *arena; // Tree's arena, from which level's workspace is drawn.
   
   class Run *run;
   bool *splitFlags; // Indexed by pair.
@@ -56,14 +60,20 @@ class SplitPred {
   }
   
   virtual ~SplitPred();
+  virtual SplitPred *Spawn(class SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const = 0;
   virtual bool *LevelInit(class Index *index, class IndexNode indexNode[], class Bottom *bottom, unsigned int levelCount, class Run *&_run);
   virtual void RunOffsets() = 0;
   virtual bool *LevelPreset(const class Index *index) = 0;
   virtual double Prebias(unsigned int levelIdx, unsigned int sCount, double sum) = 0;
   virtual void LevelClear();
-
-  virtual void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[]) = 0;
-  virtual void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode spn[]) = 0;
+  virtual double *ExplSums(unsigned int levelIdx, bool isLH, unsigned int *&sCountNode);
+  virtual void Overlap(unsigned int splitNext);
+  virtual void Inherit(unsigned int levelIdx, unsigned int nodeNext, bool isLH);
+
+  virtual void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[], const class SPRank &rank) = 0;
+  virtual void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode spn[], const class SPRank &rank) = 0;
+  virtual void ImplicitRun(unsigned int levelIdx, const class IndexNode *indexNode, const class SPNode spn[], unsigned int explCount, unsigned int rankDense, std::vector<class SPNode> &runNode) = 0;
+  void SplitImplicit(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const class SPRank &rank, unsigned int explCount, unsigned int rankDense);
 };
 
 
@@ -71,6 +81,7 @@ class SplitPred {
    @brief Splitting facilities specific regression trees.
  */
 class SPReg : public SplitPred {
+  friend class KernelBench; // Times SplitNum() apart from Split().
   static unsigned int predMono;
   static double *mono;
   double *ruMono;
@@ -78,12 +89,13 @@ class SPReg : public SplitPred {
   int MonoMode(unsigned int splitIdx);
   void SplitHeap(const class IndexNode *indexNode, const class SPNode spn[], unsigned int predIdx);
   void Split(const class IndexNode indexNode[], class SPNode *nodeBase);
-  void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[]);
-  void SplitNumWV(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[]);
-  void SplitNumMono(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], bool increasing);
-  void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode *nodeBase);
-  void SplitFacWV(unsigned int splitIdx, int runIdx, const class IndexNode *indexNode, const class SPNode spn[]);
-  unsigned int BuildRuns(class RunSet *runSet, const class SPNode spn[], unsigned int start, unsigned int end);
+  void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[], const class SPRank &rank);
+  template<typename rankType> void SplitNum(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const rankType rank[]);
+  template<typename rankType> void SplitNumWV(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const rankType rank[]);
+  template<typename rankType> void SplitNumMono(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const rankType rank[], bool increasing);
+  void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode *nodeBase, const class SPRank &rank);
+  void SplitFacWV(unsigned int splitIdx, int runIdx, const class IndexNode *indexNode, const class SPNode spn[], const class SPRank &rank);
+  unsigned int BuildRuns(class RunSet *runSet, const class SPNode spn[], const class SPRank &rank, unsigned int start, unsigned int end);
   unsigned int HeapSplit(class RunSet *runSet, double sum, unsigned int sCountNode, unsigned int &lhIdxCount, double &maxGini);
 
 
@@ -92,11 +104,13 @@ class SPReg : public SplitPred {
   static void DeImmutables();
   SPReg(class SamplePred *_samplePred, unsigned int bagCount);
   ~SPReg();
+  SplitPred *Spawn(class SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const;
   void RunOffsets();
   bool *LevelPreset(const class Index *index);
   double Prebias(unsigned int spiltIdx, unsigned int sCount, double sum);
   bool *LevelInit(class Index *index, class IndexNode indexNode[], class Bottom *bottom, unsigned int levelCount, class Run *&_run);
   void LevelClear();
+  void ImplicitRun(unsigned int levelIdx, const class IndexNode *indexNode, const class SPNode spn[], unsigned int explCount, unsigned int rankDense, std::vector<class SPNode> &runNode);
 };
 
 
@@ -104,21 +118,38 @@ class SPReg : public SplitPred {
    @brief Splitting facilities for categorical trees.
  */
 class SPCtg : public SplitPred {
+  friend class KernelBench; // Times the Gini kernels apart from Split().
   static unsigned int ctgWidth;
+  static constexpr unsigned int ctgUnroll = 8; // Widest specialized kernel.
+
+  // Kernels specialized to the forest's category width, selected once
+  // by Immutables().
+  static void (SPCtg::*sumsAndSquares)(const class Index *, bool[]);
+  static void (SPCtg::*splitNumGini)(unsigned int, const class IndexNode *, const class SPNode[], const class SPRank &);
   double *ctgSum; // Per-level sum, by split/category pair.
-  double *ctgSumR; // Numeric predictors:  sum to right.
+  unsigned int *sCountCtg; // Per-level sample count, by split/category pair.
+  double *sumExpl; // Sums over explicitly-walked successors, by split/category pair.
+  unsigned int *sCountExpl; // Sample counts, as above.
+  bool *lhExpl; // Per-level:  whether the explicitly-walked successor is left-hand.
+  double *ctgSumNext; // Next level's sums, derived from this level's.
+  unsigned int *sCountNext; // Next level's sample counts, as above.
+  double *ctgSumR; // Numeric predictors, generic width only:  sum to right.
   double *sumSquares; // Per-level sum of squares, by split.
 // Numerical tolerances taken from A. Liaw's code:
   static constexpr double minDenom = 1.0e-5;
   static constexpr double minSumL = 1.0e-8;
   static constexpr double minSumR = 1.0e-5;
   const class SampleNode *sampleCtg;
+  class SampleNode *sampleLocal; // Owned compact copy, if spawned.
   bool *LevelPreset(const class Index *index);
   double Prebias(unsigned int levelIdx, unsigned int sCount, double sum);
   void LevelClear();
   void Split(const class IndexNode indexNode[], class SPNode *nodeBase);
   void RunOffsets();
-  void SumsAndSquares(const class Index *index, bool unsplitable[]);
+  template<unsigned int ctgW> static void Specialize();
+  template<unsigned int ctgW> class CtgAccum;
+  template<unsigned int ctgW> void SumsAndSquares(const class Index *index, bool unsplitable[]);
+  void SumsScan(const class Index *index, unsigned int width);
   unsigned int LHBits(unsigned int lhBits, unsigned int pairOffset, unsigned int depth, unsigned int &lhSampCt);
 
   /**
@@ -135,17 +166,23 @@ class SPCtg : public SplitPred {
   }
 
   void LevelInitSumR();
-  void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[]);
-  void SplitNumGini(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[]);
+  void SplitNum(unsigned int splitIdx, const class IndexNode indexNode[], const class SPNode spn[], const class SPRank &rank);
+  template<unsigned int ctgW> void SplitNumGini(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const class SPRank &rank);
+  template<unsigned int ctgW, typename rankType> void SplitNumGini(unsigned int splitIdx, const class IndexNode *indexNode, const class SPNode spn[], const rankType rank[]);
   unsigned int SplitBinary(class RunSet *runSet, unsigned int levelIdx, double sum, double &maxGini, unsigned int &sCount);
-  unsigned int BuildRuns(class RunSet *runSet, const class SPNode spn[], unsigned int start, unsigned int end);
+  unsigned int BuildRuns(class RunSet *runSet, const class SPNode spn[], const class SPRank &rank, unsigned int start, unsigned int end);
   unsigned int SplitRuns(class RunSet *runSet, unsigned int levelIdx, double sum, double &maxGini, unsigned int &lhSampCt);
   
  public:
-  SPCtg(class SamplePred *_samplePred, class SampleNode _sampleCtg[], unsigned int bagCount);
+  SPCtg(class SamplePred *_samplePred, class SampleNode _sampleCtg[], unsigned int bagCount, bool _owned = false);
   ~SPCtg();
+  SplitPred *Spawn(class SamplePred *_samplePred, unsigned int _bagCount, const std::vector<unsigned int> &sIdxMap) const;
   static void Immutables(unsigned int _ctgWidth);
   static void DeImmutables();
+  double *ExplSums(unsigned int levelIdx, bool isLH, unsigned int *&sCountNode);
+  void Overlap(unsigned int splitNext);
+  void Inherit(unsigned int levelIdx, unsigned int nodeNext, bool isLH);
+  void ImplicitRun(unsigned int levelIdx, const class IndexNode *indexNode, const class SPNode spn[], unsigned int explCount, unsigned int rankDense, std::vector<class SPNode> &runNode);
   
   /**
      @brief Records sum of proxy values at 'yCtg' strictly to the right and updates the
@@ -173,8 +210,8 @@ class SPCtg : public SplitPred {
   static inline unsigned int CtgWidth() {
     return ctgWidth;
   }
-  void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode spn[]);
-  void SplitFacGini(unsigned int splitIdx, int runIdx, const class IndexNode *indexNode, const class SPNode spn[]);
+  void SplitFac(unsigned int splitIdx, int runIdx, const class IndexNode indexNode[], const class SPNode spn[], const class SPRank &rank);
+  void SplitFacGini(unsigned int splitIdx, int runIdx, const class IndexNode *indexNode, const class SPNode spn[], const class SPRank &rank);
 };
 
 
@@ -18,6 +18,7 @@
 #include "pretree.h"
 #include "bottom.h"
 #include "runset.h"
+#include "arena.h"
 
 #include <cfloat>
 
@@ -83,7 +84,38 @@ void SplitSig::Write(unsigned int _bottomIdx, unsigned int _predIdx, int _setIdx
 }
 
 
-SSNode::SSNode() : info(-DBL_MAX) {
+/**
+   @brief Translates the split written for a sparse predictor, if any,
+   from the merged copy scanned by the splitting method to buffer
+   coordinates.  The implicit run occupies 'runWidth' consecutive
+   positions of the copy, one per category represented, and is never
+   itself cut.
+
+   @param runPos is the position of the run within the copy.
+
+   @param runWidth is the count of positions occupied by the run.
+
+   @param implicit is the count of implicit indices.
+
+   @param rank are the ranks of the copy.
+
+   @return void.
+ */
+void SplitSig::Implicit(unsigned int _splitIdx, unsigned int _predIdx, unsigned int runPos, unsigned int runWidth, unsigned int implicit, const unsigned int rank[]) {
+  SSNode &ssn = Lookup(_splitIdx, _predIdx);
+  if (ssn.lhIdxCount == 0) // No split written.
+    return;
+
+  ssn.rkLow = rank[ssn.lhIdxCount - 1];
+  ssn.rkHigh = rank[ssn.lhIdxCount];
+  if (ssn.lhIdxCount > runPos) {
+    ssn.lhIdxCount += implicit - runWidth;
+    ssn.lhImplicit = implicit;
+  }
+}
+
+
+SSNode::SSNode() : setIdx(-1), predIdx(0), sCount(0), lhIdxCount(0), lhImplicit(0), rkLow(0), rkHigh(0), info(-DBL_MAX) {
 }
 
 
@@ -97,14 +129,20 @@ SSNode::SSNode() : info(-DBL_MAX) {
 
    @param ptId is the pretree index.
 
-   @param lhStart is the start index of the LHS.
+   @param start is the start index of the LHS.
+
+   @param end is the final explicit index of the node.
+
+   @param implicit is the count of the node's implicit indices.
+
+   @param sum is the response sum over the node.
 
    @return void.
 
    Sacrifices elegance for efficiency, as coprocessor may not support virtual calls.
 */
-double SSNode::NonTerminal(SamplePred *samplePred, PreTree *preTree, Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH) {
-  return setIdx >= 0 ? NonTerminalRun(samplePred, preTree, bottom, splitIdx, start, end, ptId, ptLH, ptRH) : NonTerminalNum(samplePred, preTree, bottom, splitIdx, start, end, ptId, ptLH, ptRH);
+double SSNode::NonTerminal(SamplePred *samplePred, PreTree *preTree, Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int implicit, double sum, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH) {
+  return setIdx >= 0 ? NonTerminalRun(samplePred, preTree, bottom, splitIdx, start, end, ptId, ptLH, ptRH) : NonTerminalNum(samplePred, preTree, bottom, splitIdx, start, end, implicit, sum, ptId, ptLH, ptRH);
 }
 
 
@@ -122,13 +160,18 @@ double SSNode::NonTerminalRun(SamplePred *samplePred, PreTree *preTree, Bottom *
   unsigned int sourceBit = bottom->BufBit(splitIdx, predIdx);
   (void) preTree->Replay(samplePred, predIdx, sourceBit, start, end, ptRH);
 
+  // Successor statistics are gathered over the left-hand runs, as these
+  // are replayed.
+  unsigned int *sCountExpl;
+  double *sumExpl = bottom->ExplSums(splitIdx, true, sCountExpl);
   double lhSum = 0.0;
   Run *run = bottom->Runs();
-  for (unsigned int outSlot = 0; outSlot < run->RunsLH(setIdx); outSlot++) {
+  unsigned int runsLH = run->RunsLH(setIdx);
+  for (unsigned int outSlot = 0; outSlot < runsLH; outSlot++) {
     unsigned int runStart, runEnd;
     unsigned int rank = run->RunBounds(setIdx, outSlot, runStart, runEnd);
     preTree->LHBit(ptId, rank);
-    lhSum += preTree->Replay(samplePred, predIdx, sourceBit, runStart, runEnd, ptLH);
+    lhSum += preTree->Replay(samplePred, predIdx, sourceBit, runStart, runEnd, ptLH, sumExpl, sCountExpl);
   }
 
   return lhSum;
@@ -138,16 +181,29 @@ double SSNode::NonTerminalRun(SamplePred *samplePred, PreTree *preTree, Bottom *
 /**
    @brief Writes PreTree nonterminal node for numerical predictor.
 
+   Implicit samples are not replayed, retaining the parent's index until
+   reassigned in bulk once the level has been consumed.
+
    @return sum of LH subnode's sample values.
  */
-double SSNode::NonTerminalNum(SamplePred *samplePred, PreTree *preTree, Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH) {
-  unsigned int rkLow, rkHigh;
+double SSNode::NonTerminalNum(SamplePred *samplePred, PreTree *preTree, Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int implicit, double sum, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH) {
   unsigned int sourceBit = bottom->BufBit(splitIdx, predIdx);
-  samplePred->SplitRanks(predIdx, sourceBit, start + lhIdxCount - 1, rkLow, rkHigh);
+  int lhExtent = lhIdxCount - lhImplicit; // Explicit LH indices.
+  if (implicit == 0) {
+    samplePred->SplitRanks(predIdx, sourceBit, start + lhExtent - 1, rkLow, rkHigh);
+  }
   preTree->NonTerminalNum(info, predIdx, rkLow, rkHigh, ptId, ptLH, ptRH);
-  
-  double lhSum = preTree->Replay(samplePred, predIdx, sourceBit, start, start + lhIdxCount - 1, ptLH);
-  (void) preTree->Replay(samplePred, predIdx, sourceBit, start + lhIdxCount, end, ptRH);
+
+  // Successor statistics are gathered, as its samples are replayed, over
+  // the smaller side or, if implicit samples are present, over the side
+  // lacking them.
+  bool walkLH = implicit > 0 ? !ImplicitLH() : 2 * lhIdxCount <= (unsigned int) (end - start + 1);
+  unsigned int *sCountExpl;
+  double *sumExpl = bottom->ExplSums(splitIdx, walkLH, sCountExpl);
+  double lhSum = preTree->Replay(samplePred, predIdx, sourceBit, start, start + lhExtent - 1, ptLH, walkLH ? sumExpl : 0, sCountExpl);
+  double rhSum = preTree->Replay(samplePred, predIdx, sourceBit, start + lhExtent, end, ptRH, walkLH ? 0 : sumExpl, sCountExpl);
+  if (implicit > 0 && ImplicitLH())
+    lhSum = sum - rhSum;
 
   return lhSum;
 }
@@ -188,20 +244,22 @@ SSNode *SplitSig::ArgMax(unsigned int levelIdx, double gainMax) const {
 
  @param _splitCount is the number of splits in the current level.
 
+ @param arena is the tree's arena.
+
  @return void.
 */
-void SplitSig::LevelInit(int _splitCount) {
+void SplitSig::LevelInit(int _splitCount, Arena *arena) {
   splitCount = _splitCount;
-  levelSS = new SSNode[nPred * splitCount];
+  levelSS = arena->Alloc<SSNode>(nPred * splitCount);
 }
 
 
 /**
-   @brief Deallocates level's signatures.
+   @brief Relinquishes level's signatures, which are reclaimed with the
+   arena.
 
    @return void.
  */
 void SplitSig::LevelClear() {
-  delete [] levelSS;
   levelSS = 0;
 }
@@ -23,13 +23,16 @@
  */
 class SSNode {  
   double NonTerminalRun(class SamplePred *samplePred, class PreTree *preTree, class Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH);
-  double NonTerminalNum(class SamplePred *samplePred, class PreTree *preTree, class Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH);
+  double NonTerminalNum(class SamplePred *samplePred, class PreTree *preTree, class Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int implicit, double sum, unsigned int ptId, unsigned int &ptLH, unsigned int &ptRH);
  public:
   SSNode();
   int setIdx; // Index into RunSet workspace.
   unsigned int predIdx; // Rederivable, but convenient to cache.
   unsigned int sCount; // # samples subsumed by split LHS.
   unsigned int lhIdxCount; // Index count of split LHS.
+  unsigned int lhImplicit; // Implicit indices in split LHS:  sparse predictors only.
+  unsigned int rkLow; // Ranks bounding the cut:  sparse predictors only.
+  unsigned int rkHigh;
   double info; // Information content of split.
 
   static double minRatio;
@@ -63,7 +66,18 @@ class SSNode {
     _lhIdxCount = lhIdxCount;
   }
 
-  double NonTerminal(class SamplePred *samplePred, class PreTree *preTree, class Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int ptId, unsigned int &ptL, unsigned int &ptR);
+  double NonTerminal(class SamplePred *samplePred, class PreTree *preTree, class Bottom *bottom, unsigned int splitIdx, int start, int end, unsigned int implicit, double sum, unsigned int ptId, unsigned int &ptL, unsigned int &ptR);
+
+
+  /**
+     @brief Determines which successor receives the implicit samples of
+     the splitting predictor.
+
+     @return true iff implicit samples, if any, are left-hand.
+   */
+  inline bool ImplicitLH() const {
+    return lhImplicit > 0;
+  }
 };
 
 
@@ -100,9 +114,10 @@ class SplitSig {
   static void Immutables(unsigned int _nPred, double _minRatio);
   static void DeImmutables();
 
-  void LevelInit(int splitCount);
+  void LevelInit(int splitCount, class Arena *arena);
   void LevelClear();
   void Write(unsigned int _splitIdx, unsigned int _predIdx, int _runIdx, unsigned int _sCount, unsigned int _lhIdxCount, double _info);
+  void Implicit(unsigned int _splitIdx, unsigned int _predIdx, unsigned int runPos, unsigned int runWidth, unsigned int implicit, const unsigned int rank[]);
 };
 
 #endif
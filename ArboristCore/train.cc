@@ -26,16 +26,32 @@
 #include "response.h"
 #include "splitpred.h"
 #include "leaf.h"
+#include "arena.h"
+#include "spill.h"
+#include "memtrack.h"
+#include "proftrack.h"
+#include "philox.h"
 
 #include <algorithm>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 // Testing only:
 //#include <iostream>
 //using namespace std;
 
 int Train::trainBlock = 0;
+size_t Train::blockBytes = 0;
+size_t Train::peakRSS = 0;
 unsigned int Train::nTree = 0;
 unsigned int Train::nRow = 0;
 int Train::nPred = 0;
+unsigned int Train::segmentCount = 0;
+unsigned int Train::reallocCount = 0;
+size_t Train::arenaAlloc = 0;
+size_t Train::arenaChunk = 0;
+size_t Train::arenaServed = 0;
+size_t Train::arenaHighWater = 0;
 
 /**
    @brief Initializes immutable values for "top-level" classes directly,
@@ -49,20 +65,41 @@ int Train::nPred = 0;
 
    @param totLevels, if positive, limits the number of levels to build.
 
+   @param blockBytes, if positive, budgets the memory of a block of
+   trees, with 'trainBlock' bounding the block size.
+
+   @param spillDir, if nonempty, names a directory in which to back the
+   largest training buffers with memory-mapped files.
+
+   @param seed keys the generation of random variates.  Training is
+   reproducible from the seed, independent of thread count.
+
+   @param spillMin is the size, in bytes, below which buffers remain on
+   the heap although a spill directory is named.
+
+   @param dfBytes, if positive, finishes depth-first those nodes whose
+   compact copy fits within the given number of bytes.
+
    @return void.
 */
-void Train::Init(double *_feNum, int _facCard[], int _cardMax, int _nPredNum, int _nPredFac, int _nRow, int _nTree, int _nSamp, double _feSampleWeight[], bool _withRepl, int _trainBlock, int _minNode, double _minRatio, int _totLevels, int _ctgWidth, int _predFixed, double _predProb[], double _regMono[]) {
+void Train::Init(double *_feNum, int _facCard[], int _cardMax, int _nPredNum, int _nPredFac, int _nRow, int _nTree, int _nSamp, double _feSampleWeight[], bool _withRepl, int _trainBlock, int _minNode, double _minRatio, int _totLevels, int _ctgWidth, int _predFixed, double _predProb[], double _regMono[], size_t _blockBytes, const char *_spillDir, unsigned int _seed, size_t _spillMin, size_t _dfBytes) {
   nTree = _nTree;
   nRow = _nRow;
   nPred = _nPredNum + _nPredFac;
   trainBlock = _trainBlock;
+  blockBytes = _blockBytes;
   PBTrain::Immutables(_feNum, _facCard, _cardMax, _nPredNum, _nPredFac, nRow);
-  Sample::Immutables(nRow, nPred, _nSamp, _feSampleWeight, _withRepl, _ctgWidth, nTree);
+  Sample::Immutables(nRow, nPred, _nSamp, _feSampleWeight, _withRepl, _ctgWidth);
   SPNode::Immutables(_ctgWidth);
   SplitSig::Immutables(nPred, _minRatio);
-  Index::Immutables(_minNode, _totLevels);
+  Index::Immutables(_minNode, _totLevels, nPred, _dfBytes);
   PreTree::Immutables(nPred, _nSamp, _minNode);
   SplitPred::Immutables(nPred, _ctgWidth, _predFixed, _predProb, _regMono);
+  Arena::Immutables();
+  Spill::Immutables(_spillDir, _spillMin);
+  MemTrack::Immutables();
+  ProfTrack::Immutables();
+  Philox::Immutables(_seed);
   //  Run::Immutables(_ctgWidth);
 }
 
@@ -74,6 +111,7 @@ void Train::Init(double *_feNum, int _facCard[], int _cardMax, int _nPredNum, in
 */
 void Train::DeImmutables() {
   nTree = nRow = nPred = trainBlock = 0;
+  blockBytes = 0;
   PBTrain::DeImmutables();
   SplitSig::DeImmutables();
   Index::DeImmutables();
@@ -81,6 +119,9 @@ void Train::DeImmutables() {
   Sample::DeImmutables();
   SPNode::DeImmutables();
   SplitPred::DeImmutables();
+  Arena::DeImmutables();
+  Spill::DeImmutables();
+  Philox::DeImmutables();
   //  Run::DeImmutables();
 }
 
@@ -88,7 +129,7 @@ void Train::DeImmutables() {
 /**
    @brief Regression constructor.
  */
-Train::Train(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank) : forest(new Forest(_forestNode, _origin, _facOrigin, _facSplit)), predInfo(_predInfo), response(Response::FactoryReg(_y, _row2Rank, _leafOrigin, _leafNode, _bagRow, _rank)) {
+Train::Train(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank) : forest(new Forest(_forestNode, _origin, _facOrigin, _facSplit)), predInfo(_predInfo), response(Response::FactoryReg(_y, _row2Rank, _leafOrigin, _leafNode, _bagPack, _rank)) {
 }
 
 
@@ -103,8 +144,8 @@ Train::Train(const std::vector<double> &_y, const std::vector<unsigned int> &_ro
 
    @return forest height, with output reference parameter.
 */
-void Train::Regression(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<unsigned int> &_rank) {
-  Train *train = new Train(_y, _row2Rank, _origin, _facOrigin, _predInfo, _forestNode, _facSplit, _leafOrigin, _leafNode, _bagRow, _rank);
+void Train::Regression(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank) {
+  Train *train = new Train(_y, _row2Rank, _origin, _facOrigin, _predInfo, _forestNode, _facSplit, _leafOrigin, _leafNode, _bagPack, _rank);
 
   RowRank *rowRank = new RowRank(_feRow, _feRank, _feInvNum, nRow, nPred);
   train->ForestTrain(rowRank);
@@ -118,7 +159,7 @@ void Train::Regression(int _feRow[], int _feRank[], int _feInvNum[], const std::
 /**
    @brief Classification constructor.
  */
-Train::Train(const std::vector<unsigned int> &_yCtg, unsigned int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight) : forest(new Forest(_forestNode, _origin, _facOrigin, _facSplit)), predInfo(_predInfo), response(Response::FactoryCtg(_yCtg, _yProxy, _leafOrigin, _leafNode, _bagRow, _weight, _ctgWidth)) {
+Train::Train(const std::vector<unsigned int> &_yCtg, unsigned int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight) : forest(new Forest(_forestNode, _origin, _facOrigin, _facSplit)), predInfo(_predInfo), response(Response::FactoryCtg(_yCtg, _yProxy, _leafOrigin, _leafNode, _bagPack, _weight, _ctgWidth)) {
 }
 
 
@@ -127,8 +168,8 @@ Train::Train(const std::vector<unsigned int> &_yCtg, unsigned int _ctgWidth, con
 
    @return void.
 */
-void Train::Classification(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<unsigned int> &_yCtg, int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<BagRow> &_bagRow, std::vector<double> &_weight) {
-  Train *train = new Train(_yCtg, _ctgWidth, _yProxy, _origin, _facOrigin, _predInfo, _forestNode, _facSplit, _leafOrigin, _leafNode, _bagRow, _weight);
+void Train::Classification(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<unsigned int> &_yCtg, int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight) {
+  Train *train = new Train(_yCtg, _ctgWidth, _yProxy, _origin, _facOrigin, _predInfo, _forestNode, _facSplit, _leafOrigin, _leafNode, _bagPack, _weight);
 
   RowRank *rowRank = new RowRank(_feRow, _feRank, _feInvNum, nRow, nPred);
   train->ForestTrain(rowRank);
@@ -146,16 +187,19 @@ Train::~Train() {
 
 
 /**
-  @brief Trains the requisite number of trees.
-
-  @param trainBlock is the maximum Count of trees to train en block.
+  @brief Trains the requisite number of trees.  If budgeted, the block
+  size is chosen initially from an estimate of the per-tree footprint
+  and thereafter from the footprint measured in the preceding block.
 
   @return void.
 */
 void Train::ForestTrain(const RowRank *rowRank) {
-  for (unsigned treeStart = 0; treeStart < nTree; treeStart += trainBlock) {
-    unsigned int treeEnd = std::min(treeStart + trainBlock, nTree); // one beyond.
-    Block(rowRank, treeStart, treeEnd - treeStart);
+  unsigned int blockSize = BlockSize(Sample::BytesEst());
+  for (unsigned treeStart = 0; treeStart < nTree; ) {
+    unsigned int treeEnd = std::min(treeStart + blockSize, nTree); // one beyond.
+    size_t treeBytes = Block(rowRank, treeStart, treeEnd - treeStart);
+    blockSize = BlockSize(treeBytes);
+    treeStart = treeEnd;
   }
     
   // Normalizes 'predInfo' to per-tree means.
@@ -163,23 +207,159 @@ void Train::ForestTrain(const RowRank *rowRank) {
   for (int i = 0; i < nPred; i++)
     predInfo[i] *= recipNTree;
 
+  segmentCount = reallocCount = 0;
+  forest->Finalize(segmentCount, reallocCount);
+  response->LeafFinalize(segmentCount, reallocCount);
   forest->SplitUpdate(rowRank);
+
+  // The arena tallies do not outlive training, so are copied out.
+  Arena::Totals(arenaAlloc, arenaChunk, arenaServed, arenaHighWater);
+
+  peakRSS = 0;
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+    peakRSS = usage.ru_maxrss; // Bytes.
+#else
+    peakRSS = size_t(usage.ru_maxrss) * 1024; // Kilobytes.
+#endif
+  }
+#endif
+}
+
+
+/**
+   @brief Reports the per-tree arenas' traffic over the most recent
+   training, summed across trees.  Few system allocations relative to
+   requests served indicate that the arenas are absorbing the per-level
+   scratch.
+
+   @param allocCount outputs the number of requests served.
+
+   @param chunkCount outputs the number of system allocations.
+
+   @param bytesServed outputs the total bytes requested.
+
+   @param highWater outputs the peak bytes outstanding within any tree.
+
+   @return void, with output reference parameters.
+ */
+void Train::ArenaReport(size_t &allocCount, size_t &chunkCount, size_t &bytesServed, size_t &highWater) {
+  allocCount = arenaAlloc;
+  chunkCount = arenaChunk;
+  bytesServed = arenaServed;
+  highWater = arenaHighWater;
+}
+
+
+/**
+   @brief Reports the memory accounting of the most recent training.
+   Reports are empty unless accounting has been compiled in, by defining
+   ARBORIST_MEMTRACK.
+
+   @param subName outputs the name of each accounted subsystem.
+
+   @param current outputs bytes held at completion, by subsystem.
+
+   @param peak outputs high-water bytes, by subsystem.
+
+   @param treePeak outputs the high-water total within each tree.
+
+   @param levelPeak outputs the high-water total at each tree depth.
+
+   @return void, with output reference parameters.
+ */
+void Train::MemReport(std::vector<std::string> &subName, std::vector<size_t> &current, std::vector<size_t> &peak, std::vector<size_t> &treePeak, std::vector<size_t> &levelPeak) {
+  MemTrack::Report(current, peak, treePeak, levelPeak);
+  subName.clear();
+  for (unsigned int sub = 0; sub < current.size(); sub++)
+    subName.push_back(MemTrack::SubName(sub));
+}
+
+
+/**
+   @brief Reports the phase timing of the most recent training.
+   Reports are empty unless timing has been compiled in, by defining
+   ARBORIST_PROFILE.  Tallies by depth and by tree are flattened, with
+   phase varying fastest.
+
+   @param phaseName outputs the name of each timed phase.
+
+   @param phaseSec outputs seconds spent in each phase.
+
+   @param levelSec outputs seconds spent in each phase, by depth.
+
+   @param treeSec outputs seconds spent in each phase, by tree.
+
+   @param levelPairs outputs pairs or nodes visited, by depth and phase.
+
+   @param levelVolume outputs bytes restaged and split candidates, by
+   depth and phase.
+
+   @return void, with output reference parameters.
+ */
+void Train::ProfReport(std::vector<std::string> &phaseName, std::vector<double> &phaseSec, std::vector<double> &levelSec, std::vector<double> &treeSec, std::vector<size_t> &levelPairs, std::vector<size_t> &levelVolume) {
+  ProfTrack::Report(phaseSec, levelSec, treeSec, levelPairs, levelVolume);
+  phaseName.clear();
+  for (unsigned int phase = 0; phase < phaseSec.size(); phase++)
+    phaseName.push_back(ProfTrack::PhaseName(phase));
+}
+
+
+/**
+   @brief Exports the phase timing of the most recent training as a
+   Chrome trace, loadable by chrome://tracing or Perfetto.
+
+   @param trace outputs the trace-event JSON, empty unless timing has
+   been compiled in.
+
+   @return void, with output reference parameter.
+ */
+void Train::ProfTrace(std::string &trace) {
+  ProfTrack::Trace(trace);
 }
 
 
 /**
+   @brief Sizes the next block of trees.  Absent a budget, the front
+   end's block size is employed.
+
+   @param treeBytes is the anticipated footprint of a single tree.
 
-   @param tEnd is one 
+   @return count of trees to train in the next block.
  */
-void Train::Block(const RowRank *rowRank, unsigned int tStart, unsigned int tCount) {
-  PreTree **ptBlock = response->BlockTree(rowRank, tCount);
+unsigned int Train::BlockSize(size_t treeBytes) const {
+  unsigned int blockMax = trainBlock > 0 ? trainBlock : nTree;
+  if (blockBytes == 0 || treeBytes == 0)
+    return blockMax;
+
+  size_t blockSize = blockBytes / treeBytes;
+  return blockSize < 1 ? 1 : std::min(blockSize, size_t(blockMax));
+}
+
+
+/**
+   @brief Trains a block of trees.
+
+   @param tStart is the absolute index of the first tree in the block.
+
+   @param tCount is the number of trees in the block.
+
+   @return largest per-tree footprint measured in the block, in bytes.
+ */
+size_t Train::Block(const RowRank *rowRank, unsigned int tStart, unsigned int tCount) {
+  PreTree **ptBlock = response->BlockTree(rowRank, tStart, tCount);
   if (tStart == 0)
     Reserve(ptBlock, tCount);
 
   BlockTree(ptBlock, tStart, tCount);
+  size_t treeBytes = response->BlockBytes(tCount);
   response->DeBlock(tCount);
 
   delete [] ptBlock;
+
+  return treeBytes;
 }
 
  
@@ -189,6 +369,8 @@ void Train::Block(const RowRank *rowRank, unsigned int tStart, unsigned int tCou
 
   @param ptBlock is a block of PreTree references.
 
+  @param tCount is the number of trees in the block.
+
   @return void.
 */
 void Train::Reserve(PreTree **ptBlock, unsigned int tCount) {
@@ -197,7 +379,7 @@ void Train::Reserve(PreTree **ptBlock, unsigned int tCount) {
   unsigned int blockHeight = BlockPeek(ptBlock, tCount, blockFac, blockBag, blockLeaf, maxHeight);
   PreTree::Reserve(maxHeight);
 
-  double slop = (slopFactor * nTree) / trainBlock;
+  double slop = (slopFactor * nTree) / tCount;
   forest->Reserve(blockHeight, blockFac, slop);
   response->LeafReserve(slop * blockLeaf, slop * blockBag);
 }
@@ -243,7 +425,7 @@ void Train::BlockTree(PreTree **ptBlock, unsigned int blockStart, unsigned int b
     const std::vector<unsigned int> leafMap = ptBlock[blockIdx]->DecTree(forest, tIdx, predInfo);
     response->Leaves(leafMap, blockIdx, tIdx);
 
-    delete ptBlock[blockIdx];
+    PreTree::Release(ptBlock[blockIdx]);
   }
 }
 
@@ -17,6 +17,8 @@
 #define ARBORIST_TRAIN_H
 
 #include <vector>
+#include <string>
+#include <cstddef>
 //using namespace std;
 
 /**
@@ -24,11 +26,20 @@
    of the data and constructs forest, leaf and diagnostic structures.
 */
 class Train {
+  friend class KernelBench; // Tears down immutables between runs.
   static constexpr double slopFactor = 1.2; // Estimates tree growth.
   static int trainBlock; // Front-end defined buffer size.
+  static size_t blockBytes; // Memory budget for a block, if positive.
+  static size_t peakRSS; // Peak resident set, in bytes, if measurable.
   static unsigned int nTree;
   static unsigned int nRow;
   static int nPred;
+  static unsigned int segmentCount; // Overflow segments opened by crescent storage.
+  static unsigned int reallocCount; // Reallocating copies of crescent storage.
+  static size_t arenaAlloc; // Requests served by the per-tree arenas.
+  static size_t arenaChunk; // System allocations made by the per-tree arenas.
+  static size_t arenaServed; // Bytes requested of the per-tree arenas.
+  static size_t arenaHighWater; // Peak bytes outstanding in any one arena.
 
   class Forest *forest;
   double *predInfo; // E.g., Gini gain:  nPred.
@@ -38,11 +49,11 @@ class Train {
 
   /**
   */
-  Train(const std::vector<unsigned int> &_yCtg, unsigned int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<double> &_weight);
+  Train(const std::vector<unsigned int> &_yCtg, unsigned int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight);
 
  /**
   */
-  Train(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<unsigned int> &_rank);
+  Train(const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank);
 
   ~Train();
   
@@ -54,16 +65,53 @@ class Train {
 
    @return void.
  */
-  static void Init(double *_feNum, int _facCard[], int _cardMax, int _nPredNum, int _nPredFac, int _nRow, int _nTree, int _nSamp, double _feSampleWeight[], bool withRepl, int _trainBlock, int _minNode, double _minRatio, int _totLevels, int _ctgWidth, int _predFixed, double _predProb[], double _regMono[] = 0);
+  static void Init(double *_feNum, int _facCard[], int _cardMax, int _nPredNum, int _nPredFac, int _nRow, int _nTree, int _nSamp, double _feSampleWeight[], bool withRepl, int _trainBlock, int _minNode, double _minRatio, int _totLevels, int _ctgWidth, int _predFixed, double _predProb[], double _regMono[] = 0, size_t _blockBytes = 0, const char *_spillDir = 0, unsigned int _seed = 0, size_t _spillMin = 1 << 20, size_t _dfBytes = 0);
 
-  static void Regression(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<unsigned int> &_rank);
+  static void Regression(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<double> &_y, const std::vector<unsigned int> &_row2Rank, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<unsigned int> &_rank);
 
-  static void Classification(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<unsigned int>  &_yCtg, int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<class BagRow> &_bagRow, std::vector<double> &_weight);
+  static void Classification(int _feRow[], int _feRank[], int _feInvNum[], const std::vector<unsigned int>  &_yCtg, int _ctgWidth, const std::vector<double> &_yProxy, std::vector<unsigned int> &_origin, std::vector<unsigned int> &_facOrigin, double _predInfo[], std::vector<class ForestNode> &_forestNode, std::vector<unsigned int> &_facSplit, std::vector<unsigned int> &_leafOrigin, std::vector<class LeafNode> &_leafNode, std::vector<unsigned char> &_bagPack, std::vector<double> &_weight);
 
+  /**
+     @brief Reports the count of overflow segments opened by the most
+     recent training, as a gauge of the size estimate's accuracy.
+
+     @return overflow segment count.
+   */
+  static inline unsigned int SegmentCount() {
+    return segmentCount;
+  }
+
+
+  /**
+     @brief Reports the count of reallocating copies incurred by the most
+     recent training's crescent storage.
+
+     @return reallocation count.
+   */
+  static inline unsigned int ReallocCount() {
+    return reallocCount;
+  }
+
+  /**
+     @brief Reports the peak resident set of the training process,
+     as a check on the memory budget.
+
+     @return peak resident set, in bytes, or zero if not measurable.
+   */
+  static inline size_t PeakRSS() {
+    return peakRSS;
+  }
+
+  static void ArenaReport(size_t &allocCount, size_t &chunkCount, size_t &bytesServed, size_t &highWater);
+  static void MemReport(std::vector<std::string> &subName, std::vector<size_t> &current, std::vector<size_t> &peak, std::vector<size_t> &treePeak, std::vector<size_t> &levelPeak);
+  static void ProfReport(std::vector<std::string> &phaseName, std::vector<double> &phaseSec, std::vector<double> &levelSec, std::vector<double> &treeSec, std::vector<size_t> &levelPairs, std::vector<size_t> &levelVolume);
+  static void ProfTrace(std::string &trace);
+
+  unsigned int BlockSize(size_t treeBytes) const;
   void Reserve(class PreTree **ptBlock, unsigned int tCount);
   unsigned int BlockPeek(class PreTree **ptBlock, unsigned int tCount, unsigned int &blockFac, unsigned int &blockBag, unsigned int &blockLeaf, unsigned int &maxHeight);
   void BlockTree(class PreTree **ptBlock, unsigned int tStart, unsigned int tCount);
-  void Block(const class RowRank *rowRank, unsigned int tStart, unsigned int tCount);
+  size_t Block(const class RowRank *rowRank, unsigned int tStart, unsigned int tCount);
 };
 
 